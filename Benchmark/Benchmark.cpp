@@ -0,0 +1,79 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstdarg>
+#include <algorithm>
+//=====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace benchmark
+{
+    static bool g_passed = true;
+
+    bool expect(const bool condition, const char* format, ...)
+    {
+        if (condition)
+            return true;
+
+        va_list args;
+        va_start(args, format);
+        printf("FAILED: ");
+        vprintf(format, args);
+        printf("\n");
+        va_end(args);
+
+        g_passed = false;
+        return false;
+    }
+
+    bool expect_passed()
+    {
+        return g_passed;
+    }
+
+    vector<std::byte> procedural_image(const uint32_t side)
+    {
+        vector<std::byte> image(static_cast<size_t>(side) * side * 4);
+        uint32_t seed = 1;
+        for (uint32_t y = 0; y < side; y++)
+        {
+            for (uint32_t x = 0; x < side; x++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const uint32_t noise    = (seed >> 24) & 31;
+                const bool checker      = ((x / 37) + (y / 29)) & 1;
+                std::byte* pixel        = &image[(static_cast<size_t>(y) * side + x) * 4];
+                pixel[0] = static_cast<std::byte>(min(255u, (x * 255) / side + noise));
+                pixel[1] = static_cast<std::byte>(min(255u, (y * 255) / side + noise));
+                pixel[2] = static_cast<std::byte>(checker ? 200 + noise : 40 + noise);
+                pixel[3] = static_cast<std::byte>(checker ? 255 : 128);
+            }
+        }
+
+        return image;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+//=====================
+
+namespace Spartan
+{
+    class Context;
+    class Threading;
+    class World;
+}
+
+namespace benchmark
+{
+    // Runs a function, returns how long it took on average in milliseconds
+    template <typename Function>
+    double time_ms(Function&& function, const uint32_t repeats = 1)
+    {
+        const auto time_start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < repeats; i++)
+        {
+            function();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - time_start).count() / repeats;
+    }
+
+    // Deterministic values, any 32-bit or in [min, max)
+    struct Random
+    {
+        uint32_t seed = 1;
+        uint32_t next()
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return seed;
+        }
+        float next(const float min, const float max)
+        {
+            return min + (max - min) * static_cast<float>(next() >> 8) / 16777216.0f;
+        }
+    };
+
+    // Self-checks, a failed one is reported and turns the exit code of the run into a failure
+    bool expect(bool condition, const char* format, ...);
+    bool expect_passed();
+
+    // An RGBA8 image with gradients, noise and hard edges
+    std::vector<std::byte> procedural_image(uint32_t side);
+
+    //= MODES ============================================================================
+    void compression(Spartan::Threading* threading, uint32_t size);
+    void mips(Spartan::Threading* threading, uint32_t size);
+    void mesh(uint32_t segments);
+    void normals(Spartan::Threading* threading, uint32_t segments);
+    void components(Spartan::World* world, uint32_t count);
+    void transforms(Spartan::World* world, Spartan::Threading* threading, uint32_t count);
+    void radix_sort(uint32_t count);
+    void file_stream(Spartan::Context* context, uint32_t megabytes);
+    void simd(uint32_t count);
+    void culling(uint32_t count);
+    void threading(Spartan::Context* context, uint32_t task_count);
+    void parallel_for(Spartan::Context* context, uint32_t item_count);
+    void events(Spartan::Threading* threading, uint32_t count);
+    void handles(Spartan::World* world, uint32_t count);
+    void import(Spartan::Context* context, const char* file_path, uint32_t mesh_count);
+    //====================================================================================
+}
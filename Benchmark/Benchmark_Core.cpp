@@ -0,0 +1,373 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Benchmark.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "Core/EventSystem.h"
+#include "Core/HandleTable.h"
+#include "Threading/Threading.h"
+#include "World/World.h"
+#include "World/Entity.h"
+//=================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+//=======================
+
+namespace benchmark
+{
+    // Checks that fired events reach every subscriber right away and queued ones (from any thread) exactly once, on the next ProcessQueue(), then measures both.
+    // FrameEnd and FrameResolutionChanged are used because nothing else subscribes to them while the engine isn't ticking.
+    void events(Threading* threading, const uint32_t count)
+    {
+        EventSystem& events = EventSystem::Get();
+
+        // Firing, every subscriber once, in the order they subscribed
+        vector<uint32_t> calls;
+        EventSubscription subscriptions[3];
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            subscriptions[i] = events.Subscribe<EventType::FrameEnd>([&calls, i]() { calls.emplace_back(i); }); // the macro would split the capture list
+        }
+        FIRE_EVENT(EventType::FrameEnd);
+        expect(calls == vector<uint32_t>{ 0, 1, 2 }, "Firing reached %u of 3 subscribers", static_cast<uint32_t>(calls.size()));
+
+        // Unsubscribing, the handle is released and the handler is not called anymore
+        calls.clear();
+        UNSUBSCRIBE_FROM_EVENT(subscriptions[1]);
+        expect(!subscriptions[1].IsValid(), "Unsubscribing left the subscription valid");
+        FIRE_EVENT(EventType::FrameEnd);
+        expect(calls == vector<uint32_t>{ 0, 2 }, "Firing after unsubscribing made %u calls, expected 2", static_cast<uint32_t>(calls.size()));
+
+        // A new subscription takes the free slot and is called
+        calls.clear();
+        subscriptions[1] = SUBSCRIBE_TO_EVENT(EventType::FrameEnd, [&calls]() { calls.emplace_back(3); });
+        FIRE_EVENT(EventType::FrameEnd);
+        expect(calls.size() == 3 && count_if(calls.begin(), calls.end(), [](uint32_t i) { return i == 3; }) == 1, "Firing after subscribing again made %u calls, expected 3", static_cast<uint32_t>(calls.size()));
+
+        // Data is passed by reference, not copied
+        {
+            const vector<shared_ptr<Entity>> entities(4);
+            const void* received = nullptr;
+            EventSubscription subscription = SUBSCRIBE_TO_EVENT(EventType::WorldResolved, [&received](const vector<shared_ptr<Entity>>& data) { received = &data; });
+            FIRE_EVENT_DATA(EventType::WorldResolved, entities);
+            UNSUBSCRIBE_FROM_EVENT(subscription);
+            expect(received == &entities, "Firing with data passed a copy of it");
+        }
+
+        for (EventSubscription& subscription : subscriptions)
+        {
+            UNSUBSCRIBE_FROM_EVENT(subscription);
+        }
+
+        // Handlers which unsubscribe themselves and subscribe enough others to grow the subscribers, the dispatch in progress only calls the ones it started with.
+        // The captures are read after unsubscribing, so a function released mid call would show up here (or under a sanitizer).
+        {
+            vector<EventSubscription> added;
+            EventSubscription self[2];
+            uint32_t calls_self     = 0;
+            uint32_t calls_added    = 0;
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                self[i] = events.Subscribe<EventType::FrameEnd>([&, i]()
+                {
+                    UNSUBSCRIBE_FROM_EVENT(self[i]);
+                    for (uint32_t j = 0; j < 64; j++)
+                    {
+                        added.emplace_back(events.Subscribe<EventType::FrameEnd>([&calls_added]() { calls_added++; }));
+                    }
+                    calls_self += i + 1;
+                });
+            }
+            FIRE_EVENT(EventType::FrameEnd);
+            expect(calls_self == 3 && calls_added == 0, "Subscribing from a handler reached the new subscribers (%u calls) or skipped an old one", calls_added);
+
+            FIRE_EVENT(EventType::FrameEnd);
+            expect(calls_self == 3 && calls_added == added.size(), "After subscribing from a handler, firing made %u of %u calls", calls_added, static_cast<uint32_t>(added.size()));
+
+            // A handler which unsubscribes the one after it, that one is skipped
+            EventSubscription later;
+            uint32_t calls_later = 0;
+            EventSubscription first = SUBSCRIBE_TO_EVENT(EventType::FrameResolutionChanged, [&]() { UNSUBSCRIBE_FROM_EVENT(later); });
+            later = SUBSCRIBE_TO_EVENT(EventType::FrameResolutionChanged, [&calls_later]() { calls_later++; });
+            FIRE_EVENT(EventType::FrameResolutionChanged);
+            expect(calls_later == 0, "A handler unsubscribed during the dispatch was still called");
+
+            UNSUBSCRIBE_FROM_EVENT(first);
+            for (EventSubscription& subscription : added)
+            {
+                UNSUBSCRIBE_FROM_EVENT(subscription);
+            }
+        }
+
+        // Queueing from one thread, nothing is delivered until ProcessQueue(), which delivers in order
+        vector<EventType> delivered;
+        EventSubscription subscription_end          = SUBSCRIBE_TO_EVENT(EventType::FrameEnd,               [&delivered]() { delivered.emplace_back(EventType::FrameEnd); });
+        EventSubscription subscription_resolution   = SUBSCRIBE_TO_EVENT(EventType::FrameResolutionChanged, [&delivered]() { delivered.emplace_back(EventType::FrameResolutionChanged); });
+        vector<EventType> queued;
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            if (i % 3 == 0)
+            {
+                QUEUE_EVENT(EventType::FrameResolutionChanged);
+                queued.emplace_back(EventType::FrameResolutionChanged);
+            }
+            else
+            {
+                QUEUE_EVENT(EventType::FrameEnd);
+                queued.emplace_back(EventType::FrameEnd);
+            }
+        }
+        expect(delivered.empty(), "Queueing delivered %u events before ProcessQueue()", static_cast<uint32_t>(delivered.size()));
+        events.ProcessQueue();
+        expect(delivered == queued, "ProcessQueue() delivered %u of %u events, or out of order", static_cast<uint32_t>(delivered.size()), static_cast<uint32_t>(queued.size()));
+        UNSUBSCRIBE_FROM_EVENT(subscription_end);
+        UNSUBSCRIBE_FROM_EVENT(subscription_resolution);
+
+        // Queueing from every thread, each event is delivered exactly once, and the ones queued by handlers wait for the next ProcessQueue()
+        uint32_t received       = 0;
+        bool requeue            = true;
+        EventSubscription subscription = SUBSCRIBE_TO_EVENT(EventType::FrameEnd, [&]()
+        {
+            received++;
+            if (requeue)
+            {
+                requeue = false;
+                QUEUE_EVENT(EventType::FrameEnd);
+            }
+        });
+
+        const double time_queue_ms = time_ms([&]()
+        {
+            threading->ParallelFor(count, [](uint32_t start, uint32_t end)
+            {
+                for (uint32_t i = start; i < end; i++)
+                {
+                    QUEUE_EVENT(EventType::FrameEnd);
+                }
+            });
+        });
+        expect(received == 0, "Queueing from many threads delivered %u events before ProcessQueue()", received);
+
+        const double time_process_ms = time_ms([&]() { events.ProcessQueue(); });
+        expect(received == count, "ProcessQueue() delivered %u of %u events queued from many threads", received, count);
+
+        events.ProcessQueue();
+        expect(received == count + 1, "An event queued by a handler was delivered %u times, expected once on the next ProcessQueue()", received - count);
+
+        // Firing, the cost of the call itself
+        received = 0;
+        requeue  = false;
+        const double time_fire_ms = time_ms([&]()
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                FIRE_EVENT(EventType::FrameEnd);
+            }
+        });
+        expect(received == count, "Firing delivered %u of %u events", received, count);
+        UNSUBSCRIBE_FROM_EVENT(subscription);
+
+        printf("Events:\t\t%u\n", count);
+        printf("Fire:\t\t%.2f ms (%.1f ns per event)\n", time_fire_ms, time_fire_ms * 1e6 / count);
+        printf("Queue:\t\t%.2f ms (%.1f ns per event, all threads)\n", time_queue_ms, time_queue_ms * 1e6 / count);
+        printf("Process:\t%.2f ms (%.1f ns per event)\n", time_process_ms, time_process_ms * 1e6 / count);
+    }
+
+    namespace
+    {
+        // Every handle the table ever gave out, along with what it should resolve to
+        struct HandleRecord
+        {
+            Handle handle;
+            uint32_t* object    = nullptr;
+            bool alive          = true;
+        };
+
+        // Resolves every handle and counts the ones which don't match their record
+        uint32_t handle_mismatches(const HandleTable<uint32_t>& table, const vector<HandleRecord>& records)
+        {
+            uint32_t mismatches = 0;
+            for (const HandleRecord& record : records)
+            {
+                mismatches += table.Get(record.handle) != (record.alive ? record.object : nullptr) ? 1 : 0;
+            }
+            return mismatches;
+        }
+    }
+
+    // Checks the handle table against a record of every handle it gave out, over random adds and removes, then the world's entity lookups built on it.
+    // Also measures a lookup by handle and by id, against the linear search the world used before.
+    void handles(World* world, const uint32_t count)
+    {
+        // Random adds and removes, removes also hit handles which are already gone
+        HandleTable<uint32_t> table;
+        vector<uint32_t> objects(count * 4);
+        vector<HandleRecord> records;
+        records.reserve(objects.size());
+        Random random;
+        uint32_t alive          = 0;
+        uint32_t alive_max      = 0;
+        uint32_t index_end      = 0;
+        uint32_t removes_wrong  = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(objects.size()); i++)
+        {
+            if (alive == 0 || random.next() % 3 != 0)
+            {
+                HandleRecord record;
+                record.object   = &objects[i];
+                record.handle   = table.Add(record.object);
+                records.emplace_back(record);
+                alive++;
+            }
+            else
+            {
+                HandleRecord& record = records[random.next() % records.size()];
+                removes_wrong += table.Remove(record.handle) != record.alive ? 1 : 0;
+                alive         -= record.alive ? 1 : 0;
+                record.alive   = false;
+            }
+
+            alive_max = max(alive_max, alive);
+            index_end = max(index_end, records.back().handle.index + 1);
+        }
+        expect(removes_wrong == 0, "Removing %u handles reported the wrong result", removes_wrong);
+        expect(table.GetCount() == alive, "The handle table counts %u objects, expected %u", table.GetCount(), alive);
+        expect(handle_mismatches(table, records) == 0, "%u handles resolved to the wrong object", handle_mismatches(table, records));
+        expect(!table.Get(Handle()), "An invalid handle resolved to an object");
+
+        // Freed slots are reused before the table grows, so it never holds more slots than objects at its peak
+        expect(index_end <= alive_max, "The handle table grew to %u slots for at most %u objects", index_end, alive_max);
+
+        // Clearing, old handles resolve to nothing, even once their slots are in use again
+        table.Clear();
+        for (HandleRecord& record : records)
+        {
+            record.alive = false;
+        }
+        expect(table.GetCount() == 0, "Clearing left %u objects in the handle table", table.GetCount());
+        uint32_t index_reused_end = 0;
+        for (uint32_t i = 0; i < alive_max; i++)
+        {
+            index_reused_end = max(index_reused_end, table.Add(&objects[i]).index + 1);
+        }
+        expect(handle_mismatches(table, records) == 0, "%u handles from before clearing resolved to an object", handle_mismatches(table, records));
+        expect(index_reused_end <= alive_max, "The handle table grew to %u slots after clearing, instead of reusing %u", index_reused_end, alive_max);
+
+        // The world, every entity is found by handle, id and name, and after an id change only by its new id
+        vector<shared_ptr<Entity>> entities;
+        entities.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            entities.emplace_back(world->EntityCreate());
+            entities.back()->SetName("handles_" + to_string(i));
+        }
+
+        vector<uint32_t> ids_old;
+        for (uint32_t i = 0; i < count; i += 2)
+        {
+            ids_old.emplace_back(entities[i]->GetId());
+            entities[i]->SetId(Spartan_Object::GenerateId());
+        }
+
+        uint32_t mismatches = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const shared_ptr<Entity>& entity = entities[i];
+            mismatches += world->EntityGetByHandle(entity->GetHandle()) != entity.get() ? 1 : 0;
+            mismatches += world->EntityGetById(entity->GetId()) != entity ? 1 : 0;
+            mismatches += world->EntityGetByName(entity->GetName()) != entity ? 1 : 0;
+        }
+        for (const uint32_t id : ids_old)
+        {
+            mismatches += world->EntityGetById(id) ? 1 : 0;
+        }
+        expect(mismatches == 0, "%u entity lookups returned the wrong entity", mismatches);
+
+        // Lookups, the linear search is timed over a slice, it's quadratic over all of them
+        const uint32_t repeats  = 10;
+        uint32_t found_handle   = 0;
+        uint32_t found_id       = 0;
+        uint32_t found_linear   = 0;
+        const double time_handle_ms = time_ms([&]()
+        {
+            for (const shared_ptr<Entity>& entity : entities)
+            {
+                found_handle += world->EntityGetByHandle(entity->GetHandle()) ? 1 : 0;
+            }
+        }, repeats) / count;
+
+        const double time_id_ms = time_ms([&]()
+        {
+            for (const shared_ptr<Entity>& entity : entities)
+            {
+                found_id += world->EntityGetById(entity->GetId()) ? 1 : 0;
+            }
+        }, repeats) / count;
+
+        const uint32_t count_linear = min(count, 1000u);
+        const double time_linear_ms = time_ms([&]()
+        {
+            for (uint32_t i = 0; i < count_linear; i++)
+            {
+                const uint32_t id = entities[count - 1 - i]->GetId();
+                for (const shared_ptr<Entity>& entity : world->EntityGetAll())
+                {
+                    if (entity->GetId() == id)
+                    {
+                        found_linear++;
+                        break;
+                    }
+                }
+            }
+        }, repeats) / count_linear;
+        expect(found_handle == count * repeats && found_id == count * repeats && found_linear == count_linear * repeats, "Timed lookups missed entities");
+
+        // Unloading, every handle and id resolves to nothing
+        vector<Handle> handles_old;
+        vector<uint32_t> ids;
+        for (const shared_ptr<Entity>& entity : entities)
+        {
+            handles_old.emplace_back(entity->GetHandle());
+            ids.emplace_back(entity->GetId());
+        }
+        world->Unload();
+        mismatches = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            mismatches += world->EntityGetByHandle(handles_old[i]) ? 1 : 0;
+            mismatches += world->EntityGetById(ids[i]) ? 1 : 0;
+        }
+        expect(mismatches == 0, "%u lookups found an entity after unloading", mismatches);
+
+        printf("Handles:\t%u slots for at most %u objects, %u adds and removes\n", index_end, alive_max, static_cast<uint32_t>(objects.size()));
+        printf("Entities:\t%u\n", count);
+        printf("By handle:\t%.1f ns\n", time_handle_ms * 1e6);
+        printf("By id:\t\t%.1f ns\n", time_id_ms * 1e6);
+        printf("Linear:\t\t%.1f ns\n", time_linear_ms * 1e6);
+    }
+}
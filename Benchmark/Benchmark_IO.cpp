@@ -0,0 +1,242 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===============
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <memory>
+#include "RHI/RHI_Vertex.h"
+#include "RHI/RHI_Texture2D.h"
+#include "IO/FileStream.h"
+//==========================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        // Same chunk ids and layout as a .model (indices and vertices) and a .texture (a single mip)
+        const uint32_t chunk_indices    = 1;
+        const uint32_t chunk_vertices   = 2;
+        const uint32_t chunk_mip        = 3;
+
+        struct Payload
+        {
+            vector<uint32_t> indices;
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vector<std::byte> mip;
+        };
+
+        bool write(const string& path, const Payload& payload)
+        {
+            FileStream file(path, FileStream_Write | FileStream_Chunked);
+            if (!file.IsOpen())
+                return false;
+
+            file.ChunkBegin(chunk_indices);
+            file.Write(payload.indices);
+            file.ChunkBegin(chunk_vertices);
+            file.Write(payload.vertices);
+            file.ChunkBegin(chunk_mip);
+            file.Write(payload.mip);
+            file.Close();
+
+            return true;
+        }
+
+        bool read(const string& path, const uint32_t flags, Payload* payload)
+        {
+            FileStream file(path, FileStream_Read | FileStream_Chunked | flags);
+            if (!file.IsOpen())
+                return false;
+
+            file.ChunkSeek(chunk_indices);
+            file.Read(&payload->indices);
+            file.ChunkSeek(chunk_vertices);
+            file.Read(&payload->vertices);
+            file.ChunkSeek(chunk_mip);
+            file.Read(&payload->mip);
+
+            return true;
+        }
+
+        // Only touches the bytes, what a loader that uploads straight from the mapping would do
+        uint64_t read_spans(const string& path)
+        {
+            FileStream file(path, FileStream_Read | FileStream_Chunked | FileStream_Mapped);
+            if (!file.IsOpen())
+                return 0;
+
+            uint64_t checksum = 0;
+            file.ChunkSeek(chunk_indices);
+            for (const uint32_t index : file.ReadSpan<uint32_t>())
+            {
+                checksum += index;
+            }
+            file.ChunkSeek(chunk_vertices);
+            for (const RHI_Vertex_PosTexNorTan& vertex : file.ReadSpan<RHI_Vertex_PosTexNorTan>())
+            {
+                checksum += static_cast<uint64_t>(vertex.pos[0]);
+            }
+            file.ChunkSeek(chunk_mip);
+            for (const std::byte value : file.ReadSpan<std::byte>())
+            {
+                checksum += static_cast<uint64_t>(value);
+            }
+
+            return checksum;
+        }
+
+        // Saves a texture with a mip chain and loads it back the way the resource cache does
+        void texture_round_trip(Context* context)
+        {
+            const string path   = "benchmark_file_stream.texture";
+            const uint32_t side = 256;
+            vector<vector<std::byte>> mips;
+            for (uint32_t mip_side = side; mip_side >= 4; mip_side /= 2)
+            {
+                mips.emplace_back(procedural_image(mip_side));
+            }
+
+            // Saving frees the texture's data, so the mips above are what it's compared against
+            auto texture = make_shared<RHI_Texture2D>(context, side, side, RHI_Format_R8G8B8A8_Unorm, mips);
+            bool saved = false;
+            const double time_save_ms = time_ms([&]() { saved = texture->SaveToFile(path); });
+            if (!expect(saved, "Failed to save \"%s\"", path.c_str()))
+                return;
+
+            {
+                FileStream file(path, FileStream_Read | FileStream_Chunked);
+                expect(file.IsOpen() && file.GetVersion() != 0, "\"%s\" was not saved in the chunked layout", path.c_str());
+            }
+
+            auto loaded = make_shared<RHI_Texture2D>(context, false);
+            bool result = false;
+            const double time_load_ms = time_ms([&]() { result = loaded->LoadFromFile(path); });
+            if (expect(result, "Failed to load \"%s\"", path.c_str()))
+            {
+                expect(loaded->GetWidth() == side && loaded->GetHeight() == side && loaded->GetFormat() == RHI_Format_R8G8B8A8_Unorm, "The texture loaded back as %ux%u, format %u", loaded->GetWidth(), loaded->GetHeight(), static_cast<uint32_t>(loaded->GetFormat()));
+                expect(loaded->GetId() == texture->GetId(), "The texture loaded back with id %u instead of %u", loaded->GetId(), texture->GetId());
+                expect(loaded->GetMipCount() == mips.size(), "The texture loaded back with %u of %u mips", loaded->GetMipCount(), static_cast<uint32_t>(mips.size()));
+
+                // Loading frees the data as well, the mips are read back from the file on demand
+                loaded->SetResourceFilePath(path);
+                uint32_t mismatches = 0;
+                for (uint32_t i = 0; i < static_cast<uint32_t>(mips.size()); i++)
+                {
+                    mismatches += loaded->GetOrLoadMip(static_cast<uint8_t>(i)) != mips[i] ? 1 : 0;
+                }
+                expect(mismatches == 0, "%u of %u texture mips loaded back different", mismatches, static_cast<uint32_t>(mips.size()));
+            }
+
+            printf("Texture:\t\t%u mips, save %.2f ms, load %.2f ms\n", static_cast<uint32_t>(mips.size()), time_save_ms, time_load_ms);
+            remove(path.c_str());
+        }
+    }
+
+    // Writes a file shaped like a large .model and .texture, then reads it back through a stream and through a memory mapping.
+    // Also saves a texture and loads it back through its own loader.
+    void file_stream(Context* context, const uint32_t megabytes)
+    {
+        const string path       = "benchmark_file_stream.bin";
+        const string path_empty = "benchmark_file_stream_empty.bin";
+
+        // A third of the size each for indices, vertices and texels
+        const uint64_t bytes = static_cast<uint64_t>(megabytes) * 1024 * 1024 / 3;
+        Payload payload;
+        payload.indices.resize(bytes / sizeof(uint32_t));
+        payload.vertices.resize(bytes / sizeof(RHI_Vertex_PosTexNorTan));
+        payload.mip = procedural_image(static_cast<uint32_t>(sqrt(static_cast<double>(bytes / 4))));
+
+        uint64_t checksum = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(payload.indices.size()); i++)
+        {
+            payload.indices[i] = (i * 2654435761u) % static_cast<uint32_t>(payload.vertices.size());
+            checksum += payload.indices[i];
+        }
+        for (uint32_t i = 0; i < static_cast<uint32_t>(payload.vertices.size()); i++)
+        {
+            payload.vertices[i] = RHI_Vertex_PosTexNorTan(Vector3(static_cast<float>(i % 1024), 0.5f, -0.5f), Vector2(0.25f, 0.75f), Vector3::Up, Vector3::Right);
+            checksum += i % 1024;
+        }
+        for (const std::byte value : payload.mip)
+        {
+            checksum += static_cast<uint64_t>(value);
+        }
+
+        if (!expect(write(path, payload), "Failed to write \"%s\"", path.c_str()))
+            return;
+
+        printf("File:\t\t\t%.1f MB\n", (payload.indices.size() * sizeof(uint32_t) + payload.vertices.size() * sizeof(RHI_Vertex_PosTexNorTan) + payload.mip.size()) / (1024.0 * 1024.0));
+
+        // The first read also warms the file cache, so that neither path pays for the disk
+        Payload streamed;
+        Payload mapped;
+        read(path, 0, &streamed);
+        const double time_stream_ms = time_ms([&]() { read(path, 0, &streamed); }, 5);
+        const double time_mapped_ms = time_ms([&]() { read(path, FileStream_Mapped, &mapped); }, 5);
+        uint64_t checksum_spans     = 0;
+        const double time_spans_ms  = time_ms([&]() { checksum_spans = read_spans(path); }, 5);
+
+        printf("Stream:\t\t\t%.2f ms\n", time_stream_ms);
+        printf("Mapped (copy):\t\t%.2f ms\n", time_mapped_ms);
+        printf("Mapped (span):\t\t%.2f ms\n", time_spans_ms);
+
+        for (const Payload* result : { &streamed, &mapped })
+        {
+            expect(result->indices == payload.indices, "The indices read back differ from the ones written");
+            expect(result->mip == payload.mip, "The texels read back differ from the ones written");
+            expect(result->vertices.size() == payload.vertices.size() && memcmp(result->vertices.data(), payload.vertices.data(), payload.vertices.size() * sizeof(RHI_Vertex_PosTexNorTan)) == 0, "The vertices read back differ from the ones written");
+        }
+        expect(checksum_spans == checksum, "The spans read back differ from what was written (checksum %llu instead of %llu)", static_cast<unsigned long long>(checksum_spans), static_cast<unsigned long long>(checksum));
+
+        // An empty file is a valid mapping of zero bytes, reading from it must fail without touching memory
+        {
+            FILE* file_empty = fopen(path_empty.c_str(), "wb");
+            if (expect(file_empty != nullptr, "Failed to create \"%s\"", path_empty.c_str()))
+            {
+                fclose(file_empty);
+
+                FileStream file(path_empty, FileStream_Read | FileStream_Mapped);
+                expect(file.IsOpen() && file.IsMapped(), "An empty file failed to map");
+
+                uint32_t value = 0xFFFFFFFF;
+                file.Read(&value);
+                expect(value == 0, "Reading an empty mapped file returned %u instead of zero", value);
+                expect(file.ReadSpan<std::byte>().size() == 0, "An empty mapped file returned a non empty span");
+            }
+        }
+
+        remove(path.c_str());
+        remove(path_empty.c_str());
+
+        texture_round_trip(context);
+    }
+}
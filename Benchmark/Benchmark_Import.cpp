@@ -0,0 +1,170 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Core/Context.h"
+#include "Threading/Threading.h"
+#include "World/World.h"
+#include "World/ComponentPools.h"
+#include "Rendering/Model.h"
+#include "Rendering/Mesh.h"
+#include "Utilities/Geometry.h"
+#include "RHI/RHI_Vertex.h"
+//===============================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        // A grid of spheres, each with its own position and material so that the importer can't merge or instance them
+        bool write_scene(const string& path, const uint32_t mesh_count)
+        {
+            const string path_material  = path.substr(0, path.find_last_of('.')) + ".mtl";
+            const string name_material  = path_material.substr(path_material.find_last_of("/\\") + 1);
+            FILE* file_obj              = fopen(path.c_str(), "w");
+            FILE* file_mtl              = fopen(path_material.c_str(), "w");
+            if (!file_obj || !file_mtl)
+            {
+                if (file_obj) fclose(file_obj);
+                if (file_mtl) fclose(file_mtl);
+                return false;
+            }
+
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vector<uint32_t> indices;
+            Utility::Geometry::CreateSphere(&vertices, &indices, 1.0f, 32, 32);
+
+            fprintf(file_obj, "mtllib %s\n", name_material.c_str());
+            uint32_t index_offset = 1; // obj indices start at one
+            for (uint32_t i = 0; i < mesh_count; i++)
+            {
+                const float x = static_cast<float>(i % 32) * 3.0f;
+                const float z = static_cast<float>(i / 32) * 3.0f;
+
+                fprintf(file_mtl, "newmtl material_%u\nKd %.3f %.3f %.3f\n", i, (i % 7) / 7.0f, (i % 11) / 11.0f, (i % 13) / 13.0f);
+                fprintf(file_obj, "o sphere_%u\nusemtl material_%u\n", i, i);
+
+                for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+                {
+                    fprintf(file_obj, "v %f %f %f\n", vertex.pos[0] + x, vertex.pos[1], vertex.pos[2] + z);
+                }
+
+                for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+                {
+                    fprintf(file_obj, "vt %f %f\n", vertex.tex[0], vertex.tex[1]);
+                }
+
+                for (size_t j = 0; j + 2 < indices.size(); j += 3)
+                {
+                    const uint32_t a = indices[j] + index_offset;
+                    const uint32_t b = indices[j + 1] + index_offset;
+                    const uint32_t c = indices[j + 2] + index_offset;
+                    fprintf(file_obj, "f %u/%u %u/%u %u/%u\n", a, a, b, b, c, c);
+                }
+
+                index_offset += static_cast<uint32_t>(vertices.size());
+            }
+
+            fclose(file_obj);
+            fclose(file_mtl);
+
+            return true;
+        }
+
+        struct ImportStats
+        {
+            double time_ms          = 0.0;
+            uint32_t renderables    = 0;
+            uint32_t vertices       = 0;
+            uint32_t indices        = 0;
+        };
+
+        ImportStats import_model(Context* context, const string& path)
+        {
+            World* world = context->GetSubsystem<World>();
+            world->Unload();
+
+            ImportStats stats;
+            shared_ptr<Model> model = make_shared<Model>(context);
+            bool loaded             = false;
+            stats.time_ms           = time_ms([&]() { loaded = model->LoadFromFile(path); });
+
+            expect(loaded, "Failed to import \"%s\"", path.c_str());
+            if (loaded && model->GetMesh())
+            {
+                stats.renderables   = world->GetComponentPools()->GetCount(ComponentType::Renderable);
+                stats.vertices      = model->GetMesh()->Vertices_Count();
+                stats.indices       = model->GetMesh()->Indices_Count();
+            }
+
+            return stats;
+        }
+    }
+
+    // Imports a model (or a generated scene with mesh_count spheres) with the importer's ParallelFor() kept on one thread, then spread over all of them
+    void import(Context* context, const char* file_path, const uint32_t mesh_count)
+    {
+        string path = file_path ? file_path : "";
+        if (path.empty())
+        {
+            path = "benchmark_import.obj";
+            if (!expect(write_scene(path, mesh_count), "Failed to write \"%s\"", path.c_str()))
+                return;
+        }
+
+        Threading* threading = context->GetSubsystem<Threading>();
+
+        threading->SetParallelForThreadCountMax(0);
+        const ImportStats stats_serial = import_model(context, path);
+
+        threading->SetParallelForThreadCountMax(UINT32_MAX);
+        const ImportStats stats_parallel = import_model(context, path);
+
+        printf("Model:\t\t\t%s, %u meshes, %u vertices, %u indices\n", path.c_str(), stats_parallel.renderables, stats_parallel.vertices, stats_parallel.indices);
+        printf("Threads\t\tImport (ms)\n");
+        printf("1\t\t%.2f\n", stats_serial.time_ms);
+        printf("%u\t\t%.2f\n", threading->GetThreadCount() + 1, stats_parallel.time_ms);
+
+        // Either way the importer has to produce the same model
+        expect(stats_serial.renderables == stats_parallel.renderables, "Mesh count differs, %u with one thread, %u with all", stats_serial.renderables, stats_parallel.renderables);
+        expect(stats_serial.vertices == stats_parallel.vertices, "Vertex count differs, %u with one thread, %u with all", stats_serial.vertices, stats_parallel.vertices);
+        expect(stats_serial.indices == stats_parallel.indices, "Index count differs, %u with one thread, %u with all", stats_serial.indices, stats_parallel.indices);
+        if (!file_path)
+        {
+            expect(stats_parallel.renderables == mesh_count, "Imported %u meshes, the scene has %u", stats_parallel.renderables, mesh_count);
+
+            const string path_material = path.substr(0, path.find_last_of('.')) + ".mtl";
+            remove(path.c_str());
+            remove(path_material.c_str());
+        }
+    }
+}
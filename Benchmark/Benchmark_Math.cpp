@@ -0,0 +1,270 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ==================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "Math/Matrix.h"
+#include "Math/BoundingBox.h"
+#include "Math/Quaternion.h"
+#include "Math/Frustum.h"
+//=============================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        // Matrices are stored column-major
+        double element(const Matrix& m, const uint32_t row, const uint32_t column)
+        {
+            return static_cast<double>(m.Data()[column * 4 + row]);
+        }
+
+        // Same products as the scalar code in Matrix, in double precision, so it can serve as the reference
+        Matrix multiply_reference(const Matrix& a, const Matrix& b)
+        {
+            float result[16];
+            for (uint32_t row = 0; row < 4; row++)
+            {
+                for (uint32_t column = 0; column < 4; column++)
+                {
+                    double sum = 0.0;
+                    for (uint32_t k = 0; k < 4; k++)
+                    {
+                        sum += element(a, row, k) * element(b, k, column);
+                    }
+                    result[row * 4 + column] = static_cast<float>(sum);
+                }
+            }
+
+            return Matrix
+            (
+                result[0],  result[1],  result[2],  result[3],
+                result[4],  result[5],  result[6],  result[7],
+                result[8],  result[9],  result[10], result[11],
+                result[12], result[13], result[14], result[15]
+            );
+        }
+
+        // The box enclosing the eight transformed corners
+        BoundingBox transform_reference(const BoundingBox& box, const Matrix& m)
+        {
+            Vector3 corners[8];
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                const Vector3 corner
+                (
+                    (i & 1) ? box.GetMax().x : box.GetMin().x,
+                    (i & 2) ? box.GetMax().y : box.GetMin().y,
+                    (i & 4) ? box.GetMax().z : box.GetMin().z
+                );
+                corners[i] = Vector3
+                (
+                    static_cast<float>(corner.x * element(m, 0, 0) + corner.y * element(m, 1, 0) + corner.z * element(m, 2, 0) + element(m, 3, 0)),
+                    static_cast<float>(corner.x * element(m, 0, 1) + corner.y * element(m, 1, 1) + corner.z * element(m, 2, 1) + element(m, 3, 1)),
+                    static_cast<float>(corner.x * element(m, 0, 2) + corner.y * element(m, 1, 2) + corner.z * element(m, 2, 2) + element(m, 3, 2))
+                );
+            }
+
+            return BoundingBox(corners, 8);
+        }
+
+        // The plane test, one box at a time and in double precision. Returns how far the box is in front of the plane that rejects it the most,
+        // a negative distance means culled.
+        double cull_reference(const Frustum& frustum, const BoundingBoxPacked& boxes, const uint32_t i, const bool ignore_depth)
+        {
+            double distance_min = numeric_limits<double>::max();
+            for (uint32_t p = ignore_depth ? 2 : 0; p < 6; p++)
+            {
+                const Plane& plane  = frustum.GetPlanes()[p];
+                const double center = boxes.center_x[i] * static_cast<double>(plane.normal.x) + boxes.center_y[i] * static_cast<double>(plane.normal.y) + boxes.center_z[i] * static_cast<double>(plane.normal.z);
+                const double radius = boxes.extent_x[i] * abs(static_cast<double>(plane.normal.x)) + boxes.extent_y[i] * abs(static_cast<double>(plane.normal.y)) + boxes.extent_z[i] * abs(static_cast<double>(plane.normal.z));
+                distance_min        = min(distance_min, center + radius + plane.d);
+            }
+            return distance_min;
+        }
+
+        float max_difference(const float* a, const float* b, const uint32_t count)
+        {
+            float difference = 0.0f;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                difference = max(difference, abs(a[i] - b[i]));
+            }
+            return difference;
+        }
+    }
+
+    // Checks the matrix and bounding box kernels against double precision references, then times them
+    void simd(const uint32_t count)
+    {
+    #if defined(SPARTAN_SIMD_AVX2)
+        printf("Backend:\t\tAVX2\n");
+    #elif defined(SPARTAN_SIMD_SSE4)
+        printf("Backend:\t\tSSE4.1\n");
+    #else
+        printf("Backend:\t\tscalar\n");
+    #endif
+
+        // Well conditioned transforms, like the ones a scene is made of
+        Random random;
+        vector<Matrix> a(count);
+        vector<Matrix> b(count);
+        vector<BoundingBox> boxes(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const auto transform = [&random]()
+            {
+                const Vector3 position      = Vector3(random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f));
+                const Quaternion rotation   = Quaternion::FromEulerAngles(random.next(-180.0f, 180.0f), random.next(-180.0f, 180.0f), random.next(-180.0f, 180.0f));
+                const Vector3 scale         = Vector3(random.next(0.5f, 2.0f), random.next(0.5f, 2.0f), random.next(0.5f, 2.0f));
+                return Matrix(position, rotation, scale);
+            };
+
+            a[i] = transform();
+            b[i] = transform();
+            const Vector3 center = Vector3(random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f));
+            const Vector3 extent = Vector3(random.next(0.1f, 5.0f), random.next(0.1f, 5.0f), random.next(0.1f, 5.0f));
+            boxes[i] = BoundingBox(center - extent, center + extent);
+        }
+
+        // Accuracy, the bounds are relative to the magnitude of the values involved (translations up to ~400)
+        const float bound_multiply  = 1e-3f;
+        const float bound_invert    = 5e-4f;
+        const float bound_transform = 1e-3f;
+
+        vector<Matrix> products(count);
+        vector<BoundingBox> transformed(count);
+        Matrix::Multiply(a.data(), b.data(), products.data(), count);
+        BoundingBox::Transform(boxes.data(), a.data(), transformed.data(), count);
+
+        float error_multiply        = 0.0f;
+        float error_multiply_batch  = 0.0f;
+        float error_invert          = 0.0f;
+        float error_transform       = 0.0f;
+        float error_transform_batch = 0.0f;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Matrix reference = multiply_reference(a[i], b[i]);
+            error_multiply          = max(error_multiply, max_difference((a[i] * b[i]).Data(), reference.Data(), 16));
+            error_multiply_batch    = max(error_multiply_batch, max_difference(products[i].Data(), reference.Data(), 16));
+
+            // The rotation and translation parts of m * m^-1 should give the identity
+            const Matrix identity = multiply_reference(a[i], a[i].Inverted());
+            error_invert = max(error_invert, max_difference(identity.Data(), Matrix::Identity.Data(), 16));
+
+            const BoundingBox box_reference = transform_reference(boxes[i], a[i]);
+            const BoundingBox box           = boxes[i].Transform(a[i]);
+            error_transform         = max(error_transform, max(max_difference(&box.GetMin().x, &box_reference.GetMin().x, 3), max_difference(&box.GetMax().x, &box_reference.GetMax().x, 3)));
+            error_transform_batch   = max(error_transform_batch, max(max_difference(&transformed[i].GetMin().x, &box_reference.GetMin().x, 3), max_difference(&transformed[i].GetMax().x, &box_reference.GetMax().x, 3)));
+        }
+
+        printf("Multiply error:\t\t%g (batch %g)\n", error_multiply, error_multiply_batch);
+        printf("Invert error:\t\t%g\n", error_invert);
+        printf("Box transform error:\t%g (batch %g)\n", error_transform, error_transform_batch);
+        expect(error_multiply <= bound_multiply && error_multiply_batch <= bound_multiply, "Matrix multiplication is off by %g (bound %g)", max(error_multiply, error_multiply_batch), bound_multiply);
+        expect(error_invert <= bound_invert, "Matrix inversion is off by %g (bound %g)", error_invert, bound_invert);
+        expect(error_transform <= bound_transform && error_transform_batch <= bound_transform, "Bounding box transformation is off by %g (bound %g)", max(error_transform, error_transform_batch), bound_transform);
+
+        // Throughput, against the double precision references as the baseline
+        const uint32_t repeats = 10;
+        const double time_multiply_ms            = time_ms([&]() { for (uint32_t i = 0; i < count; i++) products[i] = a[i] * b[i]; }, repeats);
+        const double time_multiply_batch_ms      = time_ms([&]() { Matrix::Multiply(a.data(), b.data(), products.data(), count); }, repeats);
+        const double time_multiply_reference_ms  = time_ms([&]() { for (uint32_t i = 0; i < count; i++) products[i] = multiply_reference(a[i], b[i]); }, repeats);
+        const double time_invert_ms              = time_ms([&]() { for (uint32_t i = 0; i < count; i++) products[i] = a[i].Inverted(); }, repeats);
+        const double time_transform_ms           = time_ms([&]() { for (uint32_t i = 0; i < count; i++) transformed[i] = boxes[i].Transform(a[i]); }, repeats);
+        const double time_transform_batch_ms     = time_ms([&]() { BoundingBox::Transform(boxes.data(), a.data(), transformed.data(), count); }, repeats);
+        const double time_transform_reference_ms = time_ms([&]() { for (uint32_t i = 0; i < count; i++) transformed[i] = transform_reference(boxes[i], a[i]); }, repeats);
+
+        printf("Multiply:\t\t%.3f ms (batch %.3f ms, reference %.3f ms)\n", time_multiply_ms, time_multiply_batch_ms, time_multiply_reference_ms);
+        printf("Invert:\t\t\t%.3f ms\n", time_invert_ms);
+        printf("Box transform:\t\t%.3f ms (batch %.3f ms, reference %.3f ms)\n", time_transform_ms, time_transform_batch_ms, time_transform_reference_ms);
+    }
+
+    // Checks the packed frustum culling against a plane test per box, then times it against the per box test the renderer used before
+    void culling(const uint32_t count)
+    {
+        // Boxes around and ahead of a camera at the origin, looking down +z
+        const Frustum frustum = Frustum
+        (
+            Matrix::CreateLookAtLH(Vector3::Zero, Vector3::Forward, Vector3::Up),
+            Matrix::CreatePerspectiveFieldOfViewLH(60.0f * Helper::DEG_TO_RAD, 16.0f / 9.0f, 0.3f, 1000.0f),
+            1000.0f
+        );
+
+        Random random;
+        BoundingBoxPacked boxes;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Vector3 center = Vector3(random.next(-600.0f, 600.0f), random.next(-300.0f, 300.0f), random.next(-100.0f, 1100.0f));
+            const Vector3 extent = Vector3(random.next(0.1f, 20.0f), random.next(0.1f, 20.0f), random.next(0.1f, 20.0f));
+            boxes.Add(BoundingBox(center - extent, center + extent));
+        }
+
+        // Boxes this close to a plane may go either way, depending on rounding
+        const double tolerance = 1e-3;
+        vector<uint8_t> visible(boxes.GetCountPadded());
+        for (const bool ignore_depth : { false, true })
+        {
+            frustum.Cull(boxes, 0, boxes.GetCountPadded(), visible.data(), ignore_depth);
+
+            uint32_t visible_count  = 0;
+            uint32_t mismatches     = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const double distance = cull_reference(frustum, boxes, i, ignore_depth);
+                mismatches           += (abs(distance) > tolerance && (distance >= 0.0) != (visible[i] != 0)) ? 1 : 0;
+                visible_count        += visible[i];
+            }
+
+            printf(ignore_depth ? "Visible (no depth):\t%u of %u\n" : "Visible:\t\t%u of %u\n", visible_count, count);
+            expect(mismatches == 0, "Culling%s disagrees with the plane test on %u boxes", ignore_depth ? " (ignoring depth)" : "", mismatches);
+        }
+
+        // Throughput
+        const uint32_t repeats = 10;
+        uint32_t visible_count_per_box = 0;
+        const double time_packed_ms = time_ms([&]() { frustum.Cull(boxes, 0, boxes.GetCountPadded(), visible.data()); }, repeats);
+        const double time_per_box_ms = time_ms([&]()
+        {
+            visible_count_per_box = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const Vector3 center = Vector3(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+                const Vector3 extent = Vector3(boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]);
+                visible_count_per_box += frustum.IsVisible(center, extent) ? 1 : 0;
+            }
+        }, repeats);
+
+        printf("Packed:\t\t\t%.3f ms\n", time_packed_ms);
+        printf("Per box:\t\t%.3f ms (%u visible, the sphere test is more conservative)\n", time_per_box_ms, visible_count_per_box);
+    }
+}
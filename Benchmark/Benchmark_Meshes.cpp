@@ -0,0 +1,196 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =============================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include "Resource/Import/MeshOptimizer.h"
+#include "Rendering/Mesh.h"
+#include "Utilities/Geometry.h"
+#include "RHI/RHI_Vertex.h"
+//========================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        // The triangles rotated so that the smallest index comes first (the winding is kept), then sorted, so index lists can be compared as sets of triangles
+        vector<array<uint32_t, 3>> triangles_sorted(const vector<uint32_t>& indices)
+        {
+            vector<array<uint32_t, 3>> triangles;
+            triangles.reserve(indices.size() / 3);
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                triangles.push_back(a < b && a < c ? array<uint32_t, 3>{ a, b, c } : b < c ? array<uint32_t, 3>{ b, c, a } : array<uint32_t, 3>{ c, a, b });
+            }
+            sort(triangles.begin(), triangles.end());
+            return triangles;
+        }
+
+        // Whole triangles, in range and not collapsed to a line or a point
+        bool triangles_valid(const vector<uint32_t>& indices, const uint32_t vertex_count)
+        {
+            if (indices.size() % 3 != 0)
+                return false;
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                if (a >= vertex_count || b >= vertex_count || c >= vertex_count || a == b || b == c || a == c)
+                    return false;
+            }
+
+            return true;
+        }
+    }
+
+    // Optimizes a sphere whose triangles were shuffled (the worst case for the vertex cache), then builds its levels of detail and packs its vertices.
+    // Every step is checked: reordering has to keep the same triangles, and the results have to stay within bounds.
+    void mesh(const uint32_t segments)
+    {
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;
+        Utility::Geometry::CreateSphere(&vertices, &indices, 1.0f, static_cast<int>(max(segments, 3u)), static_cast<int>(max(segments, 3u)));
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+        // Shuffle the triangles, deterministically
+        uint32_t seed = 1;
+        for (uint32_t i = static_cast<uint32_t>(indices.size() / 3) - 1; i > 0; i--)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const uint32_t j = (seed >> 8) % (i + 1);
+            swap_ranges(indices.begin() + i * 3, indices.begin() + i * 3 + 3, indices.begin() + j * 3);
+        }
+
+        const vector<array<uint32_t, 3>> triangles = triangles_sorted(indices);
+        const float acmr_shuffled                   = MeshOptimizer::ComputeAcmr(indices, vertex_count);
+        printf("Mesh:\t\t\t%u vertices, %u triangles\n", vertex_count, static_cast<uint32_t>(indices.size() / 3));
+        printf("ACMR (shuffled):\t%.3f\n", acmr_shuffled);
+
+        // A sphere lands at 0.67 to 0.69 with a 16 entry FIFO, 0.75 leaves room without letting a poor order through
+        const float acmr_max = 0.75f;
+        double duration_ms = time_ms([&]() { MeshOptimizer::OptimizeVertexCache(&indices, vertex_count); });
+        const float acmr_cache = MeshOptimizer::ComputeAcmr(indices, vertex_count);
+        printf("Vertex cache:\t\t%.2f ms, ACMR %.3f\n", duration_ms, acmr_cache);
+        expect(triangles_sorted(indices) == triangles, "Vertex cache optimization changed the triangles");
+        expect(acmr_cache <= acmr_max, "Vertex cache optimization reached an ACMR of %.3f, the maximum is %.3f", acmr_cache, acmr_max);
+
+        // Overdraw may give up some of the cache efficiency, but no more than its threshold (1.05)
+        duration_ms = time_ms([&]() { MeshOptimizer::OptimizeOverdraw(&indices, vertices); });
+        const float acmr_overdraw = MeshOptimizer::ComputeAcmr(indices, vertex_count);
+        printf("Overdraw:\t\t%.2f ms, ACMR %.3f\n", duration_ms, acmr_overdraw);
+        expect(triangles_sorted(indices) == triangles, "Overdraw optimization changed the triangles");
+        expect(acmr_overdraw <= acmr_cache * 1.05f + 0.01f, "Overdraw optimization raised the ACMR from %.3f to %.3f", acmr_cache, acmr_overdraw);
+
+        // Vertex fetch, every index has to keep pointing at the same vertex data, now laid out in first use order
+        {
+            vector<uint32_t> indices_fetch                  = indices;
+            vector<RHI_Vertex_PosTexNorTan> vertices_fetch  = vertices;
+            duration_ms = time_ms([&]() { MeshOptimizer::OptimizeVertexFetch({ &indices_fetch }, &vertices_fetch); });
+            printf("Vertex fetch:\t\t%.2f ms, %u vertices\n", duration_ms, static_cast<uint32_t>(vertices_fetch.size()));
+
+            uint32_t mismatches = 0;
+            uint32_t next_new   = 0;
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                mismatches += memcmp(&vertices_fetch[indices_fetch[i]], &vertices[indices[i]], sizeof(RHI_Vertex_PosTexNorTan)) != 0 ? 1 : 0;
+                mismatches += indices_fetch[i] > next_new ? 1 : 0;
+                next_new    = max(next_new, indices_fetch[i] + 1);
+            }
+            expect(vertices_fetch.size() <= vertices.size(), "Vertex fetch optimization grew the vertices from %u to %u", vertex_count, static_cast<uint32_t>(vertices_fetch.size()));
+            expect(mismatches == 0, "Vertex fetch optimization broke %u indices", mismatches);
+        }
+
+        // Levels of detail, each one has to be valid, smaller than the last and within the error it was given
+        const float error_max = 0.1f;
+        vector<uint32_t> lod = indices;
+        for (uint32_t level = 1; level <= 4; level++)
+        {
+            float error = 0.0f;
+            vector<uint32_t> simplified;
+            duration_ms = time_ms([&]() { simplified = MeshOptimizer::Simplify(lod, vertices, static_cast<uint32_t>(lod.size() / 2), error_max, &error); });
+            printf("LOD %u:\t\t\t%.2f ms, %u triangles, error %.4f\n", level, duration_ms, static_cast<uint32_t>(simplified.size() / 3), error);
+            expect(triangles_valid(simplified, vertex_count), "LOD %u has invalid triangles", level);
+            expect(simplified.size() <= lod.size(), "LOD %u has more triangles than the level before it", level);
+            expect(error <= error_max, "LOD %u moved the surface by %.4f, the maximum is %.4f", level, error, error_max);
+
+            if (simplified.size() == lod.size())
+                break;
+
+            lod = move(simplified);
+        }
+
+        // Vertex packing, memory and fetch bandwidth saved, and the precision it costs
+        Mesh mesh_float;
+        mesh_float.Vertices_Set(vertices);
+        vector<RHI_Vertex_PosTexNorTanPacked> vertices_packed;
+        Vector3 offset;
+        float scale = 1.0f;
+        duration_ms = time_ms([&]() { mesh_float.Vertices_Pack(&vertices_packed, &offset, &scale); });
+
+        Mesh mesh_unpacked;
+        const double time_unpack_ms = time_ms([&]() { mesh_unpacked.Vertices_Unpack(vertices_packed.data(), vertex_count, offset, scale); });
+
+        float error_position    = 0.0f;
+        float error_normal      = 0.0f;
+        float error_tangent     = 0.0f;
+        float error_uv          = 0.0f;
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const RHI_Vertex_PosTexNorTan& a = vertices[i];
+            const RHI_Vertex_PosTexNorTan& b = mesh_unpacked.Vertices_Get()[i];
+            error_position  = max(error_position, Vector3::Distance(Vector3(a.pos[0], a.pos[1], a.pos[2]), Vector3(b.pos[0], b.pos[1], b.pos[2])));
+            error_normal    = max(error_normal, acos(Helper::Clamp(Vector3(a.nor[0], a.nor[1], a.nor[2]).Dot(Vector3(b.nor[0], b.nor[1], b.nor[2])), -1.0f, 1.0f)) * Helper::RAD_TO_DEG);
+            error_tangent   = max(error_tangent, acos(Helper::Clamp(Vector3(a.tan[0], a.tan[1], a.tan[2]).Dot(Vector3(b.tan[0], b.tan[1], b.tan[2])), -1.0f, 1.0f)) * Helper::RAD_TO_DEG);
+            error_uv        = max(error_uv, max(abs(a.tex[0] - b.tex[0]), abs(a.tex[1] - b.tex[1])));
+        }
+
+        // Every cache miss fetches one vertex
+        const double fetches = MeshOptimizer::ComputeAcmr(indices, vertex_count) * (indices.size() / 3);
+        const size_t stride_float   = sizeof(RHI_Vertex_PosTexNorTan);
+        const size_t stride_packed  = sizeof(RHI_Vertex_PosTexNorTanPacked);
+        printf("Vertex packing:\t\t%.2f ms (unpack %.2f ms), %zu -> %zu bytes per vertex\n", duration_ms, time_unpack_ms, stride_float, stride_packed);
+        printf("Vertex memory:\t\t%.1f KB -> %.1f KB (%.0f%% saved)\n", vertex_count * stride_float / 1024.0, vertex_count * stride_packed / 1024.0, 100.0 * (1.0 - static_cast<double>(stride_packed) / stride_float));
+        printf("Vertex fetch per draw:\t%.1f KB -> %.1f KB\n", fetches * stride_float / 1024.0, fetches * stride_packed / 1024.0);
+        printf("Packing error:\t\tposition %.6f, normal %.4f deg, tangent %.4f deg, uv %.6f\n", error_position, error_normal, error_tangent, error_uv);
+
+        // Positions are snorm16 over the largest half extent, so each axis is off by half a step at most, a full step across the diagonal leaves room for float rounding.
+        // Directions are octahedral snorm16, measured at 0.03 to 0.04 degrees. Texture coordinates are halves, 11 bits of mantissa for values up to 1.
+        const float error_position_max  = scale * sqrt(3.0f) / 32767.0f;
+        const float error_direction_max = 0.1f;
+        const float error_uv_max        = 1.0f / 2048.0f;
+        expect(error_position <= error_position_max, "Packed positions are off by %.6f, the maximum is %.6f", error_position, error_position_max);
+        expect(error_normal <= error_direction_max, "Packed normals are off by %.4f degrees, the maximum is %.4f", error_normal, error_direction_max);
+        expect(error_tangent <= error_direction_max, "Packed tangents are off by %.4f degrees, the maximum is %.4f", error_tangent, error_direction_max);
+        expect(error_uv <= error_uv_max, "Packed texture coordinates are off by %.6f, the maximum is %.6f", error_uv, error_uv_max);
+    }
+}
@@ -0,0 +1,229 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "Threading/Threading.h"
+#include "RHI/RHI_Definition.h"
+#include "Resource/Import/BlockCompressor.h"
+#include "Resource/Import/MipGenerator.h"
+//==========================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        // Box filters an RGBA8 square down to half its side, one pixel at a time in double precision, samples are weighed by how much of them the footprint covers
+        vector<std::byte> box_reference(const vector<std::byte>& source, const uint32_t side)
+        {
+            const uint32_t side_mip = max(side / 2, 1u);
+            const double scale      = static_cast<double>(side) / side_mip;
+            const auto overlap      = [scale](const uint32_t destination, const uint32_t i)
+            {
+                return max(min(i + 1.0, (destination + 1) * scale) - max(static_cast<double>(i), destination * scale), 0.0);
+            };
+
+            vector<std::byte> mip(static_cast<size_t>(side_mip) * side_mip * 4);
+            for (uint32_t y = 0; y < side_mip; y++)
+            {
+                for (uint32_t x = 0; x < side_mip; x++)
+                {
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        double sum = 0.0;
+                        for (uint32_t sy = static_cast<uint32_t>(y * scale); sy < min(static_cast<uint32_t>(ceil((y + 1) * scale)), side); sy++)
+                        {
+                            for (uint32_t sx = static_cast<uint32_t>(x * scale); sx < min(static_cast<uint32_t>(ceil((x + 1) * scale)), side); sx++)
+                            {
+                                sum += overlap(x, sx) * overlap(y, sy) * std::to_integer<int>(source[(static_cast<size_t>(sy) * side + sx) * 4 + c]);
+                            }
+                        }
+                        mip[(static_cast<size_t>(y) * side_mip + x) * 4 + c] = static_cast<std::byte>(static_cast<uint32_t>(sum / (scale * scale) + 0.5));
+                    }
+                }
+            }
+
+            return mip;
+        }
+
+        // Fraction of the pixels whose alpha passes the cutoff
+        float alpha_coverage(const vector<std::byte>& image, const float cutoff)
+        {
+            const size_t pixels = image.size() / 4;
+            size_t passed       = 0;
+            for (size_t i = 0; i < pixels; i++)
+            {
+                passed += std::to_integer<int>(image[i * 4 + 3]) / 255.0f > cutoff ? 1 : 0;
+            }
+
+            return static_cast<float>(passed) / static_cast<float>(pixels);
+        }
+    }
+
+    // Compresses a procedural image with every format and preset, reports speed and error, and checks that the error stays within bounds
+    void compression(Threading* threading, const uint32_t size)
+    {
+        const uint32_t side = max(size & ~3u, 4u);
+        const vector<std::byte> image = procedural_image(side);
+
+        const RHI_Format formats[]                      = { RHI_Format_BC1_Unorm, RHI_Format_BC3_Unorm, RHI_Format_BC4_Unorm, RHI_Format_BC5_Unorm, RHI_Format_BC7_Unorm };
+        const BlockCompression_Quality qualities[]      = { BlockCompression_Fast, BlockCompression_Normal, BlockCompression_High };
+        const char* quality_names[]                     = { "fast", "normal", "high" };
+        const double pixels                             = static_cast<double>(side) * side;
+
+        // Lowest acceptable PSNR (dB) per format and preset, about 1.5 dB under what the encoder reaches on this image
+        const double psnr_min[][3] =
+        {
+            { 30.5, 31.5, 33.5 }, // BC1
+            { 31.5, 32.5, 34.5 }, // BC3
+            { 45.0, 45.0, 45.0 }, // BC4
+            { 45.0, 45.0, 45.0 }, // BC5
+            { 32.5, 37.0, 37.0 }  // BC7
+        };
+
+        printf("Image:\t\t\t%ux%u\n", side, side);
+        for (uint32_t format_index = 0; format_index < static_cast<uint32_t>(std::size(formats)); format_index++)
+        {
+            // Only compare the channels the format stores
+            const RHI_Format format = formats[format_index];
+            const uint32_t channels = format == RHI_Format_BC4_Unorm ? 1 : format == RHI_Format_BC5_Unorm ? 2 : format == RHI_Format_BC1_Unorm ? 3 : 4;
+
+            double psnr_previous = 0.0;
+            for (const BlockCompression_Quality quality : qualities)
+            {
+                vector<std::byte> blocks;
+                const auto time_start = chrono::high_resolution_clock::now();
+                if (!expect(BlockCompressor::Compress(format, quality, side, side, image.data(), &blocks, threading), "%s (%s) failed to compress", rhi_format_to_string(format), quality_names[quality]))
+                    continue;
+                const double time_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - time_start).count();
+
+                vector<std::byte> decoded;
+                BlockCompressor::Decompress(format, side, side, blocks.data(), &decoded);
+
+                double error = 0.0;
+                for (uint32_t i = 0; i < side * side; i++)
+                {
+                    for (uint32_t c = 0; c < channels; c++)
+                    {
+                        const double delta = static_cast<double>(std::to_integer<int>(image[i * 4 + c]) - std::to_integer<int>(decoded[i * 4 + c]));
+                        error += delta * delta;
+                    }
+                }
+                const double rmse = sqrt(error / (pixels * channels));
+                const double psnr = rmse > 0.0 ? 20.0 * log10(255.0 / rmse) : 99.0;
+
+                printf("%s (%s):\t%.2f ms, %.1f MPix/s, RMSE %.3f, PSNR %.2f dB\n", rhi_format_to_string(format), quality_names[quality], time_ms, pixels / (time_ms * 1000.0), rmse, psnr);
+                expect(psnr >= psnr_min[format_index][quality], "%s (%s) PSNR is %.2f dB, the minimum is %.2f dB", rhi_format_to_string(format), quality_names[quality], psnr, psnr_min[format_index][quality]);
+
+                // A slower preset should never look worse
+                expect(psnr >= psnr_previous - 0.01, "%s (%s) PSNR is %.2f dB, lower than the faster preset's %.2f dB", rhi_format_to_string(format), quality_names[quality], psnr, psnr_previous);
+                psnr_previous = psnr;
+            }
+        }
+    }
+
+    // Builds the full mip chain of a procedural image with every filter, linear and sRGB, and checks it against a scalar box filter,
+    // a constant image and the alpha coverage of the top mip
+    void mips(Threading* threading, const uint32_t size)
+    {
+        const uint32_t side             = max(size, 2u);
+        const uint32_t levels           = static_cast<uint32_t>(log2(static_cast<double>(side))) + 1;
+        const vector<std::byte> image   = procedural_image(side);
+        const char* filter_names[]      = { "box", "kaiser" };
+
+        // Every channel of a constant image has to survive the filters and the sRGB round trip
+        const std::byte constant[4]     = { std::byte{ 100 }, std::byte{ 150 }, std::byte{ 200 }, std::byte{ 255 } };
+        vector<std::byte> image_constant(image.size());
+        for (size_t i = 0; i < image_constant.size(); i++)
+        {
+            image_constant[i] = constant[i % 4];
+        }
+
+        printf("Image:\t\t\t%ux%u\n", side, side);
+        for (const MipFilter filter : { MipFilter_Box, MipFilter_Kaiser })
+        {
+            for (const bool srgb : { false, true })
+            {
+                const char* name            = filter_names[filter];
+                const float alpha_cutoff    = srgb ? 0.6f : 0.0f;
+
+                vector<vector<std::byte>> chain(1, image);
+                const auto time_start = chrono::high_resolution_clock::now();
+                const bool result = MipGenerator::Generate(RHI_Format_R8G8B8A8_Unorm, side, side, &chain, filter, srgb, alpha_cutoff, threading);
+                const double time_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - time_start).count();
+
+                printf("%s%s:\t\t%s, %.2f ms, %u mips\n", name, srgb ? " (srgb)" : "", result ? "ok" : "failed", time_ms, static_cast<uint32_t>(chain.size()));
+                if (!expect(result, "%s%s failed to generate mips", name, srgb ? " (srgb)" : "") ||
+                    !expect(chain.size() == levels, "%s%s generated %u mips, expected %u", name, srgb ? " (srgb)" : "", static_cast<uint32_t>(chain.size()), levels))
+                    continue;
+
+                // Linear box filtering has a scalar reference, every level is compared with it (computed from the level above)
+                if (filter == MipFilter_Box && !srgb)
+                {
+                    uint32_t error_max = 0;
+                    for (uint32_t level = 1; level < levels; level++)
+                    {
+                        const vector<std::byte> reference = box_reference(chain[level - 1], side >> (level - 1));
+                        for (size_t i = 0; i < reference.size(); i++)
+                        {
+                            error_max = max(error_max, static_cast<uint32_t>(abs(std::to_integer<int>(reference[i]) - std::to_integer<int>(chain[level][i]))));
+                        }
+                    }
+                    expect(error_max <= 1, "%s mips are up to %u off the scalar reference, the maximum is 1", name, error_max);
+                }
+
+                // Scaling alpha moves coverage in steps of every pixel that shares an alpha value, on this image they stay under 0.03 down to 8x8.
+                // Below that a handful of pixels can't get close to the top mip, so they are left out.
+                if (alpha_cutoff > 0.0f)
+                {
+                    const float tolerance   = 0.05f;
+                    const float coverage    = alpha_coverage(chain[0], alpha_cutoff);
+                    for (uint32_t level = 1; level < levels && (side >> level) >= 8; level++)
+                    {
+                        const float coverage_mip = alpha_coverage(chain[level], alpha_cutoff);
+                        expect(abs(coverage_mip - coverage) <= tolerance, "%s%s mip %u has an alpha coverage of %.3f, the top mip has %.3f", name, srgb ? " (srgb)" : "", level, coverage_mip, coverage);
+                    }
+                }
+
+                vector<vector<std::byte>> chain_constant(1, image_constant);
+                MipGenerator::Generate(RHI_Format_R8G8B8A8_Unorm, side, side, &chain_constant, filter, srgb, alpha_cutoff, threading);
+                uint32_t error_max = 0;
+                for (const vector<std::byte>& mip : chain_constant)
+                {
+                    for (size_t i = 0; i < mip.size(); i++)
+                    {
+                        error_max = max(error_max, static_cast<uint32_t>(abs(std::to_integer<int>(mip[i]) - std::to_integer<int>(constant[i % 4]))));
+                    }
+                }
+                expect(chain_constant.size() == levels && error_max <= 1, "%s%s drifts by up to %u on a constant image, the maximum is 1", name, srgb ? " (srgb)" : "", error_max);
+            }
+        }
+    }
+}
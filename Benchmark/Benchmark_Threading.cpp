@@ -0,0 +1,343 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ======================
+#include "Benchmark.h"
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+#include "Threading/Threading.h"
+//=================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        // 1, 2, 4, ... cores, always ending with all of them
+        vector<uint32_t> core_counts()
+        {
+            const uint32_t cores_max = (max)(thread::hardware_concurrency(), 1u);
+            vector<uint32_t> counts;
+            for (uint32_t cores = 1; cores < cores_max; cores *= 2)
+            {
+                counts.emplace_back(cores);
+            }
+            counts.emplace_back(cores_max);
+            return counts;
+        }
+
+        // Some arithmetic that can't be optimized away, its cost grows linearly with the iterations
+        uint32_t work(const uint32_t item, const uint32_t iterations)
+        {
+            uint32_t value = item + 1;
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                value ^= value << 13;
+                value ^= value >> 17;
+                value ^= value << 5;
+            }
+            return value;
+        }
+
+        // The scheduler the work stealing one replaced, kept as it was (minus logging) so that the two can be compared: one mutex guarded deque
+        // of heap allocated tasks, workers sleep on a condition variable. It had no way to wait on a task, callers spun on their own counters.
+        class ThreadingBaseline
+        {
+        public:
+            ThreadingBaseline(const uint32_t thread_count)
+            {
+                for (uint32_t i = 0; i < thread_count; i++)
+                {
+                    m_threads.emplace_back(thread(&ThreadingBaseline::ThreadLoop, this));
+                }
+            }
+
+            ~ThreadingBaseline()
+            {
+                unique_lock<mutex> lock(m_mutex_tasks);
+                m_stopping = true;
+                lock.unlock();
+
+                m_condition_var.notify_all();
+
+                for (auto& thread : m_threads)
+                {
+                    thread.join();
+                }
+            }
+
+            template <typename Function>
+            void AddTask(Function&& function)
+            {
+                if (m_threads.empty())
+                {
+                    function();
+                    return;
+                }
+
+                unique_lock<mutex> lock(m_mutex_tasks);
+                m_tasks.push_back(make_shared<std::function<void()>>(bind(forward<Function>(function))));
+                lock.unlock();
+
+                m_condition_var.notify_one();
+            }
+
+        private:
+            void ThreadLoop()
+            {
+                shared_ptr<std::function<void()>> task;
+                while (true)
+                {
+                    unique_lock<mutex> lock(m_mutex_tasks);
+                    m_condition_var.wait(lock, [this] { return !m_tasks.empty() || m_stopping; });
+
+                    if (m_stopping && m_tasks.empty())
+                        return;
+
+                    task = m_tasks.front();
+                    m_tasks.pop_front();
+                    lock.unlock();
+
+                    (*task)();
+                }
+            }
+
+            vector<thread> m_threads;
+            deque<shared_ptr<std::function<void()>>> m_tasks;
+            mutex m_mutex_tasks;
+            condition_variable m_condition_var;
+            bool m_stopping = false;
+        };
+
+        // Spins until the counter reaches the value, the way callers of the baseline waited
+        void spin(const atomic<uint32_t>& counter, const uint32_t value)
+        {
+            while (counter.load() < value)
+            {
+                this_thread::yield();
+            }
+        }
+
+        // The same three measurements as below, through the baseline
+        void threading_baseline(const uint32_t cores, const uint32_t task_count)
+        {
+            ThreadingBaseline threading(cores - 1);
+
+            atomic<uint32_t> executed = 0;
+            const double time_throughput_ms = time_ms([&]()
+            {
+                for (uint32_t i = 0; i < task_count; i++)
+                {
+                    threading.AddTask([&executed]() { executed.fetch_add(1, memory_order_relaxed); });
+                }
+                spin(executed, task_count);
+            });
+            expect(executed == task_count, "The baseline with %u cores executed %u tasks instead of %u", cores, executed.load(), task_count);
+
+            const uint32_t round_trips = 1000;
+            atomic<uint32_t> round_trips_executed = 0;
+            const double time_latency_ms = time_ms([&]()
+            {
+                const uint32_t expected = round_trips_executed + 1;
+                threading.AddTask([&round_trips_executed]() { round_trips_executed++; });
+                spin(round_trips_executed, expected);
+            }, round_trips);
+            expect(round_trips_executed == round_trips, "The baseline with %u cores executed %u round trips instead of %u", cores, round_trips_executed.load(), round_trips);
+
+            const uint32_t fan_out          = 16;
+            const uint32_t fan_out_repeats  = 10;
+            atomic<uint32_t> leaves         = 0;
+            atomic<uint32_t> spawners       = 0;
+            const double time_fan_out_ms = time_ms([&]()
+            {
+                const uint32_t expected_spawners    = spawners + fan_out + 1;
+                const uint32_t expected_leaves      = leaves + fan_out * fan_out;
+                threading.AddTask([&]()
+                {
+                    for (uint32_t i = 0; i < fan_out; i++)
+                    {
+                        threading.AddTask([&]()
+                        {
+                            for (uint32_t j = 0; j < fan_out; j++)
+                            {
+                                threading.AddTask([&leaves]() { leaves.fetch_add(1, memory_order_relaxed); });
+                            }
+                            spawners++;
+                        });
+                    }
+                    spawners++;
+                });
+                spin(spawners, expected_spawners);
+                spin(leaves, expected_leaves);
+            }, fan_out_repeats);
+            expect(leaves == fan_out * fan_out * fan_out_repeats, "The baseline with %u cores executed %u nested tasks instead of %u", cores, leaves.load(), fan_out * fan_out * fan_out_repeats);
+
+            printf("mutex/deque\t%u\t%.0f\t\t\t%.2f\t\t%.3f\n", cores, task_count / time_throughput_ms, time_latency_ms * 1000.0, time_fan_out_ms);
+        }
+    }
+
+    // Task throughput and latency with 1 to N cores, the calling thread counts as one of them, for the work stealing scheduler and the one it replaced
+    void threading(Context* context, const uint32_t task_count)
+    {
+        printf("Scheduler\tCores\tThroughput (tasks/ms)\tLatency (us)\tFan-out (ms)\n");
+
+        for (const uint32_t cores : core_counts())
+        {
+            threading_baseline(cores, task_count);
+
+            Threading threading(context, cores - 1);
+
+            // Throughput, many small tasks under one parent, in batches that fit the task pool
+            const uint32_t batch = 1024;
+            atomic<uint32_t> executed = 0;
+            const double time_throughput_ms = time_ms([&]()
+            {
+                for (uint32_t submitted = 0; submitted < task_count; submitted += batch)
+                {
+                    const TaskHandle parent = threading.CreateTask([] {});
+                    for (uint32_t i = submitted; i < (min)(submitted + batch, task_count); i++)
+                    {
+                        threading.SubmitTask(threading.CreateTask([&executed]() { executed.fetch_add(1, memory_order_relaxed); }, parent));
+                    }
+                    threading.SubmitTask(parent);
+                    threading.Wait(parent);
+                }
+            });
+            expect(executed == task_count, "%u cores executed %u tasks instead of %u", cores, executed.load(), task_count);
+
+            // Latency, a single task submitted and waited on, so the time is dominated by waking up and handing over
+            const uint32_t round_trips = 1000;
+            uint32_t round_trips_executed = 0;
+            const double time_latency_ms = time_ms([&]()
+            {
+                const TaskHandle task = threading.CreateTask([&round_trips_executed]() { round_trips_executed++; });
+                threading.SubmitTask(task);
+                threading.Wait(task);
+            }, round_trips);
+            expect(round_trips_executed == round_trips, "%u cores executed %u round trips instead of %u", cores, round_trips_executed, round_trips);
+
+            // Fan-out, a task which spawns children from whichever thread runs it, which spawn their own (1 + 16 + 16 * 16 tasks).
+            // They all attach to the root, which can't complete while any of them is unfinished.
+            const uint32_t fan_out          = 16;
+            const uint32_t fan_out_repeats  = 10;
+            atomic<uint32_t> leaves         = 0;
+            TaskHandle root;
+            const double time_fan_out_ms = time_ms([&]()
+            {
+                root = threading.CreateTask([&]()
+                {
+                    for (uint32_t i = 0; i < fan_out; i++)
+                    {
+                        threading.SubmitTask(threading.CreateTask([&]()
+                        {
+                            for (uint32_t j = 0; j < fan_out; j++)
+                            {
+                                threading.SubmitTask(threading.CreateTask([&leaves]() { leaves.fetch_add(1, memory_order_relaxed); }, root));
+                            }
+                        }, root));
+                    }
+                });
+                threading.SubmitTask(root);
+                threading.Wait(root);
+            }, fan_out_repeats);
+            expect(leaves == fan_out * fan_out * fan_out_repeats, "%u cores executed %u nested tasks instead of %u", cores, leaves.load(), fan_out * fan_out * fan_out_repeats);
+
+            printf("work stealing\t%u\t%.0f\t\t\t%.2f\t\t%.3f\n", cores, task_count / time_throughput_ms, time_latency_ms * 1000.0, time_fan_out_ms);
+        }
+    }
+
+    // ParallelFor's guided chunks against a static split into one equal chunk per core, on workloads whose cost per item is
+    // uniform, grows along the range, or is concentrated at its end
+    void parallel_for(Context* context, const uint32_t item_count)
+    {
+        struct Workload
+        {
+            const char* name;
+            uint32_t (*iterations)(uint32_t item, uint32_t item_count);
+        };
+        const Workload workloads[] =
+        {
+            { "uniform",    [](uint32_t, uint32_t) { return 64u; } },
+            { "linear",     [](uint32_t item, uint32_t item_count) { return 1u + static_cast<uint32_t>(128ull * item / item_count); } },
+            { "hot spot",   [](uint32_t item, uint32_t item_count) { return item >= item_count - item_count / 10 ? 640u : 32u; } }
+        };
+
+        printf("Workload\tCores\tStatic (ms)\tParallelFor (ms)\n");
+
+        for (const Workload& workload : workloads)
+        {
+            vector<uint32_t> reference(item_count);
+            for (uint32_t i = 0; i < item_count; i++)
+            {
+                reference[i] = work(i, workload.iterations(i, item_count));
+            }
+
+            for (const uint32_t cores : core_counts())
+            {
+                Threading threading(context, cores - 1);
+                const auto run = [&workload, item_count](vector<uint32_t>& results, const uint32_t start, const uint32_t end)
+                {
+                    for (uint32_t i = start; i < end; i++)
+                    {
+                        results[i] = work(i, workload.iterations(i, item_count));
+                    }
+                };
+
+                // Static, the calling thread takes the first chunk
+                vector<uint32_t> results_static(item_count);
+                const double time_static_ms = time_ms([&]()
+                {
+                    const uint32_t chunk    = (item_count + cores - 1) / cores;
+                    const TaskHandle parent = threading.CreateTask([] {});
+                    for (uint32_t start = chunk; start < item_count; start += chunk)
+                    {
+                        threading.SubmitTask(threading.CreateTask([&, start]() { run(results_static, start, (min)(start + chunk, item_count)); }, parent));
+                    }
+                    threading.SubmitTask(parent);
+                    run(results_static, 0, (min)(chunk, item_count));
+                    threading.Wait(parent);
+                }, 5);
+
+                vector<uint32_t> results_adaptive(item_count);
+                const double time_adaptive_ms = time_ms([&]()
+                {
+                    threading.ParallelFor(item_count, [&](const uint32_t start, const uint32_t end) { run(results_adaptive, start, end); });
+                }, 5);
+
+                expect(results_static == reference, "The static split computed different results (%s, %u cores)", workload.name, cores);
+                expect(results_adaptive == reference, "ParallelFor computed different results (%s, %u cores)", workload.name, cores);
+
+                printf("%-16s%u\t%.3f\t\t%.3f\n", workload.name, cores, time_static_ms, time_adaptive_ms);
+            }
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Utilities/Sort.h"
+#include "Utilities/Geometry.h"
+//=============================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    namespace
+    {
+        struct SortItem
+        {
+            uint64_t key    = 0;
+            uint32_t index  = 0; // original position, to check stability
+        };
+
+        bool operator==(const SortItem& a, const SortItem& b) { return a.key == b.key && a.index == b.index; }
+    }
+
+    // Checks the radix sort against std::stable_sort on keys of different widths and orders, then times them
+    void radix_sort(const uint32_t count)
+    {
+        struct Distribution
+        {
+            const char* name;
+            uint64_t (*key)(Random& random, uint32_t i);
+        };
+
+        const Distribution distributions[] =
+        {
+            { "64-bit",     [](Random& random, uint32_t)    { return (static_cast<uint64_t>(random.next()) << 32) | random.next(); } },
+            { "16-bit",     [](Random& random, uint32_t)    { return static_cast<uint64_t>(random.next() >> 16); } },
+            { "draw key",   [](Random& random, uint32_t)    { return (static_cast<uint64_t>(random.next() & 0x3F) << 50) | (static_cast<uint64_t>(random.next() & 0xFF) << 34) | (random.next() >> 14); } },
+            { "descending", [](Random&, uint32_t i)         { return static_cast<uint64_t>(UINT32_MAX - i) << 20; } },
+            { "constant",   [](Random&, uint32_t)           { return static_cast<uint64_t>(42); } },
+        };
+
+        printf("Keys\t\tRadix (ms)\tstable_sort (ms)\n");
+
+        Random random;
+        vector<SortItem> items;
+        vector<SortItem> scratch;
+        vector<SortItem> reference;
+        for (const Distribution& distribution : distributions)
+        {
+            // A few tiny sizes, for the early outs, then the requested one
+            for (const uint32_t size : { 0u, 1u, 2u, 3u, count })
+            {
+                items.resize(size);
+                for (uint32_t i = 0; i < size; i++)
+                {
+                    items[i] = SortItem{ distribution.key(random, i), i };
+                }
+                reference = items;
+
+                const double time_radix_ms  = time_ms([&]() { Utility::Sort::RadixSort(items, scratch); });
+                const double time_stable_ms = time_ms([&]() { stable_sort(reference.begin(), reference.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; }); });
+                expect(items == reference, "Radix sort of %u %s keys differs from std::stable_sort", size, distribution.name);
+
+                if (size == count)
+                {
+                    printf("%-16s%.3f\t\t%.3f\n", distribution.name, time_radix_ms, time_stable_ms);
+                }
+            }
+        }
+    }
+
+    // Computes the normals and tangents of a sphere, checks them against the analytic ones and that threading doesn't change them, then times it
+    void normals(Threading* threading, const uint32_t segments)
+    {
+        const int side = static_cast<int>(max(segments, 3u));
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;
+        Utility::Geometry::CreateSphere(&vertices, &indices, 1.0f, side, side);
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+        vector<RHI_Vertex_PosTexNorTan> vertices_serial = vertices;
+        const double time_serial_ms     = time_ms([&]() { Utility::Geometry::ComputeNormalsTangents(indices, &vertices_serial); });
+        const double time_parallel_ms   = time_ms([&]() { Utility::Geometry::ComputeNormalsTangents(indices, &vertices, threading); });
+
+        // Every vertex gathers its own faces, so splitting the work has to give the exact same result
+        uint32_t mismatches = 0;
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            mismatches += (memcmp(vertices[i].nor, vertices_serial[i].nor, sizeof(vertices[i].nor)) != 0 || memcmp(vertices[i].tan, vertices_serial[i].tan, sizeof(vertices[i].tan)) != 0) ? 1 : 0;
+        }
+        expect(mismatches == 0, "%u vertices differ between the threaded and the serial computation", mismatches);
+
+        // On a unit sphere the normal is the position and the tangent follows the longitude (u), the poles have no tangent direction
+        float error_normal      = 0.0f;
+        float error_tangent     = 0.0f;
+        float error_orthogonal  = 0.0f;
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const RHI_Vertex_PosTexNorTan& vertex = vertices[i];
+            const Vector3 position  = Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+            const Vector3 normal    = Vector3(vertex.nor[0], vertex.nor[1], vertex.nor[2]);
+            const Vector3 tangent   = Vector3(vertex.tan[0], vertex.tan[1], vertex.tan[2]);
+            error_normal            = max(error_normal, acos(Helper::Clamp(Vector3::Dot(normal, position.Normalized()), -1.0f, 1.0f)));
+            error_orthogonal        = max(error_orthogonal, abs(Vector3::Dot(normal, tangent)));
+
+            if (i != 0 && i != vertex_count - 1)
+            {
+                const Vector3 tangent_analytic = Vector3(-position.z, 0.0f, position.x).Normalized();
+                error_tangent = max(error_tangent, acos(Helper::Clamp(Vector3::Dot(tangent, tangent_analytic), -1.0f, 1.0f)));
+            }
+        }
+
+        // The seam and the poles only see the faces on one side of them, which tilts them by about half a segment
+        const float bound_angle         = 2.0f * Helper::PI / side;
+        const float bound_orthogonal    = 1e-4f;
+        printf("Sphere:\t\t\t%u vertices, %u triangles\n", vertex_count, static_cast<uint32_t>(indices.size() / 3));
+        printf("Normal error:\t\t%.3f degrees (bound %.3f)\n", error_normal * Helper::RAD_TO_DEG, bound_angle * Helper::RAD_TO_DEG);
+        printf("Tangent error:\t\t%.3f degrees (bound %.3f)\n", error_tangent * Helper::RAD_TO_DEG, bound_angle * Helper::RAD_TO_DEG);
+        printf("Orthogonality:\t\t%g (bound %g)\n", error_orthogonal, bound_orthogonal);
+        printf("Serial:\t\t\t%.3f ms\n", time_serial_ms);
+        printf("Threaded:\t\t%.3f ms\n", time_parallel_ms);
+        expect(error_normal <= bound_angle, "Normals are off by %.3f degrees", error_normal * Helper::RAD_TO_DEG);
+        expect(error_tangent <= bound_angle, "Tangents are off by %.3f degrees", error_tangent * Helper::RAD_TO_DEG);
+        expect(error_orthogonal <= bound_orthogonal, "Tangents aren't perpendicular to the normals, the dot product reaches %g", error_orthogonal);
+    }
+}
@@ -0,0 +1,192 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/ComponentPools.h"
+#include "World/TransformHierarchy.h"
+#include "World/Components/Transform.h"
+#include "World/Components/Renderable.h"
+//======================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+namespace benchmark
+{
+    // Walking every entity and asking it for its components, versus iterating the component pools directly
+    void components(World* world, const uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            shared_ptr<Entity> entity = world->EntityCreate();
+            if (i % 4 == 0)
+            {
+                entity->AddComponent<Renderable>();
+            }
+        }
+
+        const uint32_t repeats = 100;
+
+        // Every pass counts the shadow casters, so that the work can't be optimized away and the results can be compared
+        const ComponentPools* pools = world->GetComponentPools().get();
+        uint32_t casters_entities   = 0;
+        uint32_t casters_pool       = 0;
+        uint32_t casters_query      = 0;
+
+        const double time_entities_ms = time_ms([&]()
+        {
+            casters_entities = 0;
+            for (const shared_ptr<Entity>& entity : world->EntityGetAll())
+            {
+                if (Renderable* renderable = entity->GetComponent<Renderable>())
+                {
+                    casters_entities += renderable->GetCastShadows() ? 1 : 0;
+                }
+            }
+        }, repeats);
+
+        const double time_pool_ms = time_ms([&]()
+        {
+            casters_pool = 0;
+            for (IComponent* component : pools->GetComponents(ComponentType::Renderable))
+            {
+                casters_pool += static_cast<Renderable*>(component)->GetCastShadows() ? 1 : 0;
+            }
+        }, repeats);
+
+        const double time_query_ms = time_ms([&]()
+        {
+            casters_query = 0;
+            pools->Each<Transform, Renderable>([&](Entity*, Transform* transform, Renderable* renderable)
+            {
+                casters_query += (renderable->GetCastShadows() && transform) ? 1 : 0;
+            });
+        }, repeats);
+
+        // Every renderable has a transform, so all three walks have to agree
+        expect(casters_pool == casters_entities && casters_query == casters_entities, "The entity walk counted %u casters, the pool %u and the query %u", casters_entities, casters_pool, casters_query);
+        expect(pools->GetCount(ComponentType::Renderable) >= (count + 3) / 4, "The pool holds %u renderables, at least %u were added", pools->GetCount(ComponentType::Renderable), (count + 3) / 4);
+
+        printf("Entities:\t\t%u, %u renderable\n", world->EntityGetCount(), pools->GetCount(ComponentType::Renderable));
+        printf("Entity walk:\t\t%.3f ms (%u casters)\n", time_entities_ms, casters_entities);
+        printf("Pool:\t\t\t%.3f ms (%u casters)\n", time_pool_ms, casters_pool);
+        printf("Query:\t\t\t%.3f ms (%u casters, transform and renderable)\n", time_query_ms, casters_query);
+    }
+
+    namespace
+    {
+        // The world matrix the way transforms used to compute it, by walking up to the root
+        Matrix matrix_recursive(const Transform* transform)
+        {
+            const Matrix local = Matrix(transform->GetPositionLocal(), transform->GetRotationLocal(), transform->GetScaleLocal());
+            return transform->GetParent() ? local * matrix_recursive(transform->GetParent()) : local;
+        }
+
+        float max_difference(const vector<Transform*>& transforms)
+        {
+            float difference = 0.0f;
+            for (const Transform* transform : transforms)
+            {
+                const Matrix reference = matrix_recursive(transform);
+                const Matrix& matrix    = transform->GetMatrix();
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    difference = max(difference, abs(matrix.Data()[i] - reference.Data()[i]) / max(1.0f, abs(reference.Data()[i])));
+                }
+            }
+            return difference;
+        }
+
+        void move_randomly(vector<Transform*>& transforms, Random& random, const uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                Transform* transform = transforms[static_cast<uint32_t>(random.next(0.0f, static_cast<float>(transforms.size())))];
+                transform->SetPositionLocal(Vector3(random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f)));
+                transform->SetRotationLocal(Quaternion::FromEulerAngles(random.next(-180.0f, 180.0f), random.next(-180.0f, 180.0f), random.next(-180.0f, 180.0f)));
+            }
+        }
+    }
+
+    // A random hierarchy, propagated by the transform hierarchy (in one batch and lazily) and checked against walking up to the root
+    void transforms(World* world, Threading* threading, const uint32_t count)
+    {
+        // A quarter are roots, the rest hang under an earlier transform
+        Random random;
+        vector<Transform*> transforms;
+        transforms.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Transform* transform = world->EntityCreate()->GetTransform();
+            transform->SetPositionLocal(Vector3(random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f)));
+            transform->SetRotationLocal(Quaternion::FromEulerAngles(random.next(-180.0f, 180.0f), random.next(-180.0f, 180.0f), random.next(-180.0f, 180.0f)));
+            transform->SetScaleLocal(Vector3(random.next(0.8f, 1.25f), random.next(0.8f, 1.25f), random.next(0.8f, 1.25f)));
+            if (i != 0 && random.next(0.0f, 1.0f) < 0.75f)
+            {
+                transform->SetParent(transforms[min(static_cast<uint32_t>(random.next(0.0f, static_cast<float>(i))), i - 1)]);
+            }
+            transforms.emplace_back(transform);
+        }
+
+        TransformHierarchy* hierarchy = world->GetTransformHierarchy().get();
+        const uint32_t moved_count    = max(count / 8, 1u);
+        const float tolerance         = 1e-5f;
+
+        // Batched, every transform is dirty
+        const double time_batched_ms = time_ms([&]() { hierarchy->Update(threading); });
+        float difference = max_difference(transforms);
+        expect(difference <= tolerance, "Batched update differs from the recursive walk by %g (relative)", difference);
+
+        // Lazily, an eighth moved and each one is resolved on read
+        move_randomly(transforms, random, moved_count);
+        difference = max_difference(transforms);
+        expect(difference <= tolerance, "Lazy resolve differs from the recursive walk by %g (relative)", difference);
+
+        // Batched again, an eighth moved
+        move_randomly(transforms, random, moved_count);
+        const double time_moved_ms = time_ms([&]() { hierarchy->Update(threading); });
+        difference = max_difference(transforms);
+        expect(difference <= tolerance, "Batched update after moving differs from the recursive walk by %g (relative)", difference);
+
+        double checksum = 0.0;
+        const double time_recursive_ms = time_ms([&]()
+        {
+            for (const Transform* transform : transforms)
+            {
+                checksum += matrix_recursive(transform).m30;
+            }
+        });
+
+        printf("Transforms:\t\t%u, %u moved\n", count, moved_count);
+        printf("Batched (all):\t\t%.3f ms\n", time_batched_ms);
+        printf("Batched (moved):\t%.3f ms\n", time_moved_ms);
+        printf("Recursive (all):\t%.3f ms (checksum %.1f)\n", time_recursive_ms, checksum);
+    }
+}
@@ -0,0 +1,458 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include "Core/Engine.h"
+#include "Core/Context.h"
+#include "Rendering/Renderer.h"
+#include "RHI/RHI_SwapChain.h"
+#include "RHI/RHI_CommandList.h"
+#include "Profiling/Profiler.h"
+#include "Threading/Threading.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/Components/Transform.h"
+#include "World/Components/Renderable.h"
+//==============================================
+
+//= NAMESPACES ==========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=======================
+
+// Drives the engine without a window, and reports how long the CPU takes to produce a frame.
+// Meant to be built against the null RHI backend, so that the numbers are free of driver and GPU noise.
+//
+// usage: Benchmark [--world <file>] [--entities <count>] [--frames <count>] [--warmup <count>] [--width <px>] [--height <px>]
+//        Benchmark --reload <count>, saves a world of <count> entities and checks that it loads back while frames keep ticking, the way the editor loads
+//        Benchmark --compression <size>, measures the texture block compressor instead, on a procedural <size>x<size> image
+//        Benchmark --mips <size>, measures the mip chain generator instead, on a procedural <size>x<size> image
+//        Benchmark --mesh <segments>, measures the mesh optimizer and the vertex packing instead, on a sphere with <segments> slices and stacks
+//        Benchmark --normals <segments>, checks the computed normals and tangents of a sphere with <segments> slices and stacks against the analytic ones and measures them instead
+//        Benchmark --components <count>, measures component iteration instead, over <count> entities of which a quarter are renderable
+//        Benchmark --transforms <count>, checks the transform hierarchy against a recursive walk and measures it instead, over <count> transforms
+//        Benchmark --sort <count>, checks the radix sort against std::stable_sort and measures both instead, over <count> keys of several distributions
+//        Benchmark --filestream <megabytes>, measures reading a model and texture sized file through a stream and through a memory mapping instead
+//        Benchmark --simd <count>, checks the accuracy of the SIMD matrix and bounding box kernels and measures them instead, over <count> transforms
+//        Benchmark --culling <count>, checks the packed frustum culling against a plane test per box and measures it instead, over <count> boxes
+//        Benchmark --threading <count>, measures task throughput (over <count> tasks), latency and nested spawning instead, with 1 to N cores
+//        Benchmark --parallelfor <count>, compares ParallelFor with a static split instead, over <count> items of uniform and skewed cost, with 1 to N cores
+//        Benchmark --events <count>, checks that fired and queued events reach their subscribers exactly once and measures them instead, with <count> events queued from all threads
+//        Benchmark --handles <count>, checks the handle table over random adds and removes, and the entity lookups built on it, and measures them instead, over <count> entities
+//        Benchmark --import <file|count>, measures importing a model with one thread and with all of them instead, a count imports a generated scene with that many meshes
+
+namespace benchmark
+{
+    struct Options
+    {
+        const char* world       = nullptr;
+        uint32_t entities       = 0;
+        uint32_t frames         = 1000;
+        uint32_t warmup         = 100;
+        uint32_t width          = 1920;
+        uint32_t height         = 1080;
+        uint32_t reload         = 0;
+        uint32_t compression    = 0;
+        uint32_t mips           = 0;
+        uint32_t mesh           = 0;
+        uint32_t normals        = 0;
+        uint32_t components     = 0;
+        uint32_t transforms     = 0;
+        uint32_t sort           = 0;
+        uint32_t file_stream    = 0;
+        uint32_t simd           = 0;
+        uint32_t culling        = 0;
+        uint32_t threading      = 0;
+        uint32_t parallel_for   = 0;
+        uint32_t events         = 0;
+        uint32_t handles        = 0;
+        const char* import      = nullptr;
+        uint32_t import_meshes  = 0;
+    };
+
+    struct FrameStats
+    {
+        double time_ms              = 0.0;
+        uint32_t draws              = 0;
+        uint32_t dispatches         = 0;
+        uint32_t bindings           = 0;
+        uint32_t pipeline_barriers  = 0;
+        uint32_t meshes_rendered    = 0;
+        uint64_t bytes_uploaded     = 0;
+    };
+
+    Options parse(int argc, char** argv)
+    {
+        Options options;
+
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            const char* name    = argv[i];
+            const char* value   = argv[i + 1];
+
+            if      (strcmp(name, "--world") == 0)       options.world        = value;
+            else if (strcmp(name, "--entities") == 0)    options.entities     = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--frames") == 0)      options.frames       = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--warmup") == 0)      options.warmup       = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--width") == 0)       options.width        = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--height") == 0)      options.height       = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--reload") == 0)      options.reload       = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--compression") == 0) options.compression  = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--mips") == 0)        options.mips         = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--mesh") == 0)        options.mesh         = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--normals") == 0)     options.normals      = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--components") == 0)  options.components   = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--transforms") == 0)  options.transforms   = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--sort") == 0)        options.sort         = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--filestream") == 0)  options.file_stream  = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--simd") == 0)        options.simd         = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--culling") == 0)     options.culling      = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--threading") == 0)   options.threading    = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--parallelfor") == 0) options.parallel_for = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--events") == 0)      options.events       = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--handles") == 0)     options.handles      = static_cast<uint32_t>(atoi(value));
+            else if (strcmp(name, "--import") == 0)      options.import       = value;
+            else printf("Unknown option \"%s\"\n", name);
+        }
+
+        options.frames = max(options.frames, 1u);
+
+        // --import takes either a file or the mesh count of a scene to generate
+        if (options.import && options.import[strspn(options.import, "0123456789")] == '\0')
+        {
+            options.import_meshes   = static_cast<uint32_t>(atoi(options.import));
+            options.import          = nullptr;
+        }
+
+        return options;
+    }
+
+    // Same sequence as Editor::OnTick(), minus ImGui
+    FrameStats tick(Engine& engine, Renderer* renderer, Profiler* profiler)
+    {
+        RHI_SwapChain* swapchain    = renderer->GetSwapChain();
+        RHI_CommandList* cmd_list   = swapchain->GetCmdList();
+
+        const auto time_start = chrono::high_resolution_clock::now();
+
+        cmd_list->Begin();
+        engine.Tick();
+        renderer->Pass_CopyToBackbuffer(cmd_list);
+        cmd_list->End();
+        cmd_list->Submit();
+        swapchain->Present();
+
+        const auto time_end = chrono::high_resolution_clock::now();
+
+        // The profiler clears these at the start of every tick, so right now they hold this frame's counts
+        FrameStats stats;
+        stats.time_ms           = chrono::duration<double, milli>(time_end - time_start).count();
+        stats.draws             = profiler->m_rhi_draw;
+        stats.dispatches        = profiler->m_rhi_dispatch;
+        stats.pipeline_barriers = profiler->m_rhi_pipeline_barriers;
+        stats.meshes_rendered   = profiler->m_renderer_meshes_rendered;
+        stats.bytes_uploaded    = profiler->m_rhi_bytes_uploaded;
+        stats.bindings          =
+            profiler->m_rhi_bindings_buffer_index       +
+            profiler->m_rhi_bindings_buffer_vertex      +
+            profiler->m_rhi_bindings_buffer_constant    +
+            profiler->m_rhi_bindings_sampler            +
+            profiler->m_rhi_bindings_texture_sampled    +
+            profiler->m_rhi_bindings_texture_storage    +
+            profiler->m_rhi_bindings_shader_vertex      +
+            profiler->m_rhi_bindings_shader_pixel       +
+            profiler->m_rhi_bindings_shader_compute     +
+            profiler->m_rhi_bindings_render_target      +
+            profiler->m_rhi_bindings_descriptor_set     +
+            profiler->m_rhi_bindings_pipeline;
+
+        return stats;
+    }
+
+    // The world can only load while the engine keeps ticking, so do it on another thread
+    bool load_world(Engine& engine, Renderer* renderer, Profiler* profiler, World* world, Threading* threading, const char* file_path)
+    {
+        atomic<bool> loaded = false;
+        atomic<bool> result = false;
+        threading->AddTask([&]() { result = world->LoadFromFile(file_path); loaded = true; });
+
+        while (!loaded)
+        {
+            tick(engine, renderer, profiler);
+        }
+
+        return result;
+    }
+
+    uint32_t persistent_entity_count(World* world)
+    {
+        const auto& entities = world->EntityGetAll();
+        return static_cast<uint32_t>(count_if(entities.begin(), entities.end(), [](const shared_ptr<Entity>& entity) { return !entity->IsTransient(); }));
+    }
+
+    // A grid of cubes in front of the default camera, roughly half of it falls outside of the view
+    void spawn_entities(World* world, const uint32_t count)
+    {
+        const uint32_t side     = static_cast<uint32_t>(ceil(sqrt(static_cast<double>(count))));
+        const float spacing     = 2.0f;
+        const float offset      = side * spacing * 0.5f;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            shared_ptr<Entity> entity = world->EntityCreate();
+            entity->SetName("benchmark_cube_" + to_string(i));
+            entity->GetTransform()->SetPosition(Vector3((i % side) * spacing - offset, 0.0f, (i / side) * spacing - offset));
+
+            Renderable* renderable = entity->AddComponent<Renderable>();
+            renderable->GeometrySet(Geometry_Default_Cube);
+            renderable->UseDefaultMaterial();
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const benchmark::Options options = benchmark::parse(argc, argv);
+
+    // No window, the null backend doesn't need one
+    WindowData window_data;
+    window_data.width           = static_cast<float>(options.width);
+    window_data.height          = static_cast<float>(options.height);
+    window_data.monitor_width   = options.width;
+    window_data.monitor_height  = options.height;
+
+    Engine engine(window_data);
+    Context* context        = engine.GetContext();
+    Renderer* renderer      = context->GetSubsystem<Renderer>();
+    Profiler* profiler      = context->GetSubsystem<Profiler>();
+    World* world            = context->GetSubsystem<World>();
+    Threading* threading    = context->GetSubsystem<Threading>();
+
+    if (options.compression != 0)
+    {
+        benchmark::compression(threading, options.compression);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.mips != 0)
+    {
+        benchmark::mips(threading, options.mips);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.mesh != 0)
+    {
+        benchmark::mesh(options.mesh);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.normals != 0)
+    {
+        benchmark::normals(threading, options.normals);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.components != 0)
+    {
+        benchmark::components(world, options.components);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.transforms != 0)
+    {
+        benchmark::transforms(world, threading, options.transforms);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.sort != 0)
+    {
+        benchmark::radix_sort(options.sort);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.file_stream != 0)
+    {
+        benchmark::file_stream(context, options.file_stream);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.simd != 0)
+    {
+        benchmark::simd(options.simd);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.culling != 0)
+    {
+        benchmark::culling(options.culling);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.threading != 0)
+    {
+        benchmark::threading(context, options.threading);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.parallel_for != 0)
+    {
+        benchmark::parallel_for(context, options.parallel_for);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.events != 0)
+    {
+        benchmark::events(threading, options.events);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.handles != 0)
+    {
+        benchmark::handles(world, options.handles);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.import || options.import_meshes != 0)
+    {
+        benchmark::import(context, options.import, options.import_meshes);
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!renderer->IsInitialized())
+    {
+        printf("The renderer failed to initialize\n");
+        return EXIT_FAILURE;
+    }
+
+    if (options.reload != 0)
+    {
+        // A frame and a load which wait on each other would hang inside a tick, so a watchdog fails the run instead
+        thread([]()
+        {
+            this_thread::sleep_for(chrono::minutes(5));
+            printf("FAILED: Loading the world while ticking didn't finish, the frame and the load are likely waiting on each other\n");
+            fflush(stdout);
+            _Exit(EXIT_FAILURE);
+        }).detach();
+
+        benchmark::spawn_entities(world, options.reload);
+        for (uint32_t i = 0; i < options.warmup; i++)
+        {
+            benchmark::tick(engine, renderer, profiler);
+        }
+
+        const char* file_path   = "benchmark_reload.world";
+        const uint32_t count    = benchmark::persistent_entity_count(world);
+        if (!benchmark::expect(world->SaveToFile(file_path), "Failed to save \"%s\"", file_path))
+            return EXIT_FAILURE;
+
+        // Load more than once, the later loads replace a world which is being ticked and rendered
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            double frames           = 0.0;
+            bool result             = false;
+            const double time_ms    = benchmark::time_ms([&]() { result = benchmark::load_world(engine, renderer, profiler, world, threading, file_path); });
+            benchmark::expect(result, "Failed to load \"%s\"", file_path);
+            benchmark::expect(benchmark::persistent_entity_count(world) == count, "Loading restored %u of %u entities", benchmark::persistent_entity_count(world), count);
+            printf("Load %u:\t\t%.2f ms\n", i, time_ms);
+
+            for (uint32_t frame = 0; frame < options.warmup; frame++)
+            {
+                frames += benchmark::tick(engine, renderer, profiler).time_ms;
+            }
+            printf("Frames after:\t%.3f ms avg\n", frames / max(options.warmup, 1u));
+        }
+
+        return benchmark::expect_passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.world && !benchmark::load_world(engine, renderer, profiler, world, threading, options.world))
+    {
+        printf("Failed to load \"%s\"\n", options.world);
+        return EXIT_FAILURE;
+    }
+
+    benchmark::spawn_entities(world, options.entities);
+
+    // Warm up, lets caches fill and any asynchronous work settle
+    for (uint32_t i = 0; i < options.warmup; i++)
+    {
+        benchmark::tick(engine, renderer, profiler);
+    }
+
+    // Measure
+    vector<benchmark::FrameStats> frames(options.frames);
+    for (benchmark::FrameStats& frame : frames)
+    {
+        frame = benchmark::tick(engine, renderer, profiler);
+    }
+
+    // Report
+    {
+        vector<double> times;
+        times.reserve(frames.size());
+
+        double time_total               = 0.0;
+        double draws                    = 0.0;
+        double dispatches               = 0.0;
+        double bindings                 = 0.0;
+        double pipeline_barriers        = 0.0;
+        double meshes_rendered          = 0.0;
+        double bytes_uploaded           = 0.0;
+        for (const benchmark::FrameStats& frame : frames)
+        {
+            times.emplace_back(frame.time_ms);
+            time_total          += frame.time_ms;
+            draws               += frame.draws;
+            dispatches          += frame.dispatches;
+            bindings            += frame.bindings;
+            pipeline_barriers   += frame.pipeline_barriers;
+            meshes_rendered     += frame.meshes_rendered;
+            bytes_uploaded      += static_cast<double>(frame.bytes_uploaded);
+        }
+
+        sort(times.begin(), times.end());
+        const double count  = static_cast<double>(frames.size());
+        const double p95    = times[min(times.size() - 1, static_cast<size_t>(count * 0.95))];
+
+        printf("Frames:\t\t\t%u (after %u warm-up frames)\n", options.frames, options.warmup);
+        printf("Resolution:\t\t%ux%u\n", options.width, options.height);
+        printf("Entities:\t\t%u\n", static_cast<uint32_t>(world->EntityGetAll().size()));
+        printf("Frame time (ms):\tavg %.3f, min %.3f, max %.3f, p95 %.3f\n", time_total / count, times.front(), times.back(), p95);
+        printf("Meshes rendered:\t%.1f\n", meshes_rendered / count);
+        printf("Draw calls:\t\t%.1f\n", draws / count);
+        printf("Dispatches:\t\t%.1f\n", dispatches / count);
+        printf("Bindings:\t\t%.1f\n", bindings / count);
+        printf("Pipeline barriers:\t%.1f\n", pipeline_barriers / count);
+        printf("Uploaded:\t\t%.3f MB\n", bytes_uploaded / count / 1024.0 / 1024.0);
+    }
+
+    return EXIT_SUCCESS;
+}
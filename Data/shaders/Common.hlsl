@@ -92,6 +92,13 @@ inline float3 pack(float3 value)    { return value * 0.5f + 0.5f; }
 inline float2 unpack(float2 value)  { return value * 2.0f - 1.0f; }
 inline float2 pack(float2 value)    { return value * 0.5f + 0.5f; }
 
+// Normal maps can be two channel (BC5), so z is always reconstructed from x and y
+inline float3 unpack_normal(float2 value)
+{
+    float2 xy = unpack(value);
+    return float3(xy, sqrt(saturate(1.0f - dot(xy, xy))));
+}
+
 /*------------------------------------------------------------------------------
     FAST MATH APPROXIMATIONS
 ------------------------------------------------------------------------------*/
@@ -103,6 +103,14 @@ cbuffer BufferObject : register(b3)
     matrix g_object_wvp_previous;
 };
 
+// High frequency - Updates per instanced draw
+static const int g_max_instances = 128;
+cbuffer BufferInstance : register(b5)
+{
+    matrix g_instance_transform[g_max_instances];
+    matrix g_instance_wvp_previous[g_max_instances];
+};
+
 // High frequency - Updates per light
 cbuffer LightBuffer : register(b4)
 {
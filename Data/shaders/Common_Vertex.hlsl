@@ -44,6 +44,14 @@ struct Vertex_PosUvNorTan
     float3 tangent      : TANGENT0;
 };
 
+// Quantized Vertex_PosUvNorTan, see RHI_Vertex_PosTexNorTanPacked
+struct Vertex_PosUvNorTanPacked
+{
+    float4 position     : POSITION0; // xyz: snorm within the mesh bounds (dequantized by the transform), w: bitangent sign
+    float2 uv           : TEXCOORD0; // half
+    float4 nor_tan      : NORMAL0;   // xy: octahedral normal, zw: octahedral tangent
+};
+
 struct Vertex_Pos2dUvColor
 {
     float2 position     : POSITION0;
@@ -66,4 +74,41 @@ struct Pixel_PosColor
 {
     float4 position : SV_POSITION;
     float4 color    : COLOR;
-};
\ No newline at end of file
+};
+
+float3 octahedral_decode(float2 encoded)
+{
+    float3 direction    = float3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t             = saturate(-direction.z);
+    direction.x        += direction.x >= 0.0f ? -t : t;
+    direction.y        += direction.y >= 0.0f ? -t : t;
+    return normalize(direction);
+}
+
+Vertex_PosUvNorTan unpack_vertex(Vertex_PosUvNorTanPacked input)
+{
+    Vertex_PosUvNorTan output;
+    output.position = float4(input.position.xyz, 1.0f);
+    output.uv       = input.uv;
+    output.normal   = octahedral_decode(input.nor_tan.xy);
+    output.tangent  = octahedral_decode(input.nor_tan.zw);
+    return output;
+}
+
+Vertex_PosUvNorTan unpack_vertex(Vertex_PosUvNorTan input)
+{
+    return input;
+}
+
+Vertex_PosUv unpack_vertex_pos_uv(Vertex_PosUvNorTanPacked input)
+{
+    Vertex_PosUv output;
+    output.position = float4(input.position.xyz, 1.0f);
+    output.uv       = input.uv;
+    return output;
+}
+
+Vertex_PosUv unpack_vertex_pos_uv(Vertex_PosUv input)
+{
+    return input;
+}
@@ -23,12 +23,26 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common.hlsl"
 //====================
 
-Pixel_PosUv mainVS(Vertex_PosUv input)
+#if PACKED
+#define Vertex_Input Vertex_PosUvNorTanPacked
+#else
+#define Vertex_Input Vertex_PosUv
+#endif
+
+#if INSTANCED
+Pixel_PosUv mainVS(Vertex_Input input_vertex, uint instance_id : SV_InstanceID)
 {
+    matrix transform = g_instance_transform[instance_id];
+#else
+Pixel_PosUv mainVS(Vertex_Input input_vertex)
+{
+    matrix transform = g_object_transform;
+#endif
+    Vertex_PosUv input = unpack_vertex_pos_uv(input_vertex);
     Pixel_PosUv output;
 
     input.position.w    = 1.0f; 
-    output.position     = mul(input.position, g_object_transform);
+    output.position     = mul(input.position, transform);
     output.uv           = input.uv;
 
     return output;
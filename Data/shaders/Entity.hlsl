@@ -31,8 +31,15 @@ struct PixelInputType
     float3 positionWS   : POSITIONT_WS;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+#if PACKED
+#define Vertex_Input Vertex_PosUvNorTanPacked
+#else
+#define Vertex_Input Vertex_PosUvNorTan
+#endif
+
+PixelInputType mainVS(Vertex_Input input_vertex)
 {
+    Vertex_PosUvNorTan input = unpack_vertex(input_vertex);
     PixelInputType output;
 
     input.position.w    = 1.0f;
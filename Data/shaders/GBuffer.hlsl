@@ -42,17 +42,33 @@ struct PixelOutputType
     float2 velocity : SV_Target3;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+#if PACKED
+#define Vertex_Input Vertex_PosUvNorTanPacked
+#else
+#define Vertex_Input Vertex_PosUvNorTan
+#endif
+
+#if INSTANCED
+PixelInputType mainVS(Vertex_Input input_vertex, uint instance_id : SV_InstanceID)
 {
+    matrix transform    = g_instance_transform[instance_id];
+    matrix wvp_previous = g_instance_wvp_previous[instance_id];
+#else
+PixelInputType mainVS(Vertex_Input input_vertex)
+{
+    matrix transform    = g_object_transform;
+    matrix wvp_previous = g_object_wvp_previous;
+#endif
+    Vertex_PosUvNorTan input = unpack_vertex(input_vertex);
     PixelInputType output;
     
     input.position.w            = 1.0f;     
-    output.position_ss_previous = mul(input.position, g_object_wvp_previous);
-    output.position             = mul(input.position, g_object_transform);
+    output.position_ss_previous = mul(input.position, wvp_previous);
+    output.position             = mul(input.position, transform);
     output.position             = mul(output.position, g_view_projection);
     output.position_ss_current  = output.position;
-    output.normal               = normalize(mul(input.normal, (float3x3)g_object_transform)).xyz;
-    output.tangent              = normalize(mul(input.tangent, (float3x3)g_object_transform)).xyz;
+    output.normal               = normalize(mul(input.normal, (float3x3)transform)).xyz;
+    output.tangent              = normalize(mul(input.tangent, (float3x3)transform)).xyz;
     output.uv                   = input.uv;
     
     return output;
@@ -117,7 +133,7 @@ PixelOutputType mainPS(PixelInputType input)
     
     #if NORMAL_MAP
         // Get tangent space normal and apply intensity
-        float3 tangent_normal   = normalize(unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, texCoords).rgb));
+        float3 tangent_normal   = normalize(unpack_normal(tex_material_normal.Sample(sampler_anisotropic_wrap, texCoords).rg));
         float normal_intensity  = clamp(g_mat_normal, 0.012f, g_mat_normal);
         tangent_normal.xy       *= saturate(normal_intensity);
         normal                  = normalize(mul(tangent_normal, TBN).xyz); // Transform to world space
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Widget_Assets.h"
 #include "Widget_Properties.h"
 #include "Rendering/Model.h"
+#include "Resource/Import/ModelImporter.h"
 #include "../WidgetsDeferred/FileDialog.h"
 //========================================
 
@@ -56,6 +57,16 @@ void Widget_Assets::Tick()
         Widget_Assets_Statics::g_show_file_dialog_load = true;
     }
 
+    ImGui::SameLine();
+
+    // Applies to the models imported from now on
+    ModelImporter* importer = m_context->GetSubsystem<ResourceCache>()->GetModelImporter();
+    bool vertex_packing     = importer->GetVertexPacking();
+    if (ImGui::Checkbox("Pack vertices", &vertex_packing))
+    {
+        importer->SetVertexPacking(vertex_packing);
+    }
+
     ImGui::SameLine();
     
     // VIEW
@@ -975,11 +975,13 @@ void Widget_Properties::ShowTerrain(Terrain* terrain) const
 
     if (ComponentProperty::Begin("Terrain", Icon_Component_Terrain, terrain))
     {
-        //= REFLECT =====================================
+        //= REFLECT =================================================
         float min_y             = terrain->GetMinY();
         float max_y             = terrain->GetMaxY();
+        float stream_distance   = terrain->GetStreamDistance();
+        float lod_distance      = terrain->GetLodDistance();
         const float progress    = terrain->GetProgress();
-        //===============================================
+        //===========================================================
 
         const float cursor_y = ImGui::GetCursorPosY();
 
@@ -1002,6 +1004,8 @@ void Widget_Properties::ShowTerrain(Terrain* terrain) const
         {
             ImGui::InputFloat("Min Y", &min_y);
             ImGui::InputFloat("Max Y", &max_y);
+            ImGui::InputFloat("Stream Distance", &stream_distance);
+            ImGui::InputFloat("LOD Distance", &lod_distance);
 
             if (progress > 0.0f && progress < 1.0f)
             {
@@ -1012,10 +1016,12 @@ void Widget_Properties::ShowTerrain(Terrain* terrain) const
         }
         ImGui::EndGroup();
 
-        //= MAP =================================================
-        if (min_y != terrain->GetMinY()) terrain->SetMinY(min_y);
-        if (max_y != terrain->GetMaxY()) terrain->SetMaxY(max_y);
-        //=======================================================
+        //= MAP =================================================================================================
+        if (min_y != terrain->GetMinY())                        terrain->SetMinY(min_y);
+        if (max_y != terrain->GetMaxY())                        terrain->SetMaxY(max_y);
+        if (stream_distance != terrain->GetStreamDistance())    terrain->SetStreamDistance(stream_distance);
+        if (lod_distance != terrain->GetLodDistance())          terrain->SetLodDistance(lod_distance);
+        //=======================================================================================================
     }
     ComponentProperty::End();
 }
@@ -242,6 +242,9 @@ void Widget_RenderOptions::Tick()
             // Fog
             ImGuiEx::DragFloatWrap("Fog", &fog, 0.01f, 0.0f, 16.0f, "%.2f");
             ImGuiEx::Tooltip("Fog density, something that also affects the visibility of volumetric lighting.");
+
+            // Level of detail
+            render_option_float("##lod_option", "LOD threshold", Option_Value_Lod_Threshold, "How far (in pixels) a lower level of detail may deviate on screen, zero always draws full detail.", 0.1f, 0.0f, 16.0f);
         }
 
         // Map
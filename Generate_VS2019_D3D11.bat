@@ -1,4 +1,4 @@
 @echo off
 cd /D "%~dp0"
-call "Scripts\generate_project_files.bat" vs2019 d3d11
+call "Scripts\generate_project_files.bat" vs2019 d3d11 %*
 exit
\ No newline at end of file
@@ -0,0 +1,4 @@
+@echo off
+cd /D "%~dp0"
+call "Scripts\generate_project_files.bat" vs2019 null %*
+exit
\ No newline at end of file
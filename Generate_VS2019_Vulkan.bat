@@ -1,4 +1,4 @@
 @echo off
 cd /D "%~dp0"
-call "Scripts\generate_project_files.bat" vs2019 vulkan
+call "Scripts\generate_project_files.bat" vs2019 vulkan %*
 exit
\ No newline at end of file
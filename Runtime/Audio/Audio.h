@@ -21,9 +21,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==================
+//= INCLUDES ===================
 #include "../Core/ISubsystem.h"
-//=============================
+#include "../Core/EventSystem.h"
+//==============================
 
 //= FORWARD DECLARATIONS =
 namespace FMOD
@@ -61,5 +62,6 @@ namespace Spartan
         Transform* m_listener        = nullptr;
         Profiler* m_profiler        = nullptr;
         FMOD::System* m_system_fmod = nullptr;
+        EventSubscription m_subscription_world_unload;
     };
 }
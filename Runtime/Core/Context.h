@@ -33,8 +33,10 @@ namespace Spartan
 
     enum class TickType
     {
-        Variable,
-        Smoothed
+        Frame,      // at the frame boundary, while nothing else is running
+        Variable,   // simulation, with the raw delta time
+        Smoothed,   // simulation, with the smoothed delta time
+        Render      // alongside the simulation, drawing what it published last frame
     };
 
     struct _subystem
@@ -53,7 +53,7 @@ namespace Spartan
         m_context->m_engine = this;
 
         // Register subsystems
-        m_context->RegisterSubsystem<Timer>(TickType::Variable);         // must be first so it ticks first
+        m_context->RegisterSubsystem<Timer>(TickType::Frame);            // must be first so it ticks first
         m_context->RegisterSubsystem<Threading>(TickType::Variable);
         m_context->RegisterSubsystem<ResourceCache>(TickType::Variable);
         m_context->RegisterSubsystem<Audio>(TickType::Variable);
@@ -61,14 +61,15 @@ namespace Spartan
         m_context->RegisterSubsystem<Input>(TickType::Smoothed);
         m_context->RegisterSubsystem<Scripting>(TickType::Smoothed);
         m_context->RegisterSubsystem<World>(TickType::Smoothed);
-        m_context->RegisterSubsystem<Profiler>(TickType::Variable);
-        m_context->RegisterSubsystem<Renderer>(TickType::Smoothed);
+        m_context->RegisterSubsystem<Profiler>(TickType::Frame);         // reads the time blocks of both threads
+        m_context->RegisterSubsystem<Renderer>(TickType::Render);        // draws the world's last published snapshot
         m_context->RegisterSubsystem<Settings>(TickType::Variable);
                  
         // Initialize above subsystems
         m_context->Initialize();
 
-        m_timer = m_context->GetSubsystem<Timer>();
+        m_timer     = m_context->GetSubsystem<Timer>();
+        m_threading = m_context->GetSubsystem<Threading>();
     }
 
     Engine::~Engine()
@@ -78,8 +79,33 @@ namespace Spartan
 
     void Engine::Tick() const
     {
+        // Nothing else runs at the frame boundary, deliver what worker threads queued during the last frame
+        EventSystem::Get().ProcessQueue();
+
+        m_context->Tick(TickType::Frame, static_cast<float>(m_timer->GetDeltaTimeSec()));
+
+        // The renderer draws the snapshot the world published at the end of the previous frame, while this one is simulated,
+        // so a frame takes max(simulation, render) instead of their sum. Without worker threads they run back to back.
+        const float delta_time_smoothed = static_cast<float>(m_timer->GetDeltaTimeSmoothedSec());
+        TaskHandle render;
+        if (m_threading->GetThreadCount() != 0)
+        {
+            render = m_threading->AddTask([this, delta_time_smoothed]() { m_context->Tick(TickType::Render, delta_time_smoothed); });
+        }
+        else
+        {
+            m_context->Tick(TickType::Render, delta_time_smoothed);
+        }
+
         m_context->Tick(TickType::Variable, static_cast<float>(m_timer->GetDeltaTimeSec()));
-        m_context->Tick(TickType::Smoothed, static_cast<float>(m_timer->GetDeltaTimeSmoothedSec()));
+        m_context->Tick(TickType::Smoothed, delta_time_smoothed);
+
+        // The frame ends once both are done, the caller presents right after.
+        // Wait() only helps with the render task and its children, so this thread can't pick up a world load, which waits for it to tick the world.
+        if (render.IsValid())
+        {
+            m_threading->Wait(render);
+        }
     }
 
     void Engine::SetWindowData(WindowData& window_data)
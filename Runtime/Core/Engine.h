@@ -30,6 +30,7 @@ namespace Spartan
 {
     class Context;
     class Timer;
+    class Threading;
 
     struct WindowData
     {
@@ -60,7 +61,7 @@ namespace Spartan
         Engine(const WindowData& window_data);
         ~Engine();
 
-        // Performs a simulation cycle
+        // Performs a simulation cycle, while the previous one is rendered
         void Tick() const;
 
         //  Flags
@@ -79,8 +80,9 @@ namespace Spartan
 
     private:
         WindowData m_window_data;
-        uint32_t m_flags    = 0;
-        Timer* m_timer      = nullptr;
+        uint32_t m_flags        = 0;
+        Timer* m_timer          = nullptr;
+        Threading* m_threading  = nullptr;
         std::shared_ptr<Context> m_context;
     };
 }
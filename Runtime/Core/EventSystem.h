@@ -21,23 +21,34 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ===============
-#include <unordered_map>
+//= INCLUDES ================
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <functional>
-#include "../Core/Variant.h"
-//==========================
+#include <type_traits>
+#include "Spartan_Definitions.h"
+//===========================
 
 /*
 HOW TO USE
-=================================================================================
-To subscribe a function to an event        -> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
-To unsubscribe a function from an event    -> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
-To fire an event                        -> FIRE_EVENT(EVENT_ID);
-To fire an event with data                -> FIRE_EVENT_DATA(EVENT_ID, Variant);
-
-Note: Currently, this is a blocking event system
-=================================================================================
+=================================================================================================
+To subscribe a function to an event        -> auto handle = SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
+To unsubscribe a function from an event    -> UNSUBSCRIBE_FROM_EVENT(handle);
+To fire an event                           -> FIRE_EVENT(EVENT_ID);
+To fire an event with data                 -> FIRE_EVENT_DATA(EVENT_ID, data);
+To queue an event (any thread)             -> QUEUE_EVENT(EVENT_ID);
+To queue an event with data (any thread)   -> QUEUE_EVENT_DATA(EVENT_ID, data);
+
+Fired events call their subscribers immediately, on the firing thread, and pass the data by reference.
+Queued events are delivered on the main thread, once per frame, when the engine calls ProcessQueue().
+Handlers may subscribe and unsubscribe, themselves included. A dispatch calls the subscribers it started with,
+minus the ones unsubscribed along the way, new subscribers are called from the next one on.
+=================================================================================================
 */
 
 enum class EventType
@@ -53,29 +64,46 @@ enum class EventType
     WorldResolved,            // The world has finished resolving
     WorldStop,                // The world should stop ticking
     WorldStart,                // The world should start ticking
-    FrameResolutionChanged
+    FrameResolutionChanged,
+    Undefined
 };
 
-//= MACROS ====================================================================================================
-#define EVENT_HANDLER_EXPRESSION(expression)        [this](const Spartan::Variant& var)    { ##expression }
-#define EVENT_HANDLER_EXPRESSION_STATIC(expression)    [](const Spartan::Variant& var)        { ##expression }
+//= MACROS ========================================================================================================
+#define EVENT_HANDLER_EXPRESSION(expression)        [this]()                    { ##expression }
+#define EVENT_HANDLER_EXPRESSION_STATIC(expression)    []()                        { ##expression }
+
+#define EVENT_HANDLER(function)                        [this]()                    { function(); }
+#define EVENT_HANDLER_STATIC(function)                []()                        { function(); }
 
-#define EVENT_HANDLER(function)                        [this](const Spartan::Variant& var)    { function(); }
-#define EVENT_HANDLER_STATIC(function)                [](const Spartan::Variant& var)        { function(); }
+#define EVENT_HANDLER_DATA(function)                [this](const auto& data)    { function(data); }
+#define EVENT_HANDLER_DATA_STATIC(function)            [](const auto& data)        { function(data); }
 
-#define EVENT_HANDLER_VARIANT(function)                [this](const Spartan::Variant& var)    { function(var); }
-#define EVENT_HANDLER_VARIANT_STATIC(function)        [](const Spartan::Variant& var)        { function(var); }
+#define FIRE_EVENT(eventID)                            Spartan::EventSystem::Get().Fire<eventID>()
+#define FIRE_EVENT_DATA(eventID, data)                Spartan::EventSystem::Get().Fire<eventID>(data)
 
-#define FIRE_EVENT(eventID)                            Spartan::EventSystem::Get().Fire(eventID)
-#define FIRE_EVENT_DATA(eventID, data)                Spartan::EventSystem::Get().Fire(eventID, data)
+#define QUEUE_EVENT(eventID)                        Spartan::EventSystem::Get().Queue<eventID>()
+#define QUEUE_EVENT_DATA(eventID, data)                Spartan::EventSystem::Get().Queue<eventID>(data)
 
-#define SUBSCRIBE_TO_EVENT(eventID, function)        Spartan::EventSystem::Get().Subscribe(eventID, function);
-#define UNSUBSCRIBE_FROM_EVENT(eventID, function)    Spartan::EventSystem::Get().Unsubscribe(eventID, function);
-//=============================================================================================================
+#define SUBSCRIBE_TO_EVENT(eventID, function)        Spartan::EventSystem::Get().Subscribe<eventID>(function)
+#define UNSUBSCRIBE_FROM_EVENT(handle)                Spartan::EventSystem::Get().Unsubscribe(handle)
+//=================================================================================================================
 
 namespace Spartan
 {
-    using subscriber = std::function<void(const Variant&)>;
+    class Entity;
+
+    // The data each event carries, events which are not listed here carry none
+    template<EventType type> struct EventData                   { using Type = void; };
+    template<> struct EventData<EventType::WorldResolved>       { using Type = std::vector<std::shared_ptr<Entity>>; };
+
+    // Identifies a subscription, returned by Subscribe() and handed back to Unsubscribe()
+    struct EventSubscription
+    {
+        EventType type  = EventType::Undefined;
+        uint32_t id     = 0;
+
+        bool IsValid() const { return id != 0; }
+    };
 
     class SPARTAN_CLASS EventSystem
     {
@@ -86,44 +114,235 @@ namespace Spartan
             return instance;
         }
 
-        void Subscribe(const EventType event_id, subscriber&& function)
+        template<EventType type, typename Function>
+        EventSubscription Subscribe(Function&& function)
         {
-            m_subscribers[event_id].push_back(std::forward<subscriber>(function));
+            using Data = typename EventData<type>::Type;
+
+            // Wrap the handler once, here, so that dispatching is a plain call
+            Subscriber subscriber;
+            subscriber.id = ++m_id;
+            if constexpr (std::is_invocable_v<Function>)
+            {
+                subscriber.function = [function = std::forward<Function>(function)](const void*) { function(); };
+            }
+            else
+            {
+                static_assert(!std::is_void_v<Data>, "This event carries no data, the handler must take no arguments");
+                subscriber.function = [function = std::forward<Function>(function)](const void* data) { function(*static_cast<const Data*>(data)); };
+            }
+
+            // Growing the subscribers would move the running function, so during a dispatch they join once it's done
+            if (m_dispatch_depth != 0)
+            {
+                m_subscribers_pending.emplace_back(type, std::move(subscriber));
+            }
+            else
+            {
+                Add(type, std::move(subscriber));
+            }
+
+            return { type, m_id };
         }
 
-        void Unsubscribe(const EventType event_id, subscriber&& function)
+        void Unsubscribe(EventSubscription& subscription)
         {
-            const size_t function_adress    = *reinterpret_cast<long*>(reinterpret_cast<char*>(&function));
-            auto& subscribers                = m_subscribers[event_id];
+            if (!subscription.IsValid())
+                return;
 
-            for (auto it = subscribers.begin(); it != subscribers.end();)
+            // Free the slot, but leave the function to a dispatch in progress, it might be the one running
+            auto& subscribers = m_subscribers[static_cast<uint32_t>(subscription.type)];
+            for (Subscriber& subscriber : subscribers)
             {
-                const size_t subscriber_adress = *reinterpret_cast<long*>(reinterpret_cast<char*>(&(*it)));
-                if (subscriber_adress == function_adress)
+                if (subscriber.id == subscription.id)
                 {
-                    it = subscribers.erase(it);
-                    return;
+                    subscriber.id = 0;
+                    if (m_dispatch_depth == 0)
+                    {
+                        Release(subscribers);
+                    }
+                    else
+                    {
+                        m_release_pending = true;
+                    }
+                    break;
                 }
             }
+
+            // It might also still be waiting for the dispatch to end
+            m_subscribers_pending.erase(std::remove_if(m_subscribers_pending.begin(), m_subscribers_pending.end(), [&subscription](const auto& pending) { return pending.second.id == subscription.id; }), m_subscribers_pending.end());
+
+            subscription = EventSubscription();
         }
 
-        void Fire(const EventType event_id, const Variant& data = 0)
+        template<EventType type>
+        void Fire()
         {
-            if (m_subscribers.find(event_id) == m_subscribers.end())
-                return;
+            static_assert(std::is_void_v<typename EventData<type>::Type>, "This event carries data, use FIRE_EVENT_DATA");
+            Dispatch(type, nullptr);
+        }
+
+        template<EventType type>
+        void Fire(const typename EventData<type>::Type& data)
+        {
+            Dispatch(type, &data);
+        }
+
+        // Thread safe, the event is delivered during the next ProcessQueue()
+        template<EventType type>
+        void Queue()
+        {
+            static_assert(std::is_void_v<typename EventData<type>::Type>, "This event carries data, use QUEUE_EVENT_DATA");
+
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            m_queue.emplace_back();
+            m_queue.back().type = type;
+        }
+
+        template<EventType type>
+        void Queue(const typename EventData<type>::Type& data)
+        {
+            using Data = typename EventData<type>::Type;
+            static_assert(std::is_trivially_copyable_v<Data> && sizeof(Data) <= queued_data_size, "Only small, trivially copyable data can be queued");
+
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            m_queue.emplace_back();
+            m_queue.back().type     = type;
+            m_queue.back().has_data = true;
+            std::memcpy(m_queue.back().data, &data, sizeof(Data));
+        }
 
-            for (const auto& subscriber : m_subscribers[event_id])
+        // Delivers the queued events, called by the engine at the start of every frame
+        void ProcessQueue()
+        {
+            // Swap the buffers so that events queued by the handlers wait for the next call, both keep their capacity
             {
-                subscriber(data);
+                std::lock_guard<std::mutex> lock(m_queue_mutex);
+                if (m_queue.empty())
+                    return;
+
+                std::swap(m_queue, m_queue_processing);
             }
+
+            for (const QueuedEvent& event : m_queue_processing)
+            {
+                Dispatch(event.type, event.has_data ? event.data : nullptr);
+            }
+
+            m_queue_processing.clear();
         }
 
         void Clear() 
         {
-            m_subscribers.clear(); 
+            SP_ASSERT(m_dispatch_depth == 0 && "Clearing from a handler would destroy the running function");
+
+            for (auto& subscribers : m_subscribers)
+            {
+                subscribers.clear();
+            }
+
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            m_queue.clear();
         }
 
     private:
-        std::unordered_map<EventType, std::vector<subscriber>> m_subscribers;
+        static const uint32_t event_count       = static_cast<uint32_t>(EventType::Undefined);
+        static const uint32_t queued_data_size  = 64;
+
+        struct Subscriber
+        {
+            uint32_t id = 0; // 0 when the slot is free
+            std::function<void(const void*)> function;
+        };
+
+        struct QueuedEvent
+        {
+            EventType type  = EventType::Undefined;
+            bool has_data   = false;
+            alignas(16) unsigned char data[queued_data_size];
+        };
+
+        void Dispatch(const EventType type, const void* data)
+        {
+            // Only the subscribers present at the start are called, by index, the ones unsubscribed along the way are skipped
+            std::vector<Subscriber>& subscribers    = m_subscribers[static_cast<uint32_t>(type)];
+            const size_t count                      = subscribers.size();
+
+            m_dispatch_depth++;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (subscribers[i].id != 0)
+                {
+                    subscribers[i].function(data);
+                }
+            }
+            m_dispatch_depth--;
+
+            if (m_dispatch_depth == 0 && (m_release_pending || !m_subscribers_pending.empty()))
+            {
+                ApplyPending();
+            }
+        }
+
+        // Releases the functions unsubscribed and adds the subscribers subscribed during a dispatch
+        void ApplyPending()
+        {
+            if (m_release_pending)
+            {
+                for (auto& subscribers : m_subscribers)
+                {
+                    Release(subscribers);
+                }
+                m_release_pending = false;
+            }
+
+            for (auto& [type, subscriber] : m_subscribers_pending)
+            {
+                Add(type, std::move(subscriber));
+            }
+            m_subscribers_pending.clear();
+        }
+
+        // Releases the functions of the free slots and drops the free slots at the end, so that dispatching doesn't walk them
+        static void Release(std::vector<Subscriber>& subscribers)
+        {
+            for (Subscriber& subscriber : subscribers)
+            {
+                if (subscriber.id == 0)
+                {
+                    subscriber.function = nullptr;
+                }
+            }
+
+            while (!subscribers.empty() && subscribers.back().id == 0)
+            {
+                subscribers.pop_back();
+            }
+        }
+
+        // Reuse the slot of an earlier subscription, or append one
+        void Add(const EventType type, Subscriber&& subscriber)
+        {
+            auto& subscribers = m_subscribers[static_cast<uint32_t>(type)];
+            auto it = std::find_if(subscribers.begin(), subscribers.end(), [](const Subscriber& s) { return s.id == 0; });
+            if (it != subscribers.end())
+            {
+                *it = std::move(subscriber);
+            }
+            else
+            {
+                subscribers.emplace_back(std::move(subscriber));
+            }
+        }
+
+        std::array<std::vector<Subscriber>, event_count> m_subscribers;
+        std::vector<std::pair<EventType, Subscriber>> m_subscribers_pending;
+        uint32_t m_id               = 0;
+        uint32_t m_dispatch_depth   = 0;
+        bool m_release_pending      = false;
+
+        std::vector<QueuedEvent> m_queue;
+        std::vector<QueuedEvent> m_queue_processing;
+        std::mutex m_queue_mutex;
     };
 }
@@ -0,0 +1,128 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include <cstdint>
+#include "Spartan_Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // Refers to an object in a HandleTable. A slot's generation changes whenever it's freed,
+    // so a handle to an object which is gone resolves to nothing, even after the slot has been reused.
+    struct Handle
+    {
+        static const uint32_t index_invalid = static_cast<uint32_t>(-1);
+
+        bool IsValid() const                        { return index != index_invalid; }
+        bool operator==(const Handle& rhs) const    { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(const Handle& rhs) const    { return !(*this == rhs); }
+
+        uint32_t index      = index_invalid;
+        uint32_t generation = 0;
+    };
+
+    // Maps handles to objects in O(1), freed slots are reused. Not thread safe.
+    template <typename T>
+    class HandleTable
+    {
+    public:
+        Handle Add(T* object)
+        {
+            Handle handle;
+            if (!m_slots_free.empty())
+            {
+                handle.index = m_slots_free.back();
+                m_slots_free.pop_back();
+            }
+            else
+            {
+                handle.index = static_cast<uint32_t>(m_slots.size());
+                m_slots.emplace_back();
+            }
+
+            Slot& slot          = m_slots[handle.index];
+            slot.object         = object;
+            handle.generation   = slot.generation;
+            m_count++;
+
+            return handle;
+        }
+
+        bool Remove(const Handle& handle)
+        {
+            if (!Get(handle))
+                return false;
+
+            Slot& slot  = m_slots[handle.index];
+            slot.object = nullptr;
+            slot.generation++;
+            m_slots_free.emplace_back(handle.index);
+            m_count--;
+
+            return true;
+        }
+
+        // Returns null for invalid and stale handles
+        T* Get(const Handle& handle) const
+        {
+            if (handle.index >= m_slots.size())
+                return nullptr;
+
+            const Slot& slot = m_slots[handle.index];
+            return slot.generation == handle.generation ? slot.object : nullptr;
+        }
+
+        // Frees every slot, the generations are kept so that handles from before still resolve to nothing
+        void Clear()
+        {
+            m_slots_free.clear();
+            for (uint32_t i = static_cast<uint32_t>(m_slots.size()); i-- > 0;)
+            {
+                if (m_slots[i].object)
+                {
+                    m_slots[i].object = nullptr;
+                    m_slots[i].generation++;
+                }
+
+                m_slots_free.emplace_back(i);
+            }
+
+            m_count = 0;
+        }
+
+        uint32_t GetCount() const { return m_count; }
+
+    private:
+        struct Slot
+        {
+            T* object           = nullptr;
+            uint32_t generation = 0;
+        };
+
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_slots_free;
+        uint32_t m_count = 0;
+    };
+}
@@ -0,0 +1,51 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <cstdint>
+#include "Spartan_Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // A non-owning view over a contiguous range of elements
+    template <typename T>
+    class Span
+    {
+    public:
+        Span() = default;
+        Span(T* data, const uint64_t size) { m_data = data; m_size = size; }
+
+        T* data()                           const { return m_data; }
+        uint64_t size()                     const { return m_size; }
+        uint64_t size_bytes()               const { return m_size * sizeof(T); }
+        bool empty()                        const { return m_size == 0; }
+        T* begin()                          const { return m_data; }
+        T* end()                            const { return m_data + m_size; }
+        T& operator[](const uint64_t index) const { return m_data[index]; }
+
+    private:
+        T* m_data       = nullptr;
+        uint64_t m_size = 0;
+    };
+}
@@ -32,9 +32,6 @@ namespace Spartan
     class Context;
     //========================
 
-    // Globals
-    static uint32_t g_id = 0;
-
     class SPARTAN_CLASS Spartan_Object
     {
     public:
@@ -49,8 +46,8 @@ namespace Spartan
 
         // Id
         const uint32_t GetId()          const { return m_id; }
-        void SetId(const uint32_t id)          { m_id = id; }
-        static uint32_t GenerateId()          { return ++g_id; }
+        void SetId(uint32_t id);
+        static uint32_t GenerateId();
 
         // CPU & GPU sizes
         const uint64_t GetSizeCpu()     const { return m_size_cpu; }
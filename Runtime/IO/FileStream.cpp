@@ -23,6 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "FileStream.h"
 #include "../RHI/RHI_Vertex.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 //============================
 
 //= NAMESPACES =====
@@ -49,6 +57,16 @@ namespace Spartan
                 LOG_ERROR("Failed to open \"%s\" for writing", path.c_str());
                 return;
             }
+
+            m_buffer.reserve(64 * 1024);
+        }
+        else if ((m_flags & FileStream_Read) && (m_flags & FileStream_Mapped))
+        {
+            if (!Map(path))
+            {
+                LOG_ERROR("Failed to map \"%s\" for reading", path.c_str());
+                return;
+            }
         }
         else if (m_flags & FileStream_Read)
         {
@@ -61,6 +79,24 @@ namespace Spartan
         }
 
         m_is_open = true;
+
+        // Chunked container
+        if (m_flags & FileStream_Chunked)
+        {
+            if (m_flags & FileStream_Write)
+            {
+                // Reserve space for the header, it's filled in once the table of contents has been written
+                m_version = FileStream_Chunked_Version;
+                const uint64_t header[4] = { 0, 0, 0, 0 };
+                WriteBytes(header, sizeof(header));
+            }
+            else if (!ChunkReadHeader())
+            {
+                // Not a container, rewind and let the caller read it the old way
+                m_version = 0;
+                Seek(0);
+            }
+        }
     }
 
     FileStream::~FileStream()
@@ -70,8 +106,14 @@ namespace Spartan
 
     void FileStream::Close()
     {
-        if (m_flags & FileStream_Write)
+        if ((m_flags & FileStream_Write) && out.is_open())
         {
+            if (m_flags & FileStream_Chunked)
+            {
+                ChunkWriteToc();
+            }
+
+            Flush();
             out.flush();
             out.close();
         }
@@ -80,14 +122,15 @@ namespace Spartan
             in.clear();
             in.close();
         }
+
+        Unmap();
     }
 
     void FileStream::Write(const string& value)
     {
         const auto length = static_cast<uint32_t>(value.length());
         Write(length);
-
-        out.write(const_cast<char*>(value.c_str()), length);
+        WriteBytes(value.data(), length);
     }
 
     void FileStream::Write(const vector<string>& value)
@@ -105,28 +148,35 @@ namespace Spartan
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
+    }
+
+    void FileStream::Write(const vector<RHI_Vertex_PosTexNorTanPacked>& value)
+    {
+        const auto length = static_cast<uint32_t>(value.size());
+        Write(length);
+        WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTanPacked) * length);
     }
 
     void FileStream::Write(const vector<uint32_t>& value)
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+        WriteBytes(value.data(), sizeof(uint32_t) * length);
     }
 
     void FileStream::Write(const vector<unsigned char>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+        WriteBytes(value.data(), sizeof(unsigned char) * size);
     }
 
     void FileStream::Write(const vector<std::byte>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+        WriteBytes(value.data(), sizeof(std::byte) * size);
     }
 
     void FileStream::Skip(uint32_t n)
@@ -134,7 +184,13 @@ namespace Spartan
         // Set the seek cursor to offset n from the current position
         if (m_flags & FileStream_Write)
         {
+            Flush();
             out.seekp(n, ios::cur);
+            m_buffer_flushed += n;
+        }
+        else if (IsMapped())
+        {
+            m_mapped_offset += n;
         }
         else if (m_flags & FileStream_Read)
         {
@@ -148,7 +204,7 @@ namespace Spartan
         Read(&length);
 
         value->resize(length);
-        in.read(const_cast<char*>(value->c_str()), length);
+        ReadBytes(value->data(), length);
     }
 
     void FileStream::Read(vector<string>* vec)
@@ -183,7 +239,23 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
+    }
+
+    void FileStream::Read(vector<RHI_Vertex_PosTexNorTanPacked>* vec)
+    {
+        if (!vec)
+            return;
+
+        vec->clear();
+        vec->shrink_to_fit();
+
+        const auto length = ReadAs<uint32_t>();
+
+        vec->reserve(length);
+        vec->resize(length);
+
+        ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTanPacked) * length);
     }
 
     void FileStream::Read(vector<uint32_t>* vec)
@@ -199,7 +271,7 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+        ReadBytes(vec->data(), sizeof(uint32_t) * length);
     }
 
     void FileStream::Read(vector<unsigned char>* vec)
@@ -215,7 +287,7 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+        ReadBytes(vec->data(), sizeof(unsigned char) * length);
     }
 
     void FileStream::Read(vector<std::byte>* vec)
@@ -231,6 +303,282 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+        ReadBytes(vec->data(), sizeof(std::byte) * length);
+    }
+
+    void FileStream::Flush()
+    {
+        if (m_buffer.empty())
+            return;
+
+        out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        m_buffer_flushed += m_buffer.size();
+        m_buffer.clear();
+    }
+
+    void FileStream::Patch(const uint64_t offset, const void* data, const uint64_t size)
+    {
+        // Still in the buffer
+        if (offset >= m_buffer_flushed)
+        {
+            memcpy(m_buffer.data() + (offset - m_buffer_flushed), data, size);
+            return;
+        }
+
+        // Already in the file
+        Flush();
+        out.seekp(offset, ios::beg);
+        out.write(reinterpret_cast<const char*>(data), size);
+        out.seekp(0, ios::end);
+    }
+
+    void FileStream::Seek(const uint64_t offset)
+    {
+        if (IsMapped())
+        {
+            m_mapped_offset = offset;
+        }
+        else
+        {
+            in.clear();
+            in.seekg(offset, ios::beg);
+        }
+    }
+
+    void FileStream::ChunkBegin(const uint32_t id)
+    {
+        if (!(m_flags & FileStream_Chunked) || !(m_flags & FileStream_Write))
+        {
+            LOG_ERROR("The stream was not opened for writing chunks");
+            return;
+        }
+
+        if (m_chunk_open)
+        {
+            ChunkEnd();
+        }
+
+        // Align the payload
+        static const std::byte padding[FileStream_Chunked_Alignment] = {};
+        const uint64_t misalignment = GetWritePosition() % FileStream_Chunked_Alignment;
+        if (misalignment != 0)
+        {
+            WriteBytes(padding, FileStream_Chunked_Alignment - misalignment);
+        }
+
+        FileStream_Chunk& chunk = m_chunks.emplace_back();
+        chunk.id                = id;
+        chunk.offset            = GetWritePosition();
+        m_chunk_open            = true;
+    }
+
+    void FileStream::ChunkEnd()
+    {
+        if (!m_chunk_open)
+            return;
+
+        FileStream_Chunk& chunk = m_chunks.back();
+        chunk.size              = GetWritePosition() - chunk.offset;
+        m_chunk_open            = false;
+    }
+
+    bool FileStream::ChunkSeek(const uint32_t id)
+    {
+        const auto it = m_chunk_lookup.find(id);
+        if (it == m_chunk_lookup.end())
+            return false;
+
+        Seek(m_chunks[it->second].offset);
+
+        return true;
+    }
+
+    bool FileStream::ChunkReadHeader()
+    {
+        uint32_t magic = 0;
+        Read(&magic);
+        if (magic != FileStream_Chunked_Magic)
+            return false;
+
+        uint32_t chunk_count    = 0;
+        uint32_t reserved       = 0;
+        uint64_t toc_offset     = 0;
+        Read(&m_version);
+        Read(&chunk_count);
+        Read(&reserved);
+        Read(&toc_offset);
+
+        if (m_version > FileStream_Chunked_Version)
+        {
+            LOG_WARNING("The file was written by a newer version (%d), reading it might fail", m_version);
+        }
+
+        // Read the table of contents
+        Seek(toc_offset);
+        m_chunks.resize(chunk_count);
+        for (uint32_t i = 0; i < chunk_count; i++)
+        {
+            Read(&m_chunks[i].id);
+            Read(&m_chunks[i].offset);
+            Read(&m_chunks[i].size);
+            m_chunk_lookup[m_chunks[i].id] = i;
+        }
+
+        // Position the cursor at the first chunk
+        Seek(m_chunks.empty() ? toc_offset : m_chunks.front().offset);
+
+        return true;
+    }
+
+    void FileStream::ChunkWriteToc()
+    {
+        ChunkEnd();
+
+        // Table of contents
+        const uint64_t toc_offset = GetWritePosition();
+        for (const FileStream_Chunk& chunk : m_chunks)
+        {
+            Write(chunk.id);
+            Write(chunk.offset);
+            Write(chunk.size);
+        }
+
+        // Header
+        const uint32_t header_32[4] = { FileStream_Chunked_Magic, m_version, static_cast<uint32_t>(m_chunks.size()), 0 };
+        Patch(0, header_32, sizeof(header_32));
+        Patch(sizeof(header_32), &toc_offset, sizeof(toc_offset));
+    }
+
+    bool FileStream::Map(const string& path)
+    {
+#if defined(_WIN32)
+        m_mapped_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_mapped_file == INVALID_HANDLE_VALUE)
+        {
+            m_mapped_file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_mapped_file, &size))
+            return false;
+
+        // Empty files can't be mapped, but they are valid files, every read will simply fail
+        m_mapped_size = static_cast<uint64_t>(size.QuadPart);
+        if (m_mapped_size == 0)
+        {
+            m_mapped = true;
+            return true;
+        }
+
+        m_mapped_handle = CreateFileMappingA(m_mapped_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapped_handle)
+            return false;
+
+        m_mapped_data = static_cast<const std::byte*>(MapViewOfFile(m_mapped_handle, FILE_MAP_READ, 0, 0, 0));
+#else
+        const int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor == -1)
+            return false;
+
+        struct stat info;
+        if (fstat(descriptor, &info) != 0)
+        {
+            close(descriptor);
+            return false;
+        }
+
+        // Empty files can't be mapped, but they are valid files, every read will simply fail
+        m_mapped_size = static_cast<uint64_t>(info.st_size);
+        if (m_mapped_size == 0)
+        {
+            close(descriptor);
+            m_mapped = true;
+            return true;
+        }
+
+        // The mapping keeps its own reference to the file, so the descriptor can be closed right away
+        void* data = mmap(nullptr, m_mapped_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        if (data == MAP_FAILED)
+            return false;
+
+        madvise(data, m_mapped_size, MADV_SEQUENTIAL);
+        m_mapped_data = static_cast<const std::byte*>(data);
+#endif
+        m_mapped = m_mapped_data != nullptr;
+        return m_mapped;
+    }
+
+    void FileStream::Unmap()
+    {
+#if defined(_WIN32)
+        if (m_mapped_data)
+        {
+            UnmapViewOfFile(m_mapped_data);
+        }
+
+        if (m_mapped_handle)
+        {
+            CloseHandle(m_mapped_handle);
+            m_mapped_handle = nullptr;
+        }
+
+        if (m_mapped_file)
+        {
+            CloseHandle(m_mapped_file);
+            m_mapped_file = nullptr;
+        }
+#else
+        if (m_mapped_data)
+        {
+            munmap(const_cast<std::byte*>(m_mapped_data), m_mapped_size);
+        }
+#endif
+        m_mapped        = false;
+        m_mapped_data   = nullptr;
+        m_mapped_size   = 0;
+        m_mapped_offset = 0;
+    }
+
+    void FileStream::ReadBytes(void* destination, const uint64_t size)
+    {
+        if (size == 0)
+            return;
+
+        if (!IsMapped())
+        {
+            in.read(reinterpret_cast<char*>(destination), size);
+            return;
+        }
+
+        if (const void* source = ReadMapped(size))
+        {
+            memcpy(destination, source, size);
+        }
+        else
+        {
+            memset(destination, 0, size);
+        }
+    }
+
+    const void* FileStream::ReadMapped(const uint64_t size)
+    {
+        if (!IsMapped())
+        {
+            LOG_ERROR("The stream is not memory mapped");
+            return nullptr;
+        }
+
+        if (m_mapped_offset + size > m_mapped_size)
+        {
+            LOG_ERROR("Attempted to read past the end of the file");
+            m_mapped_offset = m_mapped_size;
+            return nullptr;
+        }
+
+        const void* data = m_mapped_data + m_mapped_offset;
+        m_mapped_offset += size;
+        return data;
     }
 }
@@ -24,6 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===================
 #include <vector>
 #include <fstream>
+#include <cstring>
+#include <unordered_map>
+#include "../Core/Span.h"
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -40,6 +43,24 @@ namespace Spartan
         FileStream_Read     = 1 << 0,
         FileStream_Write    = 1 << 1,
         FileStream_Append   = 1 << 2,
+        FileStream_Mapped   = 1 << 3, // read through a memory mapping of the whole file instead of a stream
+        FileStream_Chunked  = 1 << 4, // versioned container with a table of contents, see ChunkBegin() and ChunkSeek()
+    };
+
+    // Container layout (FileStream_Chunked):
+    // header  - magic, version, chunk count, table of contents offset
+    // chunks  - payloads, each one starting at an aligned offset
+    // toc     - id, offset and size of every chunk
+    // Files without the magic are treated as version 0, the sequential format that preceded the container.
+    static const uint32_t FileStream_Chunked_Magic      = 0x54525053; // "SPRT"
+    static const uint32_t FileStream_Chunked_Version    = 1;
+    static const uint32_t FileStream_Chunked_Alignment  = 16;
+
+    struct FileStream_Chunk
+    {
+        uint32_t id     = 0;
+        uint64_t offset = 0;
+        uint64_t size   = 0;
     };
 
     class SPARTAN_CLASS FileStream
@@ -76,12 +97,13 @@ namespace Spartan
         >::type>
         void Write(T value)
         {
-            out.write(reinterpret_cast<char*>(&value), sizeof(value));
+            WriteBytes(&value, sizeof(value));
         }
 
         void Write(const std::string& value);
         void Write(const std::vector<std::string>& value);
         void Write(const std::vector<RHI_Vertex_PosTexNorTan>& value);
+        void Write(const std::vector<RHI_Vertex_PosTexNorTanPacked>& value);
         void Write(const std::vector<uint32_t>& value);
         void Write(const std::vector<unsigned char>& value);
         void Write(const std::vector<std::byte>& value);
@@ -114,11 +136,12 @@ namespace Spartan
         >::type>
         void Read(T* value)
         {
-            in.read(reinterpret_cast<char*>(value), sizeof(T));
+            ReadBytes(value, sizeof(T));
         }
         void Read(std::string* value);
         void Read(std::vector<std::string>* vec);
         void Read(std::vector<RHI_Vertex_PosTexNorTan>* vec);
+        void Read(std::vector<RHI_Vertex_PosTexNorTanPacked>* vec);
         void Read(std::vector<uint32_t>* vec);
         void Read(std::vector<unsigned char>* vec);
         void Read(std::vector<std::byte>* vec);
@@ -149,12 +172,86 @@ namespace Spartan
             Read(&value);
             return value;
         }
+
+        // Returns a view of an array written by Write(const std::vector<T>&), without copying it.
+        // Only available with FileStream_Mapped, the view remains valid until the stream is closed.
+        template <class T, class = typename std::enable_if
+        <
+            std::is_same<T, RHI_Vertex_PosTexNorTan>::value         ||
+            std::is_same<T, RHI_Vertex_PosTexNorTanPacked>::value   ||
+            std::is_same<T, uint32_t>::value                        ||
+            std::is_same<T, unsigned char>::value                   ||
+            std::is_same<T, std::byte>::value
+        >::type>
+        Span<const T> ReadSpan()
+        {
+            const uint32_t length       = ReadAs<uint32_t>();
+            const void* data            = ReadMapped(static_cast<uint64_t>(length) * sizeof(T));
+            return data ? Span<const T>(static_cast<const T*>(data), length) : Span<const T>();
+        }
         //=====================================================
 
+        bool IsMapped() const { return m_mapped; }
+
+        //= CHUNKS ======================================================================
+        // Writing - everything written between ChunkBegin() and ChunkEnd() becomes the chunk's payload
+        void ChunkBegin(uint32_t id);
+        void ChunkEnd();
+        // Reading - moves the cursor to the start of the chunk, returns false if the file doesn't have it
+        bool ChunkSeek(uint32_t id);
+        bool HasChunk(uint32_t id) const { return m_chunk_lookup.find(id) != m_chunk_lookup.end(); }
+        // Returns 0 for files which predate the chunked container
+        uint32_t GetVersion() const { return m_version; }
+        //===============================================================================
+
     private:
+        // Writes are collected in memory and reach the file in large blocks, instead of one stream call per field
+        void WriteBytes(const void* data, const uint64_t size)
+        {
+            const size_t offset = m_buffer.size();
+            m_buffer.resize(offset + size);
+            memcpy(m_buffer.data() + offset, data, size);
+
+            if (m_buffer.size() >= m_buffer_flush_threshold)
+            {
+                Flush();
+            }
+        }
+        void Flush();
+        uint64_t GetWritePosition() const { return m_buffer_flushed + m_buffer.size(); }
+        void Patch(uint64_t offset, const void* data, uint64_t size);
+        void Seek(uint64_t offset);
+
+        bool ChunkReadHeader();
+        void ChunkWriteToc();
+
+        bool Map(const std::string& path);
+        void Unmap();
+        void ReadBytes(void* destination, uint64_t size);
+        const void* ReadMapped(uint64_t size);
+
         std::ofstream out;
         std::ifstream in;
         uint32_t m_flags;
         bool m_is_open;
+
+        // Write buffer
+        std::vector<std::byte> m_buffer;
+        static const uint64_t m_buffer_flush_threshold = 64 * 1024 * 1024;
+        uint64_t m_buffer_flushed = 0;
+
+        // Chunks
+        uint32_t m_version = 0;
+        std::vector<FileStream_Chunk> m_chunks;
+        std::unordered_map<uint32_t, uint32_t> m_chunk_lookup;
+        bool m_chunk_open = false;
+
+        // Memory mapping (an empty file is mapped, with no data and a size of zero)
+        bool m_mapped                   = false;
+        void* m_mapped_file             = nullptr;
+        void* m_mapped_handle           = nullptr;
+        const std::byte* m_mapped_data  = nullptr;
+        uint64_t m_mapped_size          = 0;
+        uint64_t m_mapped_offset        = 0;
     };
 }
@@ -109,8 +109,17 @@ namespace Spartan::Math
         }
     }
 
+    // The SIMD kernels read boxes and matrices as tightly packed floats
+    static_assert(sizeof(BoundingBox) == sizeof(float) * 6, "BoundingBox is expected to be packed");
+    static_assert(sizeof(Matrix) == sizeof(float) * 16, "Matrix is expected to be packed");
+
     BoundingBox BoundingBox::Transform(const Matrix& transform) const
     {
+    #if defined(SPARTAN_SIMD_SSE4)
+        BoundingBox result;
+        Simd::AabbTransform(&m_min.x, transform.Data(), &result.m_min.x);
+        return result;
+    #else
         const Vector3 center_new = transform * GetCenter();
         const Vector3 extent_old = GetExtents();
         const Vector3 extend_new = Vector3
@@ -121,6 +130,19 @@ namespace Spartan::Math
         );
 
         return BoundingBox(center_new - extend_new, center_new + extend_new);
+    #endif
+    }
+
+    void BoundingBox::Transform(const BoundingBox* boxes, const Matrix* transforms, BoundingBox* out, const uint32_t count)
+    {
+    #if defined(SPARTAN_SIMD_SSE4)
+        Simd::AabbTransform(&boxes->m_min.x, transforms->Data(), &out->m_min.x, count);
+    #else
+        for (uint32_t i = 0; i < count; i++)
+        {
+            out[i] = boxes[i].Transform(transforms[i]);
+        }
+    #endif
     }
 
     void BoundingBox::Merge(const BoundingBox& box)
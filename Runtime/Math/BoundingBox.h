@@ -73,6 +73,9 @@ namespace Spartan
             // Returns a transformed bounding box
             BoundingBox Transform(const Matrix& transform) const;
 
+            // Transforms many bounding boxes at once, out[i] = boxes[i].Transform(transforms[i])
+            static void Transform(const BoundingBox* boxes, const Matrix* transforms, BoundingBox* out, uint32_t count);
+
             // Merge with another bounding box
             void Merge(const BoundingBox& box);
 
@@ -19,9 +19,10 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =======
+//= INCLUDES ==========
 #include "Spartan.h"
-//==================
+#include "BoundingBox.h"
+//=====================
 
 //= NAMESPACES =====
 using namespace std;
@@ -84,6 +85,112 @@ namespace Spartan::Math
         m_planes[5].Normalize();
     }
 
+    void BoundingBoxPacked::Clear()
+    {
+        center_x.clear(); center_y.clear(); center_z.clear();
+        extent_x.clear(); extent_y.clear(); extent_z.clear();
+        m_count = 0;
+    }
+
+    void BoundingBoxPacked::Add(const BoundingBox& box)
+    {
+        // Grow by a whole group, the padding is overwritten by the boxes that follow
+        if (m_count == GetCountPadded())
+        {
+            const size_t size = m_count + group_size;
+            center_x.resize(size, 0.0f); center_y.resize(size, 0.0f); center_z.resize(size, 0.0f);
+            extent_x.resize(size, 0.0f); extent_y.resize(size, 0.0f); extent_z.resize(size, 0.0f);
+        }
+
+        const Vector3 center = box.GetCenter();
+        const Vector3 extent = box.GetExtents();
+        center_x[m_count] = center.x; center_y[m_count] = center.y; center_z[m_count] = center.z;
+        extent_x[m_count] = extent.x; extent_y[m_count] = extent.y; extent_z[m_count] = extent.z;
+        m_count++;
+    }
+
+    void Frustum::Cull(const BoundingBoxPacked& boxes, const uint32_t start, const uint32_t end, uint8_t* visible, const bool ignore_depth /*= false*/) const
+    {
+        // A box is outside when it's entirely behind any of the planes, comparisons against NaN (undefined boxes) keep it visible
+        const uint32_t plane_start = ignore_depth ? 2 : 0;
+
+    #if defined(SPARTAN_SIMD_AVX2)
+        for (uint32_t i = start; i < end; i += 8)
+        {
+            const __m256 center_x = _mm256_loadu_ps(&boxes.center_x[i]);
+            const __m256 center_y = _mm256_loadu_ps(&boxes.center_y[i]);
+            const __m256 center_z = _mm256_loadu_ps(&boxes.center_z[i]);
+            const __m256 extent_x = _mm256_loadu_ps(&boxes.extent_x[i]);
+            const __m256 extent_y = _mm256_loadu_ps(&boxes.extent_y[i]);
+            const __m256 extent_z = _mm256_loadu_ps(&boxes.extent_z[i]);
+
+            __m256 outside = _mm256_setzero_ps();
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                const Plane& plane = m_planes[p];
+                __m256 distance = _mm256_set1_ps(plane.d);
+                distance = _mm256_fmadd_ps(center_x, _mm256_set1_ps(plane.normal.x), distance);
+                distance = _mm256_fmadd_ps(center_y, _mm256_set1_ps(plane.normal.y), distance);
+                distance = _mm256_fmadd_ps(center_z, _mm256_set1_ps(plane.normal.z), distance);
+                distance = _mm256_fmadd_ps(extent_x, _mm256_set1_ps(Helper::Abs(plane.normal.x)), distance);
+                distance = _mm256_fmadd_ps(extent_y, _mm256_set1_ps(Helper::Abs(plane.normal.y)), distance);
+                distance = _mm256_fmadd_ps(extent_z, _mm256_set1_ps(Helper::Abs(plane.normal.z)), distance);
+                outside  = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+            }
+
+            const int mask = _mm256_movemask_ps(outside);
+            for (uint32_t lane = 0; lane < 8; lane++)
+            {
+                visible[i + lane] = ((mask >> lane) & 1) == 0;
+            }
+        }
+    #elif defined(SPARTAN_SIMD_SSE4)
+        for (uint32_t i = start; i < end; i += 4)
+        {
+            const __m128 center_x = _mm_loadu_ps(&boxes.center_x[i]);
+            const __m128 center_y = _mm_loadu_ps(&boxes.center_y[i]);
+            const __m128 center_z = _mm_loadu_ps(&boxes.center_z[i]);
+            const __m128 extent_x = _mm_loadu_ps(&boxes.extent_x[i]);
+            const __m128 extent_y = _mm_loadu_ps(&boxes.extent_y[i]);
+            const __m128 extent_z = _mm_loadu_ps(&boxes.extent_z[i]);
+
+            __m128 outside = _mm_setzero_ps();
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                const Plane& plane = m_planes[p];
+                __m128 distance = _mm_set1_ps(plane.d);
+                distance = _mm_add_ps(distance, _mm_mul_ps(center_x, _mm_set1_ps(plane.normal.x)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(center_y, _mm_set1_ps(plane.normal.y)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(center_z, _mm_set1_ps(plane.normal.z)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(extent_x, _mm_set1_ps(Helper::Abs(plane.normal.x))));
+                distance = _mm_add_ps(distance, _mm_mul_ps(extent_y, _mm_set1_ps(Helper::Abs(plane.normal.y))));
+                distance = _mm_add_ps(distance, _mm_mul_ps(extent_z, _mm_set1_ps(Helper::Abs(plane.normal.z))));
+                outside  = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+            }
+
+            const int mask = _mm_movemask_ps(outside);
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                visible[i + lane] = ((mask >> lane) & 1) == 0;
+            }
+        }
+    #else
+        for (uint32_t i = start; i < end; i++)
+        {
+            bool outside = false;
+            for (uint32_t p = plane_start; p < 6 && !outside; p++)
+            {
+                const Plane& plane      = m_planes[p];
+                const float distance    = boxes.center_x[i] * plane.normal.x + boxes.center_y[i] * plane.normal.y + boxes.center_z[i] * plane.normal.z + plane.d;
+                const float radius      = boxes.extent_x[i] * Helper::Abs(plane.normal.x) + boxes.extent_y[i] * Helper::Abs(plane.normal.y) + boxes.extent_z[i] * Helper::Abs(plane.normal.z);
+                outside                 = distance + radius < 0.0f;
+            }
+
+            visible[i] = outside ? 0 : 1;
+        }
+    #endif
+    }
+
     bool Frustum::IsVisible(const Vector3& center, const Vector3& extent, bool ignore_near_plane /*= false*/) const
     {
         float radius = 0.0f;
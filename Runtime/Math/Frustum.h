@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =============
+#include <vector>
 #include "../Math/Plane.h"
 #include "Matrix.h"
 #include "Vector3.h"
@@ -29,6 +30,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan::Math
 {
+    class BoundingBox;
+
+    // Bounding boxes as a structure of arrays (center and extent per axis), so that many of them can be tested with a single instruction.
+    // The arrays are padded with empty boxes to a multiple of the group size.
+    class BoundingBoxPacked
+    {
+    public:
+        static const uint32_t group_size = 8;
+
+        void Clear();
+        void Add(const BoundingBox& box);
+        uint32_t GetCount()         const { return m_count; }
+        uint32_t GetCountPadded()   const { return static_cast<uint32_t>(center_x.size()); }
+
+        std::vector<float> center_x, center_y, center_z;
+        std::vector<float> extent_x, extent_y, extent_z;
+
+    private:
+        uint32_t m_count = 0;
+    };
+
     class Frustum
     {
     public:
@@ -38,6 +60,14 @@ namespace Spartan::Math
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_near_plane = false) const;
 
+        // Tests the boxes in [start, end) against the planes and writes 1 (visible) or 0 (culled) per box.
+        // start and end have to be multiples of BoundingBoxPacked::group_size.
+        // ignore_depth skips the near and far planes, so that casters behind a directional light aren't rejected.
+        void Cull(const BoundingBoxPacked& boxes, uint32_t start, uint32_t end, uint8_t* visible, bool ignore_depth = false) const;
+
+        // Near, far, left, right, top, bottom
+        const Plane* GetPlanes() const { return m_planes; }
+
     private:
         Intersection CheckCube(const Vector3& center, const Vector3& extent) const;
         Intersection CheckSphere(const Vector3& center, float radius) const;
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cmath>
 #include <limits>
 #include <random>
+#include <cstring>
 //===============
 
 namespace Spartan::Math
@@ -134,4 +135,80 @@ namespace Spartan::Math::Helper
         n |= n >> 16;
         return n++;
     }
+
+    // IEEE 754 half precision, with subnormals, infinities and NaNs
+    inline float HalfToFloat(const uint16_t value)
+    {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        uint32_t exponent   = (value >> 10) & 0x1f;
+        uint32_t mantissa   = value & 0x3ff;
+        uint32_t bits       = 0;
+
+        if (exponent == 0)
+        {
+            if (mantissa == 0)
+            {
+                bits = sign;
+            }
+            else // subnormal, normalize it
+            {
+                exponent = 1;
+                while ((mantissa & 0x400) == 0)
+                {
+                    mantissa <<= 1;
+                    exponent--;
+                }
+                bits = sign | ((exponent + 112) << 23) | ((mantissa & 0x3ff) << 13);
+            }
+        }
+        else if (exponent == 31)
+        {
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        }
+        else
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+
+    // Rounds to nearest
+    inline uint16_t FloatToHalf(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(float));
+
+        const uint32_t sign         = (bits >> 16) & 0x8000;
+        const int32_t exponent      = static_cast<int32_t>((bits >> 23) & 0xff) - 112;
+        uint32_t mantissa           = bits & 0x7fffff;
+
+        // Infinity and NaN
+        if (((bits >> 23) & 0xff) == 0xff)
+            return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+        // Overflow
+        if (exponent >= 31)
+            return static_cast<uint16_t>(sign | 0x7c00);
+
+        // Subnormal or zero
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return static_cast<uint16_t>(sign);
+
+            mantissa |= 0x800000;
+            const uint32_t shift    = static_cast<uint32_t>(14 - exponent);
+            uint32_t half           = mantissa >> shift;
+            half                   += (mantissa >> (shift - 1)) & 1;
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        // Rounding can carry into the exponent, which is still the correct result
+        uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        half += (mantissa >> 12) & 1;
+        return static_cast<uint16_t>(half);
+    }
 }
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "Simd.h"
 //=====================
 
 namespace Spartan::Math
@@ -118,6 +119,16 @@ namespace Spartan::Math
 
         [[nodiscard]] Quaternion GetRotation() const
         {
+        #if defined(SPARTAN_SIMD_SSE4)
+            const __m128 scale = Simd::MatrixGetScale(Data());
+
+            // Avoid division by zero (we'll divide to remove scaling)
+            if ((_mm_movemask_ps(_mm_cmpeq_ps(scale, _mm_setzero_ps())) & 0x7) != 0) { return Quaternion(0, 0, 0, 1); }
+
+            // Extract rotation and remove scaling
+            Matrix normalized;
+            Simd::MatrixRemoveScale(Data(), scale, &normalized.m00);
+        #else
             const Vector3 scale = GetScale();
 
             // Avoid division by zero (we'll divide to remove scaling)
@@ -129,6 +140,7 @@ namespace Spartan::Math
             normalized.m10 = m10 / scale.y; normalized.m11 = m11 / scale.y; normalized.m12 = m12 / scale.y; normalized.m13 = 0.0f;
             normalized.m20 = m20 / scale.z; normalized.m21 = m21 / scale.z; normalized.m22 = m22 / scale.z; normalized.m23 = 0.0f;
             normalized.m30 = 0; normalized.m31 = 0; normalized.m32 = 0; normalized.m33 = 1.0f;
+        #endif
 
             return RotationMatrixToQuaternion(normalized);
         }
@@ -191,6 +203,11 @@ namespace Spartan::Math
         //= SCALE ========================================================================================
         [[nodiscard]] Vector3 GetScale() const
         {
+        #if defined(SPARTAN_SIMD_SSE4)
+            float scale[4];
+            _mm_storeu_ps(scale, Simd::MatrixGetScale(Data()));
+            return Vector3(scale[0], scale[1], scale[2]);
+        #else
             const int xs = (Helper::Sign(m00 * m01 * m02 * m03) < 0) ? -1 : 1;
             const int ys = (Helper::Sign(m10 * m11 * m12 * m13) < 0) ? -1 : 1;
             const int zs = (Helper::Sign(m20 * m21 * m22 * m23) < 0) ? -1 : 1;
@@ -200,6 +217,7 @@ namespace Spartan::Math
                 static_cast<float>(ys) * Helper::Sqrt(m10 * m10 + m11 * m11 + m12 * m12),
                 static_cast<float>(zs) * Helper::Sqrt(m20 * m20 + m21 * m21 + m22 * m22)
             );
+        #endif
         }
 
         static inline Matrix CreateScale(float scale) { return CreateScale(scale, scale, scale); }
@@ -286,6 +304,11 @@ namespace Spartan::Math
         [[nodiscard]] Matrix Inverted() const { return Invert(*this); }
         static inline Matrix Invert(const Matrix& matrix)
         {
+        #if defined(SPARTAN_SIMD_SSE4)
+            Matrix result;
+            Simd::MatrixInvert(matrix.Data(), &result.m00);
+            return result;
+        #else
             float v0 = matrix.m20 * matrix.m31 - matrix.m21 * matrix.m30;
             float v1 = matrix.m20 * matrix.m32 - matrix.m22 * matrix.m30;
             float v2 = matrix.m20 * matrix.m33 - matrix.m23 *matrix.m30;
@@ -339,6 +362,7 @@ namespace Spartan::Math
                 i10, i11, i12, i13,
                 i20, i21, i22, i23,
                 i30, i31, i32, i33);
+        #endif
         }
         //================================================================================================
 
@@ -360,6 +384,11 @@ namespace Spartan::Math
         //= MULTIPLICATION ================================================================================================================
         Matrix operator*(const Matrix& rhs) const
         {
+        #if defined(SPARTAN_SIMD_SSE4)
+            Matrix result;
+            Simd::MatrixMultiply(Data(), rhs.Data(), &result.m00);
+            return result;
+        #else
             return Matrix(
                 m00 * rhs.m00 + m01 * rhs.m10 + m02 * rhs.m20 + m03 * rhs.m30,
                 m00 * rhs.m01 + m01 * rhs.m11 + m02 * rhs.m21 + m03 * rhs.m31,
@@ -378,10 +407,24 @@ namespace Spartan::Math
                 m30 * rhs.m02 + m31 * rhs.m12 + m32 * rhs.m22 + m33 * rhs.m32,
                 m30 * rhs.m03 + m31 * rhs.m13 + m32 * rhs.m23 + m33 * rhs.m33
             );
+        #endif
         }
 
         void operator*=(const Matrix& rhs) { (*this) = (*this) * rhs; }
 
+        // out[i] = lhs[i] * rhs[i], out can alias either input
+        static inline void Multiply(const Matrix* lhs, const Matrix* rhs, Matrix* out, const uint32_t count)
+        {
+        #if defined(SPARTAN_SIMD_SSE4)
+            Simd::MatrixMultiply(lhs->Data(), rhs->Data(), &out->m00, count);
+        #else
+            for (uint32_t i = 0; i < count; i++)
+            {
+                out[i] = lhs[i] * rhs[i];
+            }
+        #endif
+        }
+
         Vector3 operator*(const Vector3& rhs) const
         {
             Vector4 vWorking;
@@ -0,0 +1,341 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====
+#include <cstdint>
+//===============
+
+// The backend is selected at compile time, by the build (see Scripts/premake.lua) rather than assumed from the target:
+// SPARTAN_SIMD_AVX2    - AVX2/FMA, batch kernels process two items per iteration (/arch:AVX2 or -mavx2 -mfma), the binary won't run without them
+// SPARTAN_SIMD_SSE4    - SSE4.1, defined by the build since MSVC has no macro for it (implied by AVX and AVX2)
+// neither              - the scalar code in Matrix and BoundingBox is used (define SPARTAN_SIMD_DISABLED to force it)
+#if defined(SPARTAN_SIMD_DISABLED)
+    #undef SPARTAN_SIMD_SSE4
+#else
+    #if defined(__AVX2__)
+        #define SPARTAN_SIMD_AVX2
+    #endif
+    #if !defined(SPARTAN_SIMD_SSE4) && (defined(SPARTAN_SIMD_AVX2) || defined(__AVX__) || defined(__SSE4_1__))
+        #define SPARTAN_SIMD_SSE4
+    #endif
+#endif
+
+#if defined(SPARTAN_SIMD_AVX2)
+    #include <immintrin.h>
+#elif defined(SPARTAN_SIMD_SSE4)
+    #include <smmintrin.h>
+#endif
+
+#if defined(SPARTAN_SIMD_SSE4)
+// Matrices are 16 floats in column-major order, bounding boxes are 6 floats (min, max).
+namespace Spartan::Math::Simd
+{
+    #define SPARTAN_SHUFFLE(v, x, y, z, w) _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(w, z, y, x)))
+
+    // Loads/stores exactly 3 floats, so the last element of an array is never overrun
+    inline __m128 Load3(const float* data)
+    {
+        const __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+        return _mm_movelh_ps(xy, _mm_load_ss(data + 2));
+    }
+
+    inline void Store3(float* data, const __m128 v)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(data), v);
+        _mm_store_ss(data + 2, _mm_movehl_ps(v, v));
+    }
+
+    // out = a * b, out can alias either input
+    inline void MatrixMultiply(const float* a, const float* b, float* out)
+    {
+        const __m128 a0 = _mm_loadu_ps(a + 0);
+        const __m128 a1 = _mm_loadu_ps(a + 4);
+        const __m128 a2 = _mm_loadu_ps(a + 8);
+        const __m128 a3 = _mm_loadu_ps(a + 12);
+
+        // Column j of the result is the columns of a, weighted by column j of b
+        __m128 result[4];
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            const __m128 b_j = _mm_loadu_ps(b + j * 4);
+            __m128 r = _mm_mul_ps(a0, SPARTAN_SHUFFLE(b_j, 0, 0, 0, 0));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, SPARTAN_SHUFFLE(b_j, 1, 1, 1, 1)));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, SPARTAN_SHUFFLE(b_j, 2, 2, 2, 2)));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, SPARTAN_SHUFFLE(b_j, 3, 3, 3, 3)));
+            result[j] = r;
+        }
+
+        _mm_storeu_ps(out + 0,  result[0]);
+        _mm_storeu_ps(out + 4,  result[1]);
+        _mm_storeu_ps(out + 8,  result[2]);
+        _mm_storeu_ps(out + 12, result[3]);
+    }
+
+    // out[i] = a[i] * b[i]
+    inline void MatrixMultiply(const float* a, const float* b, float* out, const uint32_t count)
+    {
+        uint32_t i = 0;
+
+    #if defined(SPARTAN_SIMD_AVX2)
+        // Two matrices per iteration, one in each 128-bit lane
+        const auto load_pair = [](const float* first, const float* second)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(first)), _mm_loadu_ps(second), 1);
+        };
+
+        for (; i + 1 < count; i += 2)
+        {
+            const float* a_i    = a + i * 16;
+            const float* b_i    = b + i * 16;
+            float* out_i        = out + i * 16;
+
+            const __m256 a0 = load_pair(a_i + 0,  a_i + 16);
+            const __m256 a1 = load_pair(a_i + 4,  a_i + 20);
+            const __m256 a2 = load_pair(a_i + 8,  a_i + 24);
+            const __m256 a3 = load_pair(a_i + 12, a_i + 28);
+
+            __m256 result[4];
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                const __m256 b_j = load_pair(b_i + j * 4, b_i + 16 + j * 4);
+                __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b_j, 0x00));
+                r = _mm256_fmadd_ps(a1, _mm256_permute_ps(b_j, 0x55), r);
+                r = _mm256_fmadd_ps(a2, _mm256_permute_ps(b_j, 0xAA), r);
+                r = _mm256_fmadd_ps(a3, _mm256_permute_ps(b_j, 0xFF), r);
+                result[j] = r;
+            }
+
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                _mm_storeu_ps(out_i + j * 4,        _mm256_castps256_ps128(result[j]));
+                _mm_storeu_ps(out_i + 16 + j * 4,   _mm256_extractf128_ps(result[j], 1));
+            }
+        }
+    #endif
+
+        for (; i < count; i++)
+        {
+            MatrixMultiply(a + i * 16, b + i * 16, out + i * 16);
+        }
+    }
+
+    // General 4x4 inverse using 2x2 sub-matrices (the transpose of the inverse is the inverse of the transpose,
+    // so the result is correct for column-major data as well)
+    inline void MatrixInvert(const float* m, float* out)
+    {
+        // 2x2 sub-matrix products, a 2x2 matrix is packed as (m00, m01, m10, m11)
+        const auto mat2_mul = [](const __m128 a, const __m128 b)
+        {
+            return _mm_add_ps(_mm_mul_ps(a, SPARTAN_SHUFFLE(b, 0, 3, 0, 3)), _mm_mul_ps(SPARTAN_SHUFFLE(a, 1, 0, 3, 2), SPARTAN_SHUFFLE(b, 2, 1, 2, 1)));
+        };
+        const auto mat2_adj_mul = [](const __m128 a, const __m128 b)
+        {
+            return _mm_sub_ps(_mm_mul_ps(SPARTAN_SHUFFLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SPARTAN_SHUFFLE(a, 1, 1, 2, 2), SPARTAN_SHUFFLE(b, 2, 3, 0, 1)));
+        };
+        const auto mat2_mul_adj = [](const __m128 a, const __m128 b)
+        {
+            return _mm_sub_ps(_mm_mul_ps(a, SPARTAN_SHUFFLE(b, 3, 0, 3, 0)), _mm_mul_ps(SPARTAN_SHUFFLE(a, 1, 0, 3, 2), SPARTAN_SHUFFLE(b, 2, 1, 2, 1)));
+        };
+
+        const __m128 r0 = _mm_loadu_ps(m + 0);
+        const __m128 r1 = _mm_loadu_ps(m + 4);
+        const __m128 r2 = _mm_loadu_ps(m + 8);
+        const __m128 r3 = _mm_loadu_ps(m + 12);
+
+        // Sub-matrices
+        const __m128 a = _mm_movelh_ps(r0, r1);
+        const __m128 b = _mm_movehl_ps(r1, r0);
+        const __m128 c = _mm_movelh_ps(r2, r3);
+        const __m128 d = _mm_movehl_ps(r3, r2);
+
+        // Determinants of the sub-matrices (|a|, |b|, |c|, |d|)
+        const __m128 det_sub = _mm_sub_ps
+        (
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0)))
+        );
+        const __m128 det_a = SPARTAN_SHUFFLE(det_sub, 0, 0, 0, 0);
+        const __m128 det_b = SPARTAN_SHUFFLE(det_sub, 1, 1, 1, 1);
+        const __m128 det_c = SPARTAN_SHUFFLE(det_sub, 2, 2, 2, 2);
+        const __m128 det_d = SPARTAN_SHUFFLE(det_sub, 3, 3, 3, 3);
+
+        const __m128 d_c = mat2_adj_mul(d, c);
+        const __m128 a_b = mat2_adj_mul(a, b);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_mul(b, d_c));
+        __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_mul(c, a_b));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_mul_adj(d, a_b));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_mul_adj(a, d_c));
+
+        // Determinant = |a||d| + |b||c| - trace(a_b * d_c)
+        __m128 det = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+        __m128 trace = _mm_mul_ps(a_b, SPARTAN_SHUFFLE(d_c, 0, 2, 1, 3));
+        trace = _mm_hadd_ps(trace, trace);
+        trace = _mm_hadd_ps(trace, trace);
+        det = _mm_sub_ps(det, trace);
+
+        const __m128 det_inv = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+        x = _mm_mul_ps(x, det_inv);
+        y = _mm_mul_ps(y, det_inv);
+        z = _mm_mul_ps(z, det_inv);
+        w = _mm_mul_ps(w, det_inv);
+
+        // Adjugate shuffle and store
+        _mm_storeu_ps(out + 0,  _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out + 4,  _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+        _mm_storeu_ps(out + 8,  _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+    }
+
+    // Length of each of the first three rows, negated when the product of the row's elements is negative
+    inline __m128 MatrixGetScale(const float* m)
+    {
+        // Row i is lane i of the columns
+        const __m128 c0 = _mm_loadu_ps(m + 0);
+        const __m128 c1 = _mm_loadu_ps(m + 4);
+        const __m128 c2 = _mm_loadu_ps(m + 8);
+        const __m128 c3 = _mm_loadu_ps(m + 12);
+
+        __m128 length_squared   = _mm_mul_ps(c0, c0);
+        length_squared          = _mm_add_ps(length_squared, _mm_mul_ps(c1, c1));
+        length_squared          = _mm_add_ps(length_squared, _mm_mul_ps(c2, c2));
+        const __m128 length     = _mm_sqrt_ps(length_squared);
+
+        const __m128 product    = _mm_mul_ps(_mm_mul_ps(c0, c1), _mm_mul_ps(c2, c3));
+        const __m128 negative   = _mm_and_ps(_mm_cmplt_ps(product, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+
+        return _mm_xor_ps(length, negative);
+    }
+
+    // Divides the first three rows by the scale and zeroes the translation
+    inline void MatrixRemoveScale(const float* m, const __m128 scale, float* out)
+    {
+        // Lane 3 of the columns is the translation row
+        const __m128 divisor = _mm_blend_ps(scale, _mm_set1_ps(1.0f), 0x8);
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            const __m128 column = _mm_div_ps(_mm_loadu_ps(m + j * 4), divisor);
+            _mm_storeu_ps(out + j * 4, _mm_blend_ps(column, _mm_setzero_ps(), 0x8));
+        }
+        _mm_storeu_ps(out + 12, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    // Transforms an axis aligned box and returns the box enclosing the result
+    inline void AabbTransform(const float* box, const float* m, float* out)
+    {
+        // Rows, so that a point transforms as x * row0 + y * row1 + z * row2 + row3
+        __m128 r0 = _mm_loadu_ps(m + 0);
+        __m128 r1 = _mm_loadu_ps(m + 4);
+        __m128 r2 = _mm_loadu_ps(m + 8);
+        __m128 r3 = _mm_loadu_ps(m + 12);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        const __m128 min        = Load3(box);
+        const __m128 max        = Load3(box + 3);
+        const __m128 half       = _mm_set1_ps(0.5f);
+        const __m128 center     = _mm_mul_ps(_mm_add_ps(max, min), half);
+        const __m128 extent     = _mm_mul_ps(_mm_sub_ps(max, min), half);
+        const __m128 abs_mask   = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        // Center, with the perspective divide (matches Matrix * Vector3)
+        __m128 center_new = r3;
+        center_new = _mm_add_ps(center_new, _mm_mul_ps(r0, SPARTAN_SHUFFLE(center, 0, 0, 0, 0)));
+        center_new = _mm_add_ps(center_new, _mm_mul_ps(r1, SPARTAN_SHUFFLE(center, 1, 1, 1, 1)));
+        center_new = _mm_add_ps(center_new, _mm_mul_ps(r2, SPARTAN_SHUFFLE(center, 2, 2, 2, 2)));
+        center_new = _mm_div_ps(center_new, SPARTAN_SHUFFLE(center_new, 3, 3, 3, 3));
+
+        // Extent, projected on the absolute axes
+        __m128 extent_new = _mm_mul_ps(_mm_and_ps(r0, abs_mask), SPARTAN_SHUFFLE(extent, 0, 0, 0, 0));
+        extent_new = _mm_add_ps(extent_new, _mm_mul_ps(_mm_and_ps(r1, abs_mask), SPARTAN_SHUFFLE(extent, 1, 1, 1, 1)));
+        extent_new = _mm_add_ps(extent_new, _mm_mul_ps(_mm_and_ps(r2, abs_mask), SPARTAN_SHUFFLE(extent, 2, 2, 2, 2)));
+
+        Store3(out,     _mm_sub_ps(center_new, extent_new));
+        Store3(out + 3, _mm_add_ps(center_new, extent_new));
+    }
+
+    // out[i] = boxes[i] transformed by matrices[i]
+    inline void AabbTransform(const float* boxes, const float* matrices, float* out, const uint32_t count)
+    {
+        uint32_t i = 0;
+
+    #if defined(SPARTAN_SIMD_AVX2)
+        // Two boxes per iteration, one in each 128-bit lane (the in-lane shuffles transpose both matrices at once)
+        const auto load_pair = [](const __m128 first, const __m128 second)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(first), second, 1);
+        };
+
+        const __m256 half       = _mm256_set1_ps(0.5f);
+        const __m256 abs_mask   = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+        for (; i + 1 < count; i += 2)
+        {
+            const float* m_i    = matrices + i * 16;
+            const float* box_i  = boxes + i * 6;
+            float* out_i        = out + i * 6;
+
+            const __m256 c0 = load_pair(_mm_loadu_ps(m_i + 0),  _mm_loadu_ps(m_i + 16));
+            const __m256 c1 = load_pair(_mm_loadu_ps(m_i + 4),  _mm_loadu_ps(m_i + 20));
+            const __m256 c2 = load_pair(_mm_loadu_ps(m_i + 8),  _mm_loadu_ps(m_i + 24));
+            const __m256 c3 = load_pair(_mm_loadu_ps(m_i + 12), _mm_loadu_ps(m_i + 28));
+
+            // Transpose
+            const __m256 t0 = _mm256_unpacklo_ps(c0, c1);
+            const __m256 t1 = _mm256_unpacklo_ps(c2, c3);
+            const __m256 t2 = _mm256_unpackhi_ps(c0, c1);
+            const __m256 t3 = _mm256_unpackhi_ps(c2, c3);
+            const __m256 r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            const __m256 min    = load_pair(Load3(box_i),     Load3(box_i + 6));
+            const __m256 max    = load_pair(Load3(box_i + 3), Load3(box_i + 9));
+            const __m256 center = _mm256_mul_ps(_mm256_add_ps(max, min), half);
+            const __m256 extent = _mm256_mul_ps(_mm256_sub_ps(max, min), half);
+
+            __m256 center_new = r3;
+            center_new = _mm256_fmadd_ps(r0, _mm256_permute_ps(center, 0x00), center_new);
+            center_new = _mm256_fmadd_ps(r1, _mm256_permute_ps(center, 0x55), center_new);
+            center_new = _mm256_fmadd_ps(r2, _mm256_permute_ps(center, 0xAA), center_new);
+            center_new = _mm256_div_ps(center_new, _mm256_permute_ps(center_new, 0xFF));
+
+            __m256 extent_new = _mm256_mul_ps(_mm256_and_ps(r0, abs_mask), _mm256_permute_ps(extent, 0x00));
+            extent_new = _mm256_fmadd_ps(_mm256_and_ps(r1, abs_mask), _mm256_permute_ps(extent, 0x55), extent_new);
+            extent_new = _mm256_fmadd_ps(_mm256_and_ps(r2, abs_mask), _mm256_permute_ps(extent, 0xAA), extent_new);
+
+            const __m256 min_new = _mm256_sub_ps(center_new, extent_new);
+            const __m256 max_new = _mm256_add_ps(center_new, extent_new);
+            Store3(out_i,       _mm256_castps256_ps128(min_new));
+            Store3(out_i + 3,   _mm256_castps256_ps128(max_new));
+            Store3(out_i + 6,   _mm256_extractf128_ps(min_new, 1));
+            Store3(out_i + 9,   _mm256_extractf128_ps(max_new, 1));
+        }
+    #endif
+
+        for (; i < count; i++)
+        {
+            AabbTransform(boxes + i * 6, matrices + i * 16, out + i * 6);
+        }
+    }
+}
+#endif
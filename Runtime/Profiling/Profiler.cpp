@@ -211,7 +211,9 @@ namespace Spartan
         if (!can_profile_cpu && !can_profile_gpu)
             return;
 
-        // Last incomplete block of the same type, is the parent
+        lock_guard<mutex> lock(m_time_blocks_mutex);
+
+        // Last incomplete block of the same type (on this thread), is the parent
         TimeBlock* time_block_parent = GetLastIncompleteTimeBlock(type);
 
         if (TimeBlock* time_block = GetNewTimeBlock())
@@ -226,6 +228,7 @@ namespace Spartan
         if (m_increase_capacity)
             return;
 
+        lock_guard<mutex> lock(m_time_blocks_mutex);
         if (TimeBlock* time_block = GetLastIncompleteTimeBlock())
         {
             time_block->End();
@@ -263,9 +266,13 @@ namespace Spartan
 
     TimeBlock* Profiler::GetLastIncompleteTimeBlock(TimeBlock_Type type /*= TimeBlock_Undefined*/)
     {
+        const thread::id thread_id = this_thread::get_id();
+
         for (int i = m_time_block_count - 1; i >= 0; i--)
         {
             TimeBlock& time_block = m_time_blocks_write[i];
+            if (time_block.GetThreadId() != thread_id)
+                continue;
 
             if (type == time_block.GetType() || type == TimeBlock_Undefined)
             {
@@ -334,6 +341,7 @@ namespace Spartan
             "\n"
             // RHI
             "Draw:\t\t\t%d\n"
+            "Draw instanced:\t%d\n"
             "Dispatch:\t\t\t%d\n"
             "Index buffer:\t\t%d\n"
             "Vertex buffer:\t\t%d\n"
@@ -347,7 +355,8 @@ namespace Spartan
             "Render target:\t%d\n"
             "Pipeline:\t\t\t%d\n"
             "Descriptor set:\t%d\n"
-            "Pipeline barrier:\t%d";
+            "Pipeline barrier:\t%d\n"
+            "Uploaded:\t\t\t%.2f MB";
 
         static char buffer[2048];
         sprintf_s
@@ -374,6 +383,7 @@ namespace Spartan
 
             // RHI
             m_rhi_draw,
+            m_rhi_draw_instanced,
             m_rhi_dispatch,
             m_rhi_bindings_buffer_index,
             m_rhi_bindings_buffer_vertex,
@@ -387,7 +397,8 @@ namespace Spartan
             m_rhi_bindings_render_target,
             m_rhi_bindings_pipeline,
             m_rhi_bindings_descriptor_set,
-            m_rhi_pipeline_barriers
+            m_rhi_pipeline_barriers,
+            static_cast<double>(m_rhi_bytes_uploaded) / 1024.0 / 1024.0
         );
 
         m_metrics = string(buffer);
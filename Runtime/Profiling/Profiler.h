@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===========================
 #include <string>
 #include <vector>
+#include <atomic>
+#include <mutex>
 #include "TimeBlock.h"
 #include "../Core/ISubsystem.h"
 #include "../Core/Stopwatch.h"
@@ -40,7 +42,6 @@ namespace Spartan
     class Timer;
     class ResourceCache;
     class Renderer;
-    class Variant;
     class Timer;
 
     class SPARTAN_CLASS Profiler : public ISubsystem
@@ -78,6 +79,7 @@ namespace Spartan
         
         // Metrics - RHI
         uint32_t m_rhi_draw                                = 0;
+        uint32_t m_rhi_draw_instanced                   = 0;
         uint32_t m_rhi_dispatch                         = 0;
         uint32_t m_rhi_bindings_buffer_index            = 0;
         uint32_t m_rhi_bindings_buffer_vertex            = 0;
@@ -92,6 +94,7 @@ namespace Spartan
         uint32_t m_rhi_bindings_descriptor_set          = 0;     
         uint32_t m_rhi_bindings_pipeline                = 0;
         uint32_t m_rhi_pipeline_barriers                = 0;
+        std::atomic<uint64_t> m_rhi_bytes_uploaded      = 0; // buffers and textures can be created from any thread
 
         // Metrics - Renderer
         uint32_t m_renderer_meshes_rendered = 0;
@@ -114,6 +117,7 @@ namespace Spartan
         void ClearRhiMetrics()
         {
             m_rhi_draw                          = 0;
+            m_rhi_draw_instanced                = 0;
             m_rhi_dispatch                      = 0;
             m_renderer_meshes_rendered          = 0;
             m_rhi_bindings_buffer_index         = 0;
@@ -129,6 +133,7 @@ namespace Spartan
             m_rhi_bindings_descriptor_set       = 0;
             m_rhi_bindings_pipeline             = 0;
             m_rhi_pipeline_barriers             = 0;
+            m_rhi_bytes_uploaded                = 0;
         }
 
         TimeBlock* GetNewTimeBlock();
@@ -146,6 +151,7 @@ namespace Spartan
         // Time blocks (double buffered)
         uint32_t m_time_block_capacity    = 200;
         uint32_t m_time_block_count        = 0;
+        std::mutex m_time_blocks_mutex; // the simulation and the renderer time their blocks concurrently
         std::vector<TimeBlock> m_time_blocks_write;
         std::vector<TimeBlock> m_time_blocks_read;
 
@@ -96,6 +96,7 @@ namespace Spartan
         const uint32_t height,
         const uint32_t channels,
         const uint32_t bits_per_channel,
+        const RHI_Format rhi_format,
         const uint32_t array_size,
         const uint8_t mip_count,
         const DXGI_FORMAT format,
@@ -128,8 +129,8 @@ namespace Spartan
             {
                 D3D11_SUBRESOURCE_DATA& subresource_data    = vec_subresource_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
                 subresource_data.pSysMem                    = i < data.size()? data[i].data() : nullptr;        // Data pointer
-                subresource_data.SysMemPitch                = (width >> i) * channels * (bits_per_channel / 8); // Line width in bytes
-                subresource_data.SysMemSlicePitch           = 0;                                                // This is only used for 3D textures
+                subresource_data.SysMemPitch                = rhi_format_row_pitch(rhi_format, width >> i, channels * (bits_per_channel / 8)); // Line width in bytes (or block row width)
+                subresource_data.SysMemSlicePitch           = 0;                                                                                // This is only used for 3D textures
             }
         }
 
@@ -270,6 +271,7 @@ namespace Spartan
             m_height,
             m_channel_count,
             m_bits_per_channel,
+            m_format,
             m_array_size,
             m_mip_count,
             format,
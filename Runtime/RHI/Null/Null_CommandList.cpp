@@ -0,0 +1,638 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ==========================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_CommandList.h"
+#include "../RHI_Pipeline.h"
+#include "../RHI_VertexBuffer.h"
+#include "../RHI_IndexBuffer.h"
+#include "../RHI_ConstantBuffer.h"
+#include "../RHI_Sampler.h"
+#include "../RHI_Texture.h"
+#include "../RHI_SwapChain.h"
+#include "../RHI_DescriptorCache.h"
+#include "../RHI_PipelineCache.h"
+#include "../RHI_DescriptorSetLayout.h"
+#include "../RHI_Semaphore.h"
+#include "../RHI_Fence.h"
+#include "../../Profiling/Profiler.h"
+#include "../../Rendering/Renderer.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+// Follows the same state tracking as the Vulkan command list (pipeline cache, descriptor cache, deferred binding),
+// so the renderer's CPU cost and the profiler's RHI counters match what a real backend would see, minus the driver.
+
+namespace Spartan
+{
+    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context)
+    {
+        m_swap_chain        = swap_chain;
+        m_renderer          = context->GetSubsystem<Renderer>();
+        m_profiler          = context->GetSubsystem<Profiler>();
+        m_rhi_device        = m_renderer->GetRhiDevice().get();
+        m_pipeline_cache    = m_renderer->GetPipelineCache();
+        m_descriptor_cache  = m_renderer->GetDescriptorCache();
+        m_cmd_buffer        = null_utility::handle_create();
+
+        // Sync
+        m_processed_fence       = make_shared<RHI_Fence>(m_rhi_device, "cmd_buffer_processed");
+        m_processed_semaphore   = make_shared<RHI_Semaphore>(m_rhi_device, "cmd_buffer_processed");
+
+        m_timestamps.fill(0);
+    }
+
+    RHI_CommandList::~RHI_CommandList() = default;
+
+    bool RHI_CommandList::Begin()
+    {
+        // Ensure this command list is not currently in use
+        if (!Wait())
+        {
+            LOG_ERROR("Failed to wait");
+            return false;
+        }
+
+        if (m_cmd_state != RHI_CommandListState::Idle)
+        {
+            LOG_ERROR("The command list is still being used");
+            return false;
+        }
+
+        m_timestamp_index   = 0;
+        m_cmd_state         = RHI_CommandListState::Recording;
+        m_flushed           = false;
+
+        return true;
+    }
+
+    bool RHI_CommandList::End()
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_WARNING("The command list is not recording, no need to stop it");
+            return true;
+        }
+
+        m_cmd_state = RHI_CommandListState::Submittable;
+        return true;
+    }
+
+    bool RHI_CommandList::Submit()
+    {
+        // Ensure the command list has recorded
+        if (m_cmd_state == RHI_CommandListState::Idle)
+        {
+            LOG_WARNING("The command list is idle, nothing to submit.");
+            return false;
+        }
+
+        // Ensure the command list is not recording
+        if (m_cmd_state == RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("The command list is recording. Call End() before Submit().");
+            return false;
+        }
+
+        // Get wait and signal semaphores
+        RHI_Semaphore* wait_semaphore   = nullptr;
+        RHI_Semaphore* signal_semaphore = nullptr;
+        if (m_pipeline)
+        {
+            if (RHI_PipelineState* state = m_pipeline->GetPipelineState())
+            {
+                if (state->render_target_swapchain)
+                {
+                    if (!state->render_target_swapchain->PresentEnabled())
+                    {
+                        m_cmd_state = RHI_CommandListState::Submitted;
+                        return true;
+                    }
+
+                    if (state->render_target_swapchain->GetImageAcquiredSemaphore()->GetState() == RHI_Semaphore_State::Signaled)
+                    {
+                        wait_semaphore = state->render_target_swapchain->GetImageAcquiredSemaphore();
+                    }
+
+                    signal_semaphore = m_processed_semaphore.get();
+                }
+            }
+        }
+
+        m_processed_fence->Reset();
+
+        if (!m_rhi_device->Queue_Submit(RHI_Queue_Graphics, m_cmd_buffer, wait_semaphore, signal_semaphore, m_processed_fence.get()))
+        {
+            LOG_ERROR("Failed to submit the command list.");
+            return false;
+        }
+
+        m_cmd_state = RHI_CommandListState::Submitted;
+        return true;
+    }
+
+    bool RHI_CommandList::Reset()
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+            return true;
+
+        lock_guard<mutex> guard(m_mutex_reset);
+
+        m_cmd_state = RHI_CommandListState::Idle;
+        return true;
+    }
+
+    bool RHI_CommandList::BeginRenderPass(RHI_PipelineState& pipeline_state)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_WARNING("Command list must be in a recording state");
+            return false;
+        }
+
+        // Get pipeline
+        {
+            m_pipeline_active = false;
+
+            // Update the descriptor cache with the pipeline state
+            m_descriptor_cache->SetPipelineState(pipeline_state);
+
+            // Get (or create) a pipeline which matches the pipeline state
+            m_pipeline = m_pipeline_cache->GetPipeline(this, pipeline_state, m_descriptor_cache->GetResource_DescriptorSetLayout());
+            if (!m_pipeline)
+            {
+                LOG_ERROR("Failed to acquire appropriate pipeline");
+                return false;
+            }
+
+            // Keep a local pointer for convenience
+            m_pipeline_state = &pipeline_state;
+        }
+
+        // Start profiler (if used)
+        Timeblock_Start(m_pipeline_state);
+
+        // Shader resources
+        {
+            // If the pipeline changed, resources have to be set again
+            m_vertex_buffer_id  = 0;
+            m_index_buffer_id   = 0;
+
+            // There is no persistent state (same as Vulkan), so global resources have to be set
+            m_renderer->SetGlobalSamplersAndConstantBuffers(this);
+        }
+
+        return true;
+    }
+
+    bool RHI_CommandList::EndRenderPass()
+    {
+        m_render_pass_active = false;
+
+        // Profiling
+        Timeblock_End(m_pipeline_state);
+
+        return true;
+    }
+
+    void RHI_CommandList::ClearPipelineStateRenderTargets(RHI_PipelineState& pipeline_state)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+
+        // Clearing is part of beginning a render pass
+        if (!m_render_pass_active && BeginRenderPass(pipeline_state))
+        {
+            OnDraw();
+            EndRenderPass();
+        }
+    }
+
+    void RHI_CommandList::ClearRenderTarget(RHI_Texture* texture,
+        const uint32_t color_index          /*= 0*/,
+        const uint32_t depth_stencil_index  /*= 0*/,
+        const bool storage                  /*= false*/,
+        const Math::Vector4& clear_color    /*= rhi_color_load*/,
+        const float clear_depth             /*= rhi_depth_load*/,
+        const uint32_t clear_stencil        /*= rhi_stencil_load*/
+    )
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+
+        if (m_render_pass_active)
+        {
+            LOG_ERROR("Must only be called outside of a render pass instance");
+            return;
+        }
+
+        if (!texture || !texture->Get_Resource_View())
+        {
+            LOG_ERROR("Texture is null.");
+            return;
+        }
+
+        // One of the required layouts for clear functions
+        texture->SetLayout(RHI_Image_Layout::Transfer_Dst_Optimal, this);
+    }
+
+    bool RHI_CommandList::Draw(const uint32_t vertex_count)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return false;
+        }
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        m_profiler->m_rhi_draw++;
+
+        return true;
+    }
+
+    bool RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset, const uint32_t instance_count)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return false;
+        }
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        m_profiler->m_rhi_draw++;
+        m_profiler->m_rhi_draw_instanced += instance_count > 1 ? 1 : 0;
+
+        return true;
+    }
+
+    bool RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return false;
+        }
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        m_profiler->m_rhi_dispatch++;
+
+        return true;
+    }
+
+    void RHI_CommandList::SetViewport(const RHI_Viewport& viewport) const
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+    }
+
+    void RHI_CommandList::SetScissorRectangle(const Math::Rectangle& scissor_rectangle) const
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+    }
+
+    void RHI_CommandList::SetBufferVertex(const RHI_VertexBuffer* buffer, const uint64_t offset /*= 0*/)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+
+        if (m_vertex_buffer_id == buffer->GetId() && m_vertex_buffer_offset == offset)
+            return;
+
+        m_profiler->m_rhi_bindings_buffer_vertex++;
+        m_vertex_buffer_id      = buffer->GetId();
+        m_vertex_buffer_offset  = offset;
+    }
+
+    void RHI_CommandList::SetBufferIndex(const RHI_IndexBuffer* buffer, const uint64_t offset /*= 0*/)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+
+        if (m_index_buffer_id == buffer->GetId() && m_index_buffer_offset == offset)
+            return;
+
+        m_profiler->m_rhi_bindings_buffer_index++;
+        m_index_buffer_id       = buffer->GetId();
+        m_index_buffer_offset   = offset;
+    }
+
+    bool RHI_CommandList::SetConstantBuffer(const uint32_t slot, const uint8_t scope, RHI_ConstantBuffer* constant_buffer) const
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return false;
+        }
+
+        if (!m_descriptor_cache->GetCurrentDescriptorSetLayout())
+        {
+            LOG_WARNING("Descriptor layout not set, try setting constant buffer \"%s\" within a render pass", constant_buffer->GetName().c_str());
+            return false;
+        }
+
+        // Every request is counted, redundant ones included, so that they show up in the metrics
+        m_profiler->m_rhi_bindings_buffer_constant++;
+
+        // There are no reflected descriptors to update, so the cache has nothing to match against
+        m_descriptor_cache->SetConstantBuffer(slot, constant_buffer);
+        return true;
+    }
+
+    void RHI_CommandList::SetSampler(const uint32_t slot, RHI_Sampler* sampler) const
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+
+        if (!m_descriptor_cache->GetCurrentDescriptorSetLayout())
+        {
+            LOG_WARNING("Descriptor layout not set, try setting sampler \"%s\" within a render pass", sampler->GetName().c_str());
+            return;
+        }
+
+        m_profiler->m_rhi_bindings_sampler++;
+        m_descriptor_cache->SetSampler(slot, sampler);
+    }
+
+    void RHI_CommandList::SetTexture(const uint32_t slot, RHI_Texture* texture, const bool storage /*= false*/)
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+        {
+            LOG_ERROR("Command buffer is not recording.");
+            return;
+        }
+
+        if (!m_descriptor_cache->GetCurrentDescriptorSetLayout())
+        {
+            LOG_WARNING("Descriptor layout not set, try setting texture \"%s\" within a render pass", texture->GetName().c_str());
+            return;
+        }
+
+        // Null textures are allowed, and get replaced with a black texture here
+        if (!texture || !texture->Get_Resource_View())
+        {
+            texture = m_renderer->GetDefaultTextureTransparent();
+        }
+
+        // Transition to the layout that Vulkan would require, so that barrier counts are comparable
+        {
+            RHI_Image_Layout target_layout = RHI_Image_Layout::Undefined;
+
+            if (storage)
+            {
+                if (!texture->IsStorage())
+                {
+                    LOG_ERROR("Texture %s doesn't support storage", texture->GetName().c_str());
+                }
+                else if (texture->GetLayout() != RHI_Image_Layout::General)
+                {
+                    target_layout = RHI_Image_Layout::General;
+                }
+            }
+            else
+            {
+                // Color
+                if (texture->IsColorFormat() && texture->GetLayout() != RHI_Image_Layout::Shader_Read_Only_Optimal)
+                {
+                    target_layout = RHI_Image_Layout::Shader_Read_Only_Optimal;
+                }
+
+                // Depth
+                if (texture->IsDepthFormat() && texture->GetLayout() != RHI_Image_Layout::Depth_Stencil_Read_Only_Optimal)
+                {
+                    target_layout = RHI_Image_Layout::Depth_Stencil_Read_Only_Optimal;
+                }
+            }
+
+            if (target_layout != RHI_Image_Layout::Undefined && !m_render_pass_active)
+            {
+                texture->SetLayout(target_layout, this);
+            }
+        }
+
+        if (storage)
+        {
+            m_profiler->m_rhi_bindings_texture_storage++;
+        }
+        else
+        {
+            m_profiler->m_rhi_bindings_texture_sampled++;
+        }
+
+        m_descriptor_cache->SetTexture(slot, texture, storage);
+    }
+
+    bool RHI_CommandList::Timestamp_Start(void* query_disjoint /*= nullptr*/, void* query_start /*= nullptr*/)
+    {
+        return true;
+    }
+
+    bool RHI_CommandList::Timestamp_End(void* query_disjoint /*= nullptr*/, void* query_end /*= nullptr*/)
+    {
+        return true;
+    }
+
+    float RHI_CommandList::Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t pass_index)
+    {
+        return 0.0f;
+    }
+
+    uint32_t RHI_CommandList::Gpu_GetMemory(RHI_Device* rhi_device)
+    {
+        return 0;
+    }
+
+    uint32_t RHI_CommandList::Gpu_GetMemoryUsed(RHI_Device* rhi_device)
+    {
+        return 0;
+    }
+
+    bool RHI_CommandList::Gpu_QueryCreate(RHI_Device* rhi_device, void** query /*= nullptr*/, RHI_Query_Type type /*= RHI_Query_Timestamp*/)
+    {
+        return true;
+    }
+
+    void RHI_CommandList::Gpu_QueryRelease(void*& query_object)
+    {
+
+    }
+
+    void RHI_CommandList::ResetDescriptorCache()
+    {
+        if (m_descriptor_cache)
+        {
+            m_descriptor_cache->Reset();
+        }
+    }
+
+    void RHI_CommandList::Timeblock_Start(const RHI_PipelineState* pipeline_state)
+    {
+        if (!pipeline_state || !pipeline_state->pass_name)
+            return;
+
+        // There is no GPU time to measure, so only the CPU side of each pass is profiled
+        if (m_rhi_device->GetContextRhi()->profiler && m_profiler && pipeline_state->profile)
+        {
+            m_profiler->TimeBlockStart(pipeline_state->pass_name, TimeBlock_Cpu, this);
+        }
+    }
+
+    void RHI_CommandList::Timeblock_End(const RHI_PipelineState* pipeline_state)
+    {
+        if (!pipeline_state)
+            return;
+
+        if (m_rhi_device->GetContextRhi()->profiler && m_profiler && pipeline_state->profile)
+        {
+            m_profiler->TimeBlockEnd();
+        }
+    }
+
+    bool RHI_CommandList::Deferred_BeginRenderPass()
+    {
+        if (!m_pipeline->GetPipelineState())
+        {
+            LOG_ERROR("There is no pipeline state");
+            return false;
+        }
+
+        // Count every attachment the render pass would bind
+        for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+        {
+            if (m_pipeline_state->render_target_color_textures[i])
+            {
+                m_profiler->m_rhi_bindings_render_target++;
+            }
+        }
+
+        if (m_pipeline_state->render_target_depth_texture || m_pipeline_state->render_target_swapchain)
+        {
+            m_profiler->m_rhi_bindings_render_target++;
+        }
+
+        m_render_pass_active = true;
+        return true;
+    }
+
+    bool RHI_CommandList::Deferred_BindPipeline()
+    {
+        if (!m_pipeline->GetPipeline())
+        {
+            LOG_ERROR("Invalid pipeline");
+            return false;
+        }
+
+        // Shaders
+        if (m_pipeline_state->shader_vertex)    m_profiler->m_rhi_bindings_shader_vertex++;
+        if (m_pipeline_state->shader_pixel)     m_profiler->m_rhi_bindings_shader_pixel++;
+        if (m_pipeline_state->shader_compute)   m_profiler->m_rhi_bindings_shader_compute++;
+
+        m_profiler->m_rhi_bindings_pipeline++;
+        m_pipeline_active = true;
+
+        return true;
+    }
+
+    bool RHI_CommandList::Deferred_BindDescriptorSet()
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+            return false;
+
+        void* descriptor_set = nullptr;
+        bool result = m_descriptor_cache->GetResource_DescriptorSet(descriptor_set);
+
+        if (result && descriptor_set != nullptr)
+        {
+            m_profiler->m_rhi_bindings_descriptor_set++;
+        }
+
+        return result;
+    }
+
+    bool RHI_CommandList::OnDraw()
+    {
+        if (m_cmd_state != RHI_CommandListState::Recording)
+            return false;
+
+        if (m_flushed)
+            return false;
+
+        // Begin render pass
+        if (!m_render_pass_active && !m_pipeline_state->IsCompute())
+        {
+            if (!Deferred_BeginRenderPass())
+            {
+                LOG_ERROR("Failed to begin render pass");
+                return false;
+            }
+        }
+
+        // Set pipeline
+        if (!m_pipeline_active)
+        {
+            if (!Deferred_BindPipeline())
+            {
+                LOG_ERROR("Failed to bind pipeline");
+                return false;
+            }
+        }
+
+        // Bind descriptor set
+        return Deferred_BindDescriptorSet();
+    }
+}
@@ -0,0 +1,157 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ========================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_SwapChain.h"
+#include "../RHI_Device.h"
+#include "../RHI_CommandList.h"
+#include "../RHI_Semaphore.h"
+#include "../../Rendering/Renderer.h"
+#include "../../Profiling/Profiler.h"
+//===================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    RHI_SwapChain::RHI_SwapChain(
+        void* window_handle,
+        const shared_ptr<RHI_Device>& rhi_device,
+        const uint32_t width,
+        const uint32_t height,
+        const RHI_Format format     /*= Format_R8G8B8A8_UNORM*/,
+        const uint32_t buffer_count /*= 2 */,
+        const uint32_t flags        /*= Present_Immediate */,
+        const char* name            /*= nullptr */
+    )
+    {
+        // Validate device
+        if (!rhi_device || !rhi_device->GetContextRhi())
+        {
+            LOG_ERROR("Invalid device.");
+            return;
+        }
+
+        // Validate resolution
+        if (!rhi_device->ValidateResolution(width, height))
+        {
+            LOG_WARNING("%dx%d is an invalid resolution", width, height);
+            return;
+        }
+
+        // Copy parameters, the window handle is allowed to be null since nothing is presented
+        m_format        = format;
+        m_rhi_device    = rhi_device.get();
+        m_buffer_count  = buffer_count;
+        m_width         = width;
+        m_height        = height;
+        m_window_handle = window_handle;
+        m_flags         = flags;
+
+        // Back buffers
+        m_swap_chain_view = null_utility::handle_create();
+        for (uint32_t i = 0; i < m_buffer_count; i++)
+        {
+            m_resource[i]                   = null_utility::handle_create();
+            m_resource_view[i]              = null_utility::handle_create();
+            m_image_acquired_semaphore[i]   = make_shared<RHI_Semaphore>(m_rhi_device, "swapchain_image_acquired");
+        }
+        m_resource_view_renderTarget = m_resource_view[0];
+
+        // Create command lists
+        for (uint32_t i = 0; i < m_buffer_count; i++)
+        {
+            m_cmd_lists.emplace_back(make_shared<RHI_CommandList>(i, this, rhi_device->GetContext()));
+        }
+
+        m_initialized = true;
+
+        AcquireNextImage();
+    }
+
+    RHI_SwapChain::~RHI_SwapChain()
+    {
+        m_cmd_lists.clear();
+    }
+
+    bool RHI_SwapChain::Resize(const uint32_t width, const uint32_t height, const bool force /*= false*/)
+    {
+        // Validate resolution
+        m_present_enabled = m_rhi_device->ValidateResolution(width, height);
+        if (!m_present_enabled)
+        {
+            // Return true as when minimizing, a resolution
+            // of 0,0 can be passed in, and this is fine.
+            return true;
+        }
+
+        m_width     = width;
+        m_height    = height;
+
+        return true;
+    }
+
+    bool RHI_SwapChain::AcquireNextImage()
+    {
+        if (!m_present_enabled)
+            return true;
+
+        // Cycle through the command lists and back buffers in lockstep
+        m_cmd_index     = (m_cmd_index + 1) % m_buffer_count;
+        m_image_index   = m_cmd_index;
+
+        m_image_acquired_semaphore[m_cmd_index]->SetState(RHI_Semaphore_State::Signaled);
+
+        return true;
+    }
+
+    bool RHI_SwapChain::Present()
+    {
+        if (!m_present_enabled)
+        {
+            LOG_INFO("Presenting has been disabled.");
+            return true;
+        }
+
+        // Ensure the command list is not recording
+        if (GetCmdList()->IsRecording())
+        {
+            LOG_ERROR("Command list is still recording.");
+            return false;
+        }
+
+        // Present
+        if (!m_rhi_device->Queue_Present(m_swap_chain_view, &m_image_index, GetCmdList()->GetProcessedSemaphore()))
+        {
+            LOG_ERROR("Failed to present");
+            return false;
+        }
+
+        // Acquire the next image
+        return AcquireNextImage();
+    }
+}
@@ -0,0 +1,163 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ========================
+#include "Spartan.h"
+#include "../RHI_Implementation.h"
+#include "../RHI_Texture2D.h"
+#include "../RHI_TextureCube.h"
+#include "../RHI_CommandList.h"
+#include "../../Profiling/Profiler.h"
+//===================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    inline RHI_Image_Layout GetAppropriateLayout(RHI_Texture* texture)
+    {
+        RHI_Image_Layout target_layout = RHI_Image_Layout::Preinitialized;
+
+        if (texture->IsSampled() && texture->IsColorFormat())
+            target_layout = RHI_Image_Layout::Shader_Read_Only_Optimal;
+
+        if (texture->IsRenderTarget())
+            target_layout = RHI_Image_Layout::Color_Attachment_Optimal;
+
+        if (texture->IsDepthStencil())
+            target_layout = RHI_Image_Layout::Depth_Stencil_Attachment_Optimal;
+
+        if (texture->IsStorage())
+            target_layout = RHI_Image_Layout::General;
+
+        return target_layout;
+    }
+
+    // Gives the texture a handle for every view a real backend would create, so descriptor and render target caching behaves the same
+    inline void create_views
+    (
+        RHI_Texture* texture,
+        void*& resource,
+        void* (&resource_view)[2],
+        void*& resource_view_unordered_access,
+        array<void*, rhi_max_render_target_count>& resource_view_render_target,
+        array<void*, rhi_max_render_target_count>& resource_view_depth_stencil,
+        array<void*, rhi_max_render_target_count>& resource_view_depth_stencil_read_only
+    )
+    {
+        resource = null_utility::handle_create();
+
+        if (texture->IsSampled())
+        {
+            resource_view[0] = null_utility::handle_create();
+
+            if (texture->IsStencilFormat())
+            {
+                resource_view[1] = null_utility::handle_create();
+            }
+        }
+
+        if (texture->IsStorage())
+        {
+            resource_view_unordered_access = null_utility::handle_create();
+        }
+
+        const uint32_t array_size = Helper::Min<uint32_t>(texture->GetArraySize(), rhi_max_render_target_count);
+        for (uint32_t i = 0; i < array_size; i++)
+        {
+            if (texture->IsRenderTarget())
+            {
+                resource_view_render_target[i] = null_utility::handle_create();
+            }
+
+            if (texture->IsDepthStencil())
+            {
+                resource_view_depth_stencil[i] = null_utility::handle_create();
+
+                if (texture->GetFlags() & RHI_Texture_DepthStencilReadOnly)
+                {
+                    resource_view_depth_stencil_read_only[i] = null_utility::handle_create();
+                }
+            }
+        }
+    }
+
+    inline void count_upload(const vector<vector<std::byte>>& data)
+    {
+        uint64_t byte_count = 0;
+        for (const vector<std::byte>& mip : data)
+        {
+            byte_count += mip.size();
+        }
+
+        null_utility::count_upload(byte_count);
+    }
+
+    void RHI_Texture::SetLayout(const RHI_Image_Layout new_layout, RHI_CommandList* command_list /*= nullptr*/)
+    {
+        // The texture is most likely still initialising
+        if (m_layout == RHI_Image_Layout::Undefined)
+            return;
+
+        if (m_layout == new_layout)
+            return;
+
+        // If a command list is provided, this is where Vulkan would insert a pipeline barrier
+        if (command_list)
+        {
+            m_context->GetSubsystem<Profiler>()->m_rhi_pipeline_barriers++;
+        }
+
+        m_layout = new_layout;
+    }
+
+    RHI_Texture2D::~RHI_Texture2D()
+    {
+        m_data.clear();
+    }
+
+    bool RHI_Texture2D::CreateResourceGpu()
+    {
+        create_views(this, m_resource, m_resource_view, m_resource_view_unorderedAccess, m_resource_view_renderTarget, m_resource_view_depthStencil, m_resource_view_depthStencilReadOnly);
+        count_upload(m_data);
+        m_layout = GetAppropriateLayout(this);
+
+        return true;
+    }
+
+    RHI_TextureCube::~RHI_TextureCube()
+    {
+        m_data.clear();
+    }
+
+    bool RHI_TextureCube::CreateResourceGpu()
+    {
+        create_views(this, m_resource, m_resource_view, m_resource_view_unorderedAccess, m_resource_view_renderTarget, m_resource_view_depthStencil, m_resource_view_depthStencilReadOnly);
+        count_upload(m_data);
+        m_layout = GetAppropriateLayout(this);
+
+        return true;
+    }
+}
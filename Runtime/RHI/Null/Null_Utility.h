@@ -0,0 +1,56 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <atomic>
+#include "../RHI_Device.h"
+#include "../../Profiling/Profiler.h"
+//===================================
+
+// A backend which records everything the renderer asks for but never talks to a GPU.
+// Handles are unique tokens which are never dereferenced, buffers live in host memory.
+namespace Spartan::null_utility
+{
+    struct globals
+    {
+        static inline RHI_Device* rhi_device;
+        static inline RHI_Context* rhi_context;
+        static inline Profiler* profiler;
+    };
+
+    // Returns a unique, non-null handle, so that anything which caches or compares resources behaves like it would with a real API
+    inline void* handle_create()
+    {
+        static std::atomic<uintptr_t> id = 0;
+        return reinterpret_cast<void*>(++id);
+    }
+
+    // Keeps track of the bytes that a real API would have to copy to the GPU
+    inline void count_upload(const uint64_t bytes)
+    {
+        if (globals::profiler)
+        {
+            globals::profiler->m_rhi_bytes_uploaded += bytes;
+        }
+    }
+}
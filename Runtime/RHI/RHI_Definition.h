@@ -58,6 +58,7 @@ namespace Spartan
     struct RHI_Vertex_PosCol;
     struct RHI_Vertex_PosUvCol;
     struct RHI_Vertex_PosTexNorTan;
+    struct RHI_Vertex_PosTexNorTanPacked;
 
     enum RHI_PhysicalDevice_Type
     {
@@ -72,7 +73,8 @@ namespace Spartan
     {
         RHI_Api_D3d11,
         RHI_Api_D3d12,
-        RHI_Api_Vulkan
+        RHI_Api_Vulkan,
+        RHI_Api_Null
     };
 
     enum RHI_Present_Mode : uint32_t
@@ -197,10 +199,39 @@ namespace Spartan
         // DEPTH
         RHI_Format_D32_Float,
         RHI_Format_D32_Float_S8X24_Uint,
+        // BLOCK COMPRESSED
+        RHI_Format_BC1_Unorm,
+        RHI_Format_BC3_Unorm,
+        RHI_Format_BC4_Unorm,
+        RHI_Format_BC5_Unorm,
+        RHI_Format_BC7_Unorm,
 
         RHI_Format_Undefined
     };
 
+    inline bool rhi_format_is_block_compressed(const RHI_Format format) { return format >= RHI_Format_BC1_Unorm && format <= RHI_Format_BC7_Unorm; }
+
+    // Bytes per 4x4 block
+    inline uint32_t rhi_format_block_size(const RHI_Format format) { return (format == RHI_Format_BC1_Unorm || format == RHI_Format_BC4_Unorm) ? 8 : 16; }
+
+    // Bytes per row of pixels, or per row of 4x4 blocks for the block compressed formats
+    inline uint32_t rhi_format_row_pitch(const RHI_Format format, const uint32_t width, const uint32_t bytes_per_pixel)
+    {
+        if (rhi_format_is_block_compressed(format))
+            return ((width + 3) / 4 > 1 ? (width + 3) / 4 : 1) * rhi_format_block_size(format);
+
+        return width * bytes_per_pixel;
+    }
+
+    // Rows of pixels, or rows of 4x4 blocks for the block compressed formats
+    inline uint32_t rhi_format_row_count(const RHI_Format format, const uint32_t height)
+    {
+        if (rhi_format_is_block_compressed(format))
+            return (height + 3) / 4 > 1 ? (height + 3) / 4 : 1;
+
+        return height;
+    }
+
     enum RHI_Blend
     {
         RHI_Blend_Zero,
@@ -277,6 +308,11 @@ namespace Spartan
             case RHI_Format_R32G32B32A32_Float:     return "RHI_Format_R32G32B32A32_Float";
             case RHI_Format_D32_Float:              return "RHI_Format_D32_Float";
             case RHI_Format_D32_Float_S8X24_Uint:   return "RHI_Format_D32_Float_S8X24_Uint";
+            case RHI_Format_BC1_Unorm:              return "RHI_Format_BC1_Unorm";
+            case RHI_Format_BC3_Unorm:              return "RHI_Format_BC3_Unorm";
+            case RHI_Format_BC4_Unorm:              return "RHI_Format_BC4_Unorm";
+            case RHI_Format_BC5_Unorm:              return "RHI_Format_BC5_Unorm";
+            case RHI_Format_BC7_Unorm:              return "RHI_Format_BC7_Unorm";
             case RHI_Format_Undefined:              return "RHI_Format_Undefined";
         }
 
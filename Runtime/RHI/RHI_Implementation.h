@@ -77,6 +77,12 @@ static const DXGI_FORMAT d3d11_format[] =
     // Depth
     DXGI_FORMAT_D32_FLOAT,
     DXGI_FORMAT_D32_FLOAT_S8X24_UINT,
+    // Block compressed
+    DXGI_FORMAT_BC1_UNORM,
+    DXGI_FORMAT_BC3_UNORM,
+    DXGI_FORMAT_BC4_UNORM,
+    DXGI_FORMAT_BC5_UNORM,
+    DXGI_FORMAT_BC7_UNORM,
 
     DXGI_FORMAT_UNKNOWN
 };
@@ -208,6 +214,12 @@ static const VkFormat vulkan_format[] =
     // DEPTH
     VK_FORMAT_D32_SFLOAT,
     VK_FORMAT_D32_SFLOAT_S8_UINT,
+    // BLOCK COMPRESSED
+    VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    VK_FORMAT_BC3_UNORM_BLOCK,
+    VK_FORMAT_BC4_UNORM_BLOCK,
+    VK_FORMAT_BC5_UNORM_BLOCK,
+    VK_FORMAT_BC7_UNORM_BLOCK,
 
     VK_FORMAT_MAX_ENUM
 };
@@ -326,6 +338,11 @@ namespace Spartan
             ID3D12Device* device    = nullptr;
         #endif
 
+        #if defined(API_GRAPHICS_NULL)
+            RHI_Api_Type api_type   = RHI_Api_Null;
+            void* device            = nullptr;
+        #endif
+
         #if defined(API_GRAPHICS_VULKAN)
             RHI_Api_Type api_type                                   = RHI_Api_Vulkan;
             uint32_t api_version                                    = 0;
@@ -403,6 +420,8 @@ namespace Spartan
     #include "D3D12/D3D12_Utility.h"
 #elif defined (API_GRAPHICS_VULKAN)
     #include "Vulkan/Vulkan_Utility.h"
+#elif defined (API_GRAPHICS_NULL)
+    #include "Null/Null_Utility.h"
 #endif
 
 #endif // RUNTIME
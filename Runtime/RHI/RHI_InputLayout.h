@@ -117,6 +117,16 @@ namespace Spartan
                 };
             }
 
+            if (vertex_type == RHI_Vertex_Type_PositionTextureNormalTangentPacked)
+            {
+                m_vertex_attributes =
+                {
+                    { "POSITION",   0, binding, RHI_Format_R16G16B16A16_Snorm,  offsetof(RHI_Vertex_PosTexNorTanPacked, pos) },
+                    { "TEXCOORD",   1, binding, RHI_Format_R16G16_Float,        offsetof(RHI_Vertex_PosTexNorTanPacked, tex) },
+                    { "NORMAL",     2, binding, RHI_Format_R16G16B16A16_Snorm,  offsetof(RHI_Vertex_PosTexNorTanPacked, nor_tan) }
+                };
+            }
+
             if (vertex_shader_blob && !m_vertex_attributes.empty())
             {
                 return _CreateResource(vertex_shader_blob);
@@ -158,7 +158,7 @@ namespace Spartan
         static const char* target_profile_vs = "vs_6_6";
         static const char* target_profile_ps = "ps_6_6";
         static const char* target_profile_cs = "cs_6_6";
-        #elif defined(API_GRAPHICS_VULKAN)
+        #elif defined(API_GRAPHICS_VULKAN) || defined(API_GRAPHICS_NULL)
         static const char* target_profile_vs = "vs_6_6";
         static const char* target_profile_ps = "ps_6_6";
         static const char* target_profile_cs = "cs_6_6";
@@ -177,7 +177,7 @@ namespace Spartan
         static const char* shader_model = "5_0";
         #elif defined(API_GRAPHICS_D3D12)
         static const char* shader_model = "6_0";
-        #elif defined(API_GRAPHICS_VULKAN)
+        #elif defined(API_GRAPHICS_VULKAN) || defined(API_GRAPHICS_NULL)
         static const char* shader_model = "6_0";
         #endif
 
@@ -191,5 +191,6 @@ namespace Spartan
     template void RHI_Shader::CompileAsync<RHI_Vertex_PosCol>(const RHI_Shader_Type, const std::string&);
     template void RHI_Shader::CompileAsync<RHI_Vertex_Pos2dTexCol8>(const RHI_Shader_Type, const std::string&);
     template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan>(const RHI_Shader_Type, const std::string&);
+    template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTanPacked>(const RHI_Shader_Type, const std::string&);
     //=========================================================================================================
 }
@@ -46,57 +46,52 @@ namespace Spartan
         m_data.shrink_to_fit();
     }
 
+    // Chunks of the native texture format, mip i lives in chunk chunk_mip + i
+    static const uint32_t chunk_properties  = 0;
+    static const uint32_t chunk_mip         = 1;
+
+    // Reads the mip count and moves the cursor to the first mip, works with both the chunked and the legacy (version 0) layout
+    static uint32_t read_mip_count(FileStream* file)
+    {
+        if (file->GetVersion() == 0)
+        {
+            file->ReadAs<uint32_t>(); // byte count
+            return file->ReadAs<uint32_t>();
+        }
+
+        if (!file->ChunkSeek(chunk_properties))
+            return 0;
+
+        const uint32_t mip_count = file->ReadAs<uint32_t>();
+        file->ChunkSeek(chunk_mip);
+        return mip_count;
+    }
+
     bool RHI_Texture::SaveToFile(const string& file_path)
     {
-        // Check to see if the file already exists (if so, get the byte count)
-        uint32_t byte_count = 0;
+        // If we hold no data, the mips are in the existing file, so read them before it gets overwritten
+        vector<vector<std::byte>> mips_existing;
+        if (m_data.empty() && FileSystem::Exists(file_path))
         {
-            if (FileSystem::Exists(file_path))
+            auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped | FileStream_Chunked);
+            if (file->IsOpen())
             {
-                auto file = make_unique<FileStream>(file_path, FileStream_Read);
-                if (file->IsOpen())
+                mips_existing.resize(read_mip_count(file.get()));
+                for (auto& mip : mips_existing)
                 {
-                    file->Read(&byte_count);
+                    file->Read(&mip);
                 }
             }
         }
+        const vector<vector<std::byte>>& mips = m_data.empty() ? mips_existing : m_data;
 
-        auto append = true;
-        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
+        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Chunked);
         if (!file->IsOpen())
             return false;
 
-        // If the existing file has a byte count but we 
-        // hold no data, don't overwrite the file's bytes.
-        if (byte_count != 0 && m_data.empty())
-        {
-            file->Skip
-            (
-                sizeof(uint32_t) +    // byte count
-                sizeof(uint32_t) +    // mipmap count
-                byte_count            // bytes
-            );
-        }
-        else
-        {
-            byte_count = GetByteCount();
-
-            // Write byte count
-            file->Write(byte_count);
-            // Write mipmap count
-            file->Write(static_cast<uint32_t>(m_data.size()));
-            // Write bytes
-            for (auto& mip : m_data)
-            {
-                file->Write(mip);
-            }
-
-            // The bytes have been saved, so we can now free some memory
-            m_data.clear();
-            m_data.shrink_to_fit();
-        }
-
-        // Write properties
+        // Properties
+        file->ChunkBegin(chunk_properties);
+        file->Write(static_cast<uint32_t>(mips.size()));
         file->Write(m_bits_per_channel);
         file->Write(m_width);
         file->Write(m_height);
@@ -106,6 +101,19 @@ namespace Spartan
         file->Write(GetId());
         file->Write(GetResourceFilePath());
 
+        // Mips, one chunk each so that any of them can be read without touching the others
+        for (uint32_t i = 0; i < static_cast<uint32_t>(mips.size()); i++)
+        {
+            file->ChunkBegin(chunk_mip + i);
+            file->Write(mips[i]);
+        }
+
+        file->Close();
+
+        // The bytes have been saved, so we can now free some memory
+        m_data.clear();
+        m_data.shrink_to_fit();
+
         return true;
     }
 
@@ -165,11 +173,8 @@ namespace Spartan
             m_size_gpu = 0;
             for (uint8_t mip_index = 0; mip_index < m_mip_count; mip_index++)
             {
-                const uint32_t mip_width  = m_width >> mip_index;
-                const uint32_t mip_height = m_height >> mip_index;
-
                 m_size_cpu += mip_index < m_data.size() ? m_data[mip_index].size() * sizeof(std::byte) : 0;
-                m_size_gpu += mip_width * mip_height * (m_bits_per_channel / 8);
+                m_size_gpu += GetMipByteCount(mip_index);
             }
         }
 
@@ -201,18 +206,28 @@ namespace Spartan
         // Else attempt to load the data
         else
         {
-            auto file = make_unique<FileStream>(GetResourceFilePathNative(), FileStream_Read);
+            auto file = make_unique<FileStream>(GetResourceFilePathNative(), FileStream_Read | FileStream_Mapped | FileStream_Chunked);
             if (file->IsOpen())
             {
-                auto byte_count = file->ReadAs<uint32_t>();
-                const uint32_t mip_count  = file->ReadAs<uint32_t>();
+                const uint32_t mip_count = read_mip_count(file.get());
 
                 if (index < mip_count)
                 {
-                    for (uint8_t i = 0; i <= index; i++)
+                    if (file->GetVersion() == 0)
                     {
-                        file->Read(&data);
+                        // Skip over the preceding mips without copying them
+                        for (uint8_t i = 0; i < index; i++)
+                        {
+                            file->ReadSpan<std::byte>();
+                        }
                     }
+                    else
+                    {
+                        file->ChunkSeek(chunk_mip + index);
+                    }
+
+                    const Span<const std::byte> mip = file->ReadSpan<std::byte>();
+                    data.assign(mip.begin(), mip.end());
                 }
                 else
                 {
@@ -244,25 +259,52 @@ namespace Spartan
 
     bool RHI_Texture::LoadFromFile_NativeFormat(const string& file_path)
     {
-        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped | FileStream_Chunked);
         if (!file->IsOpen())
             return false;
 
         m_data.clear();
         m_data.shrink_to_fit();
 
-        // Read byte and mipmap count
-        auto byte_count = file->ReadAs<uint32_t>();
-        const auto mip_count  = file->ReadAs<uint32_t>();
+        // Legacy layout (version 0), bytes first, properties after
+        if (file->GetVersion() == 0)
+        {
+            m_data.resize(read_mip_count(file.get()));
+            for (auto& mip : m_data)
+            {
+                file->Read(&mip);
+            }
 
-        // Read bytes
-        m_data.resize(mip_count);
-        for (auto& mip : m_data)
+            ReadProperties(file.get());
+            return true;
+        }
+
+        // Properties
+        if (!file->ChunkSeek(chunk_properties))
         {
-            file->Read(&mip);
+            LOG_ERROR("\"%s\" has no properties chunk", file_path.c_str());
+            return false;
+        }
+        m_data.resize(file->ReadAs<uint32_t>());
+        ReadProperties(file.get());
+
+        // Mips
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_data.size()); i++)
+        {
+            if (!file->ChunkSeek(chunk_mip + i))
+            {
+                LOG_ERROR("\"%s\" is missing mip %d", file_path.c_str(), i);
+                return false;
+            }
+
+            file->Read(&m_data[i]);
         }
 
-        // Read properties
+        return true;
+    }
+
+    void RHI_Texture::ReadProperties(FileStream* file)
+    {
         file->Read(&m_bits_per_channel);
         file->Read(&m_width);
         file->Read(&m_height);
@@ -270,9 +312,23 @@ namespace Spartan
         file->Read(&m_channel_count);
         file->Read(&m_flags);
         SetId(file->ReadAs<uint32_t>());
-        SetResourceFilePath(file->ReadAs<string>());
 
-        return true;
+        // Textures created in memory have no foreign file
+        const string file_path = file->ReadAs<string>();
+        if (!file_path.empty())
+        {
+            SetResourceFilePath(file_path);
+        }
+    }
+
+    uint32_t RHI_Texture::GetMipRowPitch(const uint32_t mip_index) const
+    {
+        return rhi_format_row_pitch(m_format, m_width >> mip_index, GetBytesPerPixel());
+    }
+
+    uint32_t RHI_Texture::GetMipByteCount(const uint32_t mip_index) const
+    {
+        return GetMipRowPitch(mip_index) * rhi_format_row_count(m_format, m_height >> mip_index);
     }
 
     uint32_t RHI_Texture::GetChannelCountFromFormat(const RHI_Format format)
@@ -296,6 +352,11 @@ namespace Spartan
             case RHI_Format_R32G32B32A32_Float:     return 4;
             case RHI_Format_D32_Float:              return 1;
             case RHI_Format_D32_Float_S8X24_Uint:   return 2;
+            case RHI_Format_BC1_Unorm:              return 4;
+            case RHI_Format_BC3_Unorm:              return 4;
+            case RHI_Format_BC4_Unorm:              return 1;
+            case RHI_Format_BC5_Unorm:              return 2;
+            case RHI_Format_BC7_Unorm:              return 4;
             default:                                return 0;
         }
     }
@@ -31,6 +31,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class FileStream;
+
     enum RHI_Texture_Flags : uint16_t
     {
         RHI_Texture_Sampled                    = 1 << 0,
@@ -40,7 +42,8 @@ namespace Spartan
         RHI_Texture_DepthStencilReadOnly    = 1 << 4,
         RHI_Texture_Grayscale               = 1 << 5,
         RHI_Texture_Transparent             = 1 << 6,
-        RHI_Texture_GenerateMipsWhenLoading = 1 << 7
+        RHI_Texture_GenerateMipsWhenLoading = 1 << 7,
+        RHI_Texture_Srgb                    = 1 << 8
     };
 
     enum RHI_Shader_View_Type : uint8_t
@@ -73,6 +76,10 @@ namespace Spartan
         auto GetTransparency() const                                    { return m_flags & RHI_Texture_Transparent; }
         void SetTransparency(const bool is_transparent)                 { is_transparent ? m_flags |= RHI_Texture_Transparent : m_flags &= ~RHI_Texture_Transparent; }
 
+        // The color channels hold sRGB encoded values (mips get filtered in linear space)
+        auto GetSrgb() const                                            { return m_flags & RHI_Texture_Srgb; }
+        void SetSrgb(const bool is_srgb)                                { is_srgb ? m_flags |= RHI_Texture_Srgb : m_flags &= ~RHI_Texture_Srgb; }
+
         uint32_t GetBitsPerChannel() const                              { return m_bits_per_channel; }
         void SetBitsPerChannel(const uint32_t bits)                     { m_bits_per_channel = bits; }
         uint32_t GetBytesPerChannel() const                             { return m_bits_per_channel / 8; }
@@ -84,6 +91,11 @@ namespace Spartan
         auto GetFormat() const                                          { return m_format; }
         void SetFormat(const RHI_Format format)                         { m_format = format; }
 
+        // The block compressed format to convert to when importing, undefined keeps the image as is.
+        // Grayscale images use format_grayscale instead, when one is given, as the importer only knows if an image is grayscale once it has loaded it.
+        auto GetCompressionFormat(const bool is_grayscale = false) const { return (is_grayscale && m_compression_format_grayscale != RHI_Format_Undefined) ? m_compression_format_grayscale : m_compression_format; }
+        void SetCompressionFormat(const RHI_Format format, const RHI_Format format_grayscale = RHI_Format_Undefined) { m_compression_format = format; m_compression_format_grayscale = format_grayscale; }
+
         // Data
         bool HasData() const                                            { return !m_data.empty(); }
         void SetData(const std::vector<std::vector<std::byte>>& data)   { m_data = data; }
@@ -93,6 +105,8 @@ namespace Spartan
         std::vector<std::vector<std::byte>>& GetMips()                  { return m_data; }
         std::vector<std::byte>& GetMip(const uint8_t mip_index);
         std::vector<std::byte> GetOrLoadMip(const uint8_t mip_index);
+        uint32_t GetMipRowPitch(uint32_t mip_index) const;
+        uint32_t GetMipByteCount(uint32_t mip_index) const;
 
         // Binding type
         bool IsSampled()        const { return m_flags & RHI_Texture_Sampled; }
@@ -105,6 +119,7 @@ namespace Spartan
         bool IsStencilFormat()          const { return m_format == RHI_Format_D32_Float_S8X24_Uint; }
         bool IsDepthStencilFormat()     const { return IsDepthFormat() || IsStencilFormat(); }
         bool IsColorFormat()            const { return !IsDepthStencilFormat(); }
+        bool IsCompressedFormat()       const { return rhi_format_is_block_compressed(m_format); }
         
         // Layout
         void SetLayout(const RHI_Image_Layout layout, RHI_CommandList* command_list = nullptr);
@@ -126,19 +141,22 @@ namespace Spartan
 
     protected:
         bool LoadFromFile_NativeFormat(const std::string& file_path);
+        void ReadProperties(FileStream* file);
         bool LoadFromFile_ForeignFormat(const std::string& file_path, bool generate_mipmaps);
         static uint32_t GetChannelCountFromFormat(RHI_Format format);
         virtual bool CreateResourceGpu() { LOG_ERROR("Function not implemented by API"); return false; }
 
-        uint32_t m_bits_per_channel = 8;
-        uint32_t m_width            = 0;
-        uint32_t m_height           = 0;
-        uint32_t m_channel_count    = 4;
-        uint32_t m_array_size       = 1;
-        uint8_t m_mip_count         = 1;
-        RHI_Format m_format         = RHI_Format_Undefined;
-        RHI_Image_Layout m_layout   = RHI_Image_Layout::Undefined;
-        uint16_t m_flags            = 0;
+        uint32_t m_bits_per_channel               = 8;
+        uint32_t m_width                          = 0;
+        uint32_t m_height                         = 0;
+        uint32_t m_channel_count                  = 4;
+        uint32_t m_array_size                     = 1;
+        uint8_t m_mip_count                       = 1;
+        RHI_Format m_format                       = RHI_Format_Undefined;
+        RHI_Format m_compression_format           = RHI_Format_Undefined;
+        RHI_Format m_compression_format_grayscale = RHI_Format_Undefined;
+        RHI_Image_Layout m_layout                 = RHI_Image_Layout::Undefined;
+        uint16_t m_flags                          = 0;
         RHI_Viewport m_viewport;
         std::vector<std::vector<std::byte>> m_data;
         std::shared_ptr<RHI_Device> m_rhi_device;
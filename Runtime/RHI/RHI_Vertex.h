@@ -129,11 +129,20 @@ namespace Spartan
         float tan[3] = { 0 };
     };
 
+    // RHI_Vertex_PosTexNorTan in 20 bytes instead of 44, see Mesh::Vertices_Pack()
+    struct RHI_Vertex_PosTexNorTanPacked
+    {
+        int16_t pos[4]      = { 0 }; // snorm, relative to the mesh bounds, w is the bitangent sign
+        uint16_t tex[2]     = { 0 }; // half float
+        int16_t nor_tan[4]  = { 0 }; // snorm, octahedral normal (xy) and tangent (zw)
+    };
+
     static_assert(std::is_trivially_copyable<RHI_Vertex_Pos>::value,            "RHI_Vertex_Pos is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosTex>::value,            "RHI_Vertex_PosTex is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosCol>::value,            "RHI_Vertex_PosCol is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_Pos2dTexCol8>::value,    "RHI_Vertex_Pos2dTexCol8 is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan>::value,    "RHI_Vertex_PosTexNorTan is not trivially copyable");
+    static_assert(sizeof(RHI_Vertex_PosTexNorTanPacked) == 20,                   "RHI_Vertex_PosTexNorTanPacked is not tightly packed");
 
     enum RHI_Vertex_Type
     {
@@ -142,6 +151,7 @@ namespace Spartan
         RHI_Vertex_Type_PositionColor,
         RHI_Vertex_Type_PositionTexture,
         RHI_Vertex_Type_PositionTextureNormalTangent,
+        RHI_Vertex_Type_PositionTextureNormalTangentPacked,
         RHI_Vertex_Type_Position2dTextureColor8
     };
 
@@ -153,4 +163,5 @@ namespace Spartan
     template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosCol>()            { return RHI_Vertex_Type_PositionColor; }
     template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_Pos2dTexCol8>()    { return RHI_Vertex_Type_Position2dTextureColor8; }
     template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan>()    { return RHI_Vertex_Type_PositionTextureNormalTangent; }
+    template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTanPacked>() { return RHI_Vertex_Type_PositionTextureNormalTangentPacked; }
 }
@@ -201,6 +201,7 @@ namespace Spartan
                 ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, fillModeNonSolid)
                 ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, wideLines)
                 ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, imageCubeArray)
+                ENABLE_FEATURE(m_rhi_context->device_features.features, device_features_enabled.features, textureCompressionBC)
                 ENABLE_FEATURE(m_rhi_context->device_features_1_2, device_features_1_2_enabled, timelineSemaphore)
             }
 
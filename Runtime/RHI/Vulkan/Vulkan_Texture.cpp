@@ -82,7 +82,6 @@ namespace Spartan
         const uint32_t height           = texture->GetHeight();
         const uint32_t array_size       = texture->GetArraySize();
         const uint32_t mip_levels       = texture->GetMipCount();
-        const uint32_t bytes_per_pixel  = texture->GetBytesPerPixel();
 
         // Fill out VkBufferImageCopy structs describing the array and the mip levels   
         VkDeviceSize buffer_offset = 0;
@@ -107,7 +106,7 @@ namespace Spartan
                 buffer_image_copies[mip_index] = region;
 
                 // Update staging buffer memory requirement (in bytes)
-                buffer_offset += mip_width * mip_height * bytes_per_pixel;
+                buffer_offset += texture->GetMipByteCount(mip_index);
             }
         }
 
@@ -123,7 +122,7 @@ namespace Spartan
             {
                 for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
                 {
-                    uint64_t buffer_size = (width >> mip_index) * (height >> mip_index) * bytes_per_pixel;
+                    uint64_t buffer_size = texture->GetMipByteCount(mip_index);
                     memcpy(static_cast<std::byte*>(data) + buffer_offset, texture->GetMip(array_index + mip_index).data(), buffer_size);
                     buffer_offset += buffer_size;
                 }
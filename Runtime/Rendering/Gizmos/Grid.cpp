@@ -22,7 +22,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ================================
 #include "Spartan.h"
 #include "Grid.h"
-#include "../../World/Components/Transform.h"
 #include "../../RHI/RHI_VertexBuffer.h"
 #include "../../RHI/RHI_IndexBuffer.h"
 #include "../../RHI/RHI_Vertex.h"
@@ -47,7 +46,7 @@ namespace Spartan
         CreateBuffers(vertices, indices, rhi_device);
     }
 
-    const Matrix& Grid::ComputeWorldMatrix(Transform* camera)
+    const Matrix& Grid::ComputeWorldMatrix(const Vector3& camera_position)
     {
         // To get the grid to feel infinite, it has to follow the camera,
         // but only by increments of the grid's spacing size. This gives the illusion 
@@ -55,9 +54,9 @@ namespace Spartan
         const auto gridSpacing = 1.0f;
         const auto translation = Vector3
         (
-            static_cast<int>(camera->GetPosition().x / gridSpacing) * gridSpacing, 
+            static_cast<int>(camera_position.x / gridSpacing) * gridSpacing, 
             0.0f, 
-            static_cast<int>(camera->GetPosition().z / gridSpacing) * gridSpacing
+            static_cast<int>(camera_position.z / gridSpacing) * gridSpacing
         );
     
         m_world = Matrix::CreateScale(gridSpacing) * Matrix::CreateTranslation(translation);
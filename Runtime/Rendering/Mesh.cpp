@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Mesh.h"
 #include "../RHI/RHI_Vertex.h"
+#include "../Math/BoundingBox.h"
 //============================
 
 //= NAMESPACES ================
@@ -32,6 +33,58 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    static const float snorm16_max = 32767.0f;
+
+    inline int16_t to_snorm16(const float value)
+    {
+        return static_cast<int16_t>(Helper::Round(Helper::Clamp(value, -1.0f, 1.0f) * snorm16_max));
+    }
+
+    inline float from_snorm16(const int16_t value)
+    {
+        return Helper::Max(static_cast<float>(value) / snorm16_max, -1.0f);
+    }
+
+    // Projects the direction on an octahedron and unfolds its lower half over the upper one
+    inline void octahedral_encode(const float* direction, int16_t* encoded)
+    {
+        const float length = Helper::Abs(direction[0]) + Helper::Abs(direction[1]) + Helper::Abs(direction[2]);
+        if (length == 0.0f)
+        {
+            encoded[0] = 0;
+            encoded[1] = 0;
+            return;
+        }
+
+        float x = direction[0] / length;
+        float y = direction[1] / length;
+        if (direction[2] < 0.0f)
+        {
+            const float x_folded = (1.0f - Helper::Abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float y_folded = (1.0f - Helper::Abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = x_folded;
+            y = y_folded;
+        }
+
+        encoded[0] = to_snorm16(x);
+        encoded[1] = to_snorm16(y);
+    }
+
+    inline void octahedral_decode(const int16_t* encoded, float* direction)
+    {
+        float x         = from_snorm16(encoded[0]);
+        float y         = from_snorm16(encoded[1]);
+        const float z   = 1.0f - Helper::Abs(x) - Helper::Abs(y);
+        const float t   = Helper::Saturate(-z);
+        x              += x >= 0.0f ? -t : t;
+        y              += y >= 0.0f ? -t : t;
+
+        const Vector3 decoded = Vector3(x, y, z).Normalized();
+        direction[0] = decoded.x;
+        direction[1] = decoded.y;
+        direction[2] = decoded.z;
+    }
+
     void Mesh::Clear()
     {
         m_vertices.clear();
@@ -97,4 +150,64 @@ namespace Spartan
 
         m_indices.insert(m_indices.end(), indices.begin(), indices.end());
     }
+
+    void Mesh::Vertices_Pack(vector<RHI_Vertex_PosTexNorTanPacked>* vertices, Vector3* offset, float* scale) const
+    {
+        if (!vertices || !offset || !scale)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        // A uniform scale keeps the dequantization a similarity transform, so it can be folded into the world matrix without skewing the normals
+        const BoundingBox bounds    = m_vertices.empty() ? BoundingBox(Vector3::Zero, Vector3::Zero) : BoundingBox(m_vertices.data(), static_cast<uint32_t>(m_vertices.size()));
+        const Vector3 extents       = bounds.GetExtents();
+        *offset                     = bounds.GetCenter();
+        *scale                      = Helper::Max(Helper::Max3(extents.x, extents.y, extents.z), Helper::EPSILON);
+        const float scale_inverse   = 1.0f / *scale;
+
+        vertices->resize(m_vertices.size());
+        for (size_t i = 0; i < m_vertices.size(); i++)
+        {
+            const RHI_Vertex_PosTexNorTan& vertex   = m_vertices[i];
+            RHI_Vertex_PosTexNorTanPacked& packed   = (*vertices)[i];
+
+            packed.pos[0] = to_snorm16((vertex.pos[0] - offset->x) * scale_inverse);
+            packed.pos[1] = to_snorm16((vertex.pos[1] - offset->y) * scale_inverse);
+            packed.pos[2] = to_snorm16((vertex.pos[2] - offset->z) * scale_inverse);
+            packed.pos[3] = to_snorm16(1.0f); // the tangent frame is always right handed for now
+
+            packed.tex[0] = Helper::FloatToHalf(vertex.tex[0]);
+            packed.tex[1] = Helper::FloatToHalf(vertex.tex[1]);
+
+            octahedral_encode(vertex.nor, &packed.nor_tan[0]);
+            octahedral_encode(vertex.tan, &packed.nor_tan[2]);
+        }
+    }
+
+    void Mesh::Vertices_Unpack(const RHI_Vertex_PosTexNorTanPacked* vertices, const uint32_t vertex_count, const Vector3& offset, const float scale)
+    {
+        if (!vertices && vertex_count != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        m_vertices.resize(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const RHI_Vertex_PosTexNorTanPacked& packed = vertices[i];
+            RHI_Vertex_PosTexNorTan& vertex             = m_vertices[i];
+
+            vertex.pos[0] = offset.x + from_snorm16(packed.pos[0]) * scale;
+            vertex.pos[1] = offset.y + from_snorm16(packed.pos[1]) * scale;
+            vertex.pos[2] = offset.z + from_snorm16(packed.pos[2]) * scale;
+
+            vertex.tex[0] = Helper::HalfToFloat(packed.tex[0]);
+            vertex.tex[1] = Helper::HalfToFloat(packed.tex[1]);
+
+            octahedral_decode(&packed.nor_tan[0], vertex.nor);
+            octahedral_decode(&packed.nor_tan[2], vertex.tan);
+        }
+    }
 }
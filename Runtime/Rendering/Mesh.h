@@ -28,6 +28,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    namespace Math { class Vector3; }
+
+    // A level of detail, a range of the model's index buffer which draws the same vertices with fewer triangles
+    struct MeshLod
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        float error             = 0.0f; // how far (in model space) the surface may deviate from the full detail one
+    };
+
     class Mesh
     {
     public:
@@ -59,6 +69,10 @@ namespace Spartan
         void Indices_Set(const std::vector<uint32_t>& indices)  { m_indices = indices; }
         uint32_t Indices_Count() const                          { return static_cast<uint32_t>(m_indices.size()); }
         void Indices_Append(const std::vector<uint32_t>& indices, uint32_t* indexOffset);
+
+        // Packing, positions are stored relative to the center of the bounds and scaled (uniformly) by their largest half extent
+        void Vertices_Pack(std::vector<RHI_Vertex_PosTexNorTanPacked>* vertices, Math::Vector3* offset, float* scale) const;
+        void Vertices_Unpack(const RHI_Vertex_PosTexNorTanPacked* vertices, uint32_t vertex_count, const Math::Vector3& offset, float scale);
     
         // Misc
         uint32_t GetTriangleCount() const { return Indices_Count() / 3; }
@@ -62,11 +62,22 @@ namespace Spartan
         m_vertex_buffer.reset();
         m_index_buffer.reset();
         m_mesh->Clear();
+        m_lods.clear();
         m_aabb.Undefine();
         m_normalized_scale = 1.0f;
         m_is_animated = false;
+        m_vertex_dequantization = Matrix::Identity;
     }
 
+    // Chunks of the native model format.
+    // There are no per-mesh chunks, all the meshes of a model share one index and one vertex buffer and the
+    // renderables address them by offset, so a single mesh is a range within chunk_indices and chunk_vertices.
+    static const uint32_t chunk_properties      = 0;
+    static const uint32_t chunk_indices         = 1;
+    static const uint32_t chunk_vertices        = 2;
+    static const uint32_t chunk_lods            = 3; // optional
+    static const uint32_t chunk_vertices_packed = 4; // instead of chunk_vertices
+
     bool Model::LoadFromFile(const string& file_path)
     {
         const Stopwatch timer;
@@ -81,14 +92,58 @@ namespace Spartan
         if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_MODEL)
         {
             // Deserialize
-            auto file = make_unique<FileStream>(file_path, FileStream_Read);
+            auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped | FileStream_Chunked);
             if (!file->IsOpen())
                 return false;
 
+            // Files which predate the chunked container (version 0) store the same fields back to back
+            const bool chunked = file->GetVersion() != 0;
+            if (chunked && !(file->HasChunk(chunk_properties) && file->HasChunk(chunk_indices) && (file->HasChunk(chunk_vertices) || file->HasChunk(chunk_vertices_packed))))
+            {
+                LOG_ERROR("\"%s\" is missing chunks", file_path.c_str());
+                return false;
+            }
+
+            if (chunked) file->ChunkSeek(chunk_properties);
             SetResourceFilePath(file->ReadAs<string>());
             file->Read(&m_normalized_scale);
+
+            if (chunked) file->ChunkSeek(chunk_indices);
             file->Read(&m_mesh->Indices_Get());
-            file->Read(&m_mesh->Vertices_Get());
+
+            // The cpu keeps full precision vertices (physics, picking), unpacked from the quantized ones so both sides agree
+            m_vertex_packed = chunked && file->HasChunk(chunk_vertices_packed);
+            if (m_vertex_packed)
+            {
+                file->ChunkSeek(chunk_vertices_packed);
+                Vector3 offset;
+                float scale = 1.0f;
+                file->Read(&offset);
+                file->Read(&scale);
+                const Span<const RHI_Vertex_PosTexNorTanPacked> vertices = file->ReadSpan<RHI_Vertex_PosTexNorTanPacked>();
+                m_mesh->Vertices_Unpack(vertices.data(), static_cast<uint32_t>(vertices.size()), offset, scale);
+            }
+            else
+            {
+                if (chunked) file->ChunkSeek(chunk_vertices);
+                file->Read(&m_mesh->Vertices_Get());
+            }
+
+            if (chunked && file->ChunkSeek(chunk_lods))
+            {
+                const uint32_t geometry_count = file->ReadAs<uint32_t>();
+                for (uint32_t i = 0; i < geometry_count; i++)
+                {
+                    vector<MeshLod>& lods = m_lods[file->ReadAs<uint32_t>()];
+                    lods.resize(file->ReadAs<uint32_t>());
+                    for (MeshLod& lod : lods)
+                    {
+                        file->Read(&lod.index_offset);
+                        file->Read(&lod.index_count);
+                        file->Read(&lod.error);
+                    }
+                }
+            }
 
             UpdateGeometry();
         }
@@ -130,14 +185,48 @@ namespace Spartan
 
     bool Model::SaveToFile(const string& file_path)
     {
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Chunked);
         if (!file->IsOpen())
             return false;
 
+        file->ChunkBegin(chunk_properties);
         file->Write(GetResourceFilePath());
         file->Write(m_normalized_scale);
+
+        file->ChunkBegin(chunk_indices);
         file->Write(m_mesh->Indices_Get());
-        file->Write(m_mesh->Vertices_Get());
+
+        if (m_vertex_packed)
+        {
+            vector<RHI_Vertex_PosTexNorTanPacked> vertices;
+            Vector3 offset;
+            float scale = 1.0f;
+            m_mesh->Vertices_Pack(&vertices, &offset, &scale);
+
+            file->ChunkBegin(chunk_vertices_packed);
+            file->Write(offset);
+            file->Write(scale);
+            file->Write(vertices);
+        }
+        else
+        {
+            file->ChunkBegin(chunk_vertices);
+            file->Write(m_mesh->Vertices_Get());
+        }
+
+        file->ChunkBegin(chunk_lods);
+        file->Write(static_cast<uint32_t>(m_lods.size()));
+        for (const auto& [index_offset, lods] : m_lods)
+        {
+            file->Write(index_offset);
+            file->Write(static_cast<uint32_t>(lods.size()));
+            for (const MeshLod& lod : lods)
+            {
+                file->Write(lod.index_offset);
+                file->Write(lod.index_count);
+                file->Write(lod.error);
+            }
+        }
 
         file->Close();
 
@@ -162,6 +251,12 @@ namespace Spartan
         m_mesh->GetGeometry(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
     }
 
+    const vector<MeshLod>* Model::GetLods(const uint32_t index_offset) const
+    {
+        const auto it = m_lods.find(index_offset);
+        return it != m_lods.end() ? &it->second : nullptr;
+    }
+
     void Model::UpdateGeometry()
     {
         if (m_mesh->Indices_Count() == 0 || m_mesh->Vertices_Count() == 0)
@@ -191,6 +286,25 @@ namespace Spartan
         entity->AddComponent<Renderable>()->SetMaterial(material);
     }
 
+    // Normals keep two channels, single channel properties keep one, anything else is color.
+    // Models swap normal and height maps depending on whether the image is grayscale (see ModelImporter::AssignTextures()), so those two, along with masks
+    // (the G-Buffer tests all three of their channels), get their format from the image rather than from the slot they were declared in.
+    static void set_compression_format(RHI_Texture* texture, const Material_Property texture_type)
+    {
+        switch (texture_type)
+        {
+            case Material_Normal:       texture->SetCompressionFormat(RHI_Format_BC5_Unorm, RHI_Format_BC4_Unorm); break;
+            case Material_Height:       texture->SetCompressionFormat(RHI_Format_BC5_Unorm, RHI_Format_BC4_Unorm); break;
+            case Material_Mask:         texture->SetCompressionFormat(RHI_Format_BC7_Unorm, RHI_Format_BC4_Unorm); break;
+            case Material_Roughness:    texture->SetCompressionFormat(RHI_Format_BC4_Unorm); break;
+            case Material_Metallic:     texture->SetCompressionFormat(RHI_Format_BC4_Unorm); break;
+            case Material_Occlusion:    texture->SetCompressionFormat(RHI_Format_BC4_Unorm); break;
+            case Material_Color:        texture->SetCompressionFormat(RHI_Format_BC7_Unorm); break;
+            case Material_Emission:     texture->SetCompressionFormat(RHI_Format_BC7_Unorm); break;
+            default:                    texture->SetCompressionFormat(RHI_Format_Undefined); break;
+        }
+    }
+
     void Model::AddTexture(shared_ptr<Material>& material, const Material_Property texture_type, const string& file_path)
     {
         if (!material || file_path.empty())
@@ -199,23 +313,24 @@ namespace Spartan
             return;
         }
 
+        material->SetTextureSlot(texture_type, LoadTexture(texture_type, file_path));
+    }
+
+    shared_ptr<RHI_Texture> Model::LoadTexture(const Material_Property texture_type, const string& file_path) const
+    {
         // Try to get the texture
         const auto tex_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
         if (auto texture = m_context->GetSubsystem<ResourceCache>()->GetByName<RHI_Texture2D>(tex_name))
-        {
-            material->SetTextureSlot(texture_type, texture);
-        }
-        // If we didn't get a texture, it's not cached, hence we have to load it and cache it now
-        else
-        {
-            // Load texture
-            auto generate_mipmaps = true;
-            texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
-            texture->LoadFromFile(file_path);
+            return texture;
 
-            // Set the texture to the provided material
-            material->SetTextureSlot(texture_type, texture);
-        }
+        // If we didn't get a texture, it's not cached, hence we have to load it (the material caches it once it's assigned to a slot)
+        auto generate_mipmaps = true;
+        auto texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
+        set_compression_format(texture.get(), texture_type);
+        texture->SetSrgb(texture_type == Material_Color || texture_type == Material_Emission);
+        texture->LoadFromFile(file_path);
+
+        return texture;
     }
 
     bool Model::GeometryCreateBuffers()
@@ -223,8 +338,8 @@ namespace Spartan
         auto success = true;
 
         // Get geometry
-        const auto indices    = m_mesh->Indices_Get();
-        const auto vertices    = m_mesh->Vertices_Get();
+        const auto& indices     = m_mesh->Indices_Get();
+        const auto& vertices    = m_mesh->Vertices_Get();
 
         if (!indices.empty())
         {
@@ -243,8 +358,27 @@ namespace Spartan
 
         if (!vertices.empty())
         {
+            bool created = false;
             m_vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
-            if (!m_vertex_buffer->Create(vertices))
+            if (m_vertex_packed)
+            {
+                vector<RHI_Vertex_PosTexNorTanPacked> vertices_packed;
+                Vector3 offset;
+                float scale = 1.0f;
+                m_mesh->Vertices_Pack(&vertices_packed, &offset, &scale);
+                created = m_vertex_buffer->Create(vertices_packed);
+
+                // Keep the cpu copy identical to what the gpu sees
+                m_mesh->Vertices_Unpack(vertices_packed.data(), static_cast<uint32_t>(vertices_packed.size()), offset, scale);
+                m_vertex_dequantization = Matrix(offset, Quaternion::Identity, Vector3(scale));
+            }
+            else
+            {
+                created = m_vertex_buffer->Create(vertices);
+                m_vertex_dequantization = Matrix::Identity;
+            }
+
+            if (!created)
             {
                 LOG_ERROR("Failed to create vertex buffer for \"%s\".", GetResourceName().c_str());
                 success = false;
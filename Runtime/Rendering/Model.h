@@ -24,17 +24,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <vector>
+#include <unordered_map>
 #include "Material.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
+#include "Mesh.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Matrix.h"
 //================================
 
 namespace Spartan
 {
     class ResourceCache;
     class Entity;
-    class Mesh;
     namespace Math{ class BoundingBox; }
 
     class SPARTAN_CLASS Model : public IResource, public std::enable_shared_from_this<Model>
@@ -69,10 +71,22 @@ namespace Spartan
         const auto& GetAabb() const { return m_aabb; }
         const auto& GetMesh() const { return m_mesh; }
 
+        // Levels of detail, keyed by the index offset of the full detail geometry they reduce
+        void SetLods(const uint32_t index_offset, const std::vector<MeshLod>& lods) { m_lods[index_offset] = lods; }
+        const std::vector<MeshLod>* GetLods(uint32_t index_offset) const;
+
+        // Packed vertices (RHI_Vertex_PosTexNorTanPacked) on the gpu and on disk, has to be set before the geometry is created.
+        // Their positions are quantized, the dequantization matrix has to precede the world matrix.
+        bool IsVertexPacked()                               const { return m_vertex_packed; }
+        void SetVertexPacked(const bool vertex_packed)            { m_vertex_packed = vertex_packed; }
+        const Math::Matrix& GetVertexDequantization()       const { return m_vertex_dequantization; }
+
         // Add resources to the model
         void SetRootEntity(const std::shared_ptr<Entity>& entity) { m_root_entity = entity; }
         void AddMaterial(std::shared_ptr<Material>& material, const std::shared_ptr<Entity>& entity) const;
         void AddTexture(std::shared_ptr<Material>& material, Material_Property texture_type, const std::string& file_path);
+        // Returns the cached texture, or loads it, thread safe
+        std::shared_ptr<RHI_Texture> LoadTexture(Material_Property texture_type, const std::string& file_path) const;
 
         // Misc
         bool IsAnimated()                           const { return m_is_animated; }
@@ -91,9 +105,12 @@ namespace Spartan
         std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
         std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
         std::shared_ptr<Mesh> m_mesh;
+        std::unordered_map<uint32_t, std::vector<MeshLod>> m_lods;
         Math::BoundingBox m_aabb;
         float m_normalized_scale    = 1.0f;
         bool m_is_animated            = false;
+        bool m_vertex_packed        = false;
+        Math::Matrix m_vertex_dequantization;
 
         // Dependencies
         ResourceCache* m_resource_manager;
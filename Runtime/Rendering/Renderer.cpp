@@ -22,14 +22,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============================
 #include "Spartan.h"
 #include "Renderer.h"
+#include "Renderer_Snapshot.h"
 #include "Model.h"
 #include "Font/Font.h"
 #include "Gizmos/Grid.h"
 #include "Gizmos/Transform_Gizmo.h"
 #include "../Utilities/Sampling.h"
+#include "../Utilities/Sort.h"
 #include "../Profiling/Profiler.h"
 #include "../Resource/ResourceCache.h"
 #include "../World/Entity.h"
+#include "../World/World.h"
+#include "../World/ComponentPools.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
 #include "../World/Components/Camera.h"
@@ -82,19 +86,18 @@ namespace Spartan
         m_option_values[Option_Value_Sharpen_Strength]  = 1.0f;
         m_option_values[Option_Value_Bloom_Intensity]   = 0.1f;
         m_option_values[Option_Value_Fog]               = 0.1f;
+        m_option_values[Option_Value_Lod_Threshold]     = 1.0f;
+
+        m_snapshots = make_unique<RenderSnapshots>();
 
         // Subscribe to events
-        SUBSCRIBE_TO_EVENT(EventType::WorldResolved,    EVENT_HANDLER_VARIANT(RenderablesAcquire));
-        SUBSCRIBE_TO_EVENT(EventType::WorldUnload,      EVENT_HANDLER(ClearEntities));
+        SUBSCRIBE_TO_EVENT(EventType::WorldUnload, EVENT_HANDLER(SnapshotClear));
     }
 
     Renderer::~Renderer()
     {
-        // Unsubscribe from events
-        UNSUBSCRIBE_FROM_EVENT(EventType::WorldResolved, EVENT_HANDLER_VARIANT(RenderablesAcquire));
-
-        m_entities.clear();
-        m_camera = nullptr;
+        m_snapshot  = nullptr;
+        m_camera    = nullptr;
 
         // Log to file as the renderer is no more
         LOG_TO_FILE(true);
@@ -199,20 +202,35 @@ namespace Spartan
 
         RHI_CommandList* cmd_list = m_swap_chain->GetCmdList();
 
+        // The latest frame the simulation published, if it hasn't published a new one, the previous one is drawn again
+        bool is_new_snapshot            = false;
+        m_snapshot                      = &m_snapshots->Acquire(&is_new_snapshot);
+        const SnapshotCamera& camera    = m_snapshot->camera;
+
         // If there is no camera, clear to black
-        if (!m_camera)
+        if (!m_snapshot->has_camera)
         {
             cmd_list->ClearRenderTarget(m_render_targets[RendererRt::Frame_Ldr].get(), 0, 0, false, Vector4(0.0f, 0.0f, 0.0f, 1.0f));
             return;
         }
         
         // If there is not camera but no other entities to render, clear to camera's color
-        if (m_entities[Renderer_Object_Opaque].empty() && m_entities[Renderer_Object_Transparent].empty() && m_entities[Renderer_Object_Light].empty())
+        if (m_snapshot->renderables[Renderer_Object_Opaque].empty() && m_snapshot->renderables[Renderer_Object_Transparent].empty() && m_snapshot->lights.empty())
         {
-            cmd_list->ClearRenderTarget(m_render_targets[RendererRt::Frame_Ldr].get(), 0, 0, false, m_camera->GetClearColor());
+            cmd_list->ClearRenderTarget(m_render_targets[RendererRt::Frame_Ldr].get(), 0, 0, false, camera.clear_color);
             return;
         }
 
+        // Keep the snapshot's lines until they expire
+        if (is_new_snapshot)
+        {
+            const SnapshotLines& lines = m_snapshot->lines;
+            m_lines_depth_enabled.insert(m_lines_depth_enabled.end(), lines.depth_enabled.begin(), lines.depth_enabled.end());
+            m_lines_depth_enabled_duration.insert(m_lines_depth_enabled_duration.end(), lines.depth_enabled_duration.begin(), lines.depth_enabled_duration.end());
+            m_lines_depth_disabled.insert(m_lines_depth_disabled.end(), lines.depth_disabled.begin(), lines.depth_disabled.end());
+            m_lines_depth_disabled_duration.insert(m_lines_depth_disabled_duration.end(), lines.depth_disabled_duration.begin(), lines.depth_disabled_duration.end());
+        }
+
         // Reset dynamic buffer indices when the swapchain resets to first buffer/command list
         if (m_swap_chain->GetCmdIndex() == 0)
         {
@@ -221,21 +239,25 @@ namespace Spartan
             m_buffer_frame_offset_index     = 0;
             m_buffer_light_offset_index     = 0;
             m_buffer_material_offset_index  = 0;
+            m_buffer_instance_offset_index  = 0;
         }
 
         // Update frame buffer
         {
-            if (m_update_ortho_proj || m_near_plane != m_camera->GetNearPlane() || m_far_plane != m_camera->GetFarPlane())
+            if (m_update_ortho_proj || m_near_plane != camera.near_plane || m_far_plane != camera.far_plane)
             {
                 m_buffer_frame_cpu.projection_ortho         = Matrix::CreateOrthographicLH(m_viewport.width, m_viewport.height, m_near_plane, m_far_plane);
                 m_buffer_frame_cpu.view_projection_ortho    = Matrix::CreateLookAtLH(Vector3(0, 0, -m_near_plane), Vector3::Forward, Vector3::Up) * m_buffer_frame_cpu.projection_ortho;
                 m_update_ortho_proj                         = false;
             }
 
-            m_near_plane                    = m_camera->GetNearPlane();
-            m_far_plane                     = m_camera->GetFarPlane();
-            m_buffer_frame_cpu.view         = m_camera->GetViewMatrix();
-            m_buffer_frame_cpu.projection   = m_camera->GetProjectionMatrix();
+            // Velocity is computed against the previous frame's (jittered) view projection
+            m_view_projection_previous      = m_buffer_frame_cpu.view_projection;
+
+            m_near_plane                    = camera.near_plane;
+            m_far_plane                     = camera.far_plane;
+            m_buffer_frame_cpu.view         = camera.view;
+            m_buffer_frame_cpu.projection   = camera.projection;
 
             // TAA - Generate jitter
             if (GetOption(Render_AntiAliasing_Taa))
@@ -259,14 +281,14 @@ namespace Spartan
             // Update the remaining of the frame buffer
             m_buffer_frame_cpu.view_projection              = m_buffer_frame_cpu.view * m_buffer_frame_cpu.projection;
             m_buffer_frame_cpu.view_projection_inv          = Matrix::Invert(m_buffer_frame_cpu.view_projection);   
-            m_buffer_frame_cpu.view_projection_unjittered   = m_buffer_frame_cpu.view * m_camera->GetProjectionMatrix();
-            m_buffer_frame_cpu.camera_aperture              = m_camera->GetAperture();
-            m_buffer_frame_cpu.camera_shutter_speed         = m_camera->GetShutterSpeed();
-            m_buffer_frame_cpu.camera_iso                   = m_camera->GetIso();
-            m_buffer_frame_cpu.camera_near                  = m_camera->GetNearPlane();
-            m_buffer_frame_cpu.camera_far                   = m_camera->GetFarPlane();
-            m_buffer_frame_cpu.camera_position              = m_camera->GetTransform()->GetPosition();
-            m_buffer_frame_cpu.camera_direction             = m_camera->GetTransform()->GetForward();
+            m_buffer_frame_cpu.view_projection_unjittered   = m_buffer_frame_cpu.view * camera.projection;
+            m_buffer_frame_cpu.camera_aperture              = camera.aperture;
+            m_buffer_frame_cpu.camera_shutter_speed         = camera.shutter_speed;
+            m_buffer_frame_cpu.camera_iso                   = camera.iso;
+            m_buffer_frame_cpu.camera_near                  = camera.near_plane;
+            m_buffer_frame_cpu.camera_far                   = camera.far_plane;
+            m_buffer_frame_cpu.camera_position              = camera.position;
+            m_buffer_frame_cpu.camera_direction             = camera.forward;
             m_buffer_frame_cpu.bloom_intensity              = m_option_values[Option_Value_Bloom_Intensity];
             m_buffer_frame_cpu.sharpen_strength             = m_option_values[Option_Value_Sharpen_Strength];
             m_buffer_frame_cpu.fog                          = m_option_values[Option_Value_Fog];
@@ -281,9 +303,12 @@ namespace Spartan
             m_buffer_frame_cpu.frame                        = static_cast<uint32_t>(m_frame_num);
         }
 
-        m_is_rendering = true;
+        // Sort the renderables and determine what's visible to the camera and to each shadow map slice
+        RenderablesSort(Renderer_Object_Opaque);
+        RenderablesSort(Renderer_Object_Transparent);
+        Cull();
+
         Pass_Main(cmd_list);
-        m_is_rendering = false;
 
         DrawDebugTick(delta_time);
 
@@ -349,12 +374,8 @@ namespace Spartan
     }
 
     template<typename T>
-    bool update_dynamic_buffer(RHI_CommandList* cmd_list, RHI_ConstantBuffer* buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index)
+    bool advance_dynamic_buffer(RHI_CommandList* cmd_list, RHI_ConstantBuffer* buffer_gpu, uint32_t& offset_index)
     {
-        // Only update if needed
-        if (buffer_cpu == buffer_cpu_previous)
-            return true;
-
         offset_index++;
 
         // Re-allocate buffer with double size (if needed)
@@ -379,6 +400,19 @@ namespace Spartan
             buffer_gpu->SetOffsetIndexDynamic(offset_index);
         }
 
+        return true;
+    }
+
+    template<typename T>
+    bool update_dynamic_buffer(RHI_CommandList* cmd_list, RHI_ConstantBuffer* buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index)
+    {
+        // Only update if needed
+        if (buffer_cpu == buffer_cpu_previous)
+            return true;
+
+        if (!advance_dynamic_buffer<T>(cmd_list, buffer_gpu, offset_index))
+            return false;
+
         // Map  
         T* buffer = static_cast<T*>(buffer_gpu->Map());
         if (!buffer)
@@ -408,14 +442,11 @@ namespace Spartan
     bool Renderer::UpdateFrameBuffer(RHI_CommandList* cmd_list)
     {
         // Update directional light intensity, just grab the first one
-        for (const auto& entity : m_entities[Renderer_Object_Light])
+        for (const SnapshotLight& light : m_snapshot->lights)
         {
-            if (Light* light = entity->GetComponent<Light>())
+            if (light.type == LightType::Directional)
             {
-                if (light->GetLightType() == LightType::Directional)
-                {
-                    m_buffer_frame_cpu.directional_light_intensity = light->GetIntensity();
-                }
+                m_buffer_frame_cpu.directional_light_intensity = light.intensity;
             }
         }
 
@@ -443,7 +474,7 @@ namespace Spartan
         // Update
         for (uint32_t i = 0; i < m_max_material_instances; i++)
         {
-            Material* material = m_material_instances[i];
+            const SnapshotMaterial* material = m_material_instances[i];
             if (!material)
                 continue;
 
@@ -492,7 +523,7 @@ namespace Spartan
         return cmd_list->SetConstantBuffer(3, RHI_Shader_Vertex | RHI_Shader_Compute, m_buffer_object_gpu);
     }
 
-    bool Renderer::UpdateLightBuffer(RHI_CommandList* cmd_list, const Light* light)
+    bool Renderer::UpdateLightBuffer(RHI_CommandList* cmd_list, const SnapshotLight* light)
     {
         if (!cmd_list)
         {
@@ -506,29 +537,29 @@ namespace Spartan
             return false;
         }
 
-        for (uint32_t i = 0; i < light->GetShadowArraySize(); i++)
+        for (uint32_t i = 0; i < light->shadow_array_size; i++)
         {
-            m_buffer_light_cpu.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i);
+            m_buffer_light_cpu.view_projection[i] = light->view_projection[i];
         }
 
         // Convert luminous power to luminous intensity
-        float luminous_intensity = light->GetIntensity() * m_camera->GetExposure();
-        if (light->GetLightType() == LightType::Point)
+        float luminous_intensity = light->intensity * m_snapshot->camera.exposure;
+        if (light->type == LightType::Point)
         {
             luminous_intensity /= Math::Helper::PI_4; // lumens to candelas
             luminous_intensity *= 255.0f; // this is a hack, must fix whats my color units
         }
-        else if (light->GetLightType() == LightType::Spot)
+        else if (light->type == LightType::Spot)
         {
             luminous_intensity /= Math::Helper::PI; // lumens to candelas
             luminous_intensity *= 255.0f; // this is a hack, must fix whats my color units
         }
 
-        m_buffer_light_cpu.intensity_range_angle_bias   = Vector4(luminous_intensity, light->GetRange(), light->GetAngle(), GetOption(Render_ReverseZ) ? light->GetBias() : -light->GetBias());
-        m_buffer_light_cpu.color                        = light->GetColor();
-        m_buffer_light_cpu.normal_bias                  = light->GetNormalBias();
-        m_buffer_light_cpu.position                     = light->GetTransform()->GetPosition();
-        m_buffer_light_cpu.direction                    = light->GetDirection();
+        m_buffer_light_cpu.intensity_range_angle_bias   = Vector4(luminous_intensity, light->range, light->angle, GetOption(Render_ReverseZ) ? light->bias : -light->bias);
+        m_buffer_light_cpu.color                        = light->color;
+        m_buffer_light_cpu.normal_bias                  = light->normal_bias;
+        m_buffer_light_cpu.position                     = light->position;
+        m_buffer_light_cpu.direction                    = light->direction;
 
         if (!update_dynamic_buffer<BufferLight>(cmd_list, m_buffer_light_gpu.get(), m_buffer_light_cpu, m_buffer_light_cpu_previous, m_buffer_light_offset_index))
             return false;
@@ -537,86 +568,110 @@ namespace Spartan
         return cmd_list->SetConstantBuffer(4, RHI_Shader_Pixel, m_buffer_light_gpu);
     }
 
-    void Renderer::RenderablesAcquire(const Variant& entities_variant)
+    bool Renderer::UpdateInstanceBuffer(RHI_CommandList* cmd_list, const uint32_t instance_count)
     {
-        SCOPED_TIME_BLOCK(m_profiler);
-
-        // Clear previous state
-        m_entities.clear();
-        m_camera = nullptr;
-
-        vector<shared_ptr<Entity>> entities = entities_variant.Get<vector<shared_ptr<Entity>>>();
-        for (const auto& entity : entities)
+        if (!cmd_list)
         {
-            if (!entity || !entity->IsActive())
-                continue;
+            LOG_ERROR("Invalid command list");
+            return false;
+        }
 
-            // Get all the components we are interested in
-            Renderable* renderable  = entity->GetComponent<Renderable>();
-            Light* light            = entity->GetComponent<Light>();
-            Camera* camera          = entity->GetComponent<Camera>();
+        if (instance_count == 0 || instance_count > renderer_max_instances)
+        {
+            LOG_ERROR("Invalid instance count %d", instance_count);
+            return false;
+        }
 
-            if (renderable)
-            {
-                bool is_transparent = false;
+        // Every instanced draw gets a new offset, comparing against the previous contents isn't worth it
+        if (!advance_dynamic_buffer<BufferInstance>(cmd_list, m_buffer_instance_gpu.get(), m_buffer_instance_offset_index))
+            return false;
 
-                if (const Material* material = renderable->GetMaterial())
-                {
-                    is_transparent = material->GetColorAlbedo().w < 1.0f;
-                }
+        // Map
+        std::byte* buffer = static_cast<std::byte*>(m_buffer_instance_gpu->Map());
+        if (!buffer)
+        {
+            LOG_ERROR("Failed to map buffer");
+            return false;
+        }
 
-                m_entities[is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque].emplace_back(entity.get());
-            }
+        const uint64_t size   = m_buffer_instance_gpu->GetStride();
+        const uint64_t offset = m_buffer_instance_offset_index * size;
+        if (m_buffer_instance_gpu->IsDynamic())
+        {
+            buffer += offset;
+        }
 
-            if (light)
-            {
-                m_entities[Renderer_Object_Light].emplace_back(entity.get());
-            }
+        // Update, only the instances that will be drawn
+        const size_t size_used = instance_count * sizeof(Matrix);
+        memcpy(buffer + offsetof(BufferInstance, transform), m_buffer_instance_cpu.transform, size_used);
+        memcpy(buffer + offsetof(BufferInstance, wvp_previous), m_buffer_instance_cpu.wvp_previous, size_used);
 
-            if (camera)
-            {
-                m_entities[Renderer_Object_Camera].emplace_back(entity.get());
-                m_camera = camera->GetPtrShared<Camera>();
-            }
-        }
+        // Unmap
+        if (!m_buffer_instance_gpu->Unmap(offset, size))
+            return false;
 
-        RenderablesSort(&m_entities[Renderer_Object_Opaque]);
-        RenderablesSort(&m_entities[Renderer_Object_Transparent]);
+        // Dynamic buffers with offsets have to be rebound whenever the offset changes
+        return cmd_list->SetConstantBuffer(5, RHI_Shader_Vertex, m_buffer_instance_gpu);
     }
 
-    void Renderer::RenderablesSort(vector<Entity*>* renderables)
+    void Renderer::RenderablesSort(const Renderer_Object_Type object_type)
     {
-        if (!m_camera || renderables->size() <= 2)
-            return;
+        const vector<SnapshotRenderable>& renderables   = m_snapshot->renderables[object_type];
+        vector<const SnapshotRenderable*>& sorted       = m_renderables[object_type];
+        const bool is_transparent                       = object_type == Renderer_Object_Transparent;
 
-        auto comparison_op = [this](Entity* entity)
+        sorted.clear();
+        if (renderables.size() <= 1)
         {
-            auto renderable = entity->GetRenderable();
-            if (!renderable)
-                return 0.0f;
+            for (const SnapshotRenderable& renderable : renderables)
+            {
+                sorted.emplace_back(&renderable);
+            }
+            return;
+        }
 
-            return (renderable->GetAabb().GetCenter() - m_camera->GetTransform()->GetPosition()).LengthSquared();
+        // Squared distances are positive, so their bits sort the same way the floats do
+        const Vector3& camera_position = m_snapshot->camera.position;
+        auto depth_bits = [&camera_position](const SnapshotRenderable& renderable)
+        {
+            const float distance_squared = (renderable.aabb.GetCenter() - camera_position).LengthSquared();
+            uint32_t bits;
+            memcpy(&bits, &distance_squared, sizeof(uint32_t));
+            return static_cast<uint64_t>(bits);
         };
 
-        // Sort by depth (front to back)
-        sort(renderables->begin(), renderables->end(), [&comparison_op](Entity* a, Entity* b)
-        {
-            return comparison_op(a) < comparison_op(b);
-        });
-    }
+        // Build the keys, one evaluation of each renderable instead of one per comparison
+        //   opaque:      | shader variation (14) | material (16) | geometry (16) | depth (18) | - state first, then front to back
+        //   transparent: | inverted depth (32) | shader variation (14) | material (16) | -        back to front, then state
+        // Ids are truncated, a collision only costs a rebind, never correctness.
+        m_draw_keys.clear();
+        for (const SnapshotRenderable& renderable : renderables)
+        {
+            const SnapshotMaterial* material    = renderable.material;
+            const uint64_t variation            = material ? (material->flags & 0x3FFF) : 0;
+            const uint64_t material_id          = material ? (material->id & 0xFFFF) : 0;
+            const uint64_t geometry_id          = renderable.model ? (renderable.model->GetId() & 0xFFFF) : 0;
+            const uint64_t depth                = depth_bits(renderable);
+
+            uint64_t key = 0;
+            if (is_transparent)
+            {
+                key = ((~depth & 0xFFFFFFFF) << 32) | (variation << 18) | (material_id << 2);
+            }
+            else
+            {
+                key = (variation << 50) | (material_id << 34) | (geometry_id << 18) | (depth >> 13);
+            }
 
-    void Renderer::ClearEntities()
-    {
-        m_rhi_device->Queue_WaitAll();
+            m_draw_keys.emplace_back(DrawKey{ key, &renderable });
+        }
 
-        // light depth buffers might be used by the command list
-        if (!m_swap_chain->GetCmdList()->Reset())
+        Utility::Sort::RadixSort(m_draw_keys, m_draw_keys_scratch);
+
+        for (const DrawKey& draw_key : m_draw_keys)
         {
-            LOG_ERROR("Failed to reset command pool");
-            return;
+            sorted.emplace_back(draw_key.renderable);
         }
-
-        m_entities.clear();
     }
 
     const shared_ptr<Spartan::RHI_Texture>& Renderer::GetEnvironmentTexture()
@@ -667,18 +722,16 @@ namespace Spartan
 
         m_option_values[option] = value;
 
-        // Shadow resolution handling
+        // Shadow resolution handling, snapshots keep their own references to the previous shadow maps
         if (option == Option_Value_ShadowResolution)
         {
-            const auto& light_entities = m_entities[Renderer_Object_Light];
-            for (const auto& light_entity : light_entities)
+            m_context->GetSubsystem<World>()->GetComponentPools()->Each<Light>([](Entity*, Light* light)
             {
-                auto light = light_entity->GetComponent<Light>();
                 if (light->GetShadowsEnabled())
                 {
                     light->CreateShadowMap();
                 }
-            }
+            });
         }
     }
 
@@ -24,12 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include <unordered_map>
 #include <array>
-#include <atomic>
+#include <mutex>
 #include "Renderer_ConstantBuffers.h"
 #include "Renderer_Enums.h"
 #include "Material.h"
 #include "../Core/ISubsystem.h"
 #include "../Math/Rectangle.h"
+#include "../Math/Frustum.h"
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Viewport.h"
 #include "../RHI/RHI_Vertex.h"
@@ -43,10 +44,14 @@ namespace Spartan
     class Light;
     class ResourceCache;
     class Font;
-    class Variant;
     class Grid;
     class Transform_Gizmo;
     class Profiler;
+    class RenderSnapshots;
+    struct RenderSnapshot;
+    struct SnapshotRenderable;
+    struct SnapshotMaterial;
+    struct SnapshotLight;
 
     namespace Math
     {
@@ -75,7 +80,11 @@ namespace Spartan
         void Tick(float delta_time) override;
         //===================================
 
-        // Debug draw
+        // Copies out everything the next Tick() reads from the world, called by the world once it has simulated a frame.
+        // Tick() runs alongside the simulation (on another thread), so it only ever reads the latest published snapshot.
+        void SnapshotPublish();
+
+        // Debug draw, the lines are published along with the snapshot (safe to call from any thread)
         void DrawDebugTick(const float delta_time);
         void DrawDebugLine(const Math::Vector3& from, const Math::Vector3& to, const Math::Vector4& color_from = DEBUG_COLOR, const Math::Vector4& color_to = DEBUG_COLOR, const float duration = 0.0f, const bool depth = true);
         void DrawDebugTriangle(const Math::Vector3& v0, const Math::Vector3& v1, const Math::Vector3& v2, const Math::Vector4& color = DEBUG_COLOR, const float duration = 0.0f, const bool depth = true);
@@ -145,7 +154,6 @@ namespace Spartan
         const auto& GetCamera()                             const { return m_camera; }
         auto IsInitialized()                                const { return m_initialized; }
         auto& GetShaders()                                  const { return m_shaders; }
-        bool IsRendering()                                  const { return m_is_rendering; }
         uint32_t GetMaxResolution() const;
 
         // Passes
@@ -203,12 +211,22 @@ namespace Spartan
         bool UpdateMaterialBuffer(RHI_CommandList* cmd_list);
         bool UpdateUberBuffer(RHI_CommandList* cmd_list);
         bool UpdateObjectBuffer(RHI_CommandList* cmd_list);
-        bool UpdateLightBuffer(RHI_CommandList* cmd_list, const Light* light);
-
-        // Misc
-        void RenderablesAcquire(const Variant& renderables);
-        void RenderablesSort(std::vector<Entity*>* renderables);
-        void ClearEntities();
+        bool UpdateLightBuffer(RHI_CommandList* cmd_list, const SnapshotLight* light);
+        bool UpdateInstanceBuffer(RHI_CommandList* cmd_list, uint32_t instance_count);
+
+        // Snapshot
+        void SnapshotClear();
+        void RenderablesSort(Renderer_Object_Type object_type);
+
+        // Culling
+        struct RenderBatch
+        {
+            uint32_t start = 0; // index into the visible renderables
+            uint32_t count = 0;
+        };
+        void Cull();
+        const std::vector<const SnapshotRenderable*>& GetRenderablesVisible(Renderer_Object_Type object_type, const SnapshotLight* light = nullptr, uint32_t slice = 0) const;
+        const std::vector<RenderBatch>& GetBatchesVisible(Renderer_Object_Type object_type, const SnapshotLight* light = nullptr, uint32_t slice = 0) const;
 
         // Render textures
         std::unordered_map<RendererRt, std::shared_ptr<RHI_Texture>> m_render_targets;
@@ -251,12 +269,13 @@ namespace Spartan
         std::shared_ptr<RHI_Sampler> m_sampler_trilinear_clamp;
         std::shared_ptr<RHI_Sampler> m_sampler_anisotropic_wrap;
 
-        // Line rendering
+        // Line rendering, the lines of every snapshot are kept until their duration expires
         std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer_lines;
         std::vector<RHI_Vertex_PosCol> m_lines_depth_disabled;
         std::vector<RHI_Vertex_PosCol> m_lines_depth_enabled;
         std::vector<float> m_lines_depth_disabled_duration;
         std::vector<float> m_lines_depth_enabled_duration;
+        std::mutex m_lines_mutex; // guards the lines of the snapshot being written
 
         // Gizmos
         std::unique_ptr<Transform_Gizmo> m_gizmo_transform;
@@ -284,7 +303,6 @@ namespace Spartan
         float m_far_plane                   = 0.0f;
         uint64_t m_frame_num                = 0;
         bool m_is_odd_frame                 = false;
-        std::atomic<bool> m_is_rendering    = false;
         bool m_brdf_specular_lut_rendered   = false;
         bool m_update_ortho_proj            = true;
 
@@ -322,11 +340,47 @@ namespace Spartan
         BufferLight m_buffer_light_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_gpu;
         uint32_t m_buffer_light_offset_index = 0;
+
+        BufferInstance m_buffer_instance_cpu;
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_instance_gpu;
+        uint32_t m_buffer_instance_offset_index = 0;
         //========================================================
 
-        // Entities and material references
-        std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities;
-        std::array<Material*, m_max_material_instances> m_material_instances;    
+        // Snapshots, the one being rendered and its renderables in draw order (opaque, transparent)
+        std::unique_ptr<RenderSnapshots> m_snapshots;
+        const RenderSnapshot* m_snapshot = nullptr;
+        std::array<std::vector<const SnapshotRenderable*>, 2> m_renderables;
+        Math::Matrix m_view_projection_previous = Math::Matrix::Identity;
+
+        // Culling, one view for the camera and one per shadow map slice
+        struct CullView
+        {
+            Math::Frustum frustum;
+            const SnapshotLight* light  = nullptr;
+            uint32_t slice              = 0;
+            bool ignore_depth           = false;
+            std::vector<const SnapshotRenderable*> visible[2];  // opaque, transparent (in m_renderables order)
+            std::vector<RenderBatch> batches[2];                // visible, split into runs which can be drawn instanced
+        };
+        std::vector<CullView> m_cull_views;
+        uint32_t m_cull_view_count = 0;
+        Math::BoundingBoxPacked m_cull_boxes;   // opaque followed by transparent
+        std::vector<uint8_t> m_cull_results;    // one row of m_cull_boxes.GetCountPadded() per view
+        std::array<const SnapshotMaterial*, m_max_material_instances> m_material_instances;
+
+        // Sorting, one key per renderable, rebuilt every frame
+        struct DrawKey
+        {
+            uint64_t key                         = 0;
+            const SnapshotRenderable* renderable = nullptr;
+        };
+        std::vector<DrawKey> m_draw_keys;
+        std::vector<DrawKey> m_draw_keys_scratch;
+
+        // Materials copied into the snapshot being written, so that renderables sharing one share the copy
+        std::unordered_map<const Material*, const SnapshotMaterial*> m_snapshot_materials;
+
+        // The active camera, as of the last snapshot (for the simulation, the renderer only reads the snapshot)
         std::shared_ptr<Camera> m_camera;
 
         // Dependencies
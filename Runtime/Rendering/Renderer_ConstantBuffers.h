@@ -186,6 +186,14 @@ namespace Spartan
         bool operator!=(const BufferObject& rhs) const { return !(*this == rhs); }
     };
     
+    // High frequency - Updates once per instanced draw, only the first instance_count elements are written
+    static const uint32_t renderer_max_instances = 128;
+    struct BufferInstance
+    {
+        Math::Matrix transform[renderer_max_instances];     // what the vertex shader multiplies with, see the passes
+        Math::Matrix wvp_previous[renderer_max_instances];
+    };
+
     // Light buffer
     struct BufferLight
     {
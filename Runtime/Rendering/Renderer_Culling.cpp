@@ -0,0 +1,222 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =============================
+#include "Spartan.h"
+#include "Renderer.h"
+#include "Renderer_Snapshot.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+//========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    // Renderables can share an instanced draw when everything but their transform is the same
+    static bool is_instance_of(const SnapshotRenderable* a, const SnapshotRenderable* b)
+    {
+        if (!a->model)
+            return false;
+
+        return
+            a->model           == b->model          &&
+            a->index_offset    == b->index_offset   &&
+            a->index_count     == b->index_count    &&
+            a->vertex_offset   == b->vertex_offset  &&
+            a->material        == b->material       &&
+            a->cast_shadows    == b->cast_shadows;
+    }
+
+    void Renderer::Cull()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        const vector<const SnapshotRenderable*>& renderables_opaque      = m_renderables[Renderer_Object_Opaque];
+        const vector<const SnapshotRenderable*>& renderables_transparent = m_renderables[Renderer_Object_Transparent];
+
+        // Collect the views, the camera always comes first
+        m_cull_view_count = 0;
+        auto add_view = [this](const Frustum& frustum, const SnapshotLight* light, const uint32_t slice, const bool ignore_depth)
+        {
+            if (m_cull_view_count == m_cull_views.size())
+            {
+                m_cull_views.emplace_back();
+            }
+
+            CullView& view      = m_cull_views[m_cull_view_count++];
+            view.frustum        = frustum;
+            view.light          = light;
+            view.slice          = slice;
+            view.ignore_depth   = ignore_depth;
+        };
+
+        add_view(m_snapshot->camera.frustum, nullptr, 0, false);
+        for (const SnapshotLight& light : m_snapshot->lights)
+        {
+            if (!light.shadows_enabled)
+                continue;
+
+            for (uint32_t slice = 0; slice < light.shadow_array_size; slice++)
+            {
+                add_view(light.frustum[slice], &light, slice, light.frustum_ignore_depth);
+            }
+        }
+
+        // Pack the bounding boxes, levels of detail were already picked by the simulation
+        m_cull_boxes.Clear();
+        for (const SnapshotRenderable* renderable : renderables_opaque)
+        {
+            m_cull_boxes.Add(renderable->aabb);
+        }
+        for (const SnapshotRenderable* renderable : renderables_transparent)
+        {
+            m_cull_boxes.Add(renderable->aabb);
+        }
+
+        const uint32_t box_count    = m_cull_boxes.GetCountPadded();
+        const uint32_t group_count  = box_count / BoundingBoxPacked::group_size;
+        if (group_count == 0)
+        {
+            for (uint32_t i = 0; i < m_cull_view_count; i++)
+            {
+                m_cull_views[i].visible[0].clear();
+                m_cull_views[i].visible[1].clear();
+                m_cull_views[i].batches[0].clear();
+                m_cull_views[i].batches[1].clear();
+            }
+            return;
+        }
+
+        m_cull_results.resize(static_cast<size_t>(m_cull_view_count) * box_count);
+
+        // Test every view against every group of boxes, a chunk can span the end of one view and the start of the next
+        Threading* threading = m_context->GetSubsystem<Threading>();
+        threading->ParallelFor(m_cull_view_count * group_count, [this, group_count, box_count](const uint32_t start, const uint32_t end)
+        {
+            for (uint32_t i = start; i < end;)
+            {
+                const uint32_t view_index   = i / group_count;
+                const uint32_t group_start  = i % group_count;
+                const uint32_t group_end    = Helper::Min(group_count, group_start + (end - i));
+                const CullView& view        = m_cull_views[view_index];
+                uint8_t* results            = &m_cull_results[static_cast<size_t>(view_index) * box_count];
+
+                view.frustum.Cull(m_cull_boxes, group_start * BoundingBoxPacked::group_size, group_end * BoundingBoxPacked::group_size, results, view.ignore_depth);
+
+                i += group_end - group_start;
+            }
+        });
+
+        // Compact the results into per view lists which keep the sorting of m_renderables
+        const uint32_t opaque_count     = static_cast<uint32_t>(renderables_opaque.size());
+        const uint32_t renderable_count = m_cull_boxes.GetCount();
+        threading->ParallelFor(m_cull_view_count, [this, &renderables_opaque, &renderables_transparent, opaque_count, renderable_count, box_count](const uint32_t start, const uint32_t end)
+        {
+            for (uint32_t view_index = start; view_index < end; view_index++)
+            {
+                CullView& view          = m_cull_views[view_index];
+                const uint8_t* results  = &m_cull_results[static_cast<size_t>(view_index) * box_count];
+
+                view.visible[0].clear();
+                view.visible[1].clear();
+                for (uint32_t i = 0; i < renderable_count; i++)
+                {
+                    if (!results[i])
+                        continue;
+
+                    if (i < opaque_count)
+                    {
+                        view.visible[0].emplace_back(renderables_opaque[i]);
+                    }
+                    else
+                    {
+                        view.visible[1].emplace_back(renderables_transparent[i - opaque_count]);
+                    }
+                }
+
+                // Group the runs of identical opaque geometry (the sort puts them next to each other).
+                // Transparent renderables stay one per batch, merging them would break their back to front order.
+                for (uint32_t type = 0; type < 2; type++)
+                {
+                    const vector<const SnapshotRenderable*>& visible    = view.visible[type];
+                    vector<RenderBatch>& batches                        = view.batches[type];
+                    batches.clear();
+
+                    for (uint32_t i = 0; i < static_cast<uint32_t>(visible.size()); i++)
+                    {
+                        const bool extend =
+                            type == 0                                                   &&
+                            !batches.empty()                                            &&
+                            batches.back().count < renderer_max_instances               &&
+                            is_instance_of(visible[batches.back().start], visible[i]);
+
+                        if (extend)
+                        {
+                            batches.back().count++;
+                        }
+                        else
+                        {
+                            batches.emplace_back(RenderBatch{ i, 1 });
+                        }
+                    }
+                }
+            }
+        }, 1);
+    }
+
+    const vector<Renderer::RenderBatch>& Renderer::GetBatchesVisible(const Renderer_Object_Type object_type, const SnapshotLight* light /*= nullptr*/, const uint32_t slice /*= 0*/) const
+    {
+        static const vector<RenderBatch> empty;
+
+        if (object_type != Renderer_Object_Opaque && object_type != Renderer_Object_Transparent)
+            return empty;
+
+        for (uint32_t i = 0; i < m_cull_view_count; i++)
+        {
+            const CullView& view = m_cull_views[i];
+            if (view.light == light && view.slice == slice)
+                return view.batches[object_type == Renderer_Object_Transparent ? 1 : 0];
+        }
+
+        return empty;
+    }
+
+    const vector<const SnapshotRenderable*>& Renderer::GetRenderablesVisible(const Renderer_Object_Type object_type, const SnapshotLight* light /*= nullptr*/, const uint32_t slice /*= 0*/) const
+    {
+        static const vector<const SnapshotRenderable*> empty;
+
+        if (object_type != Renderer_Object_Opaque && object_type != Renderer_Object_Transparent)
+            return empty;
+
+        for (uint32_t i = 0; i < m_cull_view_count; i++)
+        {
+            const CullView& view = m_cull_views[i];
+            if (view.light == light && view.slice == slice)
+                return view.visible[object_type == Renderer_Object_Transparent ? 1 : 0];
+        }
+
+        return empty;
+    }
+}
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =============================
 #include "Spartan.h"
 #include "Renderer.h"
+#include "Renderer_Snapshot.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Transform.h"
 //========================================
@@ -68,21 +69,25 @@ namespace Spartan
 
     void Renderer::DrawDebugLine(const Vector3& from, const Vector3& to, const Vector4& color_from, const Vector4& color_to, const float duration /*= 0.0f*/, const bool depth /*= true*/)
     {
+        // Lines go out with the next published snapshot, Tick() keeps them until they expire
+        lock_guard<mutex> lock(m_lines_mutex);
+        SnapshotLines& lines = m_snapshots->GetWrite().lines;
+
         if (depth)
         {
-            m_lines_depth_enabled.emplace_back(from, color_from);
-            m_lines_depth_enabled_duration.emplace_back(duration);
+            lines.depth_enabled.emplace_back(from, color_from);
+            lines.depth_enabled_duration.emplace_back(duration);
 
-            m_lines_depth_enabled.emplace_back(to, color_to);
-            m_lines_depth_enabled_duration.emplace_back(duration);
+            lines.depth_enabled.emplace_back(to, color_to);
+            lines.depth_enabled_duration.emplace_back(duration);
         }
         else
         {
-            m_lines_depth_disabled.emplace_back(from, color_from);
-            m_lines_depth_disabled_duration.emplace_back(duration);
+            lines.depth_disabled.emplace_back(from, color_from);
+            lines.depth_disabled_duration.emplace_back(duration);
 
-            m_lines_depth_disabled.emplace_back(to, color_to);
-            m_lines_depth_disabled_duration.emplace_back(duration);
+            lines.depth_disabled.emplace_back(to, color_to);
+            lines.depth_disabled_duration.emplace_back(duration);
         }
     }
 
@@ -87,8 +87,14 @@ namespace Spartan
     enum class RendererShader
     {
         Gbuffer_V,
+        Gbuffer_Instanced_V,
+        Gbuffer_Packed_V,
+        Gbuffer_Instanced_Packed_V,
         Gbuffer_P,
         Depth_V,
+        Depth_Instanced_V,
+        Depth_Packed_V,
+        Depth_Instanced_Packed_V,
         Depth_P,
         Quad_V,
         Texture_P,
@@ -128,6 +134,7 @@ namespace Spartan
         Ssgi_C,
         Ssr_C,
         Entity_V,
+        Entity_Packed_V,
         Entity_Transform_P,
         BlurBox_P,
         BlurGaussian_P,
@@ -205,7 +212,8 @@ namespace Spartan
         Option_Value_Gamma,
         Option_Value_Bloom_Intensity,
         Option_Value_Sharpen_Strength,
-        Option_Value_Fog
+        Option_Value_Fog,
+        Option_Value_Lod_Threshold
     };
 
     // Tonemapping
@@ -22,23 +22,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============================
 #include "Spartan.h"
 #include "Renderer.h"
+#include "Renderer_Snapshot.h"
 #include "Model.h"
 #include "ShaderGBuffer.h"
 #include "ShaderLight.h"
 #include "Font/Font.h"
 #include "Gizmos/Grid.h"
-#include "Gizmos/Transform_Gizmo.h"
 #include "../Profiling/Profiler.h"
 #include "../RHI/RHI_CommandList.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_PipelineState.h"
 #include "../RHI/RHI_Texture.h"
-#include "../World/Entity.h"
-#include "../World/Components/Camera.h"
 #include "../World/Components/Light.h"
-#include "../World/Components/Transform.h"
-#include "../World/Components/Renderable.h"
 //=========================================
 
 //= NAMESPACES ===============
@@ -83,7 +79,7 @@ namespace Spartan
         // Runs only once
         Pass_BrdfSpecularLut(cmd_list);
         
-        const bool draw_transparent_objects = !m_entities[Renderer_Object_Transparent].empty();
+        const bool draw_transparent_objects = !m_renderables[Renderer_Object_Transparent].empty();
         
         // Depth
         {
@@ -164,42 +160,41 @@ namespace Spartan
         // Transparent objects, read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
 
         // Acquire shader
-        RHI_Shader* shader_v = m_shaders[RendererShader::Depth_V].get();
-        RHI_Shader* shader_p = m_shaders[RendererShader::Depth_P].get();
+        RHI_Shader* shader_v                    = m_shaders[RendererShader::Depth_V].get();
+        RHI_Shader* shader_v_instanced          = m_shaders[RendererShader::Depth_Instanced_V].get();
+        RHI_Shader* shader_v_packed             = m_shaders[RendererShader::Depth_Packed_V].get();
+        RHI_Shader* shader_v_instanced_packed   = m_shaders[RendererShader::Depth_Instanced_Packed_V].get();
+        RHI_Shader* shader_p                    = m_shaders[RendererShader::Depth_P].get();
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
 
-        // Get entities
-        const auto& entities = m_entities[object_type];
-        if (entities.empty())
+        // Get renderables
+        if (m_renderables[object_type].empty())
             return;
 
         const bool transparent_pass = object_type == Renderer_Object_Transparent;
 
         // Go through all of the lights
-        const auto& entities_light = m_entities[Renderer_Object_Light];
-        for (uint32_t light_index = 0; light_index < entities_light.size(); light_index++)
+        for (const SnapshotLight& snapshot_light : m_snapshot->lights)
         {
-            const Light* light = entities_light[light_index]->GetComponent<Light>();
+            const SnapshotLight* light = &snapshot_light;
 
             // Skip some obvious cases
-            if (!light || !light->GetShadowsEnabled())
+            if (!light->shadows_enabled)
                 continue;
 
             // Skip lights that don't cast transparent shadows (if this is a transparent pass)
-            if (transparent_pass && !light->GetShadowsTransparentEnabled())
+            if (transparent_pass && !light->shadows_transparent_enabled)
                 continue;
 
             // Acquire light's shadow maps
-            RHI_Texture* tex_depth = light->GetDepthTexture();
-            RHI_Texture* tex_color = light->GetColorTexture();
+            RHI_Texture* tex_depth = light->texture_depth.get();
+            RHI_Texture* tex_color = light->texture_color.get();
             if (!tex_depth)
                 continue;
 
             // Set render state
             static RHI_PipelineState pipeline_state;
-            pipeline_state.shader_vertex                    = shader_v;
-            pipeline_state.vertex_buffer_stride             = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
             pipeline_state.shader_pixel                     = transparent_pass ? shader_p : nullptr;
             pipeline_state.blend_state                      = transparent_pass ? m_blend_alpha.get() : m_blend_disabled.get();
             pipeline_state.depth_stencil_state              = transparent_pass ? m_depth_stencil_on_off_r.get() : m_depth_stencil_on_off_w.get();
@@ -220,14 +215,14 @@ namespace Spartan
                 pipeline_state.clear_color[0] = Vector4::One;
                 pipeline_state.clear_depth    = transparent_pass ? rhi_depth_load : GetClearDepth();
 
-                const Matrix& view_projection = light->GetViewMatrix(array_index) * light->GetProjectionMatrix(array_index);
+                const Matrix& view_projection = light->view_projection[array_index];
 
                 // Set appropriate rasterizer state
-                if (light->GetLightType() == LightType::Directional)
+                if (light->type == LightType::Directional)
                 {
                     // "Pancaking" - https://www.gamedev.net/forums/topic/639036-shadow-mapping-and-high-up-objects/
                     // It's basically a way to capture the silhouettes of potential shadow casters behind the light's view point.
-                    // Of course we also have to make sure that the light doesn't cull them in the first place (this is done automatically by the light)
+                    // Of course we also have to make sure that the light doesn't cull them in the first place (Cull() ignores the near and far planes of directional lights)
                     pipeline_state.rasterizer_state = m_rasterizer_light_directional.get();
                 }
                 else
@@ -235,75 +230,113 @@ namespace Spartan
                     pipeline_state.rasterizer_state = m_rasterizer_light_point_spot.get();
                 }
 
-                // State tracking
-                bool render_pass_active     = false;
-                uint32_t m_set_material_id  = 0;
+                // Only the renderables inside this slice's frustum (culled in Cull())
+                const vector<const SnapshotRenderable*>& renderables_visible    = GetRenderablesVisible(object_type, light, array_index);
+                const vector<RenderBatch>& batches                              = GetBatchesVisible(object_type, light, array_index);
 
-                for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
+                // Single entities first, then the instanced batches, then both again for packed vertices.
+                // They need a different vertex shader (and input layout) and therefore a render pass of their own.
+                for (uint32_t variant = 0; variant < 4; variant++)
                 {
-                    Entity* entity = entities[entity_index];
-
-                    // Acquire renderable component
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
+                    const bool instanced                = (variant & 1) != 0;
+                    const bool packed                   = (variant & 2) != 0;
+                    pipeline_state.shader_vertex        = packed ? (instanced ? shader_v_instanced_packed : shader_v_packed) : (instanced ? shader_v_instanced : shader_v);
+                    pipeline_state.vertex_buffer_stride = static_cast<uint32_t>(packed ? sizeof(RHI_Vertex_PosTexNorTanPacked) : sizeof(RHI_Vertex_PosTexNorTan));
+                    if (!pipeline_state.shader_vertex->IsCompiled())
                         continue;
 
-                    // Skip meshes that don't cast shadows
-                    if (!renderable->GetCastShadows())
-                        continue;
+                    // Until the instanced shader compiles, batches are drawn one entity at a time
+                    const bool instancing = (packed ? shader_v_instanced_packed : shader_v_instanced)->IsCompiled();
 
-                    // Acquire geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                    // State tracking
+                    bool render_pass_active     = false;
+                    uint32_t m_set_material_id  = 0;
 
-                    // Acquire material
-                    const auto& material = renderable->GetMaterial();
-                    if (!material)
-                        continue;
+                    for (const RenderBatch& batch : batches)
+                    {
+                        const bool draw_instanced = instancing && batch.count > 1;
+                        if (draw_instanced != instanced)
+                            continue;
 
-                    // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustrum(renderable, array_index))
-                        continue;
+                        // Every renderable in a batch shares the state of the first one
+                        const SnapshotRenderable* renderable = renderables_visible[batch.start];
 
-                    if (!render_pass_active)
-                    {
-                        render_pass_active = cmd_list->BeginRenderPass(pipeline_state);
-                    }
+                        // Skip meshes that don't cast shadows
+                        if (!renderable->cast_shadows)
+                            continue;
 
-                    // Bind material
-                    if (transparent_pass && m_set_material_id != material->GetId())
-                    {
-                        // Bind material textures
-                        RHI_Texture* tex_albedo = material->GetTexture_Ptr(Material_Color);
-                        cmd_list->SetTexture(RendererBindingsSrv::tex, tex_albedo ? tex_albedo : m_default_tex_white.get());
+                        // Acquire geometry
+                        const Model* model = renderable->model.get();
+                        if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexPacked() != packed)
+                            continue;
 
-                        // Update uber buffer with material properties
-                        m_buffer_uber_cpu.mat_albedo    = material->GetColorAlbedo();
-                        m_buffer_uber_cpu.mat_tiling_uv = material->GetTiling();
-                        m_buffer_uber_cpu.mat_offset_uv = material->GetOffset();
+                        // Acquire material
+                        const SnapshotMaterial* material = renderable->material;
+                        if (!material)
+                            continue;
 
-                        // Update constant buffer
-                        UpdateUberBuffer(cmd_list);
+                        if (!render_pass_active)
+                        {
+                            render_pass_active = cmd_list->BeginRenderPass(pipeline_state);
 
-                        m_set_material_id = material->GetId();
-                    }
+                            // A second render pass has to keep what the first one drew
+                            pipeline_state.clear_color[0]   = rhi_color_load;
+                            pipeline_state.clear_depth      = rhi_depth_load;
+                        }
 
-                    // Bind geometry
-                    cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                        // Bind material
+                        if (transparent_pass && m_set_material_id != material->id)
+                        {
+                            // Bind material textures
+                            RHI_Texture* tex_albedo = material->GetTexture(Material_Color);
+                            cmd_list->SetTexture(RendererBindingsSrv::tex, tex_albedo ? tex_albedo : m_default_tex_white.get());
 
-                    // Update uber buffer with cascade transform
-                    m_buffer_object_cpu.object = entity->GetTransform()->GetMatrix() * view_projection;
-                    if (!UpdateObjectBuffer(cmd_list))
-                        continue;
+                            // Update uber buffer with material properties
+                            m_buffer_uber_cpu.mat_albedo    = material->color_albedo;
+                            m_buffer_uber_cpu.mat_tiling_uv = material->tiling;
+                            m_buffer_uber_cpu.mat_offset_uv = material->offset;
 
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
-                }
+                            // Update constant buffer
+                            UpdateUberBuffer(cmd_list);
 
-                if (render_pass_active)
-                {
-                    cmd_list->EndRenderPass();
+                            m_set_material_id = material->id;
+                        }
+
+                        // Bind geometry
+                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
+
+                        if (draw_instanced)
+                        {
+                            // Update instance buffer with cascade transforms
+                            for (uint32_t i = 0; i < batch.count; i++)
+                            {
+                                m_buffer_instance_cpu.transform[i] = renderables_visible[batch.start + i]->transform * view_projection;
+                            }
+
+                            if (!UpdateInstanceBuffer(cmd_list, batch.count))
+                                continue;
+
+                            cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset, batch.count);
+                        }
+                        else
+                        {
+                            for (uint32_t i = 0; i < batch.count; i++)
+                            {
+                                // Update object buffer with cascade transform
+                                m_buffer_object_cpu.object = renderables_visible[batch.start + i]->transform * view_projection;
+                                if (!UpdateObjectBuffer(cmd_list))
+                                    continue;
+
+                                cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset);
+                            }
+                        }
+                    }
+
+                    if (render_pass_active)
+                    {
+                        cmd_list->EndRenderPass();
+                    }
                 }
             }
         }
@@ -315,9 +348,13 @@ namespace Spartan
         // just their depth information into a depth map.
 
         // Acquire required resources/data
-        const auto& shader_depth    = m_shaders[RendererShader::Depth_V];
-        const auto& tex_depth       = m_render_targets[RendererRt::Gbuffer_Depth];
-        const auto& entities        = m_entities[Renderer_Object_Opaque];
+        const auto& shader_depth                    = m_shaders[RendererShader::Depth_V];
+        const auto& shader_depth_instanced          = m_shaders[RendererShader::Depth_Instanced_V];
+        const auto& shader_depth_packed             = m_shaders[RendererShader::Depth_Packed_V];
+        const auto& shader_depth_instanced_packed   = m_shaders[RendererShader::Depth_Instanced_Packed_V];
+        const auto& tex_depth               = m_render_targets[RendererRt::Gbuffer_Depth];
+        const auto& renderables             = GetRenderablesVisible(Renderer_Object_Opaque);
+        const auto& batches                 = GetBatchesVisible(Renderer_Object_Opaque);
 
         // Ensure the shader has compiled
         if (!shader_depth->IsCompiled())
@@ -325,7 +362,6 @@ namespace Spartan
 
         // Set render state
         static RHI_PipelineState pipeline_state;
-        pipeline_state.shader_vertex                = shader_depth.get();
         pipeline_state.shader_pixel                 = nullptr;
         pipeline_state.rasterizer_state             = m_rasterizer_cull_back_solid.get();
         pipeline_state.blend_state                  = m_blend_disabled.get();
@@ -336,29 +372,47 @@ namespace Spartan
         pipeline_state.primitive_topology           = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                    = "Pass_DepthPrePass";
 
-        // Record commands
-        if (cmd_list->BeginRenderPass(pipeline_state))
-        { 
-            if (!entities.empty())
+        // Single entities first, then the instanced batches, then both again for packed vertices.
+        // They need a different vertex shader (and input layout) and therefore a render pass of their own.
+        for (uint32_t variant = 0; variant < 4; variant++)
+        {
+            const bool instanced                = (variant & 1) != 0;
+            const bool packed                   = (variant & 2) != 0;
+            pipeline_state.shader_vertex        = (packed ? (instanced ? shader_depth_instanced_packed : shader_depth_packed) : (instanced ? shader_depth_instanced : shader_depth)).get();
+            pipeline_state.vertex_buffer_stride = static_cast<uint32_t>(packed ? sizeof(RHI_Vertex_PosTexNorTanPacked) : sizeof(RHI_Vertex_PosTexNorTan));
+            if (!pipeline_state.shader_vertex->IsCompiled())
+                continue;
+
+            // Until the instanced shader compiles, batches are drawn one entity at a time
+            const bool instancing = (packed ? shader_depth_instanced_packed : shader_depth_instanced)->IsCompiled();
+
+            // The first pass clears, even if there is nothing to draw
+            const bool has_work = variant == 0 || any_of(batches.begin(), batches.end(), [&renderables, instancing, instanced, packed](const RenderBatch& batch)
+            {
+                const Model* model = renderables[batch.start]->model.get();
+                return (instancing && batch.count > 1) == instanced && model && model->IsVertexPacked() == packed;
+            });
+            if (!has_work)
+                continue;
+
+            // Record commands
+            if (cmd_list->BeginRenderPass(pipeline_state))
             {
                 // Variables that help reduce state changes
                 uint32_t currently_bound_geometry = 0;
 
-                // Draw opaque
-                for (const auto& entity : entities)
+                for (const RenderBatch& batch : batches)
                 {
-                    // Get renderable
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
+                    const bool draw_instanced = instancing && batch.count > 1;
+                    if (draw_instanced != instanced)
                         continue;
 
-                    // Get geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                    // Get renderable
+                    const SnapshotRenderable* renderable = renderables[batch.start];
 
-                    // Skip objects outside of the view frustum
-                    if (!m_camera->IsInViewFrustrum(renderable))
+                    // Get geometry
+                    const Model* model = renderable->model.get();
+                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexPacked() != packed)
                         continue;
 
                     // Bind geometry
@@ -369,32 +423,54 @@ namespace Spartan
                         currently_bound_geometry = model->GetId();
                     }
 
-                    // Update uber buffer with entity transform
-                    if (Transform* transform = entity->GetTransform())
+                    if (draw_instanced)
                     {
-                        // Update uber buffer with cascade transform
-                        m_buffer_uber_cpu.transform = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                        UpdateUberBuffer(cmd_list);
+                        // Update instance buffer with entity transforms
+                        for (uint32_t i = 0; i < batch.count; i++)
+                        {
+                            m_buffer_instance_cpu.transform[i] = renderables[batch.start + i]->transform * m_buffer_frame_cpu.view_projection;
+                        }
+
+                        if (!UpdateInstanceBuffer(cmd_list, batch.count))
+                            continue;
+
+                        cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset, batch.count);
                     }
+                    else
+                    {
+                        for (uint32_t i = 0; i < batch.count; i++)
+                        {
+                            // Update object buffer with entity transform (the shader reads g_object_transform)
+                            m_buffer_object_cpu.object = renderables[batch.start + i]->transform * m_buffer_frame_cpu.view_projection;
+                            if (!UpdateObjectBuffer(cmd_list))
+                                continue;
 
-                    // Draw    
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                            // Draw
+                            cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset);
+                        }
+                    }
                 }
+                cmd_list->EndRenderPass();
             }
-            cmd_list->EndRenderPass();
+
+            // The following passes keep the depth of the first one
+            pipeline_state.clear_depth = rhi_depth_load;
         }
     }
 
     void Renderer::Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass /*= false*/)
     {
         // Acquire required resources/shaders
-        RHI_Texture* tex_albedo       = m_render_targets[RendererRt::Gbuffer_Albedo].get();
-        RHI_Texture* tex_normal       = m_render_targets[RendererRt::Gbuffer_Normal].get();
-        RHI_Texture* tex_material     = m_render_targets[RendererRt::Gbuffer_Material].get();
-        RHI_Texture* tex_velocity     = m_render_targets[RendererRt::Gbuffer_Velocity].get();
-        RHI_Texture* tex_depth        = m_render_targets[RendererRt::Gbuffer_Depth].get();
-        RHI_Shader* shader_v          = m_shaders[RendererShader::Gbuffer_V].get();
-        ShaderGBuffer* shader_p       = static_cast<ShaderGBuffer*>(m_shaders[RendererShader::Gbuffer_P].get());
+        RHI_Texture* tex_albedo         = m_render_targets[RendererRt::Gbuffer_Albedo].get();
+        RHI_Texture* tex_normal         = m_render_targets[RendererRt::Gbuffer_Normal].get();
+        RHI_Texture* tex_material       = m_render_targets[RendererRt::Gbuffer_Material].get();
+        RHI_Texture* tex_velocity       = m_render_targets[RendererRt::Gbuffer_Velocity].get();
+        RHI_Texture* tex_depth          = m_render_targets[RendererRt::Gbuffer_Depth].get();
+        RHI_Shader* shader_v                    = m_shaders[RendererShader::Gbuffer_V].get();
+        RHI_Shader* shader_v_instanced          = m_shaders[RendererShader::Gbuffer_Instanced_V].get();
+        RHI_Shader* shader_v_packed             = m_shaders[RendererShader::Gbuffer_Packed_V].get();
+        RHI_Shader* shader_v_instanced_packed   = m_shaders[RendererShader::Gbuffer_Instanced_Packed_V].get();
+        ShaderGBuffer* shader_p                 = static_cast<ShaderGBuffer*>(m_shaders[RendererShader::Gbuffer_P].get());
 
         // Validate that the shader has compiled
         if (!shader_v->IsCompiled())
@@ -402,8 +478,6 @@ namespace Spartan
 
         // Set render state
         RHI_PipelineState pso;
-        pso.shader_vertex                   = shader_v;
-        pso.vertex_buffer_stride            = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
         pso.blend_state                     = m_blend_disabled.get();
         pso.rasterizer_state                = GetOption(Render_Debug_Wireframe) ? m_rasterizer_cull_back_wireframe.get() : m_rasterizer_cull_back_solid.get();
         pso.depth_stencil_state             = is_transparent_pass ? m_depth_stencil_on_on_w.get() : m_depth_stencil_on_off_w.get(); // GetOptionValue(Render_DepthPrepass) is not accounted for anymore, have to fix
@@ -426,6 +500,9 @@ namespace Spartan
         uint32_t material_bound_id = 0;
         m_material_instances.fill(nullptr);
 
+        const auto& renderables = GetRenderablesVisible(is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque);
+        const auto& batches     = GetBatchesVisible(is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque);
+
         // Iterate through all the G-Buffer shader variations
         for (const auto& it : ShaderGBuffer::GetVariations())
         {
@@ -439,126 +516,155 @@ namespace Spartan
             // Set pass name
             pso.pass_name = pso.shader_pixel->GetName().c_str();
 
-            bool render_pass_active = false;
-            auto& entities = m_entities[is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque];
-
-            // Record commands
-            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+            // Single entities first, then the instanced batches, then both again for packed vertices.
+            // They need a different vertex shader (and input layout) and therefore a render pass of their own.
+            for (uint32_t variant = 0; variant < 4; variant++)
             {
-                Entity* entity = entities[i];
-
-                // Get renderable
-                const auto& renderable = entity->GetRenderable();
-                if (!renderable)
+                const bool instanced        = (variant & 1) != 0;
+                const bool packed           = (variant & 2) != 0;
+                pso.shader_vertex           = packed ? (instanced ? shader_v_instanced_packed : shader_v_packed) : (instanced ? shader_v_instanced : shader_v);
+                pso.vertex_buffer_stride    = static_cast<uint32_t>(packed ? sizeof(RHI_Vertex_PosTexNorTanPacked) : sizeof(RHI_Vertex_PosTexNorTan));
+                if (!pso.shader_vertex->IsCompiled())
                     continue;
 
-                // Get material
-                Material* material = renderable->GetMaterial();
-                if (!material)
-                    continue;
+                // Until the instanced shader compiles, batches are drawn one entity at a time
+                const bool instancing = (packed ? shader_v_instanced_packed : shader_v_instanced)->IsCompiled();
 
-                // Skip objects with different shader requirements
-                if (!static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->GetFlags()))
-                    continue;
+                bool render_pass_active = false;
 
-                // Skip transparent objects that won't contribute
-                if (material->GetColorAlbedo().w == 0 && is_transparent_pass)
-                    continue;
+                // Record commands
+                for (const RenderBatch& batch : batches)
+                {
+                    const bool draw_instanced = instancing && batch.count > 1;
+                    if (draw_instanced != instanced)
+                        continue;
 
-                // Get geometry
-                const auto& model = renderable->GeometryModel();
-                if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                    continue;
+                    // Every renderable in a batch shares the state of the first one
+                    const SnapshotRenderable* renderable = renderables[batch.start];
 
-                // Skip objects outside of the view frustum
-                if (!m_camera->IsInViewFrustrum(renderable))
-                    continue;
+                    // Get material
+                    const SnapshotMaterial* material = renderable->material;
+                    if (!material)
+                        continue;
 
-                if (!render_pass_active)
-                {
-                    render_pass_active = cmd_list->BeginRenderPass(pso);
-                }
+                    // Skip objects with different shader requirements
+                    if (!static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->flags))
+                        continue;
 
-                // Set geometry (will only happen if not already set)
-                cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                    // Skip transparent objects that won't contribute
+                    if (material->color_albedo.w == 0 && is_transparent_pass)
+                        continue;
 
-                // Bind material
-                const bool firs_run       = material_index == 0;
-                const bool new_material   = material_bound_id != material->GetId();
-                if (firs_run || new_material)
-                {
-                    material_bound_id = material->GetId();
+                    // Get geometry
+                    const Model* model = renderable->model.get();
+                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexPacked() != packed)
+                        continue;
 
-                    // Keep track of used material instances (they get mapped to shaders)
-                    if (material_index + 1 < m_material_instances.size())
+                    if (!render_pass_active)
                     {
-                        // Advance index (0 is reserved for the sky)
-                        material_index++;
+                        render_pass_active = cmd_list->BeginRenderPass(pso);
 
-                        // Keep reference
-                        m_material_instances[material_index] = material;
+                        // Bind the material again, a new render pass starts with new descriptors
+                        material_bound_id = 0;
                     }
-                    else
+
+                    // Set geometry (will only happen if not already set)
+                    cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(model->GetVertexBuffer());
+
+                    // Bind material
+                    const bool firs_run       = material_index == 0;
+                    const bool new_material   = material_bound_id != material->id;
+                    if (firs_run || new_material)
                     {
-                        LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
-                    }
+                        material_bound_id = material->id;
 
-                    // Bind material textures        
-                    cmd_list->SetTexture(RendererBindingsSrv::material_albedo, material->GetTexture_Ptr(Material_Color));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_roughness, material->GetTexture_Ptr(Material_Roughness));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_metallic, material->GetTexture_Ptr(Material_Metallic));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_normal, material->GetTexture_Ptr(Material_Normal));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_height, material->GetTexture_Ptr(Material_Height));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_occlusion, material->GetTexture_Ptr(Material_Occlusion));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_emission, material->GetTexture_Ptr(Material_Emission));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_mask, material->GetTexture_Ptr(Material_Mask));
-                
-                    // Update uber buffer with material properties
-                    m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
-                    m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
-                    m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
-                    m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
-                    m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
-                    m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
-                    m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
-                    m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
-
-                    // Update constant buffer
-                    UpdateUberBuffer(cmd_list);
-                }
+                        // Keep track of used material instances (they get mapped to shaders)
+                        if (material_index + 1 < m_material_instances.size())
+                        {
+                            // Advance index (0 is reserved for the sky)
+                            material_index++;
+
+                            // Keep reference
+                            m_material_instances[material_index] = material;
+                        }
+                        else
+                        {
+                            LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
+                        }
+
+                        // Bind material textures        
+                        cmd_list->SetTexture(RendererBindingsSrv::material_albedo, material->GetTexture(Material_Color));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_roughness, material->GetTexture(Material_Roughness));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_metallic, material->GetTexture(Material_Metallic));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_normal, material->GetTexture(Material_Normal));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_height, material->GetTexture(Material_Height));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_occlusion, material->GetTexture(Material_Occlusion));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_emission, material->GetTexture(Material_Emission));
+                        cmd_list->SetTexture(RendererBindingsSrv::material_mask, material->GetTexture(Material_Mask));
                 
-                // Update uber buffer with entity transform
-                if (Transform* transform = entity->GetTransform())
-                {
-                    m_buffer_object_cpu.object          = transform->GetMatrix();
-                    m_buffer_object_cpu.wvp_current     = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                    m_buffer_object_cpu.wvp_previous    = transform->GetWvpLastFrame();
+                        // Update uber buffer with material properties
+                        m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
+                        m_buffer_uber_cpu.mat_albedo        = material->color_albedo;
+                        m_buffer_uber_cpu.mat_tiling_uv     = material->tiling;
+                        m_buffer_uber_cpu.mat_offset_uv     = material->offset;
+                        m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
+                        m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
+                        m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
+                        m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
 
-                    // Save matrix for velocity computation
-                    transform->SetWvpLastFrame(m_buffer_object_cpu.wvp_current);
+                        // Update constant buffer
+                        UpdateUberBuffer(cmd_list);
+                    }
 
-                    // Update object buffer
-                    if (!UpdateObjectBuffer(cmd_list))
-                        continue;
+                    if (draw_instanced)
+                    {
+                        // Update instance buffer with the transforms, the previous ones are for velocity computation
+                        for (uint32_t i = 0; i < batch.count; i++)
+                        {
+                            const SnapshotRenderable* instance      = renderables[batch.start + i];
+                            m_buffer_instance_cpu.transform[i]      = instance->transform;
+                            m_buffer_instance_cpu.wvp_previous[i]   = instance->transform_previous * m_view_projection_previous;
+                        }
+
+                        if (!UpdateInstanceBuffer(cmd_list, batch.count))
+                            continue;
+
+                        // Render
+                        cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset, batch.count);
+                        m_profiler->m_renderer_meshes_rendered += batch.count;
+                    }
+                    else
+                    {
+                        for (uint32_t i = 0; i < batch.count; i++)
+                        {
+                            // Update object buffer with the transform, the previous one is for velocity computation
+                            const SnapshotRenderable* instance  = renderables[batch.start + i];
+                            m_buffer_object_cpu.object          = instance->transform;
+                            m_buffer_object_cpu.wvp_current     = m_buffer_object_cpu.object * m_buffer_frame_cpu.view_projection;
+                            m_buffer_object_cpu.wvp_previous    = instance->transform_previous * m_view_projection_previous;
+                            if (!UpdateObjectBuffer(cmd_list))
+                                continue;
+
+                            // Render
+                            cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset);
+                            m_profiler->m_renderer_meshes_rendered++;
+                        }
+                    }
+
+                    // Clear only on first pass
+                    if (!cleared)
+                    {
+                        pso.ResetClearValues();
+                        cleared = true;
+                    }
                 }
-                
-                // Render    
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
-                m_profiler->m_renderer_meshes_rendered++;
 
-                // Clear only on first pass
-                if (!cleared)
+                if (render_pass_active)
                 {
-                    pso.ResetClearValues();
-                    cleared = true;
+                    cmd_list->EndRenderPass();
                 }
             }
-
-            if (render_pass_active)
-            {
-                cmd_list->EndRenderPass();
-            }
         }
     }
 
@@ -704,8 +810,8 @@ namespace Spartan
     void Renderer::Pass_Light(RHI_CommandList* cmd_list, const bool is_transparent_pass /*= false*/)
     {
         // Acquire lights
-        const vector<Entity*>& entities = m_entities[Renderer_Object_Light];
-        if (entities.empty())
+        const vector<SnapshotLight>& lights = m_snapshot->lights;
+        if (lights.empty())
             return;
 
         // Acquire render targets
@@ -722,75 +828,73 @@ namespace Spartan
         static RHI_PipelineState pipeline_state;
         pipeline_state.pass_name = "Pass_Light";
 
-        // Iterate through all the light entities
-        for (const auto& entity : entities)
+        // Iterate through all the lights
+        for (const SnapshotLight& snapshot_light : lights)
         {
-            if (Light* light = entity->GetComponent<Light>())
+            const SnapshotLight* light = &snapshot_light;
+            if (light->intensity != 0)
             {
-                if (light->GetIntensity() != 0)
-                {
-                    // Set pixel shader
-                    pipeline_state.shader_compute = static_cast<RHI_Shader*>(ShaderLight::GetVariation(m_context, light, m_options, is_transparent_pass));
+                // Set pixel shader
+                pipeline_state.shader_compute = static_cast<RHI_Shader*>(ShaderLight::GetVariation(m_context, light, m_options, is_transparent_pass));
 
-                    // Skip the shader until it compiles or the users spots a compilation error
-                    if (!pipeline_state.shader_compute->IsCompiled())
-                        continue;
+                // Skip the shader until it compiles or the users spots a compilation error
+                if (!pipeline_state.shader_compute->IsCompiled())
+                    continue;
 
-                    // Draw
-                    if (cmd_list->BeginRenderPass(pipeline_state))
+                // Draw
+                if (cmd_list->BeginRenderPass(pipeline_state))
+                {
+                    // Update constant buffer (light pass will access it using material IDs)
+                    UpdateMaterialBuffer(cmd_list);
+
+                    cmd_list->SetTexture(RendererBindingsUav::rgb,              tex_diffuse);
+                    cmd_list->SetTexture(RendererBindingsUav::rgb2,             tex_specular);
+                    cmd_list->SetTexture(RendererBindingsUav::rgb3,             tex_volumetric);
+                    cmd_list->SetTexture(RendererBindingsSrv::gbuffer_albedo,   m_render_targets[RendererRt::Gbuffer_Albedo]);
+                    cmd_list->SetTexture(RendererBindingsSrv::gbuffer_normal,   m_render_targets[RendererRt::Gbuffer_Normal]);
+                    cmd_list->SetTexture(RendererBindingsSrv::gbuffer_material, m_render_targets[RendererRt::Gbuffer_Material]);
+                    cmd_list->SetTexture(RendererBindingsSrv::gbuffer_depth,    m_render_targets[RendererRt::Gbuffer_Depth]);
+                    cmd_list->SetTexture(RendererBindingsSrv::hbao,             (m_options & Render_Hbao) ? m_render_targets[RendererRt::Hbao_Blurred] : m_default_tex_white);
+                    cmd_list->SetTexture(RendererBindingsSrv::ssr,              (m_options & Render_ScreenSpaceReflections) ? m_render_targets[RendererRt::Ssr] : m_default_tex_transparent);
+                    cmd_list->SetTexture(RendererBindingsSrv::frame,            m_render_targets[RendererRt::Frame_Hdr_2]); // previous frame before post-processing
+
+                    // Set shadow map
+                    if (light->shadows_enabled)
                     {
-                        // Update constant buffer (light pass will access it using material IDs)
-                        UpdateMaterialBuffer(cmd_list);
-
-                        cmd_list->SetTexture(RendererBindingsUav::rgb,              tex_diffuse);
-                        cmd_list->SetTexture(RendererBindingsUav::rgb2,             tex_specular);
-                        cmd_list->SetTexture(RendererBindingsUav::rgb3,             tex_volumetric);
-                        cmd_list->SetTexture(RendererBindingsSrv::gbuffer_albedo,   m_render_targets[RendererRt::Gbuffer_Albedo]);
-                        cmd_list->SetTexture(RendererBindingsSrv::gbuffer_normal,   m_render_targets[RendererRt::Gbuffer_Normal]);
-                        cmd_list->SetTexture(RendererBindingsSrv::gbuffer_material, m_render_targets[RendererRt::Gbuffer_Material]);
-                        cmd_list->SetTexture(RendererBindingsSrv::gbuffer_depth,    m_render_targets[RendererRt::Gbuffer_Depth]);
-                        cmd_list->SetTexture(RendererBindingsSrv::hbao,             (m_options & Render_Hbao) ? m_render_targets[RendererRt::Hbao_Blurred] : m_default_tex_white);
-                        cmd_list->SetTexture(RendererBindingsSrv::ssr,              (m_options & Render_ScreenSpaceReflections) ? m_render_targets[RendererRt::Ssr] : m_default_tex_transparent);
-                        cmd_list->SetTexture(RendererBindingsSrv::frame,            m_render_targets[RendererRt::Frame_Hdr_2]); // previous frame before post-processing
-
-                        // Set shadow map
-                        if (light->GetShadowsEnabled())
-                        {
-                            RHI_Texture* tex_depth = light->GetDepthTexture();
-                            RHI_Texture* tex_color = light->GetShadowsTransparentEnabled() ? light->GetColorTexture() : m_default_tex_white.get();
+                        RHI_Texture* tex_depth = light->texture_depth.get();
+                        RHI_Texture* tex_color = light->shadows_transparent_enabled ? light->texture_color.get() : m_default_tex_white.get();
 
-                            if (light->GetLightType() == LightType::Directional)
-                            {
-                                cmd_list->SetTexture(RendererBindingsSrv::light_directional_depth, tex_depth);
-                                cmd_list->SetTexture(RendererBindingsSrv::light_directional_color, tex_color);
-                            }
-                            else if (light->GetLightType() == LightType::Point)
-                            {
-                                cmd_list->SetTexture(RendererBindingsSrv::light_point_depth, tex_depth);
-                                cmd_list->SetTexture(RendererBindingsSrv::light_point_color, tex_color);
-                            }
-                            else if (light->GetLightType() == LightType::Spot)
-                            {
-                                cmd_list->SetTexture(RendererBindingsSrv::light_spot_depth, tex_depth);
-                                cmd_list->SetTexture(RendererBindingsSrv::light_spot_color, tex_color);
-                            }
+                        if (light->type == LightType::Directional)
+                        {
+                            cmd_list->SetTexture(RendererBindingsSrv::light_directional_depth, tex_depth);
+                            cmd_list->SetTexture(RendererBindingsSrv::light_directional_color, tex_color);
+                        }
+                        else if (light->type == LightType::Point)
+                        {
+                            cmd_list->SetTexture(RendererBindingsSrv::light_point_depth, tex_depth);
+                            cmd_list->SetTexture(RendererBindingsSrv::light_point_color, tex_color);
                         }
+                        else if (light->type == LightType::Spot)
+                        {
+                            cmd_list->SetTexture(RendererBindingsSrv::light_spot_depth, tex_depth);
+                            cmd_list->SetTexture(RendererBindingsSrv::light_spot_color, tex_color);
+                        }
+                    }
 
-                        // Update light buffer
-                        UpdateLightBuffer(cmd_list, light);
+                    // Update light buffer
+                    UpdateLightBuffer(cmd_list, light);
 
-                        // Update uber buffer
-                        m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_diffuse->GetWidth()), static_cast<float>(tex_diffuse->GetHeight()));
-                        UpdateUberBuffer(cmd_list);
+                    // Update uber buffer
+                    m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_diffuse->GetWidth()), static_cast<float>(tex_diffuse->GetHeight()));
+                    UpdateUberBuffer(cmd_list);
 
-                        const uint32_t thread_group_count_x = static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(tex_diffuse->GetWidth()) / m_thread_group_count));
-                        const uint32_t thread_group_count_y = static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(tex_diffuse->GetHeight()) / m_thread_group_count));
-                        const uint32_t thread_group_count_z = 1;
-                        const bool async = false;
+                    const uint32_t thread_group_count_x = static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(tex_diffuse->GetWidth()) / m_thread_group_count));
+                    const uint32_t thread_group_count_y = static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(tex_diffuse->GetHeight()) / m_thread_group_count));
+                    const uint32_t thread_group_count_z = 1;
+                    const bool async = false;
 
-                        cmd_list->Dispatch(thread_group_count_x, thread_group_count_y, thread_group_count_z, async);
-                        cmd_list->EndRenderPass();
-                    }
+                    cmd_list->Dispatch(thread_group_count_x, thread_group_count_y, thread_group_count_z, async);
+                    cmd_list->EndRenderPass();
                 }
             }
         }
@@ -1714,12 +1818,10 @@ namespace Spartan
     
     void Renderer::Pass_Lines(RHI_CommandList* cmd_list, shared_ptr<RHI_Texture>& tex_out)
     {
-        const bool draw_picking_ray = m_options & Render_Debug_PickingRay;
-        const bool draw_aabb        = m_options & Render_Debug_Aabb;
+        // The picking ray, light and aabb lines are generated along with the snapshot, see SnapshotPublish()
         const bool draw_grid        = m_options & Render_Debug_Grid;
-        const bool draw_lights      = m_options & Render_Debug_Lights;
         const auto draw_lines       = !m_lines_depth_disabled.empty() || !m_lines_depth_enabled.empty(); // Any kind of lines, physics, user debug, etc.
-        const auto draw             = draw_picking_ray || draw_aabb || draw_grid || draw_lines || draw_lights;
+        const auto draw             = draw_grid || draw_lines;
         if (!draw)
             return;
 
@@ -1751,7 +1853,7 @@ namespace Spartan
             {
                 // Update uber buffer
                 m_buffer_uber_cpu.resolution    = m_resolution;
-                m_buffer_uber_cpu.transform     = m_gizmo_grid->ComputeWorldMatrix(m_camera->GetTransform()) * m_buffer_frame_cpu.view_projection_unjittered;
+                m_buffer_uber_cpu.transform     = m_gizmo_grid->ComputeWorldMatrix(m_snapshot->camera.position) * m_buffer_frame_cpu.view_projection_unjittered;
                 UpdateUberBuffer(cmd_list);
         
                 cmd_list->SetBufferIndex(m_gizmo_grid->GetIndexBuffer().get());
@@ -1761,53 +1863,6 @@ namespace Spartan
             }
         }
 
-        // Generate lines for debug primitives supported by the renderer
-        {
-            // Picking ray
-            if (draw_picking_ray)
-            {
-                const auto& ray = m_camera->GetPickingRay();
-                DrawDebugLine(ray.GetStart(), ray.GetStart() + ray.GetDirection() * m_camera->GetFarPlane(), Vector4(0, 1, 0, 1));
-            }
-
-            // Lights
-            if (draw_lights)
-            {
-                auto& lights = m_entities[Renderer_Object_Light];
-                for (const auto& entity : lights)
-                {
-                    Light* light = entity->GetComponent<Light>();
-
-                    if (light->GetLightType() == LightType::Spot)
-                    {
-                        Vector3 start = light->GetTransform()->GetPosition();
-                        Vector3 end = light->GetTransform()->GetForward() * light->GetRange();
-                        DrawDebugLine(start, start + end, Vector4(0, 1, 0, 1));
-                    }
-                }
-            }
-
-            // AABBs
-            if (draw_aabb)
-            {
-                for (const auto& entity : m_entities[Renderer_Object_Opaque])
-                {
-                    if (auto renderable = entity->GetRenderable())
-                    {
-                        DrawDebugBox(renderable->GetAabb(), Vector4(0.41f, 0.86f, 1.0f, 1.0f));
-                    }
-                }
-
-                for (const auto& entity : m_entities[Renderer_Object_Transparent])
-                {
-                    if (auto renderable = entity->GetRenderable())
-                    {
-                        DrawDebugBox(renderable->GetAabb(), Vector4(0.41f, 0.86f, 1.0f, 1.0f));
-                    }
-                }
-            }
-        }
-
         // Draw lines
         {
             // Width depth
@@ -1893,7 +1948,7 @@ namespace Spartan
             return;
 
         // Acquire resources
-        auto& lights                    = m_entities[Renderer_Object_Light];
+        const auto& lights              = m_snapshot->lights;
         const auto& shader_quad_v       = m_shaders[RendererShader::Quad_V];
         const auto& shader_texture_p    = m_shaders[RendererShader::Texture_P];
         if (lights.empty() || !shader_quad_v->IsCompiled() || !shader_texture_p->IsCompiled())
@@ -1913,60 +1968,56 @@ namespace Spartan
         pipeline_state.pass_name                        = "Pass_Icons";
 
         // For each light
-        for (const auto& entity : lights)
+        for (const SnapshotLight& light : lights)
         {
             if (cmd_list->BeginRenderPass(pipeline_state))
             {
-                // Light can be null if it just got removed and our buffer doesn't update till the next frame
-                if (Light* light = entity->GetComponent<Light>())
-                {
-                    auto position_light_world       = entity->GetTransform()->GetPosition();
-                    auto position_camera_world      = m_camera->GetTransform()->GetPosition();
-                    auto direction_camera_to_light  = (position_light_world - position_camera_world).Normalized();
-                    const float v_dot_l             = Vector3::Dot(m_camera->GetTransform()->GetForward(), direction_camera_to_light);
+                auto position_light_world       = light.position;
+                auto position_camera_world      = m_snapshot->camera.position;
+                auto direction_camera_to_light  = (position_light_world - position_camera_world).Normalized();
+                const float v_dot_l             = Vector3::Dot(m_snapshot->camera.forward, direction_camera_to_light);
         
-                    // Only draw if it's inside our view
-                    if (v_dot_l > 0.5f)
-                    {
-                        // Compute light screen space position and scale (based on distance from the camera)
-                        const auto position_light_screen    = m_camera->Project(position_light_world);
-                        const auto distance                 = (position_camera_world - position_light_world).Length() + Helper::EPSILON;
-                        auto scale                          = m_gizmo_size_max / distance;
-                        scale                               = Helper::Clamp(scale, m_gizmo_size_min, m_gizmo_size_max);
+                // Only draw if it's inside our view
+                if (v_dot_l > 0.5f)
+                {
+                    // Compute light screen space position and scale (based on distance from the camera)
+                    const auto position_light_screen    = light.position_screen;
+                    const auto distance                 = (position_camera_world - position_light_world).Length() + Helper::EPSILON;
+                    auto scale                          = m_gizmo_size_max / distance;
+                    scale                               = Helper::Clamp(scale, m_gizmo_size_min, m_gizmo_size_max);
         
-                        // Choose texture based on light type
-                        shared_ptr<RHI_Texture> light_tex = nullptr;
-                        const auto type = light->GetLightType();
-                        if (type == LightType::Directional) light_tex = m_gizmo_tex_light_directional;
-                        else if (type == LightType::Point)  light_tex = m_gizmo_tex_light_point;
-                        else if (type == LightType::Spot)   light_tex = m_gizmo_tex_light_spot;
+                    // Choose texture based on light type
+                    shared_ptr<RHI_Texture> light_tex = nullptr;
+                    const auto type = light.type;
+                    if (type == LightType::Directional) light_tex = m_gizmo_tex_light_directional;
+                    else if (type == LightType::Point)  light_tex = m_gizmo_tex_light_point;
+                    else if (type == LightType::Spot)   light_tex = m_gizmo_tex_light_spot;
         
-                        // Construct appropriate rectangle
-                        const auto tex_width = light_tex->GetWidth() * scale;
-                        const auto tex_height = light_tex->GetHeight() * scale;
-                        auto rectangle = Math::Rectangle
-                        (
-                            position_light_screen.x - tex_width * 0.5f,
-                            position_light_screen.y - tex_height * 0.5f,
-                            position_light_screen.x + tex_width,
-                            position_light_screen.y + tex_height
-                        );
-                        if (rectangle != m_gizmo_light_rect)
-                        {
-                            m_gizmo_light_rect = rectangle;
-                            m_gizmo_light_rect.CreateBuffers(this);
-                        }
+                    // Construct appropriate rectangle
+                    const auto tex_width = light_tex->GetWidth() * scale;
+                    const auto tex_height = light_tex->GetHeight() * scale;
+                    auto rectangle = Math::Rectangle
+                    (
+                        position_light_screen.x - tex_width * 0.5f,
+                        position_light_screen.y - tex_height * 0.5f,
+                        position_light_screen.x + tex_width,
+                        position_light_screen.y + tex_height
+                    );
+                    if (rectangle != m_gizmo_light_rect)
+                    {
+                        m_gizmo_light_rect = rectangle;
+                        m_gizmo_light_rect.CreateBuffers(this);
+                    }
         
-                        // Update uber buffer
-                        m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_width), static_cast<float>(tex_width));
-                        m_buffer_uber_cpu.transform = m_buffer_frame_cpu.view_projection_ortho;
-                        UpdateUberBuffer(cmd_list);
+                    // Update uber buffer
+                    m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_width), static_cast<float>(tex_width));
+                    m_buffer_uber_cpu.transform = m_buffer_frame_cpu.view_projection_ortho;
+                    UpdateUberBuffer(cmd_list);
         
-                        cmd_list->SetTexture(RendererBindingsSrv::tex, light_tex);
-                        cmd_list->SetBufferIndex(m_gizmo_light_rect.GetIndexBuffer());
-                        cmd_list->SetBufferVertex(m_gizmo_light_rect.GetVertexBuffer());
-                        cmd_list->DrawIndexed(Rectangle::GetIndexCount());
-                    }
+                    cmd_list->SetTexture(RendererBindingsSrv::tex, light_tex);
+                    cmd_list->SetBufferIndex(m_gizmo_light_rect.GetIndexBuffer());
+                    cmd_list->SetBufferVertex(m_gizmo_light_rect.GetVertexBuffer());
+                    cmd_list->DrawIndexed(Rectangle::GetIndexCount());
                 }
                 cmd_list->EndRenderPass();
             }
@@ -1984,8 +2035,9 @@ namespace Spartan
         if (!shader_gizmo_transform_v->IsCompiled() || !shader_gizmo_transform_p->IsCompiled())
             return;
 
-        // Transform
-        if (m_gizmo_transform->Update(m_camera.get(), m_gizmo_transform_size, m_gizmo_transform_speed))
+        // Transform, the handle was updated (and picked) by the simulation
+        const SnapshotTransformHandle& handle = m_snapshot->transform_handle;
+        if (handle.visible)
         {
             // Set render state
             static RHI_PipelineState pipeline_state;
@@ -1994,7 +2046,7 @@ namespace Spartan
             pipeline_state.rasterizer_state                 = m_rasterizer_cull_back_solid.get();
             pipeline_state.blend_state                      = m_blend_alpha.get();
             pipeline_state.depth_stencil_state              = m_depth_stencil_off_off.get();
-            pipeline_state.vertex_buffer_stride             = m_gizmo_transform->GetVertexBuffer()->GetStride();
+            pipeline_state.vertex_buffer_stride             = handle.vertex_buffer->GetStride();
             pipeline_state.render_target_color_textures[0]  = tex_out;
             pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
             pipeline_state.viewport                         = tex_out->GetViewport();
@@ -2003,13 +2055,13 @@ namespace Spartan
             pipeline_state.pass_name = "Pass_Gizmos_Axis_X";
             if (cmd_list->BeginRenderPass(pipeline_state))
             {
-                m_buffer_uber_cpu.transform         = m_gizmo_transform->GetHandle().GetTransform(Vector3::Right);
-                m_buffer_uber_cpu.transform_axis    = m_gizmo_transform->GetHandle().GetColor(Vector3::Right);
+                m_buffer_uber_cpu.transform         = handle.transform[0];
+                m_buffer_uber_cpu.transform_axis    = handle.color[0];
                 UpdateUberBuffer(cmd_list);
             
-                cmd_list->SetBufferIndex(m_gizmo_transform->GetIndexBuffer());
-                cmd_list->SetBufferVertex(m_gizmo_transform->GetVertexBuffer());
-                cmd_list->DrawIndexed(m_gizmo_transform->GetIndexCount());
+                cmd_list->SetBufferIndex(handle.index_buffer);
+                cmd_list->SetBufferVertex(handle.vertex_buffer);
+                cmd_list->DrawIndexed(handle.index_count);
                 cmd_list->EndRenderPass();
             }
             
@@ -2017,13 +2069,13 @@ namespace Spartan
             pipeline_state.pass_name = "Pass_Gizmos_Axis_Y";
             if (cmd_list->BeginRenderPass(pipeline_state))
             {
-                m_buffer_uber_cpu.transform         = m_gizmo_transform->GetHandle().GetTransform(Vector3::Up);
-                m_buffer_uber_cpu.transform_axis    = m_gizmo_transform->GetHandle().GetColor(Vector3::Up);
+                m_buffer_uber_cpu.transform         = handle.transform[1];
+                m_buffer_uber_cpu.transform_axis    = handle.color[1];
                 UpdateUberBuffer(cmd_list);
 
-                cmd_list->SetBufferIndex(m_gizmo_transform->GetIndexBuffer());
-                cmd_list->SetBufferVertex(m_gizmo_transform->GetVertexBuffer());
-                cmd_list->DrawIndexed(m_gizmo_transform->GetIndexCount());
+                cmd_list->SetBufferIndex(handle.index_buffer);
+                cmd_list->SetBufferVertex(handle.vertex_buffer);
+                cmd_list->DrawIndexed(handle.index_count);
                 cmd_list->EndRenderPass();
             }
             
@@ -2031,29 +2083,29 @@ namespace Spartan
             pipeline_state.pass_name = "Pass_Gizmos_Axis_Z";
             if (cmd_list->BeginRenderPass(pipeline_state))
             {
-                m_buffer_uber_cpu.transform         = m_gizmo_transform->GetHandle().GetTransform(Vector3::Forward);
-                m_buffer_uber_cpu.transform_axis    = m_gizmo_transform->GetHandle().GetColor(Vector3::Forward);
+                m_buffer_uber_cpu.transform         = handle.transform[2];
+                m_buffer_uber_cpu.transform_axis    = handle.color[2];
                 UpdateUberBuffer(cmd_list);
 
-                cmd_list->SetBufferIndex(m_gizmo_transform->GetIndexBuffer());
-                cmd_list->SetBufferVertex(m_gizmo_transform->GetVertexBuffer());
-                cmd_list->DrawIndexed(m_gizmo_transform->GetIndexCount());
+                cmd_list->SetBufferIndex(handle.index_buffer);
+                cmd_list->SetBufferVertex(handle.vertex_buffer);
+                cmd_list->DrawIndexed(handle.index_count);
                 cmd_list->EndRenderPass();
             }
             
             // Axes - XYZ
-            if (m_gizmo_transform->DrawXYZ())
+            if (handle.draw_xyz)
             {
                 pipeline_state.pass_name = "Pass_Gizmos_Axis_XYZ";
                 if (cmd_list->BeginRenderPass(pipeline_state))
                 {
-                    m_buffer_uber_cpu.transform         = m_gizmo_transform->GetHandle().GetTransform(Vector3::One);
-                    m_buffer_uber_cpu.transform_axis    = m_gizmo_transform->GetHandle().GetColor(Vector3::One);
+                    m_buffer_uber_cpu.transform         = handle.transform[3];
+                    m_buffer_uber_cpu.transform_axis    = handle.color[3];
                     UpdateUberBuffer(cmd_list);
 
-                    cmd_list->SetBufferIndex(m_gizmo_transform->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(m_gizmo_transform->GetVertexBuffer());
-                    cmd_list->DrawIndexed(m_gizmo_transform->GetIndexCount());
+                    cmd_list->SetBufferIndex(handle.index_buffer);
+                    cmd_list->SetBufferVertex(handle.vertex_buffer);
+                    cmd_list->DrawIndexed(handle.index_count);
                     cmd_list->EndRenderPass();
                 }
             }
@@ -2065,25 +2117,22 @@ namespace Spartan
         if (!GetOption(Render_Debug_SelectionOutline))
             return;
 
-        if (const Entity* entity = m_gizmo_transform->GetSelectedEntity())
+        if (m_snapshot->has_selection)
         {
-            // Get renderable
-            const Renderable* renderable = entity->GetRenderable();
-            if (!renderable)
-                return;
+            const SnapshotRenderable* renderable = &m_snapshot->selection;
 
             // Get material
-            const Material* material = renderable->GetMaterial();
+            const SnapshotMaterial* material = renderable->material;
             if (!material)
                 return;
 
             // Get geometry
-            const Model* model = renderable->GeometryModel();
+            const Model* model = renderable->model.get();
             if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
                 return;
 
             // Acquire shaders
-            const auto& shader_v = m_shaders[RendererShader::Entity_V];
+            const auto& shader_v = m_shaders[model->IsVertexPacked() ? RendererShader::Entity_Packed_V : RendererShader::Entity_V];
             const auto& shader_p = m_shaders[RendererShader::Entity_Outline_P];
             if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
                 return;
@@ -2109,19 +2158,16 @@ namespace Spartan
             // Record commands
             if (cmd_list->BeginRenderPass(pipeline_state))
             {
-                 // Update uber buffer with entity transform
-                if (Transform* transform = entity->GetTransform())
-                {
-                    m_buffer_uber_cpu.transform     = transform->GetMatrix();
-                    m_buffer_uber_cpu.resolution    = Vector2(tex_out->GetWidth(), tex_out->GetHeight());
-                    UpdateUberBuffer(cmd_list);
-                }
+                // Update uber buffer with the transform
+                m_buffer_uber_cpu.transform     = renderable->transform;
+                m_buffer_uber_cpu.resolution    = Vector2(tex_out->GetWidth(), tex_out->GetHeight());
+                UpdateUberBuffer(cmd_list);
 
                 cmd_list->SetTexture(RendererBindingsSrv::gbuffer_depth, tex_depth);
                 cmd_list->SetTexture(RendererBindingsSrv::gbuffer_normal, tex_normal);
                 cmd_list->SetBufferVertex(model->GetVertexBuffer());
                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                cmd_list->DrawIndexed(renderable->index_count, renderable->index_offset, renderable->vertex_offset);
                 cmd_list->EndRenderPass();
             }
         }
@@ -61,6 +61,9 @@ namespace Spartan
 
         m_buffer_light_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light", is_dynamic);
         m_buffer_light_gpu->Create<BufferLight>(m_swap_chain_buffer_count);
+
+        m_buffer_instance_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "instance", is_dynamic);
+        m_buffer_instance_gpu->Create<BufferInstance>(m_swap_chain_buffer_count);
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -191,6 +194,16 @@ namespace Spartan
         // G-Buffer
         m_shaders[RendererShader::Gbuffer_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+        m_shaders[RendererShader::Gbuffer_Instanced_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Gbuffer_Instanced_V]->AddDefine("INSTANCED");
+        m_shaders[RendererShader::Gbuffer_Instanced_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+        m_shaders[RendererShader::Gbuffer_Packed_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Gbuffer_Packed_V]->AddDefine("PACKED");
+        m_shaders[RendererShader::Gbuffer_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTanPacked>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+        m_shaders[RendererShader::Gbuffer_Instanced_Packed_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Gbuffer_Instanced_Packed_V]->AddDefine("INSTANCED");
+        m_shaders[RendererShader::Gbuffer_Instanced_Packed_V]->AddDefine("PACKED");
+        m_shaders[RendererShader::Gbuffer_Instanced_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTanPacked>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
 
         // Quad
         {
@@ -206,6 +219,16 @@ namespace Spartan
         // Depth Vertex
         m_shaders[RendererShader::Depth_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Depth_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[RendererShader::Depth_Instanced_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_Instanced_V]->AddDefine("INSTANCED");
+        m_shaders[RendererShader::Depth_Instanced_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[RendererShader::Depth_Packed_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_Packed_V]->AddDefine("PACKED");
+        m_shaders[RendererShader::Depth_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTanPacked>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[RendererShader::Depth_Instanced_Packed_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_Instanced_Packed_V]->AddDefine("INSTANCED");
+        m_shaders[RendererShader::Depth_Instanced_Packed_V]->AddDefine("PACKED");
+        m_shaders[RendererShader::Depth_Instanced_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTanPacked>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
         m_shaders[RendererShader::Depth_P] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Depth_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "Depth.hlsl");
 
@@ -338,6 +361,9 @@ namespace Spartan
         // Entity
         m_shaders[RendererShader::Entity_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Entity_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
+        m_shaders[RendererShader::Entity_Packed_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Entity_Packed_V]->AddDefine("PACKED");
+        m_shaders[RendererShader::Entity_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTanPacked>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
 
         // Entity - Transform
         m_shaders[RendererShader::Entity_Transform_P] = make_shared<RHI_Shader>(m_context);
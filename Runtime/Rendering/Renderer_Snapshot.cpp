@@ -0,0 +1,266 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =================================
+#include "Spartan.h"
+#include "Renderer.h"
+#include "Renderer_Snapshot.h"
+#include "Model.h"
+#include "Gizmos/Transform_Gizmo.h"
+#include "../Profiling/Profiler.h"
+#include "../World/World.h"
+#include "../World/Entity.h"
+#include "../World/ComponentPools.h"
+#include "../World/Components/Camera.h"
+#include "../World/Components/Light.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Transform.h"
+//============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    void Renderer::SnapshotPublish()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        RenderSnapshot& snapshot = m_snapshots->GetWrite();
+        snapshot.Clear();
+
+        // Only the entities owning the components we are interested in are visited, straight from their pools
+        const ComponentPools* pools = m_context->GetSubsystem<World>()->GetComponentPools().get();
+        auto is_visible = [](const Entity* entity) { return entity->IsActive() && !entity->IsPendingDestruction(); };
+
+        // Camera
+        m_camera = nullptr;
+        pools->Each<Camera>([this, &is_visible](Entity* entity, Camera* camera)
+        {
+            if (is_visible(entity))
+            {
+                m_camera = camera->GetPtrShared<Camera>();
+            }
+        });
+
+        if (m_camera)
+        {
+            const Transform* transform  = m_camera->GetTransform();
+            SnapshotCamera& camera      = snapshot.camera;
+            snapshot.has_camera         = true;
+            camera.view                 = m_camera->GetViewMatrix();
+            camera.projection           = m_camera->GetProjectionMatrix();
+            camera.position             = transform->GetPosition();
+            camera.forward              = transform->GetForward();
+            camera.near_plane           = m_camera->GetNearPlane();
+            camera.far_plane            = m_camera->GetFarPlane();
+            camera.aperture             = m_camera->GetAperture();
+            camera.shutter_speed        = m_camera->GetShutterSpeed();
+            camera.iso                  = m_camera->GetIso();
+            camera.exposure             = m_camera->GetExposure();
+            camera.frustum              = m_camera->GetFrustum();
+            camera.clear_color          = m_camera->GetClearColor();
+        }
+
+        // Transform handle, it picks and moves entities so it goes before their transforms are copied
+        if (GetOption(Render_Debug_Transform))
+        {
+            SnapshotTransformHandle& handle = snapshot.transform_handle;
+            handle.visible                  = m_gizmo_transform->Update(m_camera.get(), m_gizmo_transform_size, m_gizmo_transform_speed);
+            if (handle.visible)
+            {
+                static const Vector3 axes[SnapshotTransformHandle::axis_count] = { Vector3::Right, Vector3::Up, Vector3::Forward, Vector3::One };
+                for (uint32_t i = 0; i < SnapshotTransformHandle::axis_count; i++)
+                {
+                    handle.transform[i] = m_gizmo_transform->GetHandle().GetTransform(axes[i]);
+                    handle.color[i]     = m_gizmo_transform->GetHandle().GetColor(axes[i]);
+                }
+
+                handle.draw_xyz         = m_gizmo_transform->DrawXYZ();
+                handle.vertex_buffer    = m_gizmo_transform->GetVertexBuffer();
+                handle.index_buffer     = m_gizmo_transform->GetIndexBuffer();
+                handle.index_count      = m_gizmo_transform->GetIndexCount();
+            }
+        }
+
+        // Levels of detail are picked against the camera, the shadow views draw the same ones.
+        // Scales a model space error at a distance of one unit to pixels, orthographic cameras always get full detail.
+        const Vector3& camera_position  = snapshot.camera.position;
+        const bool is_perspective       = m_camera && m_camera->GetProjectionType() == Projection_Perspective;
+        const float lod_threshold       = is_perspective ? m_option_values[Option_Value_Lod_Threshold] : 0.0f;
+        const float projection_scale    = m_camera ? m_viewport.height / (2.0f * tan(m_camera->GetFovVerticalRad() * 0.5f)) : 1.0f;
+
+        // Materials, there can't be more than there are renderables so the reservation keeps the pointers to them stable
+        m_snapshot_materials.clear();
+        snapshot.materials.reserve(pools->GetCount(ComponentType::Renderable));
+        auto snapshot_material = [this, &snapshot](Material* material) -> const SnapshotMaterial*
+        {
+            if (!material)
+                return nullptr;
+
+            const SnapshotMaterial*& copy = m_snapshot_materials[material];
+            if (!copy)
+            {
+                SnapshotMaterial& item  = snapshot.materials.emplace_back();
+                item.id                 = material->GetId();
+                item.flags              = material->GetFlags();
+                item.color_albedo       = material->GetColorAlbedo();
+                item.tiling             = material->GetTiling();
+                item.offset             = material->GetOffset();
+                for (uint32_t i = 0; i < SnapshotMaterial::property_count; i++)
+                {
+                    const Material_Property type    = static_cast<Material_Property>(1 << i);
+                    item.properties[i]              = material->GetProperty(type);
+                    item.textures[i]                = material->GetTexture_PtrShared(type);
+                }
+                copy = &item;
+            }
+
+            return copy;
+        };
+
+        // Renderables
+        const Entity* selected = m_gizmo_transform->GetSelectedEntity();
+        pools->Each<Renderable>([this, &snapshot, &is_visible, &snapshot_material, &camera_position, lod_threshold, projection_scale, selected](Entity* entity, Renderable* renderable)
+        {
+            if (!is_visible(entity))
+                return;
+
+            Material* material          = renderable->GetMaterial();
+            const bool is_transparent   = material && material->GetColorAlbedo().w < 1.0f;
+
+            if (m_camera)
+            {
+                renderable->GeometryLodSelect(camera_position, projection_scale, lod_threshold);
+            }
+
+            // Models with packed vertices store positions relative to their bounds, the dequantization is folded into the world matrix
+            Transform* transform        = entity->GetTransform();
+            const Model* model          = renderable->GeometryModel();
+            SnapshotRenderable& item    = snapshot.renderables[is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque].emplace_back();
+            item.entity                 = entity;
+            item.model                  = renderable->GeometryModelShared();
+            item.material               = snapshot_material(material);
+            item.transform              = (model && model->IsVertexPacked()) ? model->GetVertexDequantization() * transform->GetMatrix() : transform->GetMatrix();
+            item.transform_previous     = transform->GetMatrixPrevious();
+            item.aabb                   = renderable->GetAabb();
+            item.index_offset           = renderable->GeometryLodIndexOffset();
+            item.index_count            = renderable->GeometryLodIndexCount();
+            item.vertex_offset          = renderable->GeometryVertexOffset();
+            item.cast_shadows           = renderable->GetCastShadows();
+
+            // Save matrix for velocity computation
+            transform->SetMatrixPrevious(item.transform);
+
+            if (entity == selected)
+            {
+                snapshot.selection      = item;
+                snapshot.has_selection  = true;
+            }
+        });
+
+        // Lights
+        pools->Each<Light>([this, &snapshot, &is_visible](Entity* entity, Light* light)
+        {
+            if (!is_visible(entity))
+                return;
+
+            SnapshotLight& item                 = snapshot.lights.emplace_back();
+            item.entity                         = entity;
+            item.type                           = light->GetLightType();
+            item.color                          = light->GetColor();
+            item.intensity                      = light->GetIntensity();
+            item.range                          = light->GetRange();
+            item.angle                          = light->GetAngle();
+            item.bias                           = light->GetBias();
+            item.normal_bias                    = light->GetNormalBias();
+            item.position                       = entity->GetTransform()->GetPosition();
+            item.direction                      = light->GetDirection();
+            item.position_screen                = m_camera ? m_camera->Project(item.position) : Vector2::Zero;
+            item.shadows_enabled                = light->GetShadowsEnabled();
+            item.shadows_screen_space_enabled   = light->GetShadowsScreenSpaceEnabled();
+            item.shadows_transparent_enabled    = light->GetShadowsTransparentEnabled();
+            item.volumetric_enabled             = light->GetVolumetricEnabled();
+            item.frustum_ignore_depth           = light->GetFrustumIgnoreDepth();
+            item.shadow_array_size              = Helper::Min(light->GetShadowArraySize(), SnapshotLight::slice_count_max);
+            item.texture_depth                  = light->GetDepthTexture();
+            item.texture_color                  = light->GetColorTexture();
+
+            for (uint32_t i = 0; i < item.shadow_array_size; i++)
+            {
+                item.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i);
+                item.frustum[i]         = light->GetFrustum(i);
+            }
+        });
+
+        // Lines for the debug primitives supported by the renderer
+        {
+            // Picking ray
+            if ((m_options & Render_Debug_PickingRay) && m_camera)
+            {
+                const auto& ray = m_camera->GetPickingRay();
+                DrawDebugLine(ray.GetStart(), ray.GetStart() + ray.GetDirection() * m_camera->GetFarPlane(), Vector4(0, 1, 0, 1));
+            }
+
+            // Lights
+            if (m_options & Render_Debug_Lights)
+            {
+                for (const SnapshotLight& light : snapshot.lights)
+                {
+                    if (light.type == LightType::Spot)
+                    {
+                        DrawDebugLine(light.position, light.position + light.direction * light.range, Vector4(0, 1, 0, 1));
+                    }
+                }
+            }
+
+            // AABBs
+            if (m_options & Render_Debug_Aabb)
+            {
+                for (const vector<SnapshotRenderable>& renderables : snapshot.renderables)
+                {
+                    for (const SnapshotRenderable& renderable : renderables)
+                    {
+                        DrawDebugBox(renderable.aabb, Vector4(0.41f, 0.86f, 1.0f, 1.0f));
+                    }
+                }
+            }
+        }
+
+        lock_guard<mutex> lock(m_lines_mutex);
+        m_snapshots->Publish();
+    }
+
+    void Renderer::SnapshotClear()
+    {
+        // The renderer keeps drawing the snapshot it has, the resources it references stay alive until it moves on to this one
+        m_camera = nullptr;
+
+        lock_guard<mutex> lock(m_lines_mutex);
+        RenderSnapshot& snapshot = m_snapshots->GetWrite();
+        snapshot.Clear();
+        snapshot.lines.Clear();
+        m_snapshots->Publish();
+    }
+}
@@ -0,0 +1,243 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===========================
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include "../Math/Matrix.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector4.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Frustum.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../World/Components/Light.h"
+#include "Material.h"
+//======================================
+
+namespace Spartan
+{
+    class Entity;
+    class Model;
+    class RHI_Texture;
+    class RHI_VertexBuffer;
+    class RHI_IndexBuffer;
+
+    // Everything the renderer reads from the world, copied out by the simulation at the end of its frame.
+    // Once published, a snapshot is never modified, the renderer records it while the simulation works on the next frame.
+    // Resources are held by reference so that they outlive the world which referenced them, entities are never dereferenced.
+
+    // The state of a material as of the snapshot, editing the material afterwards doesn't race the passes that bind it
+    struct SnapshotMaterial
+    {
+        static const uint32_t property_count = 14; // one per Material_Property bit
+
+        bool HasTexture(const Material_Property type)           const { return flags & type; }
+        RHI_Texture* GetTexture(const Material_Property type)   const { return HasTexture(type) ? textures[GetIndex(type)].get() : nullptr; }
+        float GetProperty(const Material_Property type)         const { return properties[GetIndex(type)]; }
+
+        static uint32_t GetIndex(const Material_Property type)
+        {
+            uint32_t index = 0;
+            while ((1u << index) < static_cast<uint32_t>(type)) index++;
+            return index;
+        }
+
+        uint32_t id                         = 0;
+        uint16_t flags                      = 0;
+        Math::Vector4 color_albedo          = Math::Vector4::One;
+        Math::Vector2 tiling                = Math::Vector2::One;
+        Math::Vector2 offset                = Math::Vector2::Zero;
+        std::array<float, property_count> properties = {};
+        std::array<std::shared_ptr<RHI_Texture>, property_count> textures;
+    };
+
+    struct SnapshotRenderable
+    {
+        const Entity* entity                = nullptr; // identity only
+        std::shared_ptr<Model> model;
+        const SnapshotMaterial* material    = nullptr; // in RenderSnapshot::materials, shared by every renderable using the same material
+        Math::Matrix transform              = Math::Matrix::Identity;   // world, with the vertex dequantization folded in
+        Math::Matrix transform_previous     = Math::Matrix::Identity;   // as of the previous snapshot, for velocity
+        Math::BoundingBox aabb;
+        uint32_t index_offset               = 0;                        // of the selected level of detail
+        uint32_t index_count                = 0;
+        uint32_t vertex_offset              = 0;
+        bool cast_shadows                   = true;
+    };
+
+    struct SnapshotLight
+    {
+        static const uint32_t slice_count_max = 6;
+
+        const Entity* entity                = nullptr; // identity only
+        LightType type                      = LightType::Directional;
+        Math::Vector4 color                 = Math::Vector4::One;
+        float intensity                     = 0.0f;
+        float range                         = 0.0f;
+        float angle                         = 0.0f;
+        float bias                          = 0.0f;
+        float normal_bias                   = 0.0f;
+        Math::Vector3 position              = Math::Vector3::Zero;
+        Math::Vector3 direction             = Math::Vector3::Forward;
+        Math::Vector2 position_screen       = Math::Vector2::Zero;      // for the editor icon
+        bool shadows_enabled                = false;
+        bool shadows_screen_space_enabled   = false;
+        bool shadows_transparent_enabled    = false;
+        bool volumetric_enabled             = false;
+        bool frustum_ignore_depth           = false;
+        uint32_t shadow_array_size          = 0;
+        std::array<Math::Matrix, slice_count_max> view_projection;
+        std::array<Math::Frustum, slice_count_max> frustum;
+        std::shared_ptr<RHI_Texture> texture_depth;
+        std::shared_ptr<RHI_Texture> texture_color;
+    };
+
+    struct SnapshotCamera
+    {
+        Math::Matrix view               = Math::Matrix::Identity;
+        Math::Matrix projection         = Math::Matrix::Identity;
+        Math::Vector3 position          = Math::Vector3::Zero;
+        Math::Vector3 forward           = Math::Vector3::Forward;
+        float near_plane                = 0.0f;
+        float far_plane                 = 0.0f;
+        float aperture                  = 0.0f;
+        float shutter_speed             = 0.0f;
+        float iso                       = 0.0f;
+        float exposure                  = 0.0f;
+        Math::Frustum frustum;
+        Math::Vector4 clear_color       = Math::Vector4::Zero;
+    };
+
+    struct SnapshotTransformHandle
+    {
+        static const uint32_t axis_count = 4; // x, y, z, xyz
+
+        bool visible                                        = false;
+        bool draw_xyz                                       = false;
+        const RHI_VertexBuffer* vertex_buffer               = nullptr;
+        const RHI_IndexBuffer* index_buffer                 = nullptr;
+        uint32_t index_count                                = 0;
+        std::array<Math::Matrix, axis_count> transform;
+        std::array<Math::Vector3, axis_count> color;
+    };
+
+    struct SnapshotLines
+    {
+        void Clear()
+        {
+            depth_enabled.clear();
+            depth_enabled_duration.clear();
+            depth_disabled.clear();
+            depth_disabled_duration.clear();
+        }
+
+        std::vector<RHI_Vertex_PosCol> depth_enabled;
+        std::vector<float> depth_enabled_duration;
+        std::vector<RHI_Vertex_PosCol> depth_disabled;
+        std::vector<float> depth_disabled_duration;
+    };
+
+    struct RenderSnapshot
+    {
+        // Everything but the lines, they are drawn throughout the frame
+        void Clear()
+        {
+            has_camera = false;
+            renderables[0].clear();
+            renderables[1].clear();
+            materials.clear();
+            lights.clear();
+            transform_handle.visible = false;
+            has_selection = false;
+            selection = SnapshotRenderable();
+        }
+
+        bool has_camera = false;
+        SnapshotCamera camera;
+        std::array<std::vector<SnapshotRenderable>, 2> renderables; // opaque, transparent
+        std::vector<SnapshotMaterial> materials;                    // reserved up front, renderables point into it
+        std::vector<SnapshotLight> lights;
+
+        // Editor
+        SnapshotTransformHandle transform_handle;
+        bool has_selection = false;
+        SnapshotRenderable selection;
+
+        // Debug
+        SnapshotLines lines;
+    };
+
+    // Hands snapshots from the simulation over to the renderer, without either of them waiting for the other.
+    // Of the three, one is being written, one is the latest published and one is being rendered.
+    class RenderSnapshots
+    {
+    public:
+        // Only the simulation writes, until it publishes
+        RenderSnapshot& GetWrite() { return m_snapshots[m_write]; }
+
+        void Publish()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // A snapshot the renderer never acquired is dropped, but its lines are carried over so none of them are lost
+            if (m_is_published)
+            {
+                const SnapshotLines& from   = m_snapshots[m_published].lines;
+                SnapshotLines& to           = m_snapshots[m_write].lines;
+                to.depth_enabled.insert(to.depth_enabled.end(), from.depth_enabled.begin(), from.depth_enabled.end());
+                to.depth_enabled_duration.insert(to.depth_enabled_duration.end(), from.depth_enabled_duration.begin(), from.depth_enabled_duration.end());
+                to.depth_disabled.insert(to.depth_disabled.end(), from.depth_disabled.begin(), from.depth_disabled.end());
+                to.depth_disabled_duration.insert(to.depth_disabled_duration.end(), from.depth_disabled_duration.begin(), from.depth_disabled_duration.end());
+            }
+
+            std::swap(m_write, m_published);
+            m_is_published = true;
+            m_snapshots[m_write].lines.Clear();
+        }
+
+        // The latest published snapshot, it remains valid until the next call, is_new is false if it has already been acquired
+        const RenderSnapshot& Acquire(bool* is_new)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            *is_new = m_is_published;
+            if (m_is_published)
+            {
+                std::swap(m_read, m_published);
+                m_is_published = false;
+            }
+
+            return m_snapshots[m_read];
+        }
+
+    private:
+        std::array<RenderSnapshot, 3> m_snapshots;
+        uint32_t m_write        = 0;
+        uint32_t m_published    = 1;
+        uint32_t m_read         = 2;
+        bool m_is_published     = false;
+        std::mutex m_mutex;
+    };
+}
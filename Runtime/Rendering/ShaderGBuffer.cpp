@@ -33,6 +33,7 @@ using namespace std;
 namespace Spartan
 {
     unordered_map<uint16_t, shared_ptr<ShaderGBuffer>> ShaderGBuffer::m_variations;
+    mutex ShaderGBuffer::m_mutex_variations;
 
     ShaderGBuffer::ShaderGBuffer(Context* context, const uint16_t flags /*= 0*/) : RHI_Shader(context)
     {
@@ -41,6 +42,8 @@ namespace Spartan
 
     const ShaderGBuffer* ShaderGBuffer::GenerateVariation(Context* context, const uint16_t flags)
     {
+        lock_guard<mutex> lock(m_mutex_variations);
+
         // Return existing shader, if it's already compiled
         if (m_variations.find(flags) != m_variations.end())
             return m_variations.at(flags).get();
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "../RHI/RHI_Shader.h"
 //============================
@@ -45,5 +46,6 @@ namespace Spartan
 
         uint16_t m_flags = 0;
         static std::unordered_map<uint16_t, std::shared_ptr<ShaderGBuffer>> m_variations;
+        static std::mutex m_mutex_variations; // materials can load on multiple threads at once
     };
 }
@@ -23,7 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "ShaderLight.h"
 #include "Renderer.h"
-#include "../World/Components/Light.h"
+#include "Renderer_Snapshot.h"
 #include "../Resource/ResourceCache.h"
 //====================================
 
@@ -40,19 +40,19 @@ namespace Spartan
         m_flags = flags;
     }
 
-    ShaderLight* ShaderLight::GetVariation(Context* context, const Light* light, const uint64_t renderer_flags, const bool is_transparent_pass)
+    ShaderLight* ShaderLight::GetVariation(Context* context, const SnapshotLight* light, const uint64_t renderer_flags, const bool is_transparent_pass)
     {
         // Compute flags
         uint16_t flags = 0;
-        flags |= is_transparent_pass                                                                        ? Shader_Light_Transparent              : flags;
-        flags |= light->GetLightType() == LightType::Directional                                            ? Shader_Light_Directional              : flags;
-        flags |= light->GetLightType() == LightType::Point                                                  ? Shader_Light_Point                    : flags;
-        flags |= light->GetLightType() == LightType::Spot                                                   ? Shader_Light_Spot                     : flags;
-        flags |= light->GetShadowsEnabled()                                                                 ? Shader_Light_Shadows                  : flags;
-        flags |= (light->GetShadowsScreenSpaceEnabled() && (renderer_flags & Render_ScreenSpaceShadows))    ? Shader_Light_ShadowsScreenSpace       : flags;
-        flags |= light->GetShadowsTransparentEnabled()                                                      ? Shader_Light_ShadowsTransparent       : flags;
-        flags |= (light->GetVolumetricEnabled() && (renderer_flags & Render_VolumetricLighting))            ? Shader_Light_Volumetric               : flags;
-        flags |= (renderer_flags & Render_ScreenSpaceReflections)                                           ? Shader_Light_ScreenSpaceReflections   : flags;
+        flags |= is_transparent_pass                                                                   ? Shader_Light_Transparent            : flags;
+        flags |= light->type == LightType::Directional                                                 ? Shader_Light_Directional            : flags;
+        flags |= light->type == LightType::Point                                                       ? Shader_Light_Point                  : flags;
+        flags |= light->type == LightType::Spot                                                        ? Shader_Light_Spot                   : flags;
+        flags |= light->shadows_enabled                                                                ? Shader_Light_Shadows                : flags;
+        flags |= (light->shadows_screen_space_enabled && (renderer_flags & Render_ScreenSpaceShadows)) ? Shader_Light_ShadowsScreenSpace     : flags;
+        flags |= light->shadows_transparent_enabled                                                    ? Shader_Light_ShadowsTransparent     : flags;
+        flags |= (light->volumetric_enabled && (renderer_flags & Render_VolumetricLighting))           ? Shader_Light_Volumetric             : flags;
+        flags |= (renderer_flags & Render_ScreenSpaceReflections)                                      ? Shader_Light_ScreenSpaceReflections : flags;
 
         // Return existing shader, if it's already compiled
         if (m_variations.find(flags) != m_variations.end())
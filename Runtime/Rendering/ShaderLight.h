@@ -29,7 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
-    class Light;
+    struct SnapshotLight;
 
     enum Shader_Light_Branch : uint16_t
     {
@@ -51,7 +51,7 @@ namespace Spartan
         ShaderLight(Context* context, const uint16_t flags = 0);
         ~ShaderLight() = default;
 
-        static ShaderLight* GetVariation(Context* context, const Light* light, const uint64_t renderer_flags, const bool is_transparent_pass);
+        static ShaderLight* GetVariation(Context* context, const SnapshotLight* light, const uint64_t renderer_flags, const bool is_transparent_pass);
         static auto& GetVariations() { return m_variations; }
 
     private:
@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_Texture.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
+#include "ResourceCache.h"
 //=======================================
 
 //= NAMESPACES ==========
@@ -43,6 +44,17 @@ IResource::IResource(Context* context, const ResourceType type)
     m_load_state    = Idle;
 }
 
+void IResource::OnFilePathChanged()
+{
+    if (!m_context)
+        return;
+
+    if (ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>())
+    {
+        resource_cache->OnResourceFilePathChanged(this);
+    }
+}
+
 template <typename T>
 inline constexpr ResourceType IResource::TypeToEnum() { return ResourceType::Unknown; }
 
@@ -91,6 +91,8 @@ namespace Spartan
             }
             m_resource_name                 = FileSystem::GetFileNameNoExtensionFromFilePath(file_path_relative);
             m_resource_directory            = FileSystem::GetDirectoryFromFilePath(file_path_relative);
+
+            OnFilePathChanged();
         }
         
         ResourceType GetResourceType()                  const { return m_resource_type; }
@@ -119,6 +121,9 @@ namespace Spartan
         LoadState m_load_state            = Idle;
 
     private:
+        // Lets the resource cache re-index the resource, if it's cached
+        void OnFilePathChanged();
+
         std::string m_resource_name;
         std::string m_resource_directory;
         std::string m_resource_file_path_native;
@@ -0,0 +1,839 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "BlockCompressor.h"
+#include "../../Math/Simd.h"
+#include "../../Threading/Threading.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::block_compressor
+{
+    // A 4x4 block of pixels, as floats in the [0, 255] range
+    struct Block
+    {
+        float pixels[16][4];
+    };
+
+    // Palette entries laid out as structure of arrays, so four of them can be tested at once
+    struct Palette
+    {
+        alignas(16) float channels[4][16];
+        uint32_t count = 0;
+    };
+
+    // Writes bits from the least significant end, like BC7 expects
+    struct BitWriter
+    {
+        uint64_t data[2]    = { 0, 0 };
+        uint32_t position   = 0;
+
+        void Write(const uint32_t value, const uint32_t bit_count)
+        {
+            for (uint32_t i = 0; i < bit_count; i++, position++)
+            {
+                data[position >> 6] |= static_cast<uint64_t>((value >> i) & 1) << (position & 63);
+            }
+        }
+    };
+
+    struct BitReader
+    {
+        uint64_t data[2]    = { 0, 0 };
+        uint32_t position   = 0;
+
+        uint32_t Read(const uint32_t bit_count)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < bit_count; i++, position++)
+            {
+                value |= static_cast<uint32_t>((data[position >> 6] >> (position & 63)) & 1) << i;
+            }
+            return value;
+        }
+    };
+
+    static const uint32_t bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    inline float clamp_255(const float value) { return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value); }
+
+    // Edge blocks repeat the last row/column
+    inline void load_block(const std::byte* rgba, const uint32_t width, const uint32_t height, const uint32_t block_x, const uint32_t block_y, Block& block)
+    {
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            const uint32_t pixel_y = min(block_y * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                const uint32_t pixel_x      = min(block_x * 4 + x, width - 1);
+                const std::byte* pixel      = rgba + (static_cast<size_t>(pixel_y) * width + pixel_x) * 4;
+                float* out                  = block.pixels[y * 4 + x];
+                out[0] = static_cast<float>(pixel[0]);
+                out[1] = static_cast<float>(pixel[1]);
+                out[2] = static_cast<float>(pixel[2]);
+                out[3] = static_cast<float>(pixel[3]);
+            }
+        }
+    }
+
+    // Picks the closest palette entry for every pixel, returns the total (weighted) squared error
+    inline float select_indices(const Block& block, const Palette& palette, const float weights[4], uint8_t indices[16])
+    {
+        float error_total = 0.0f;
+
+#if defined(SPARTAN_SIMD_SSE4)
+        const __m128 weight_r = _mm_set1_ps(weights[0]);
+        const __m128 weight_g = _mm_set1_ps(weights[1]);
+        const __m128 weight_b = _mm_set1_ps(weights[2]);
+        const __m128 weight_a = _mm_set1_ps(weights[3]);
+        const __m128i lanes   = _mm_setr_epi32(0, 1, 2, 3);
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const float* pixel  = block.pixels[i];
+            const __m128 r      = _mm_set1_ps(pixel[0]);
+            const __m128 g      = _mm_set1_ps(pixel[1]);
+            const __m128 b      = _mm_set1_ps(pixel[2]);
+            const __m128 a      = _mm_set1_ps(pixel[3]);
+
+            __m128 error_best   = _mm_set1_ps(numeric_limits<float>::max());
+            __m128i index_best  = _mm_setzero_si128();
+            for (uint32_t j = 0; j < palette.count; j += 4)
+            {
+                const __m128 dr = _mm_sub_ps(_mm_load_ps(palette.channels[0] + j), r);
+                const __m128 dg = _mm_sub_ps(_mm_load_ps(palette.channels[1] + j), g);
+                const __m128 db = _mm_sub_ps(_mm_load_ps(palette.channels[2] + j), b);
+                const __m128 da = _mm_sub_ps(_mm_load_ps(palette.channels[3] + j), a);
+
+                __m128 error = _mm_mul_ps(_mm_mul_ps(dr, dr), weight_r);
+                error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(dg, dg), weight_g));
+                error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(db, db), weight_b));
+                error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(da, da), weight_a));
+
+                const __m128 is_better  = _mm_cmplt_ps(error, error_best);
+                const __m128i index     = _mm_add_epi32(lanes, _mm_set1_epi32(static_cast<int>(j)));
+                error_best              = _mm_min_ps(error, error_best);
+                index_best              = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(index_best), _mm_castsi128_ps(index), is_better));
+            }
+
+            // Reduce the four lanes, the lowest index wins ties so the result matches the scalar path
+            alignas(16) float errors[4];
+            alignas(16) int32_t candidates[4];
+            _mm_store_ps(errors, error_best);
+            _mm_store_si128(reinterpret_cast<__m128i*>(candidates), index_best);
+
+            uint32_t lane = 0;
+            for (uint32_t k = 1; k < 4; k++)
+            {
+                if (errors[k] < errors[lane] || (errors[k] == errors[lane] && candidates[k] < candidates[lane]))
+                {
+                    lane = k;
+                }
+            }
+
+            indices[i]   = static_cast<uint8_t>(candidates[lane]);
+            error_total += errors[lane];
+        }
+#else
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const float* pixel  = block.pixels[i];
+            float error_best    = numeric_limits<float>::max();
+            for (uint32_t j = 0; j < palette.count; j++)
+            {
+                float error = 0.0f;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    const float d = palette.channels[c][j] - pixel[c];
+                    error += d * d * weights[c];
+                }
+
+                if (error < error_best)
+                {
+                    error_best  = error;
+                    indices[i]  = static_cast<uint8_t>(j);
+                }
+            }
+
+            error_total += error_best;
+        }
+#endif
+
+        return error_total;
+    }
+
+    // Endpoints spanning the block, either its bounding box diagonal or its extent along the principal axis
+    inline void fit_endpoints(const Block& block, const uint32_t channel_count, const bool principal_axis, float endpoint_0[4], float endpoint_1[4])
+    {
+        float mean[4]   = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float min_[4]   = { 255.0f, 255.0f, 255.0f, 255.0f };
+        float max_[4]   = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (const auto& pixel : block.pixels)
+        {
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                mean[c] += pixel[c] / 16.0f;
+                min_[c]  = min(min_[c], pixel[c]);
+                max_[c]  = max(max_[c], pixel[c]);
+            }
+        }
+
+        if (!principal_axis)
+        {
+            // Inset by 1/16 of the range, the extremes tend to be outliers
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                const float inset = (max_[c] - min_[c]) / 16.0f;
+                endpoint_0[c] = min_[c] + inset;
+                endpoint_1[c] = max_[c] - inset;
+            }
+
+            return;
+        }
+
+        // Covariance
+        float covariance[4][4] = {};
+        for (const auto& pixel : block.pixels)
+        {
+            for (uint32_t i = 0; i < channel_count; i++)
+            {
+                for (uint32_t j = i; j < channel_count; j++)
+                {
+                    covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+                }
+            }
+        }
+        for (uint32_t i = 0; i < channel_count; i++)
+        {
+            for (uint32_t j = 0; j < i; j++)
+            {
+                covariance[i][j] = covariance[j][i];
+            }
+        }
+
+        // Power iteration, starting from the bounding box diagonal
+        float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (uint32_t c = 0; c < channel_count; c++)
+        {
+            axis[c] = max_[c] - min_[c];
+        }
+        for (uint32_t iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4]   = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float length    = 0.0f;
+            for (uint32_t i = 0; i < channel_count; i++)
+            {
+                for (uint32_t j = 0; j < channel_count; j++)
+                {
+                    next[i] += covariance[i][j] * axis[j];
+                }
+                length = max(length, fabs(next[i]));
+            }
+
+            if (length < 1e-6f)
+                break;
+
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                axis[c] = next[c] / length;
+            }
+        }
+
+        float length_squared = 0.0f;
+        for (uint32_t c = 0; c < channel_count; c++)
+        {
+            length_squared += axis[c] * axis[c];
+        }
+
+        // A flat block
+        if (length_squared < 1e-12f)
+        {
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                endpoint_0[c] = endpoint_1[c] = mean[c];
+            }
+
+            return;
+        }
+
+        // Project onto the axis
+        float t_min = numeric_limits<float>::max();
+        float t_max = numeric_limits<float>::lowest();
+        for (const auto& pixel : block.pixels)
+        {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                t += (pixel[c] - mean[c]) * axis[c];
+            }
+            t_min = min(t_min, t);
+            t_max = max(t_max, t);
+        }
+
+        for (uint32_t c = 0; c < channel_count; c++)
+        {
+            endpoint_0[c] = clamp_255(mean[c] + axis[c] * t_min / length_squared);
+            endpoint_1[c] = clamp_255(mean[c] + axis[c] * t_max / length_squared);
+        }
+    }
+
+    // The endpoints which minimise the squared error for the given indices, false if the system is degenerate
+    inline bool refine_endpoints(const Block& block, const uint8_t indices[16], const float* index_weights, const uint32_t channel_count, float endpoint_0[4], float endpoint_1[4])
+    {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float x0[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float x1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const float t = index_weights[indices[i]];
+            a += (1.0f - t) * (1.0f - t);
+            b += (1.0f - t) * t;
+            c += t * t;
+            for (uint32_t k = 0; k < channel_count; k++)
+            {
+                x0[k] += (1.0f - t) * block.pixels[i][k];
+                x1[k] += t * block.pixels[i][k];
+            }
+        }
+
+        const float determinant = a * c - b * b;
+        if (fabs(determinant) < 1e-6f)
+            return false;
+
+        for (uint32_t k = 0; k < channel_count; k++)
+        {
+            endpoint_0[k] = clamp_255((c * x0[k] - b * x1[k]) / determinant);
+            endpoint_1[k] = clamp_255((a * x1[k] - b * x0[k]) / determinant);
+        }
+
+        return true;
+    }
+
+    //= BC1 ==============================================================================================
+
+    static const float bc1_weights[4]       = { 1.0f, 1.0f, 1.0f, 0.0f };
+    static const float bc1_index_weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    inline uint16_t bc1_quantize(const float color[4])
+    {
+        const uint32_t r = static_cast<uint32_t>(clamp_255(color[0]) * 31.0f / 255.0f + 0.5f);
+        const uint32_t g = static_cast<uint32_t>(clamp_255(color[1]) * 63.0f / 255.0f + 0.5f);
+        const uint32_t b = static_cast<uint32_t>(clamp_255(color[2]) * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    inline void bc1_expand(const uint16_t color, float out[3])
+    {
+        const uint32_t r = (color >> 11) & 31;
+        const uint32_t g = (color >> 5) & 63;
+        const uint32_t b = color & 31;
+        out[0] = static_cast<float>((r << 3) | (r >> 2));
+        out[1] = static_cast<float>((g << 2) | (g >> 4));
+        out[2] = static_cast<float>((b << 3) | (b >> 2));
+    }
+
+    // Always uses the four color mode, so the block is also valid as the color half of BC3
+    inline float bc1_encode(const Block& block, const float endpoint_0[4], const float endpoint_1[4], uint8_t indices[16], std::byte* out)
+    {
+        uint16_t color_0 = bc1_quantize(endpoint_0);
+        uint16_t color_1 = bc1_quantize(endpoint_1);
+        if (color_0 < color_1)
+        {
+            swap(color_0, color_1);
+        }
+
+        float e0[3], e1[3];
+        bc1_expand(color_0, e0);
+        bc1_expand(color_1, e1);
+
+        Palette palette;
+        palette.count = 4;
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            palette.channels[c][0] = e0[c];
+            palette.channels[c][1] = e1[c];
+            palette.channels[c][2] = (2.0f * e0[c] + e1[c]) / 3.0f;
+            palette.channels[c][3] = (e0[c] + 2.0f * e1[c]) / 3.0f;
+        }
+        fill_n(palette.channels[3], 4, 0.0f);
+
+        float error = 0.0f;
+        if (color_0 == color_1)
+        {
+            // Three color mode kicks in when the endpoints are equal, index 0 is still the endpoint
+            fill_n(indices, 16, static_cast<uint8_t>(0));
+            for (const auto& pixel : block.pixels)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    error += (pixel[c] - e0[c]) * (pixel[c] - e0[c]);
+                }
+            }
+        }
+        else
+        {
+            error = select_indices(block, palette, bc1_weights, indices);
+        }
+
+        uint32_t index_bits = 0;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            index_bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+        }
+
+        memcpy(out + 0, &color_0, 2);
+        memcpy(out + 2, &color_1, 2);
+        memcpy(out + 4, &index_bits, 4);
+
+        return error;
+    }
+
+    inline void bc1_compress(const Block& block, const BlockCompression_Quality quality, std::byte* out)
+    {
+        float endpoint_0[4], endpoint_1[4];
+        fit_endpoints(block, 3, quality != BlockCompression_Fast, endpoint_0, endpoint_1);
+
+        uint8_t indices[16];
+        float error = bc1_encode(block, endpoint_0, endpoint_1, indices, out);
+
+        if (quality == BlockCompression_High)
+        {
+            for (uint32_t iteration = 0; iteration < 2 && error > 0.0f; iteration++)
+            {
+                // The indices refer to the endpoints after ordering, so the weights do too
+                float e0[4], e1[4];
+                uint16_t color_0, color_1;
+                memcpy(&color_0, out + 0, 2);
+                memcpy(&color_1, out + 2, 2);
+                if (color_0 == color_1 || !refine_endpoints(block, indices, bc1_index_weights, 3, e0, e1))
+                    break;
+
+                std::byte candidate[8];
+                uint8_t candidate_indices[16];
+                const float candidate_error = bc1_encode(block, e0, e1, candidate_indices, candidate);
+                if (candidate_error >= error)
+                    break;
+
+                error = candidate_error;
+                memcpy(out, candidate, 8);
+                memcpy(indices, candidate_indices, 16);
+            }
+        }
+    }
+
+    inline void bc1_decompress(const std::byte* in, const bool four_color_only, uint8_t out[16][4])
+    {
+        uint16_t color_0, color_1;
+        uint32_t index_bits;
+        memcpy(&color_0, in + 0, 2);
+        memcpy(&color_1, in + 2, 2);
+        memcpy(&index_bits, in + 4, 4);
+
+        float palette[4][4];
+        bc1_expand(color_0, palette[0]);
+        bc1_expand(color_1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255.0f;
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            if (color_0 > color_1 || four_color_only)
+            {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+                palette[3][c] = 0.0f;
+            }
+        }
+        if (!(color_0 > color_1 || four_color_only))
+        {
+            palette[3][3] = 0.0f;
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const uint32_t index = (index_bits >> (i * 2)) & 3;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                out[i][c] = static_cast<uint8_t>(palette[index][c] + 0.5f);
+            }
+        }
+    }
+
+    //= BC4 ==============================================================================================
+
+    // Eight value mode, the endpoints are the extremes of the channel and the indices are found arithmetically
+    inline void bc4_compress(const Block& block, const uint32_t channel, std::byte* out)
+    {
+        float value_min = 255.0f;
+        float value_max = 0.0f;
+        for (const auto& pixel : block.pixels)
+        {
+            value_min = min(value_min, pixel[channel]);
+            value_max = max(value_max, pixel[channel]);
+        }
+
+        const uint32_t endpoint_0   = static_cast<uint32_t>(value_max + 0.5f);
+        const uint32_t endpoint_1   = static_cast<uint32_t>(value_min + 0.5f);
+        uint64_t bits               = endpoint_0 | (endpoint_1 << 8);
+
+        if (endpoint_0 > endpoint_1)
+        {
+            const float scale = 7.0f / static_cast<float>(endpoint_0 - endpoint_1);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                // Steps above the minimum, 0 is endpoint 1, 7 is endpoint 0, and the ones in between count down from 7
+                const float steps   = (block.pixels[i][channel] - static_cast<float>(endpoint_1)) * scale;
+                const uint32_t step = static_cast<uint32_t>(min(max(steps + 0.5f, 0.0f), 7.0f));
+                const uint64_t index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+                bits |= index << (16 + i * 3);
+            }
+        }
+
+        memcpy(out, &bits, 8);
+    }
+
+    inline void bc4_decompress(const std::byte* in, const uint32_t channel, uint8_t out[16][4])
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, in, 8);
+
+        const uint32_t endpoint_0 = static_cast<uint32_t>(bits & 0xff);
+        const uint32_t endpoint_1 = static_cast<uint32_t>((bits >> 8) & 0xff);
+
+        uint32_t palette[8] = { endpoint_0, endpoint_1 };
+        for (uint32_t i = 2; i < 8; i++)
+        {
+            if (endpoint_0 > endpoint_1)
+            {
+                palette[i] = ((8 - i) * endpoint_0 + (i - 1) * endpoint_1) / 7;
+            }
+            else
+            {
+                palette[i] = i < 6 ? ((6 - i) * endpoint_0 + (i - 1) * endpoint_1) / 5 : (i == 6 ? 0 : 255);
+            }
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            out[i][channel] = static_cast<uint8_t>(palette[(bits >> (16 + i * 3)) & 7]);
+        }
+    }
+
+    //= BC7 ==============================================================================================
+
+    static const float bc7_channel_weights[4]   = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const float bc7_index_weights[16]    =
+    {
+        0.0f / 64.0f,  4.0f / 64.0f,  9.0f / 64.0f,  13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+        34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f
+    };
+
+    inline float bc7_mode6_encode(const Block& block, const float endpoint_0[4], const float endpoint_1[4], const uint32_t p_bit_0, const uint32_t p_bit_1, uint8_t indices[16], std::byte* out)
+    {
+        // 7 bits per channel plus a shared p-bit per endpoint
+        uint32_t q0[4], q1[4];
+        uint32_t p0 = p_bit_0;
+        uint32_t p1 = p_bit_1;
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            q0[c] = static_cast<uint32_t>(min(max((endpoint_0[c] - p0) * 0.5f + 0.5f, 0.0f), 127.0f));
+            q1[c] = static_cast<uint32_t>(min(max((endpoint_1[c] - p1) * 0.5f + 0.5f, 0.0f), 127.0f));
+        }
+
+        Palette palette;
+        palette.count = 16;
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            const uint32_t e0 = (q0[c] << 1) | p0;
+            const uint32_t e1 = (q1[c] << 1) | p1;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                palette.channels[c][i] = static_cast<float>(((64 - bc7_weights[i]) * e0 + bc7_weights[i] * e1 + 32) >> 6);
+            }
+        }
+
+        const float error = select_indices(block, palette, bc7_channel_weights, indices);
+
+        // The first index is stored with its most significant bit implied to be zero
+        if (indices[0] & 8)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                swap(q0[c], q1[c]);
+            }
+            swap(p0, p1);
+
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                indices[i] = 15 - indices[i];
+            }
+        }
+
+        BitWriter writer;
+        writer.Write(1 << 6, 7); // mode 6
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            writer.Write(q0[c], 7);
+            writer.Write(q1[c], 7);
+        }
+        writer.Write(p0, 1);
+        writer.Write(p1, 1);
+        writer.Write(indices[0], 3);
+        for (uint32_t i = 1; i < 16; i++)
+        {
+            writer.Write(indices[i], 4);
+        }
+
+        memcpy(out, writer.data, 16);
+
+        return error;
+    }
+
+    // The p-bit which reproduces an endpoint best, on its own
+    inline uint32_t bc7_best_p_bit(const float endpoint[4])
+    {
+        float error[2] = { 0.0f, 0.0f };
+        for (uint32_t p = 0; p < 2; p++)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                const float q = min(max(floor((endpoint[c] - p) * 0.5f + 0.5f), 0.0f), 127.0f);
+                const float d = q * 2.0f + p - endpoint[c];
+                error[p] += d * d;
+            }
+        }
+
+        return error[1] < error[0] ? 1 : 0;
+    }
+
+    inline void bc7_compress(const Block& block, const BlockCompression_Quality quality, std::byte* out)
+    {
+        float endpoint_0[4], endpoint_1[4];
+        fit_endpoints(block, 4, quality != BlockCompression_Fast, endpoint_0, endpoint_1);
+
+        uint8_t indices[16];
+        float error = bc7_mode6_encode(block, endpoint_0, endpoint_1, bc7_best_p_bit(endpoint_0), bc7_best_p_bit(endpoint_1), indices, out);
+        if (quality != BlockCompression_High || error == 0.0f)
+            return;
+
+        const auto try_candidate = [&block, &error, &indices, out](const float e0[4], const float e1[4], const uint32_t p0, const uint32_t p1)
+        {
+            std::byte candidate[16];
+            uint8_t candidate_indices[16];
+            const float candidate_error = bc7_mode6_encode(block, e0, e1, p0, p1, candidate_indices, candidate);
+            if (candidate_error < error)
+            {
+                error = candidate_error;
+                memcpy(out, candidate, 16);
+                memcpy(indices, candidate_indices, 16);
+                return true;
+            }
+            return false;
+        };
+
+        // All p-bit combinations
+        for (uint32_t p = 0; p < 4; p++)
+        {
+            try_candidate(endpoint_0, endpoint_1, p & 1, p >> 1);
+        }
+
+        // Least squares, the stored indices might refer to swapped endpoints, which the refit takes care of
+        for (uint32_t iteration = 0; iteration < 2; iteration++)
+        {
+            float e0[4], e1[4];
+            if (!refine_endpoints(block, indices, bc7_index_weights, 4, e0, e1))
+                break;
+
+            if (!try_candidate(e0, e1, bc7_best_p_bit(e0), bc7_best_p_bit(e1)))
+                break;
+        }
+    }
+
+    inline bool bc7_decompress(const std::byte* in, uint8_t out[16][4])
+    {
+        BitReader reader;
+        memcpy(reader.data, in, 16);
+
+        if (reader.Read(7) != (1 << 6))
+            return false;
+
+        uint32_t e[2][4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            e[0][c] = reader.Read(7) << 1;
+            e[1][c] = reader.Read(7) << 1;
+        }
+        const uint32_t p0 = reader.Read(1);
+        const uint32_t p1 = reader.Read(1);
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                const uint32_t e0 = e[0][c] | p0;
+                const uint32_t e1 = e[1][c] | p1;
+                out[i][c] = static_cast<uint8_t>(((64 - bc7_weights[index]) * e0 + bc7_weights[index] * e1 + 32) >> 6);
+            }
+        }
+
+        return true;
+    }
+}
+
+namespace Spartan
+{
+    bool BlockCompressor::Compress(const RHI_Format format, const BlockCompression_Quality quality, const uint32_t width, const uint32_t height, const std::byte* rgba, vector<std::byte>* blocks, Threading* threading /*= nullptr*/)
+    {
+        if (!rgba || !blocks || width == 0 || height == 0 || !rhi_format_is_block_compressed(format))
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        const uint32_t block_count_x    = rhi_format_row_count(format, width);
+        const uint32_t block_count_y    = rhi_format_row_count(format, height);
+        const uint32_t block_size       = rhi_format_block_size(format);
+        const uint32_t row_pitch        = rhi_format_row_pitch(format, width, 4);
+        blocks->resize(static_cast<size_t>(row_pitch) * block_count_y);
+
+        const auto compress_rows = [&](const uint32_t start, const uint32_t end)
+        {
+            block_compressor::Block block;
+            for (uint32_t block_y = start; block_y < end; block_y++)
+            {
+                std::byte* out = blocks->data() + static_cast<size_t>(block_y) * row_pitch;
+                for (uint32_t block_x = 0; block_x < block_count_x; block_x++, out += block_size)
+                {
+                    block_compressor::load_block(rgba, width, height, block_x, block_y, block);
+
+                    switch (format)
+                    {
+                        case RHI_Format_BC1_Unorm:
+                            block_compressor::bc1_compress(block, quality, out);
+                            break;
+                        case RHI_Format_BC3_Unorm:
+                            block_compressor::bc4_compress(block, 3, out);
+                            block_compressor::bc1_compress(block, quality, out + 8);
+                            break;
+                        case RHI_Format_BC4_Unorm:
+                            block_compressor::bc4_compress(block, 0, out);
+                            break;
+                        case RHI_Format_BC5_Unorm:
+                            block_compressor::bc4_compress(block, 0, out);
+                            block_compressor::bc4_compress(block, 1, out + 8);
+                            break;
+                        case RHI_Format_BC7_Unorm:
+                            block_compressor::bc7_compress(block, quality, out);
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+        };
+
+        if (threading)
+        {
+            threading->ParallelFor(block_count_y, compress_rows);
+        }
+        else
+        {
+            compress_rows(0, block_count_y);
+        }
+
+        return true;
+    }
+
+    bool BlockCompressor::Decompress(const RHI_Format format, const uint32_t width, const uint32_t height, const std::byte* blocks, vector<std::byte>* rgba)
+    {
+        if (!blocks || !rgba || width == 0 || height == 0 || !rhi_format_is_block_compressed(format))
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        const uint32_t block_count_x    = rhi_format_row_count(format, width);
+        const uint32_t block_count_y    = rhi_format_row_count(format, height);
+        const uint32_t block_size       = rhi_format_block_size(format);
+        rgba->resize(static_cast<size_t>(width) * height * 4);
+
+        for (uint32_t block_y = 0; block_y < block_count_y; block_y++)
+        {
+            for (uint32_t block_x = 0; block_x < block_count_x; block_x++)
+            {
+                const std::byte* in = blocks + (static_cast<size_t>(block_y) * block_count_x + block_x) * block_size;
+
+                // Missing channels read as 0, missing alpha as 255, same as sampling them on the GPU
+                uint8_t pixels[16][4] = {};
+                for (auto& pixel : pixels)
+                {
+                    pixel[3] = 255;
+                }
+
+                switch (format)
+                {
+                    case RHI_Format_BC1_Unorm:
+                        block_compressor::bc1_decompress(in, false, pixels);
+                        break;
+                    case RHI_Format_BC3_Unorm:
+                        block_compressor::bc1_decompress(in + 8, true, pixels);
+                        block_compressor::bc4_decompress(in, 3, pixels);
+                        break;
+                    case RHI_Format_BC4_Unorm:
+                        block_compressor::bc4_decompress(in, 0, pixels);
+                        break;
+                    case RHI_Format_BC5_Unorm:
+                        block_compressor::bc4_decompress(in, 0, pixels);
+                        block_compressor::bc4_decompress(in + 8, 1, pixels);
+                        break;
+                    case RHI_Format_BC7_Unorm:
+                        if (!block_compressor::bc7_decompress(in, pixels))
+                        {
+                            LOG_ERROR("Only BC7 mode 6 blocks are supported");
+                            return false;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+
+                for (uint32_t y = 0; y < 4 && block_y * 4 + y < height; y++)
+                {
+                    for (uint32_t x = 0; x < 4 && block_x * 4 + x < width; x++)
+                    {
+                        memcpy(rgba->data() + ((static_cast<size_t>(block_y) * 4 + y) * width + block_x * 4 + x) * 4, pixels[y * 4 + x], 4);
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+}
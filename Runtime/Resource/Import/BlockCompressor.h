@@ -0,0 +1,53 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==============================
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Core/Spartan_Definitions.h"
+//=========================================
+
+namespace Spartan
+{
+    class Threading;
+
+    enum BlockCompression_Quality : uint8_t
+    {
+        BlockCompression_Fast,      // bounding box endpoints, color is encoded as BC1/BC3 instead of BC7
+        BlockCompression_Normal,    // principal axis endpoints
+        BlockCompression_High       // principal axis endpoints refined with least squares, exhaustive BC7 p-bit search
+    };
+
+    // A CPU encoder for the BCn formats, it takes RGBA8 images.
+    // Rows of blocks are spread across threads and the palette searches use SIMD (when available).
+    // BC7 only uses mode 6 (a single subset with RGBA endpoints and 16 levels), which holds up well for most content.
+    class SPARTAN_CLASS BlockCompressor
+    {
+    public:
+        static bool Compress(RHI_Format format, BlockCompression_Quality quality, uint32_t width, uint32_t height, const std::byte* rgba, std::vector<std::byte>* blocks, Threading* threading = nullptr);
+
+        // Decodes what Compress() produces, BC7 blocks which are not mode 6 are not supported
+        static bool Decompress(RHI_Format format, uint32_t width, uint32_t height, const std::byte* blocks, std::vector<std::byte>* rgba);
+    };
+}
@@ -37,23 +37,6 @@ namespace Spartan::freeimage_helper
 {
     static FREE_IMAGE_FILTER rescale_filter = FILTER_BOX;
 
-    // A struct that rescaling threads will work with
-    struct RescaleJob
-    {
-        uint32_t width           = 0;
-        uint32_t height          = 0;
-        uint32_t channel_count   = 0;
-        vector<std::byte>* data  = nullptr;
-        bool done                = false;
-
-        RescaleJob(const uint32_t width, const uint32_t height, const uint32_t channel_count)
-        {
-            this->width         = width;
-            this->height        = height;
-            this->channel_count = channel_count;
-        }
-    };
-
     inline uint32_t get_bytes_per_channel(FIBITMAP* bitmap)
     {
         if (!bitmap)
@@ -212,14 +195,17 @@ namespace Spartan
         std::vector<std::byte>& mip = texture->AddMip();
         GetBitsFromFibitmap(&mip, bitmap, image_width, image_height, image_channel_count);
 
+        // Free memory 
+        FreeImage_Unload(bitmap);
+
         // If the texture supports mipmaps, generate them
         if (generate_mipmaps)
         {
-            GenerateMipmaps(bitmap, texture, image_width, image_height, image_channel_count);
+            GenerateMipmaps(texture, image_format, image_width, image_height, image_is_transparent);
         }
 
-        // Free memory 
-        FreeImage_Unload(bitmap);
+        // Block compress (if requested), after the mips have been generated from the uncompressed image
+        const RHI_Format texture_format = Compress(texture, image_format, image_width, image_height, image_is_transparent, image_is_grayscale);
 
         // Fill RHI_Texture with image properties
         texture->SetBitsPerChannel(image_bytes_per_channel * 8);
@@ -227,7 +213,7 @@ namespace Spartan
         texture->SetHeight(image_height);
         texture->SetChannelCount(image_channel_count);
         texture->SetTransparency(image_is_transparent);
-        texture->SetFormat(image_format);
+        texture->SetFormat(texture_format);
         texture->SetGrayscale(image_is_grayscale);
 
         return true;
@@ -257,65 +243,64 @@ namespace Spartan
         return true;
     }
 
-    void ImageImporter::GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels)
+    void ImageImporter::GenerateMipmaps(RHI_Texture* texture, const RHI_Format format, const uint32_t width, const uint32_t height, const bool is_transparent) const
     {
         if (!texture)
         {
             LOG_ERROR_INVALID_PARAMETER();
             return;
         }
-    
-        // Create a RescaleJob for every mip that we need
-        vector<freeimage_helper::RescaleJob> jobs;
-        while (width > 1 && height > 1)
+
+        // Color with alpha gets alpha tested by the G-Buffer pass (see mask_threshold in GBuffer.hlsl), so keep its coverage from thinning out
+        static const float alpha_test_threshold = 0.6f;
+        const float alpha_cutoff = (texture->GetSrgb() && is_transparent) ? alpha_test_threshold : 0.0f;
+
+        if (!MipGenerator::Generate(format, width, height, &texture->GetMips(), m_mip_filter, texture->GetSrgb(), alpha_cutoff, m_context->GetSubsystem<Threading>()))
         {
-            width    = Math::Helper::Max(width / 2, static_cast<uint32_t>(1));
-            height    = Math::Helper::Max(height / 2, static_cast<uint32_t>(1));
-            jobs.emplace_back(width, height, channels);
-            
-            // Resize the RHI_Texture vector accordingly
-            const auto size = width * height * channels;
-            std::vector<std::byte>& mip = texture->AddMip();
-            mip.reserve(size);
-            mip.resize(size);
+            LOG_ERROR("Failed to generate mips for a %dx%d %s image", width, height, rhi_format_to_string(format));
         }
+    }
+
+    RHI_Format ImageImporter::Compress(RHI_Texture* texture, const RHI_Format format, const uint32_t width, const uint32_t height, const bool is_transparent, const bool is_grayscale) const
+    {
+        RHI_Format format_compressed = texture->GetCompressionFormat(is_grayscale);
+        if (format_compressed == RHI_Format_Undefined)
+            return format;
 
-        // Pass data pointers (now that the RHI_Texture mip vector has been constructed)
-        for (uint32_t i = 0; i < jobs.size(); i++)
+        // The encoder takes RGBA8, and the top mip has to be made of whole blocks
+        if (format != RHI_Format_R8G8B8A8_Unorm || width % 4 != 0 || height % 4 != 0)
         {
-            // reminder: i + 1 because the 0 mip is the default image size
-            jobs[i].data = &texture->GetMip(i + 1);
+            LOG_WARNING("Can't block compress a %dx%d %s image, it will remain uncompressed", width, height, rhi_format_to_string(format));
+            return format;
         }
 
-        // Parallelize mipmap generation using multiple threads (because FreeImage_Rescale() using FILTER_LANCZOS3 is expensive)
-        auto threading = m_context->GetSubsystem<Threading>();
-        for (auto& job : jobs)
+        // When speed matters more, color goes to BC1, and transparent color to BC3 since BC1 can only cut out alpha
+        if (format_compressed == RHI_Format_BC7_Unorm && m_compression_quality == BlockCompression_Fast)
         {
-            threading->AddTask([this, &job, &bitmap]()
-            {
-                const auto bitmap_scaled = FreeImage_Rescale(bitmap, job.width, job.height, freeimage_helper::rescale_filter);
-                if (!GetBitsFromFibitmap(job.data, bitmap_scaled, job.width, job.height, job.channel_count))
-                {
-                    LOG_ERROR("Failed to create mip level %dx%d", job.width, job.height);
-                }
-                FreeImage_Unload(bitmap_scaled);
-                job.done = true;
-            });
+            format_compressed = RHI_Format_BC1_Unorm;
+        }
+        if (format_compressed == RHI_Format_BC1_Unorm && is_transparent)
+        {
+            format_compressed = RHI_Format_BC3_Unorm;
         }
 
-        // Wait until all mipmaps have been generated
-        auto ready = false;
-        while (!ready)
+        // Compress every mip into a separate buffer, so a failure leaves the texture untouched
+        vector<vector<std::byte>>& mips = texture->GetMips();
+        vector<vector<std::byte>> mips_compressed(mips.size());
+        Threading* threading = m_context->GetSubsystem<Threading>();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(mips.size()); i++)
         {
-            ready = true;
-            for (const auto& job : jobs)
+            const uint32_t mip_width    = Math::Helper::Max(width >> i, static_cast<uint32_t>(1));
+            const uint32_t mip_height   = Math::Helper::Max(height >> i, static_cast<uint32_t>(1));
+            if (!BlockCompressor::Compress(format_compressed, m_compression_quality, mip_width, mip_height, mips[i].data(), &mips_compressed[i], threading))
             {
-                if (!job.done)
-                {
-                    ready = false;
-                }
+                LOG_ERROR("Failed to compress mip %d", i);
+                return format;
             }
         }
+
+        mips = move(mips_compressed);
+        return format_compressed;
     }
 
     FIBITMAP* ImageImporter::ApplyBitmapCorrections(FIBITMAP* bitmap) const
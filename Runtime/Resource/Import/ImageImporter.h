@@ -26,6 +26,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string>
 #include "../../RHI/RHI_Definition.h"
 #include "../../Core/Spartan_Definitions.h"
+#include "BlockCompressor.h"
+#include "MipGenerator.h"
 //=========================================
 
 struct FIBITMAP;
@@ -42,13 +44,23 @@ namespace Spartan
 
         bool Load(const std::string& file_path, RHI_Texture* texture, bool generate_mipmaps = true);
 
+        // Applies to textures which request block compression, see RHI_Texture::SetCompressionFormat()
+        BlockCompression_Quality GetCompressionQuality() const              { return m_compression_quality; }
+        void SetCompressionQuality(const BlockCompression_Quality quality)  { m_compression_quality = quality; }
+
+        MipFilter GetMipFilter() const                                      { return m_mip_filter; }
+        void SetMipFilter(const MipFilter filter)                           { m_mip_filter = filter; }
+
     private:    
         bool GetBitsFromFibitmap(std::vector<std::byte>* data, FIBITMAP* bitmap, uint32_t width, uint32_t height, uint32_t channels) const;
-        void GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels);
+        void GenerateMipmaps(RHI_Texture* texture, RHI_Format format, uint32_t width, uint32_t height, bool is_transparent) const;
         FIBITMAP* ApplyBitmapCorrections(FIBITMAP* bitmap) const;
         FIBITMAP* _FreeImage_ConvertTo32Bits(FIBITMAP* bitmap) const;
         FIBITMAP* _FreeImage_Rescale(FIBITMAP* bitmap, uint32_t width, uint32_t height) const;
+        RHI_Format Compress(RHI_Texture* texture, RHI_Format format, uint32_t width, uint32_t height, bool is_transparent, bool is_grayscale) const;
 
-        Context* m_context = nullptr;
+        Context* m_context                              = nullptr;
+        BlockCompression_Quality m_compression_quality  = BlockCompression_Normal;
+        MipFilter m_mip_filter                          = MipFilter_Kaiser;
     };
 }
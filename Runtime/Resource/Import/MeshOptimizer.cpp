@@ -0,0 +1,761 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "MeshOptimizer.h"
+#include "../../RHI/RHI_Vertex.h"
+//=================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan::mesh_optimizer
+{
+    //= VERTEX CACHE ====================================================================================================
+    static const uint32_t cache_size            = 32;
+    static const uint32_t valence_max           = 64;
+    static const float cache_decay_power        = 1.5f;
+    static const float last_triangle_score      = 0.75f;
+    static const float valence_boost_scale      = 2.0f;
+    static const float valence_boost_power      = 0.5f;
+
+    struct ScoreTables
+    {
+        float cache[cache_size];
+        float valence[valence_max];
+
+        ScoreTables()
+        {
+            for (uint32_t i = 0; i < cache_size; i++)
+            {
+                // The three most recent vertices get a fixed score, so the next triangle doesn't simply reuse the last one's edge
+                cache[i] = i < 3 ? last_triangle_score : pow(1.0f - (i - 3) / static_cast<float>(cache_size - 3), cache_decay_power);
+            }
+
+            // Vertices with few triangles left get a boost, finishing them off lets them leave the cache for good
+            valence[0] = 0.0f;
+            for (uint32_t i = 1; i < valence_max; i++)
+            {
+                valence[i] = valence_boost_scale * pow(static_cast<float>(i), -valence_boost_power);
+            }
+        }
+    };
+
+    inline float vertex_score(const int32_t cache_position, const uint32_t triangles_remaining)
+    {
+        static const ScoreTables tables;
+
+        if (triangles_remaining == 0)
+            return -1.0f;
+
+        const float score_cache = cache_position < 0 ? 0.0f : tables.cache[cache_position];
+        return score_cache + tables.valence[min(triangles_remaining, valence_max - 1)];
+    }
+    //===================================================================================================================
+
+    //= SIMPLIFICATION ==================================================================================================
+    enum Vertex_Kind : uint8_t
+    {
+        Vertex_Interior,    // can collapse onto any neighbour
+        Vertex_Border,      // on an open edge, can only slide along it
+        Vertex_Locked       // an attribute seam or non-manifold, never moves
+    };
+
+    // A symmetric 4x4 matrix which sums the squared distances to a set of planes, weighted by area
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+        double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+        double a22 = 0.0, a23 = 0.0;
+        double a33 = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(const Vector3& normal, const float distance, const double plane_weight)
+        {
+            const double x = normal.x, y = normal.y, z = normal.z, w = distance;
+            a00 += plane_weight * x * x; a01 += plane_weight * x * y; a02 += plane_weight * x * z; a03 += plane_weight * x * w;
+            a11 += plane_weight * y * y; a12 += plane_weight * y * z; a13 += plane_weight * y * w;
+            a22 += plane_weight * z * z; a23 += plane_weight * z * w;
+            a33 += plane_weight * w * w;
+            weight += plane_weight;
+        }
+
+        void Add(const Quadric& other)
+        {
+            a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+            a11 += other.a11; a12 += other.a12; a13 += other.a13;
+            a22 += other.a22; a23 += other.a23;
+            a33 += other.a33;
+            weight += other.weight;
+        }
+
+        // Weighted average of the squared distances from the point to the planes
+        double Evaluate(const float* p) const
+        {
+            const double x = p[0], y = p[1], z = p[2];
+            const double error =
+                a00 * x * x + a11 * y * y + a22 * z * z + a33 +
+                2.0 * (a01 * x * y + a02 * x * z + a03 * x + a12 * y * z + a13 * y + a23 * z);
+
+            return weight > 0.0 ? max(error, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    inline Vector3 get_position(const RHI_Vertex_PosTexNorTan& vertex) { return Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]); }
+
+    inline uint64_t edge_key(const uint32_t a, const uint32_t b) { return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a; }
+
+    // Vertices which only differ in their attributes (normal, uv) share a position id, the first such vertex
+    inline vector<uint32_t> compute_position_ids(const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        struct PositionHash
+        {
+            size_t operator()(const array<uint32_t, 3>& key) const { return (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u); }
+        };
+
+        unordered_map<array<uint32_t, 3>, uint32_t, PositionHash> ids;
+        ids.reserve(vertices.size());
+
+        vector<uint32_t> position_ids(vertices.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(vertices.size()); i++)
+        {
+            array<uint32_t, 3> key;
+            memcpy(key.data(), vertices[i].pos, sizeof(key));
+            position_ids[i] = ids.emplace(key, i).first->second;
+        }
+
+        return position_ids;
+    }
+
+    // The triangles around every position, as offsets into a flat list
+    struct Adjacency
+    {
+        vector<uint32_t> offsets;
+        vector<uint32_t> triangles;
+
+        void Build(const vector<uint32_t>& indices, const vector<uint32_t>& position_ids, const uint32_t vertex_count)
+        {
+            offsets.assign(static_cast<size_t>(vertex_count) + 1, 0);
+            for (const uint32_t index : indices)
+            {
+                offsets[position_ids[index] + 1]++;
+            }
+
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                offsets[i + 1] += offsets[i];
+            }
+
+            triangles.resize(indices.size());
+            vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i++)
+            {
+                triangles[cursor[position_ids[indices[i]]]++] = i / 3;
+            }
+        }
+    };
+    //===================================================================================================================
+}
+
+namespace Spartan
+{
+    void MeshOptimizer::OptimizeVertexCache(vector<uint32_t>* indices, const uint32_t vertex_count)
+    {
+        if (!indices || indices->size() % 3 != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        const uint32_t triangle_count = static_cast<uint32_t>(indices->size() / 3);
+        if (triangle_count == 0)
+            return;
+
+        const vector<uint32_t>& input = *indices;
+
+        // The triangles of every vertex, a vertex only keeps the ones which haven't been emitted yet
+        vector<uint32_t> remaining(vertex_count, 0);
+        for (const uint32_t index : input)
+        {
+            remaining[index]++;
+        }
+
+        vector<uint32_t> offsets(static_cast<size_t>(vertex_count) + 1, 0);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            offsets[i + 1] = offsets[i] + remaining[i];
+        }
+
+        vector<uint32_t> adjacency(input.size());
+        {
+            vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(input.size()); i++)
+            {
+                adjacency[cursor[input[i]]++] = i / 3;
+            }
+        }
+
+        vector<int32_t> cache_position(vertex_count, -1);
+        vector<float> scores_vertex(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            scores_vertex[i] = mesh_optimizer::vertex_score(-1, remaining[i]);
+        }
+
+        vector<float> scores_triangle(triangle_count);
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            scores_triangle[i] = scores_vertex[input[i * 3 + 0]] + scores_vertex[input[i * 3 + 1]] + scores_vertex[input[i * 3 + 2]];
+        }
+
+        vector<bool> emitted(triangle_count, false);
+        vector<uint32_t> output;
+        output.reserve(input.size());
+
+        uint32_t cache[mesh_optimizer::cache_size + 3];
+        uint32_t cache_count        = 0;
+        uint32_t scan_cursor        = 0;
+        int64_t triangle_best       = static_cast<int64_t>(max_element(scores_triangle.begin(), scores_triangle.end()) - scores_triangle.begin());
+
+        for (uint32_t n = 0; n < triangle_count; n++)
+        {
+            // Nothing in the cache has triangles left, continue with the next unused triangle in the input order
+            if (triangle_best < 0)
+            {
+                while (emitted[scan_cursor])
+                {
+                    scan_cursor++;
+                }
+                triangle_best = scan_cursor;
+            }
+
+            const uint32_t triangle = static_cast<uint32_t>(triangle_best);
+            const uint32_t* corners = &input[triangle * 3];
+            output.insert(output.end(), corners, corners + 3);
+            emitted[triangle] = true;
+
+            // Remove the triangle from its vertices
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const uint32_t vertex   = corners[c];
+                uint32_t* begin         = &adjacency[offsets[vertex]];
+                uint32_t* end           = begin + remaining[vertex];
+                *find(begin, end, triangle) = *(end - 1);
+                remaining[vertex]--;
+            }
+
+            // The triangle's vertices move to the front of the cache, pushing the rest back
+            uint32_t cache_new[mesh_optimizer::cache_size + 3];
+            uint32_t cache_new_count = 0;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                cache_new[cache_new_count++] = corners[c];
+            }
+            for (uint32_t i = 0; i < cache_count; i++)
+            {
+                const uint32_t vertex = cache[i];
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+                {
+                    cache_new[cache_new_count++] = vertex;
+                }
+            }
+
+            // Re-score the vertices which moved (or fell out), along with their triangles
+            triangle_best       = -1;
+            float score_best    = -1.0f;
+            for (uint32_t i = 0; i < cache_new_count; i++)
+            {
+                const uint32_t vertex   = cache_new[i];
+                const int32_t position  = i < mesh_optimizer::cache_size ? static_cast<int32_t>(i) : -1;
+                cache_position[vertex]  = position;
+
+                const float score   = mesh_optimizer::vertex_score(position, remaining[vertex]);
+                const float delta   = score - scores_vertex[vertex];
+                scores_vertex[vertex] = score;
+
+                for (uint32_t t = offsets[vertex]; t < offsets[vertex] + remaining[vertex]; t++)
+                {
+                    const uint32_t neighbour = adjacency[t];
+                    scores_triangle[neighbour] += delta;
+
+                    if (scores_triangle[neighbour] > score_best)
+                    {
+                        score_best      = scores_triangle[neighbour];
+                        triangle_best   = neighbour;
+                    }
+                }
+            }
+
+            cache_count = min(cache_new_count, mesh_optimizer::cache_size);
+            memcpy(cache, cache_new, cache_count * sizeof(uint32_t));
+        }
+
+        *indices = move(output);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(vector<uint32_t>* indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const float threshold /*= 1.05f*/)
+    {
+        if (!indices || indices->size() % 3 != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        const vector<uint32_t>& input   = *indices;
+        const uint32_t triangle_count   = static_cast<uint32_t>(input.size() / 3);
+        if (triangle_count == 0)
+            return;
+
+        // Simulates a FIFO cache, returns how many of the triangle's vertices missed
+        static const uint32_t fifo_size = 16;
+        vector<uint32_t> timestamps(vertices.size(), 0);
+        uint32_t time = fifo_size + 1;
+        const auto misses = [&timestamps, &time, &input](const uint32_t triangle)
+        {
+            uint32_t count = 0;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const uint32_t vertex = input[triangle * 3 + c];
+                if (time - timestamps[vertex] > fifo_size)
+                {
+                    timestamps[vertex] = time++;
+                    count++;
+                }
+            }
+            return count;
+        };
+        const auto cache_reset = [&time]() { time += fifo_size + 1; };
+
+        // Hard boundaries, where the cache optimizer started over (every vertex missed)
+        vector<uint32_t> clusters_hard;
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            if (misses(i) == 3)
+            {
+                clusters_hard.emplace_back(i);
+            }
+        }
+        clusters_hard.emplace_back(triangle_count);
+
+        // Soft boundaries, split a hard cluster wherever the part so far (starting with a cold cache) is already about as efficient as the whole cluster
+        vector<uint32_t> clusters;
+        for (size_t c = 0; c + 1 < clusters_hard.size(); c++)
+        {
+            const uint32_t start    = clusters_hard[c];
+            const uint32_t end      = clusters_hard[c + 1];
+
+            cache_reset();
+            uint32_t misses_cluster = 0;
+            for (uint32_t i = start; i < end; i++)
+            {
+                misses_cluster += misses(i);
+            }
+            const float acmr_cluster = static_cast<float>(misses_cluster) / (end - start);
+
+            cache_reset();
+            uint32_t start_soft     = start;
+            uint32_t misses_soft    = 0;
+            clusters.emplace_back(start);
+            for (uint32_t i = start; i < end; i++)
+            {
+                misses_soft += misses(i);
+                if (i + 1 < end && static_cast<float>(misses_soft) / (i + 1 - start_soft) <= acmr_cluster * threshold)
+                {
+                    clusters.emplace_back(i + 1);
+                    start_soft  = i + 1;
+                    misses_soft = 0;
+                    cache_reset();
+                }
+            }
+        }
+        clusters.emplace_back(triangle_count);
+
+        // Sort the clusters by how much they face away from the center, outer surfaces occlude inner ones more often than not
+        Vector3 mesh_center = Vector3::Zero;
+        float mesh_area     = 0.0f;
+        vector<pair<float, uint32_t>> sort_keys(clusters.size() - 1);
+        vector<Vector3> cluster_centers(clusters.size() - 1);
+        vector<Vector3> cluster_normals(clusters.size() - 1);
+        for (uint32_t c = 0; c + 1 < static_cast<uint32_t>(clusters.size()); c++)
+        {
+            Vector3 center  = Vector3::Zero;
+            Vector3 normal  = Vector3::Zero;
+            float area      = 0.0f;
+            for (uint32_t i = clusters[c]; i < clusters[c + 1]; i++)
+            {
+                const Vector3 p0                = mesh_optimizer::get_position(vertices[input[i * 3 + 0]]);
+                const Vector3 p1                = mesh_optimizer::get_position(vertices[input[i * 3 + 1]]);
+                const Vector3 p2                = mesh_optimizer::get_position(vertices[input[i * 3 + 2]]);
+                const Vector3 normal_triangle   = Vector3::Cross(p1 - p0, p2 - p0);
+                const float area_triangle       = normal_triangle.Length();
+
+                center  += (p0 + p1 + p2) * (area_triangle / 3.0f);
+                normal  += normal_triangle;
+                area    += area_triangle;
+            }
+
+            cluster_centers[c]  = area > 0.0f ? center / area : center;
+            cluster_normals[c]  = normal.Normalized();
+            mesh_center        += center;
+            mesh_area          += area;
+        }
+        mesh_center = mesh_area > 0.0f ? mesh_center / mesh_area : mesh_center;
+
+        for (uint32_t c = 0; c < static_cast<uint32_t>(sort_keys.size()); c++)
+        {
+            sort_keys[c] = { -Vector3::Dot(cluster_centers[c] - mesh_center, cluster_normals[c]), c };
+        }
+        stable_sort(sort_keys.begin(), sort_keys.end(), [](const pair<float, uint32_t>& a, const pair<float, uint32_t>& b) { return a.first < b.first; });
+
+        vector<uint32_t> output;
+        output.reserve(input.size());
+        for (const pair<float, uint32_t>& key : sort_keys)
+        {
+            output.insert(output.end(), input.begin() + clusters[key.second] * 3, input.begin() + clusters[key.second + 1] * 3);
+        }
+
+        *indices = move(output);
+    }
+
+    void MeshOptimizer::OptimizeVertexFetch(const vector<vector<uint32_t>*>& index_lists, vector<RHI_Vertex_PosTexNorTan>* vertices)
+    {
+        if (!vertices)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        static const uint32_t unused = static_cast<uint32_t>(-1);
+        vector<uint32_t> remap(vertices->size(), unused);
+        vector<RHI_Vertex_PosTexNorTan> output;
+        output.reserve(vertices->size());
+
+        for (vector<uint32_t>* indices : index_lists)
+        {
+            for (uint32_t& index : *indices)
+            {
+                if (remap[index] == unused)
+                {
+                    remap[index] = static_cast<uint32_t>(output.size());
+                    output.emplace_back((*vertices)[index]);
+                }
+
+                index = remap[index];
+            }
+        }
+
+        *vertices = move(output);
+    }
+
+    vector<uint32_t> MeshOptimizer::Simplify(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const uint32_t index_count_target, const float error_max, float* error /*= nullptr*/)
+    {
+        vector<uint32_t> result = indices;
+        double error_result     = 0.0;
+        if (error)
+        {
+            *error = 0.0f;
+        }
+
+        if (indices.size() % 3 != 0 || vertices.empty())
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return result;
+        }
+
+        const uint32_t vertex_count         = static_cast<uint32_t>(vertices.size());
+        const vector<uint32_t> position_ids = mesh_optimizer::compute_position_ids(vertices);
+        const auto position                 = [&vertices](const uint32_t id) { return mesh_optimizer::get_position(vertices[id]); };
+
+        // Edges as sorted keys, an edge which shows up once is on a border, more than twice is non-manifold
+        vector<uint64_t> edges;
+        const auto build_edges = [&edges, &position_ids](const vector<uint32_t>& triangles)
+        {
+            edges.clear();
+            for (size_t i = 0; i < triangles.size(); i += 3)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    edges.emplace_back(mesh_optimizer::edge_key(position_ids[triangles[i + c]], position_ids[triangles[i + (c + 1) % 3]]));
+                }
+            }
+            sort(edges.begin(), edges.end());
+        };
+        const auto edge_count = [&edges](const uint32_t a, const uint32_t b)
+        {
+            const auto range = equal_range(edges.begin(), edges.end(), mesh_optimizer::edge_key(a, b));
+            return static_cast<uint32_t>(range.second - range.first);
+        };
+
+        // Quadrics of the triangle planes, plus planes perpendicular to the border edges so that open outlines hold their shape
+        static const double border_weight = 10.0;
+        vector<mesh_optimizer::Quadric> quadrics(vertex_count);
+        build_edges(result);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const uint32_t ids[3]   = { position_ids[result[i]], position_ids[result[i + 1]], position_ids[result[i + 2]] };
+            const Vector3 p[3]      = { position(ids[0]), position(ids[1]), position(ids[2]) };
+            Vector3 normal          = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+            const float area        = normal.Length() * 0.5f;
+            if (area <= 0.0f)
+                continue;
+
+            normal /= area * 2.0f;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                quadrics[ids[c]].AddPlane(normal, -Vector3::Dot(normal, p[0]), area);
+            }
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const uint32_t a = ids[c];
+                const uint32_t b = ids[(c + 1) % 3];
+                if (edge_count(a, b) != 1)
+                    continue;
+
+                const Vector3 edge          = p[(c + 1) % 3] - p[c];
+                const Vector3 edge_normal   = Vector3::Cross(edge, normal).Normalized();
+                const double weight         = border_weight * edge.LengthSquared();
+                quadrics[a].AddPlane(edge_normal, -Vector3::Dot(edge_normal, p[c]), weight);
+                quadrics[b].AddPlane(edge_normal, -Vector3::Dot(edge_normal, p[c]), weight);
+            }
+        }
+
+        // A vertex with more than one attribute set at its position sits on a seam (uv, hard normal), those are locked
+        vector<uint32_t> wedge_count(vertex_count, 0);
+        {
+            vector<bool> seen(vertex_count, false);
+            for (const uint32_t index : result)
+            {
+                if (!seen[index])
+                {
+                    seen[index] = true;
+                    wedge_count[position_ids[index]]++;
+                }
+            }
+        }
+
+        mesh_optimizer::Adjacency adjacency;
+        vector<mesh_optimizer::Vertex_Kind> kinds(vertex_count);
+        vector<mesh_optimizer::Collapse> collapses;
+        vector<uint32_t> remap(vertex_count);
+        vector<bool> locked(vertex_count);
+        const double error_max_squared = static_cast<double>(error_max) * error_max;
+
+        while (result.size() > index_count_target)
+        {
+            build_edges(result);
+            adjacency.Build(result, position_ids, vertex_count);
+
+            // Classify
+            fill(kinds.begin(), kinds.end(), mesh_optimizer::Vertex_Interior);
+            for (uint32_t id = 0; id < vertex_count; id++)
+            {
+                if (wedge_count[id] > 1)
+                {
+                    kinds[id] = mesh_optimizer::Vertex_Locked;
+                }
+            }
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t end = i;
+                while (end < edges.size() && edges[end] == edges[i])
+                {
+                    end++;
+                }
+
+                const uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+                const uint32_t b = static_cast<uint32_t>(edges[i] & 0xFFFFFFFF);
+                if (end - i == 1)
+                {
+                    kinds[a] = kinds[a] == mesh_optimizer::Vertex_Locked ? mesh_optimizer::Vertex_Locked : mesh_optimizer::Vertex_Border;
+                    kinds[b] = kinds[b] == mesh_optimizer::Vertex_Locked ? mesh_optimizer::Vertex_Locked : mesh_optimizer::Vertex_Border;
+                }
+                else if (end - i > 2)
+                {
+                    kinds[a] = mesh_optimizer::Vertex_Locked;
+                    kinds[b] = mesh_optimizer::Vertex_Locked;
+                }
+
+                i = end;
+            }
+
+            // Candidates, collapsing a vertex onto a neighbour (the neighbour stays put, so every level can share the same vertices)
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    const uint32_t a = position_ids[result[i + c]];
+                    const uint32_t b = position_ids[result[i + (c + 1) % 3]];
+
+                    for (const auto [from, to] : { make_pair(a, b), make_pair(b, a) })
+                    {
+                        if (kinds[from] == mesh_optimizer::Vertex_Locked)
+                            continue;
+
+                        // Border vertices only slide along the border
+                        if (kinds[from] == mesh_optimizer::Vertex_Border && edge_count(from, to) != 1)
+                            continue;
+
+                        mesh_optimizer::Quadric quadric = quadrics[from];
+                        quadric.Add(quadrics[to]);
+                        collapses.push_back({ from, to, quadric.Evaluate(vertices[to].pos) });
+                    }
+                }
+            }
+
+            if (collapses.empty())
+                break;
+
+            sort(collapses.begin(), collapses.end(), [](const mesh_optimizer::Collapse& a, const mesh_optimizer::Collapse& b) { return a.cost < b.cost; });
+
+            // Every collapse removes about two triangles, don't overshoot the target by much
+            const uint32_t collapses_needed = max(static_cast<uint32_t>((result.size() - index_count_target) / 6), 1u);
+            uint32_t collapses_done         = 0;
+
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                remap[i] = i;
+            }
+            fill(locked.begin(), locked.end(), false);
+
+            for (const mesh_optimizer::Collapse& collapse : collapses)
+            {
+                if (collapses_done >= collapses_needed || collapse.cost > error_max_squared)
+                    break;
+
+                const uint32_t from = collapse.from;
+                const uint32_t to   = collapse.to;
+                if (locked[from] || locked[to])
+                    continue;
+
+                // Reject collapses which would flip a triangle, and find the vertex which carries the attributes on the side of "from"
+                const Vector3 position_to   = position(to);
+                bool flips                  = false;
+                uint32_t vertex_from        = static_cast<uint32_t>(-1);
+                uint32_t vertex_to          = static_cast<uint32_t>(-1);
+                for (uint32_t t = adjacency.offsets[from]; t < adjacency.offsets[from + 1] && !flips; t++)
+                {
+                    const uint32_t* triangle    = &result[adjacency.triangles[t] * 3];
+                    const uint32_t ids[3]       = { position_ids[triangle[0]], position_ids[triangle[1]], position_ids[triangle[2]] };
+
+                    bool has_to = false;
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        if (ids[c] == from) vertex_from = triangle[c];
+                        if (ids[c] == to)   { vertex_to = triangle[c]; has_to = true; }
+                    }
+
+                    // This triangle disappears
+                    if (has_to)
+                        continue;
+
+                    Vector3 p[3]            = { position(ids[0]), position(ids[1]), position(ids[2]) };
+                    const Vector3 normal    = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        p[c] = ids[c] == from ? position_to : p[c];
+                    }
+                    const Vector3 normal_new = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+
+                    // Anything turning by more than ~75 degrees counts, a few of those in a row can fold the surface over
+                    flips = Vector3::Dot(normal, normal_new) <= 0.25f * normal.Length() * normal_new.Length();
+                }
+
+                if (flips || vertex_from == static_cast<uint32_t>(-1) || vertex_to == static_cast<uint32_t>(-1))
+                    continue;
+
+                remap[vertex_from] = vertex_to;
+                quadrics[to].Add(quadrics[from]);
+                error_result = max(error_result, collapse.cost);
+                collapses_done++;
+
+                // The neighbourhood of this collapse is now out of date, leave it alone until the next pass
+                for (uint32_t t = adjacency.offsets[from]; t < adjacency.offsets[from + 1]; t++)
+                {
+                    const uint32_t* triangle = &result[adjacency.triangles[t] * 3];
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        locked[position_ids[triangle[c]]] = true;
+                    }
+                }
+            }
+
+            if (collapses_done == 0)
+                break;
+
+            // Apply, dropping the triangles which collapsed
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = remap[result[i + 0]];
+                const uint32_t b = remap[result[i + 1]];
+                const uint32_t c = remap[result[i + 2]];
+                if (position_ids[a] == position_ids[b] || position_ids[b] == position_ids[c] || position_ids[a] == position_ids[c])
+                    continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        if (error)
+        {
+            *error = static_cast<float>(sqrt(error_result));
+        }
+
+        return result;
+    }
+
+    float MeshOptimizer::ComputeAcmr(const vector<uint32_t>& indices, const uint32_t vertex_count, const uint32_t cache_size /*= 16*/)
+    {
+        if (indices.size() < 3)
+            return 0.0f;
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t time   = cache_size + 1;
+        uint32_t misses = 0;
+        for (const uint32_t index : indices)
+        {
+            if (time - timestamps[index] > cache_size)
+            {
+                timestamps[index] = time++;
+                misses++;
+            }
+        }
+
+        return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    }
+}
@@ -0,0 +1,55 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==============================
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Core/Spartan_Definitions.h"
+//=========================================
+
+namespace Spartan
+{
+    // Import time processing of indexed triangle lists: reordering for the GPU and simplification for LODs
+    class SPARTAN_CLASS MeshOptimizer
+    {
+    public:
+        // Orders the triangles so they reuse the vertices which are still in the post-transform cache (Tom Forsyth's linear-speed algorithm)
+        static void OptimizeVertexCache(std::vector<uint32_t>* indices, uint32_t vertex_count);
+
+        // Splits a cache optimized order into clusters and draws the outward facing ones first, so fewer pixels get shaded twice.
+        // threshold: how much worse than the input the cache efficiency of a cluster may get (1.05 is 5%)
+        static void OptimizeOverdraw(std::vector<uint32_t>* indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, float threshold = 1.05f);
+
+        // Moves the vertices into the order the indices first use them, so vertex fetches stream through memory, unused vertices are dropped.
+        // Every index list which references the vertices has to be passed, they all get remapped.
+        static void OptimizeVertexFetch(const std::vector<std::vector<uint32_t>*>& index_lists, std::vector<RHI_Vertex_PosTexNorTan>* vertices);
+
+        // Quadric error edge collapse, stops once the index count reaches the target or when the next collapse would move the surface further than error_max.
+        // The result references the same vertices, error receives how far (in model space) the surface moved.
+        static std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t index_count_target, float error_max, float* error = nullptr);
+
+        // Average cache miss ratio of a FIFO cache, vertices transformed per triangle (lower is better, 0.5 is the ideal for a regular grid)
+        static float ComputeAcmr(const std::vector<uint32_t>& indices, uint32_t vertex_count, uint32_t cache_size = 16);
+    };
+}
@@ -0,0 +1,576 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "MipGenerator.h"
+#include "../../Math/Simd.h"
+#include "../../Threading/Threading.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+// F16C ships with every AVX2 CPU, but GCC and Clang only expose it when asked to
+#if defined(SPARTAN_SIMD_AVX2) && (defined(_MSC_VER) || defined(__F16C__))
+    #define SPARTAN_MIP_F16C
+#endif
+
+namespace Spartan::mip_generator
+{
+    enum Element : uint8_t
+    {
+        Element_Unorm8,
+        Element_Float16,
+        Element_Float32
+    };
+
+    struct Layout
+    {
+        Element element             = Element_Unorm8;
+        uint32_t channels           = 0;
+        uint32_t bytes_per_pixel    = 0;
+    };
+
+    // Which source pixels (and how much of each) make up every destination pixel along one axis.
+    // Every destination pixel gets the same number of taps, unused ones have a weight of zero.
+    struct Taps
+    {
+        uint32_t count = 0;
+        vector<uint32_t> index;
+        vector<float> weight;
+    };
+
+    // Conversion tables, built once
+    struct Tables
+    {
+        float unorm8_to_float[256];
+        float srgb8_to_linear[256];
+        uint8_t linear_to_srgb8[65536]; // indexed by the linear value in 16-bit fixed point
+
+        Tables()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                const float value   = i / 255.0f;
+                unorm8_to_float[i]  = value;
+                srgb8_to_linear[i]  = value <= 0.04045f ? value / 12.92f : pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+
+            for (uint32_t i = 0; i < 65536; i++)
+            {
+                const float value   = i / 65535.0f;
+                const float srgb    = value <= 0.0031308f ? value * 12.92f : 1.055f * pow(value, 1.0f / 2.4f) - 0.055f;
+                linear_to_srgb8[i]  = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    static const Tables& get_tables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+    inline bool get_layout(const RHI_Format format, Layout& layout)
+    {
+        switch (format)
+        {
+            case RHI_Format_R8_Unorm:           layout = { Element_Unorm8,  1, 1 };  return true;
+            case RHI_Format_R8G8_Unorm:         layout = { Element_Unorm8,  2, 2 };  return true;
+            case RHI_Format_R8G8B8A8_Unorm:     layout = { Element_Unorm8,  4, 4 };  return true;
+            case RHI_Format_R16_Float:          layout = { Element_Float16, 1, 2 };  return true;
+            case RHI_Format_R16G16_Float:       layout = { Element_Float16, 2, 4 };  return true;
+            case RHI_Format_R16G16B16A16_Float: layout = { Element_Float16, 4, 8 };  return true;
+            case RHI_Format_R32_Float:          layout = { Element_Float32, 1, 4 };  return true;
+            case RHI_Format_R32G32_Float:       layout = { Element_Float32, 2, 8 };  return true;
+            case RHI_Format_R32G32B32A32_Float: layout = { Element_Float32, 4, 16 }; return true;
+            default:                            return false;
+        }
+    }
+
+    inline float filter_kaiser(const float t, const float radius)
+    {
+        static const float alpha = 4.0f;
+
+        // Zeroth order modified Bessel function of the first kind
+        const auto bessel_i0 = [](const float x)
+        {
+            float sum   = 1.0f;
+            float term  = 1.0f;
+            for (uint32_t k = 1; k < 16; k++)
+            {
+                term *= (x / (2.0f * k)) * (x / (2.0f * k));
+                sum  += term;
+            }
+            return sum;
+        };
+
+        const float ratio = t / radius;
+        if (ratio * ratio >= 1.0f)
+            return 0.0f;
+
+        const float window  = bessel_i0(alpha * sqrt(1.0f - ratio * ratio)) / bessel_i0(alpha);
+        const float x       = Math::Helper::PI * t;
+        const float sinc    = abs(x) < 1e-4f ? 1.0f : sin(x) / x;
+
+        return sinc * window;
+    }
+
+    // Samples are placed at pixel centers, so odd sizes get a proper three (or more) tap footprint instead of dropping the last pixel
+    inline Taps compute_taps(const uint32_t size_source, const uint32_t size_destination, const MipFilter filter)
+    {
+        static const float kaiser_radius = 1.5f; // in destination pixels
+
+        const float scale   = static_cast<float>(size_source) / static_cast<float>(size_destination);
+        const float support = filter == MipFilter_Box ? scale * 0.5f : kaiser_radius * scale;
+
+        Taps taps;
+        taps.count = static_cast<uint32_t>(ceil(support * 2.0f)) + 1;
+        taps.index.resize(static_cast<size_t>(size_destination) * taps.count);
+        taps.weight.resize(static_cast<size_t>(size_destination) * taps.count);
+
+        for (uint32_t x = 0; x < size_destination; x++)
+        {
+            const float center  = (x + 0.5f) * scale;
+            const int32_t first = static_cast<int32_t>(floor(center - support));
+            uint32_t* index     = &taps.index[static_cast<size_t>(x) * taps.count];
+            float* weight       = &taps.weight[static_cast<size_t>(x) * taps.count];
+            float weight_sum    = 0.0f;
+
+            for (uint32_t t = 0; t < taps.count; t++)
+            {
+                const int32_t i = first + static_cast<int32_t>(t);
+
+                if (filter == MipFilter_Box)
+                {
+                    // How much of the pixel the footprint covers
+                    const float overlap = min(i + 1.0f, center + support) - max(static_cast<float>(i), center - support);
+                    weight[t]           = max(overlap, 0.0f);
+                }
+                else
+                {
+                    weight[t] = filter_kaiser((i + 0.5f - center) / scale, kaiser_radius);
+                }
+
+                // The edges repeat
+                index[t]    = static_cast<uint32_t>(Math::Helper::Clamp(i, 0, static_cast<int32_t>(size_source) - 1));
+                weight_sum += weight[t];
+            }
+
+            for (uint32_t t = 0; t < taps.count; t++)
+            {
+                weight[t] /= weight_sum;
+            }
+        }
+
+        return taps;
+    }
+
+    // Source row to linear RGBA floats, missing channels are 0 and missing alpha is 1
+    inline void decode_row(const std::byte* source, const uint32_t width, const Layout& layout, const bool srgb, float* out)
+    {
+        const uint32_t channels = layout.channels;
+
+        if (layout.element == Element_Unorm8)
+        {
+            const Tables& tables        = get_tables();
+            const float* table_color    = srgb && channels == 4 ? tables.srgb8_to_linear : tables.unorm8_to_float;
+            const uint8_t* in           = reinterpret_cast<const uint8_t*>(source);
+
+            if (channels == 4)
+            {
+                for (uint32_t x = 0; x < width; x++, in += 4, out += 4)
+                {
+                    out[0] = table_color[in[0]];
+                    out[1] = table_color[in[1]];
+                    out[2] = table_color[in[2]];
+                    out[3] = tables.unorm8_to_float[in[3]];
+                }
+                return;
+            }
+
+            for (uint32_t x = 0; x < width; x++, in += channels, out += 4)
+            {
+                out[0] = table_color[in[0]];
+                out[1] = channels > 1 ? table_color[in[1]] : 0.0f;
+                out[2] = 0.0f;
+                out[3] = 1.0f;
+            }
+        }
+        else if (layout.element == Element_Float16)
+        {
+            const uint16_t* in = reinterpret_cast<const uint16_t*>(source);
+            uint32_t x = 0;
+
+        #if defined(SPARTAN_MIP_F16C)
+            if (channels == 4)
+            {
+                for (; x < width; x++, in += 4, out += 4)
+                {
+                    _mm_storeu_ps(out, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in))));
+                }
+                return;
+            }
+        #endif
+
+            for (; x < width; x++, in += channels, out += 4)
+            {
+                out[0] = Math::Helper::HalfToFloat(in[0]);
+                out[1] = channels > 1 ? Math::Helper::HalfToFloat(in[1]) : 0.0f;
+                out[2] = channels > 2 ? Math::Helper::HalfToFloat(in[2]) : 0.0f;
+                out[3] = channels > 3 ? Math::Helper::HalfToFloat(in[3]) : 1.0f;
+            }
+        }
+        else
+        {
+            const float* in = reinterpret_cast<const float*>(source);
+
+            if (channels == 4)
+            {
+                memcpy(out, in, static_cast<size_t>(width) * 4 * sizeof(float));
+                return;
+            }
+
+            for (uint32_t x = 0; x < width; x++, in += channels, out += 4)
+            {
+                out[0] = in[0];
+                out[1] = channels > 1 ? in[1] : 0.0f;
+                out[2] = 0.0f;
+                out[3] = 1.0f;
+            }
+        }
+    }
+
+    // Linear RGBA floats to a destination row
+    inline void encode_row(const float* in, const uint32_t width, const Layout& layout, const bool srgb, std::byte* destination)
+    {
+        const uint32_t channels = layout.channels;
+
+        if (layout.element == Element_Unorm8)
+        {
+            uint8_t* out = reinterpret_cast<uint8_t*>(destination);
+
+            if (srgb && channels == 4)
+            {
+                const uint8_t* table = get_tables().linear_to_srgb8;
+                const auto to_index = [](const float value) { return static_cast<uint32_t>(Math::Helper::Saturate(value) * 65535.0f + 0.5f); };
+
+                for (uint32_t x = 0; x < width; x++, in += 4, out += 4)
+                {
+                    out[0] = table[to_index(in[0])];
+                    out[1] = table[to_index(in[1])];
+                    out[2] = table[to_index(in[2])];
+                    out[3] = static_cast<uint8_t>(Math::Helper::Saturate(in[3]) * 255.0f + 0.5f);
+                }
+                return;
+            }
+
+            uint32_t x = 0;
+
+        #if defined(SPARTAN_SIMD_SSE4)
+            const __m128 zero   = _mm_setzero_ps();
+            const __m128 one    = _mm_set1_ps(1.0f);
+            const __m128 scale  = _mm_set1_ps(255.0f);
+            for (; x < width; x++, in += 4, out += channels)
+            {
+                const __m128 value      = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in), zero), one), scale);
+                const __m128i integers  = _mm_cvtps_epi32(value);
+                const __m128i packed    = _mm_packus_epi16(_mm_packus_epi32(integers, integers), integers);
+                const uint32_t bytes    = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+                memcpy(out, &bytes, channels);
+            }
+        #endif
+
+            for (; x < width; x++, in += 4, out += channels)
+            {
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    out[c] = static_cast<uint8_t>(Math::Helper::Saturate(in[c]) * 255.0f + 0.5f);
+                }
+            }
+        }
+        else if (layout.element == Element_Float16)
+        {
+            uint16_t* out = reinterpret_cast<uint16_t*>(destination);
+            uint32_t x = 0;
+
+            // Sharp filters ring, which can push values below zero
+        #if defined(SPARTAN_MIP_F16C)
+            if (channels == 4)
+            {
+                for (; x < width; x++, in += 4, out += 4)
+                {
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_cvtps_ph(_mm_max_ps(_mm_loadu_ps(in), _mm_setzero_ps()), 0));
+                }
+                return;
+            }
+        #endif
+
+            for (; x < width; x++, in += 4, out += channels)
+            {
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    out[c] = Math::Helper::FloatToHalf(max(in[c], 0.0f));
+                }
+            }
+        }
+        else
+        {
+            float* out = reinterpret_cast<float*>(destination);
+            for (uint32_t x = 0; x < width; x++, in += 4, out += channels)
+            {
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    out[c] = max(in[c], 0.0f);
+                }
+            }
+        }
+    }
+
+    // accumulator += row * weight
+    inline void accumulate(float* accumulator, const float* row, const float weight, const uint32_t count)
+    {
+        uint32_t i = 0;
+
+    #if defined(SPARTAN_SIMD_AVX2)
+        const __m256 weight_8 = _mm256_set1_ps(weight);
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(accumulator + i, _mm256_fmadd_ps(_mm256_loadu_ps(row + i), weight_8, _mm256_loadu_ps(accumulator + i)));
+        }
+    #endif
+
+    #if defined(SPARTAN_SIMD_SSE4)
+        const __m128 weight_4 = _mm_set1_ps(weight);
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_ps(accumulator + i, _mm_add_ps(_mm_loadu_ps(accumulator + i), _mm_mul_ps(_mm_loadu_ps(row + i), weight_4)));
+        }
+    #endif
+
+        for (; i < count; i++)
+        {
+            accumulator[i] += row[i] * weight;
+        }
+    }
+
+    // Horizontal pass, a pixel is four floats so it fits a single SSE register
+    inline void filter_row(const float* row, const Taps& taps, const uint32_t width, float* out)
+    {
+        const uint32_t* index   = taps.index.data();
+        const float* weight     = taps.weight.data();
+
+        for (uint32_t x = 0; x < width; x++, out += 4)
+        {
+        #if defined(SPARTAN_SIMD_SSE4)
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t t = 0; t < taps.count; t++, index++, weight++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + *index * 4), _mm_set1_ps(*weight)));
+            }
+            _mm_storeu_ps(out, sum);
+        #else
+            out[0] = out[1] = out[2] = out[3] = 0.0f;
+            for (uint32_t t = 0; t < taps.count; t++, index++, weight++)
+            {
+                const float* pixel = row + *index * 4;
+                out[0] += pixel[0] * *weight;
+                out[1] += pixel[1] * *weight;
+                out[2] += pixel[2] * *weight;
+                out[3] += pixel[3] * *weight;
+            }
+        #endif
+        }
+    }
+
+    inline float read_alpha(const std::byte* pixel, const Layout& layout)
+    {
+        if (layout.element == Element_Unorm8)   return get_tables().unorm8_to_float[static_cast<uint8_t>(pixel[3])];
+        if (layout.element == Element_Float16)  return Math::Helper::HalfToFloat(reinterpret_cast<const uint16_t*>(pixel)[3]);
+        return reinterpret_cast<const float*>(pixel)[3];
+    }
+
+    inline void write_alpha(std::byte* pixel, const Layout& layout, const float alpha)
+    {
+        if (layout.element == Element_Unorm8)       pixel[3] = static_cast<std::byte>(Math::Helper::Saturate(alpha) * 255.0f + 0.5f);
+        else if (layout.element == Element_Float16) reinterpret_cast<uint16_t*>(pixel)[3] = Math::Helper::FloatToHalf(alpha);
+        else                                        reinterpret_cast<float*>(pixel)[3] = alpha;
+    }
+
+    // Fraction of the pixels which pass an alpha test against the cutoff
+    inline float compute_coverage(const vector<std::byte>& mip, const Layout& layout, const uint32_t pixel_count, const float cutoff)
+    {
+        uint32_t passed = 0;
+        for (uint32_t i = 0; i < pixel_count; i++)
+        {
+            passed += read_alpha(&mip[static_cast<size_t>(i) * layout.bytes_per_pixel], layout) > cutoff ? 1 : 0;
+        }
+
+        return static_cast<float>(passed) / static_cast<float>(pixel_count);
+    }
+
+    // Scales alpha so the mip passes the alpha test as often as the top mip, otherwise alpha tested geometry thins out in the distance
+    inline void preserve_coverage(vector<std::byte>& mip, const Layout& layout, const uint32_t pixel_count, const float cutoff, const float coverage_target)
+    {
+        // Coverage only depends on which pixels pass, so a histogram of alpha is enough to search for the scale.
+        // 8-bit alpha gets a bin per value, so the search sees exactly what gets written back.
+        const bool is_unorm8    = layout.element == Element_Unorm8;
+        const uint32_t bin_max  = is_unorm8 ? 255 : 4095;
+        vector<uint32_t> histogram(bin_max + 1, 0);
+        for (uint32_t i = 0; i < pixel_count; i++)
+        {
+            const float alpha = Math::Helper::Saturate(read_alpha(&mip[static_cast<size_t>(i) * layout.bytes_per_pixel], layout));
+            histogram[static_cast<uint32_t>(alpha * bin_max + 0.5f)]++;
+        }
+
+        const auto coverage = [&](const float scale)
+        {
+            uint32_t passed = 0;
+            for (uint32_t bin = 0; bin <= bin_max; bin++)
+            {
+                float alpha = Math::Helper::Saturate(static_cast<float>(bin) / bin_max * scale);
+                alpha       = is_unorm8 ? static_cast<uint32_t>(alpha * 255.0f + 0.5f) / 255.0f : alpha;
+                passed     += alpha > cutoff ? histogram[bin] : 0;
+            }
+            return static_cast<float>(passed) / static_cast<float>(pixel_count);
+        };
+
+        // Coverage only grows with the scale
+        float scale_min = 0.0f;
+        float scale_max = 4.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const float scale = (scale_min + scale_max) * 0.5f;
+            (coverage(scale) < coverage_target ? scale_min : scale_max) = scale;
+        }
+
+        // Coverage moves in steps, take whichever side of the step lands closer (ties go up, thinning out is the worse artifact).
+        // Then step a bit further away from the edge, so rounding can't flip it.
+        const float error_min   = abs(coverage(scale_min) - coverage_target);
+        const float error_max   = abs(coverage(scale_max) - coverage_target);
+        // Leave alpha alone when scaling can't get any closer, otherwise solid alpha drifts down towards the cutoff
+        if (abs(coverage(1.0f) - coverage_target) <= min(error_min, error_max))
+            return;
+
+        const float margin      = scale_max - scale_min;
+        const float scale       = error_min + 0.001f < error_max ? scale_min - margin : scale_max + margin;
+        for (uint32_t i = 0; i < pixel_count; i++)
+        {
+            std::byte* pixel = &mip[static_cast<size_t>(i) * layout.bytes_per_pixel];
+            write_alpha(pixel, layout, Math::Helper::Saturate(read_alpha(pixel, layout) * scale));
+        }
+    }
+}
+
+namespace Spartan
+{
+    bool MipGenerator::Generate(const RHI_Format format, uint32_t width, uint32_t height, vector<vector<std::byte>>* mips, const MipFilter filter /*= MipFilter_Kaiser*/, const bool srgb /*= false*/, const float alpha_cutoff /*= 0.0f*/, Threading* threading /*= nullptr*/)
+    {
+        mip_generator::Layout layout;
+        if (!mips || mips->empty() || width == 0 || height == 0 || !mip_generator::get_layout(format, layout))
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        if (mips->front().size() < static_cast<size_t>(width) * height * layout.bytes_per_pixel)
+        {
+            LOG_ERROR("The top mip is smaller than a %dx%d %s image", width, height, rhi_format_to_string(format));
+            return false;
+        }
+
+        const bool preserve_coverage    = alpha_cutoff > 0.0f && layout.channels == 4;
+        const float coverage            = preserve_coverage ? mip_generator::compute_coverage(mips->front(), layout, width * height, alpha_cutoff) : 0.0f;
+
+        while (width > 1 && height > 1)
+        {
+            const uint32_t width_mip    = Math::Helper::Max(width / 2, static_cast<uint32_t>(1));
+            const uint32_t height_mip   = Math::Helper::Max(height / 2, static_cast<uint32_t>(1));
+            const mip_generator::Taps taps_x = mip_generator::compute_taps(width, width_mip, filter);
+            const mip_generator::Taps taps_y = mip_generator::compute_taps(height, height_mip, filter);
+
+            mips->emplace_back(static_cast<size_t>(width_mip) * height_mip * layout.bytes_per_pixel);
+            const vector<std::byte>& source = (*mips)[mips->size() - 2];
+            vector<std::byte>& destination  = mips->back();
+
+            // Vertical pass first into a full width row, then the horizontal pass, so every source row gets decoded once per band
+            const auto filter_rows = [&](const uint32_t start, const uint32_t end)
+            {
+                const uint32_t row_floats = width * 4;
+                const uint32_t cache_size = taps_y.count + 2; // neighbouring destination rows share most of their source rows
+
+                vector<float> accumulator(row_floats);
+                vector<float> filtered(static_cast<size_t>(width_mip) * 4);
+                vector<float> cache(static_cast<size_t>(cache_size) * row_floats);
+                vector<uint32_t> cache_rows(cache_size, static_cast<uint32_t>(-1));
+
+                for (uint32_t y = start; y < end; y++)
+                {
+                    fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+                    for (uint32_t t = 0; t < taps_y.count; t++)
+                    {
+                        const uint32_t row  = taps_y.index[static_cast<size_t>(y) * taps_y.count + t];
+                        const float weight  = taps_y.weight[static_cast<size_t>(y) * taps_y.count + t];
+                        if (weight == 0.0f)
+                            continue;
+
+                        float* decoded = &cache[static_cast<size_t>(row % cache_size) * row_floats];
+                        if (cache_rows[row % cache_size] != row)
+                        {
+                            mip_generator::decode_row(&source[static_cast<size_t>(row) * width * layout.bytes_per_pixel], width, layout, srgb, decoded);
+                            cache_rows[row % cache_size] = row;
+                        }
+
+                        mip_generator::accumulate(accumulator.data(), decoded, weight, row_floats);
+                    }
+
+                    mip_generator::filter_row(accumulator.data(), taps_x, width_mip, filtered.data());
+                    mip_generator::encode_row(filtered.data(), width_mip, layout, srgb, &destination[static_cast<size_t>(y) * width_mip * layout.bytes_per_pixel]);
+                }
+            };
+
+            // Bands of at least a few thousand pixels, so that small mips don't pay for scheduling
+            if (threading)
+            {
+                threading->ParallelFor(height_mip, filter_rows, Math::Helper::Max(4096 / width_mip, static_cast<uint32_t>(1)));
+            }
+            else
+            {
+                filter_rows(0, height_mip);
+            }
+
+            if (preserve_coverage)
+            {
+                mip_generator::preserve_coverage(destination, layout, width_mip * height_mip, alpha_cutoff, coverage);
+            }
+
+            width   = width_mip;
+            height  = height_mip;
+        }
+
+        return true;
+    }
+}
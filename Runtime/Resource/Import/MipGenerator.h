@@ -0,0 +1,52 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==============================
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+#include "../../Core/Spartan_Definitions.h"
+//=========================================
+
+namespace Spartan
+{
+    class Threading;
+
+    enum MipFilter : uint8_t
+    {
+        MipFilter_Box,      // averages the footprint of every pixel, cheapest
+        MipFilter_Kaiser    // windowed sinc, keeps more detail without aliasing
+    };
+
+    // Builds a mip chain on the CPU, every level is filtered from the one above it (not from the full size image).
+    // Levels are split into bands of rows which are spread across threads, and the filter kernels use SIMD (when available).
+    // Handles 8-bit unorm, 16-bit float and 32-bit float images with 1, 2 or 4 channels.
+    class SPARTAN_CLASS MipGenerator
+    {
+    public:
+        // Appends mips to the chain until either dimension reaches 1, mips->front() has to hold the full size image.
+        // srgb:            color channels are sRGB encoded, they get filtered in linear space.
+        // alpha_cutoff:    when above zero, alpha is scaled so that every mip passes an alpha test against it as often as the top mip does.
+        static bool Generate(RHI_Format format, uint32_t width, uint32_t height, std::vector<std::vector<std::byte>>* mips, MipFilter filter = MipFilter_Kaiser, bool srgb = false, float alpha_cutoff = 0.0f, Threading* threading = nullptr);
+    };
+}
@@ -31,6 +31,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../World/World.h"
 #include "../../World/Components/Renderable.h"
 #include "../../RHI/RHI_Vertex.h"
+#include "../../Utilities/Geometry.h"
+#include "MeshOptimizer.h"
 //============================================
 
 //= NAMESPACES ================
@@ -41,6 +43,102 @@ using namespace Assimp;
 
 namespace Spartan
 {
+    static const uint32_t lod_count_max             = 4;
+    static const uint32_t lod_triangle_count_min    = 64;   // meshes (or levels) this small aren't worth reducing further
+    static const float lod_reduction_min            = 0.8f; // a level has to drop at least 20% of the triangles of the one before it
+    static const float lod_error_max                = 0.05f; // as a fraction of the mesh's size
+
+    // Optimizes the triangle (and vertex) order and appends the levels of detail to the indices, their offsets are relative to the mesh
+    static void optimize_mesh(vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices, vector<MeshLod>* lods, const bool reorder_vertices)
+    {
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices->size());
+
+        MeshOptimizer::OptimizeVertexCache(indices, vertex_count);
+        MeshOptimizer::OptimizeOverdraw(indices, *vertices);
+
+        // Each level targets half the triangles of the one before it
+        const BoundingBox aabb      = BoundingBox(vertices->data(), vertex_count);
+        const float error_max       = (aabb.GetMax() - aabb.GetMin()).Length() * lod_error_max;
+        vector<vector<uint32_t>> lod_indices;
+        lod_indices.reserve(lod_count_max);
+        const vector<uint32_t>* previous = indices;
+        float error_total = 0.0f;
+        while (lod_indices.size() < lod_count_max && previous->size() / 2 >= lod_triangle_count_min * 3)
+        {
+            float error = 0.0f;
+            vector<uint32_t> simplified = MeshOptimizer::Simplify(*previous, *vertices, static_cast<uint32_t>(previous->size() / 2), error_max, &error);
+
+            // Stuck on seams or out of error budget
+            if (simplified.size() > previous->size() * lod_reduction_min)
+                break;
+
+            MeshOptimizer::OptimizeVertexCache(&simplified, vertex_count);
+
+            // Each level was reduced from the one before it, so the errors add up
+            error_total += error;
+            lods->push_back({ 0, static_cast<uint32_t>(simplified.size()), error_total });
+            lod_indices.emplace_back(move(simplified));
+            previous = &lod_indices.back();
+        }
+
+        // All the levels share the vertices, so order them by first use across all of them
+        if (reorder_vertices)
+        {
+            vector<vector<uint32_t>*> index_lists = { indices };
+            for (vector<uint32_t>& lod : lod_indices)
+            {
+                index_lists.emplace_back(&lod);
+            }
+            MeshOptimizer::OptimizeVertexFetch(index_lists, vertices);
+        }
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(lod_indices.size()); i++)
+        {
+            (*lods)[i].index_offset = static_cast<uint32_t>(indices->size());
+            indices->insert(indices->end(), lod_indices[i].begin(), lod_indices[i].end());
+        }
+    }
+
+    // A mesh converted (and optimized) off the importing thread
+    struct ModelImporterMesh
+    {
+        vector<uint32_t> indices;
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<MeshLod> lods;
+        BoundingBox aabb;
+
+        // Where the geometry ended up in the model, every node referring to the mesh shares it
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        uint32_t vertex_offset  = 0;
+        uint32_t vertex_count   = 0;
+    };
+
+    // A texture loaded once, no matter how many materials (or slots) refer to it
+    struct ModelImporterTexture
+    {
+        string file_path;
+        Material_Property type = Material_Unknown; // the first slot to refer to the texture decides its compression format and color space
+        shared_ptr<RHI_Texture> texture;
+    };
+
+    struct ModelImporterTextureSlot
+    {
+        uint32_t material_index = 0;
+        Material_Property type  = Material_Unknown;
+        uint32_t texture_index  = 0;
+    };
+
+    struct ModelImporterData
+    {
+        vector<ModelImporterMesh> meshes;                   // indexed like aiScene::mMeshes
+        vector<shared_ptr<Material>> materials;             // indexed like aiScene::mMaterials
+        vector<ModelImporterTexture> textures;
+        vector<ModelImporterTextureSlot> texture_slots;     // in the order the materials request them
+        unordered_map<string, uint32_t> texture_indices;    // by file path
+        mutex mutex_progress;
+    };
+
     ModelImporter::ModelImporter(Context* context)
     {
         m_context    = context;
@@ -101,7 +199,6 @@ namespace Spartan
             aiProcess_GenSmoothNormals |
             aiProcess_JoinIdenticalVertices |
             aiProcess_OptimizeMeshes |              // reduce the number of meshes         
-            aiProcess_ImproveCacheLocality |        // re-order triangles for better vertex cache locality.
             aiProcess_RemoveRedundantMaterials |    // remove redundant/unreferenced materials.
             aiProcess_LimitBoneWeights |
             aiProcess_SplitLargeMeshes |
@@ -120,10 +217,60 @@ namespace Spartan
         // Read the 3D model file from disk
         if (const aiScene* scene = importer.ReadFile(file_path, importer_flags))
         {
-            FIRE_EVENT(EventType::WorldStop);
+            ModelImporterData data;
+            data.meshes.resize(scene->mNumMeshes);
+            data.materials.resize(scene->mNumMaterials);
 
             params.scene            = scene;
             params.has_animation    = scene->mNumAnimations != 0;
+            params.data             = &data;
+
+            // Materials, they also queue the textures they need
+            for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+            {
+                data.materials[i] = LoadMaterial(scene->mMaterials[i], i, params);
+            }
+
+            // Update progress tracking
+            int node_count = 0;
+            AssimpHelper::compute_node_count(scene->mRootNode, &node_count);
+            ProgressReport::Get().SetJobCount(g_progress_model_importer, static_cast<int>(data.meshes.size() + data.textures.size()) + node_count);
+
+            // The heavy lifting, nothing here touches the world so it keeps running
+            LoadMeshesAndTextures(params);
+            AssignTextures(params);
+
+            // Append the geometry, in mesh order so the layout doesn't depend on thread timing
+            for (ModelImporterMesh& mesh : data.meshes)
+            {
+                if (mesh.indices.empty() || mesh.vertices.empty())
+                    continue;
+
+                model->AppendGeometry(mesh.indices, mesh.vertices, &mesh.index_offset, &mesh.vertex_offset);
+
+                // The levels of detail are stored relative to the mesh, make them relative to the model
+                mesh.index_count    = mesh.lods.empty() ? static_cast<uint32_t>(mesh.indices.size()) : mesh.lods.front().index_offset;
+                mesh.vertex_count   = static_cast<uint32_t>(mesh.vertices.size());
+                if (!mesh.lods.empty())
+                {
+                    for (MeshLod& lod : mesh.lods)
+                    {
+                        lod.index_offset += mesh.index_offset;
+                    }
+                    model->SetLods(mesh.index_offset, mesh.lods);
+                }
+
+                // The model has its own copy now
+                mesh.indices        = vector<uint32_t>();
+                mesh.vertices       = vector<RHI_Vertex_PosTexNorTan>();
+            }
+
+            // Update model geometry
+            model->SetVertexPacked(m_vertex_packing);
+            model->UpdateGeometry();
+
+            // Only the entity creation needs the world to be stopped
+            FIRE_EVENT(EventType::WorldStop);
 
             // Create root entity to match Assimp's root node
             const bool is_active = false;
@@ -131,17 +278,10 @@ namespace Spartan
             new_entity->SetName(params.name); // Set custom name, which is more descriptive than "RootNode"
             params.model->SetRootEntity(new_entity);
 
-            // Update progress tracking
-            int job_count = 0;
-            AssimpHelper::compute_node_count(scene->mRootNode, &job_count);
-            ProgressReport::Get().SetJobCount(g_progress_model_importer, job_count);
-
             // Parse all nodes, starting from the root node and continuing recursively
             ParseNode(scene->mRootNode, params, nullptr, new_entity.get());
             // Parse animations
             ParseAnimations(params);
-            // Update model geometry
-            model->UpdateGeometry();
 
             FIRE_EVENT(EventType::WorldStart);
         }
@@ -191,7 +331,6 @@ namespace Spartan
         for (uint32_t i = 0; i < assimp_node->mNumMeshes; i++)
         {
             auto entity = new_entity; // set the current entity
-            const auto assimp_mesh = params.scene->mMeshes[assimp_node->mMeshes[i]]; // get mesh
             string _name = assimp_node->mName.C_Str(); // get name
 
             // if this node has many meshes, then assign a new entity for each one of them
@@ -207,7 +346,7 @@ namespace Spartan
             entity->SetName(_name);
 
             // Process mesh
-            LoadMesh(assimp_mesh, entity, params);
+            AddMesh(assimp_node->mMeshes[i], entity, params);
             entity->SetActive(true);
         }
     }
@@ -262,19 +401,46 @@ namespace Spartan
         }
     }
 
-    void ModelImporter::LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params)
+    void ModelImporter::LoadMeshesAndTextures(const ModelParams& params)
     {
-        if (!assimp_mesh || !entity_parent)
+        ProgressReport::Get().SetStatus(g_progress_model_importer, "Loading meshes and textures");
+
+        // One job per texture or mesh, textures first since they tend to take the longest
+        const uint32_t texture_count    = static_cast<uint32_t>(params.data->textures.size());
+        const uint32_t job_count        = texture_count + static_cast<uint32_t>(params.data->meshes.size());
+        m_context->GetSubsystem<Threading>()->ParallelFor(job_count, [this, &params, texture_count](uint32_t start, uint32_t end)
         {
-            LOG_ERROR_INVALID_PARAMETER();
-            return;
-        }
+            for (uint32_t i = start; i < end; i++)
+            {
+                if (i < texture_count)
+                {
+                    LoadTexture(i, params);
+                }
+                else
+                {
+                    LoadMesh(i - texture_count, params);
+                }
+
+                // Update progress tracking
+                lock_guard<mutex> lock(params.data->mutex_progress);
+                ProgressReport::Get().IncrementJobsDone(g_progress_model_importer);
+            }
+        }, 1);
+    }
+
+    void ModelImporter::LoadMesh(const uint32_t mesh_index, const ModelParams& params)
+    {
+        const aiMesh* assimp_mesh   = params.scene->mMeshes[mesh_index];
+        ModelImporterMesh& mesh     = params.data->meshes[mesh_index];
 
         const uint32_t vertex_count = assimp_mesh->mNumVertices;
         const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
+        if (vertex_count == 0 || index_count == 0)
+            return;
 
         // Vertices
-        vector<RHI_Vertex_PosTexNorTan> vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
+        vector<RHI_Vertex_PosTexNorTan>& vertices = mesh.vertices;
+        vertices.resize(vertex_count);
         {
             for (uint32_t i = 0; i < vertex_count; i++)
             {
@@ -316,7 +482,8 @@ namespace Spartan
         }
 
         // Indices
-        vector<uint32_t> indices = vector<uint32_t>(index_count);
+        vector<uint32_t>& indices = mesh.indices;
+        indices.resize(index_count);
         {
             // Get indices by iterating through each face of the mesh.
             for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
@@ -330,36 +497,77 @@ namespace Spartan
             }
         }
 
-        // Compute AABB (before doing move operation on vertices)
-        const auto aabb = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
+        // Fill in whatever assimp couldn't provide (e.g. tangents of meshes with no texture coordinates)
+        if (!assimp_mesh->mNormals || !assimp_mesh->mTangents)
+        {
+            Utility::Geometry::ComputeNormalsTangents(indices, &vertices, m_context->GetSubsystem<Threading>(), !assimp_mesh->mNormals, !assimp_mesh->mTangents);
+        }
+
+        // Reorder for the gpu caches and append the levels of detail, vertices can only be reordered if nothing else refers to them (bones)
+        optimize_mesh(&indices, &vertices, &mesh.lods, !assimp_mesh->HasBones());
+
+        mesh.aabb = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
+    }
 
-        // Add the mesh to the model
-        uint32_t index_offset;
-        uint32_t vertex_offset;
-        params.model->AppendGeometry(move(indices), move(vertices), &index_offset, &vertex_offset);
+    void ModelImporter::LoadTexture(const uint32_t texture_index, const ModelParams& params)
+    {
+        ModelImporterTexture& texture   = params.data->textures[texture_index];
+        texture.texture                 = params.model->LoadTexture(texture.type, texture.file_path);
+    }
+
+    void ModelImporter::AssignTextures(const ModelParams& params)
+    {
+        // In the order the materials requested them, so later slots override earlier ones (as they would if loaded one by one)
+        for (const ModelImporterTextureSlot& slot : params.data->texture_slots)
+        {
+            shared_ptr<Material>& material  = params.data->materials[slot.material_index];
+            shared_ptr<RHI_Texture> texture = params.data->textures[slot.texture_index].texture;
+            if (!material || !texture)
+                continue;
+
+            // Some models (or Assimp) pass a normal map as a height map, others pass a height map as a normal map, we try to fix that.
+            auto proper_type = slot.type;
+            proper_type = (proper_type == Material_Normal && texture->GetGrayscale()) ? Material_Height : proper_type;
+            proper_type = (proper_type == Material_Height && !texture->GetGrayscale()) ? Material_Normal : proper_type;
+
+            material->SetTextureSlot(proper_type, texture);
+        }
+    }
+
+    void ModelImporter::AddMesh(const uint32_t mesh_index, Entity* entity, const ModelParams& params)
+    {
+        if (!entity)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        const aiMesh* assimp_mesh       = params.scene->mMeshes[mesh_index];
+        const ModelImporterMesh& mesh   = params.data->meshes[mesh_index];
+        if (mesh.index_count == 0)
+            return;
 
         // Add a renderable component to this entity
-        auto renderable    = entity_parent->AddComponent<Renderable>();
+        auto renderable = entity->AddComponent<Renderable>();
 
         // Set the geometry
         renderable->GeometrySet(
-            entity_parent->GetName(),
-            index_offset,
-            static_cast<uint32_t>(indices.size()),
-            vertex_offset,
-            static_cast<uint32_t>(vertices.size()),
-            aabb,
+            entity->GetName(),
+            mesh.index_offset,
+            mesh.index_count,
+            mesh.vertex_offset,
+            mesh.vertex_count,
+            mesh.aabb,
             params.model
         );
 
         // Material
-        if (params.scene->HasMaterials())
+        if (assimp_mesh->mMaterialIndex < params.data->materials.size())
         {
-            // Get aiMaterial
-            const auto assimp_material = params.scene->mMaterials[assimp_mesh->mMaterialIndex];
-            // Convert it and add it to the model
-            shared_ptr<Material> material = LoadMaterial(assimp_material, params);
-            params.model->AddMaterial(material, entity_parent->GetPtrShared());
+            if (shared_ptr<Material>& material = params.data->materials[assimp_mesh->mMaterialIndex])
+            {
+                params.model->AddMaterial(material, entity->GetPtrShared());
+            }
         }
 
         // Bones
@@ -406,7 +614,7 @@ namespace Spartan
         //boneTransforms.resize(numBones);
     }
 
-    shared_ptr<Material> ModelImporter::LoadMaterial(aiMaterial* assimp_material, const ModelParams& params)
+    shared_ptr<Material> ModelImporter::LoadMaterial(aiMaterial* assimp_material, const uint32_t material_index, const ModelParams& params)
     {
         if (!assimp_material)
         {
@@ -432,8 +640,8 @@ namespace Spartan
 
         material->SetColorAlbedo(Vector4(color_diffuse.r, color_diffuse.g, color_diffuse.b, opacity.r));
 
-        // TEXTURES
-        const auto load_mat_tex = [&params, &assimp_material, &material](const Material_Property type_spartan, const aiTextureType type_assimp_pbr, const aiTextureType type_assimp_legacy)
+        // TEXTURES, they are only queued here and loaded later, in parallel
+        const auto load_mat_tex = [&params, &assimp_material, &material, material_index](const Material_Property type_spartan, const aiTextureType type_assimp_pbr, const aiTextureType type_assimp_legacy)
         {
             aiTextureType type_assimp   = assimp_material->GetTextureCount(type_assimp_pbr)     > 0 ? type_assimp_pbr       : aiTextureType_NONE;
             type_assimp                 = assimp_material->GetTextureCount(type_assimp_legacy)  > 0 ? type_assimp_legacy    : type_assimp;
@@ -446,35 +654,25 @@ namespace Spartan
                     const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, params.file_path);
                     if (FileSystem::IsSupportedImageFile(deduced_path))
                     {
-                        params.model->AddTexture(material, type_spartan, AssimpHelper::texture_validate_path(texture_path.data, params.file_path));
+                        // Queue the texture, unless another material (or slot) already did
+                        ModelImporterData* data = params.data;
+                        auto it = data->texture_indices.find(deduced_path);
+                        if (it == data->texture_indices.end())
+                        {
+                            it = data->texture_indices.emplace(deduced_path, static_cast<uint32_t>(data->textures.size())).first;
+
+                            ModelImporterTexture texture;
+                            texture.file_path   = deduced_path;
+                            texture.type        = type_spartan;
+                            data->textures.emplace_back(move(texture));
+                        }
+                        data->texture_slots.push_back({ material_index, type_spartan, it->second });
 
                         if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
                         {
                             // FIX: materials that have a diffuse texture should not be tinted black/gray
                             material->SetColorAlbedo(Vector4::One);
                         }
-
-                        // Some models (or Assimp) pass a normal map as a height map
-                        // auto textureType others pass a height map as a normal map, we try to fix that.
-                        if (type_spartan == Material_Normal || type_spartan == Material_Height)
-                        {
-                            if (const auto texture = material->GetTexture_PtrShared(type_spartan))
-                            {
-                                auto proper_type = type_spartan;
-                                proper_type = (proper_type == Material_Normal && texture->GetGrayscale()) ? Material_Height : proper_type;
-                                proper_type = (proper_type == Material_Height && !texture->GetGrayscale()) ? Material_Normal : proper_type;
-
-                                if (proper_type != type_spartan)
-                                {
-                                    material->SetTextureSlot(type_spartan, shared_ptr<RHI_Texture>());
-                                    material->SetTextureSlot(proper_type, texture);
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("Failed to get texture");
-                            }
-                        }
                     }
                 }
             }
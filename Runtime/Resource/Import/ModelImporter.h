@@ -39,6 +39,7 @@ namespace Spartan
     class Entity;
     class Model;
     class World;
+    struct ModelImporterData;
 
     struct ModelParams
     {
@@ -51,6 +52,7 @@ namespace Spartan
         bool has_animation;
         Model* model            = nullptr;
         const aiScene* scene    = nullptr;
+        ModelImporterData* data = nullptr; // what the import phases produce
     };
 
     class SPARTAN_CLASS ModelImporter
@@ -61,16 +63,26 @@ namespace Spartan
 
         bool Load(Model* model, const std::string& file_path);
 
+        // Whether the models imported from now on store packed vertices (RHI_Vertex_PosTexNorTanPacked)
+        bool GetVertexPacking() const                       { return m_vertex_packing; }
+        void SetVertexPacking(const bool vertex_packing)    { m_vertex_packing = vertex_packing; }
+
     private:
-        // Parsing
+        // Parsing, creates the entities
         void ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
         void ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, const ModelParams& params);
         void ParseAnimations(const ModelParams& params);
 
-        // Loading
-        void LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params);
+        // Loading, the meshes and the textures are independent of each other so they load in parallel
+        void LoadMeshesAndTextures(const ModelParams& params);
+        void LoadMesh(uint32_t mesh_index, const ModelParams& params);
+        void LoadTexture(uint32_t texture_index, const ModelParams& params);
         void LoadBones(const aiMesh* assimp_mesh, const ModelParams& params);
-        std::shared_ptr<Material> LoadMaterial(aiMaterial* assimp_material, const ModelParams& params);
+        std::shared_ptr<Material> LoadMaterial(aiMaterial* assimp_material, uint32_t material_index, const ModelParams& params);
+        void AssignTextures(const ModelParams& params);
+        void AddMesh(uint32_t mesh_index, Entity* entity, const ModelParams& params);
+
+        bool m_vertex_packing = false;
 
         // Dependencies
         Context* m_context;
@@ -59,15 +59,17 @@ namespace Spartan
         SetProjectDirectory("Project/");
 
         // Subscribe to events
-        SUBSCRIBE_TO_EVENT(EventType::WorldSave,    EVENT_HANDLER(SaveResourcesToFiles));
-        SUBSCRIBE_TO_EVENT(EventType::WorldLoad,    EVENT_HANDLER(LoadResourcesFromFiles));
-        SUBSCRIBE_TO_EVENT(EventType::WorldUnload,    EVENT_HANDLER(Clear));
+        m_subscription_world_save   = SUBSCRIBE_TO_EVENT(EventType::WorldSave,      EVENT_HANDLER(SaveResourcesToFiles));
+        m_subscription_world_load   = SUBSCRIBE_TO_EVENT(EventType::WorldLoad,      EVENT_HANDLER(LoadResourcesFromFiles));
+        m_subscription_world_unload = SUBSCRIBE_TO_EVENT(EventType::WorldUnload,    EVENT_HANDLER(Clear));
     }
 
     ResourceCache::~ResourceCache()
     {
-        // Unsubscribe from event
-        UNSUBSCRIBE_FROM_EVENT(EventType::WorldUnload, EVENT_HANDLER(Clear));
+        // Unsubscribe from events
+        UNSUBSCRIBE_FROM_EVENT(m_subscription_world_save);
+        UNSUBSCRIBE_FROM_EVENT(m_subscription_world_load);
+        UNSUBSCRIBE_FROM_EVENT(m_subscription_world_unload);
         Clear();
     }
 
@@ -88,29 +90,45 @@ namespace Spartan
             return false;
         }
 
-        for (const auto& resource : m_resource_groups[resource_type])
-        {
-            if (resource_name == resource->GetResourceName())
-                return true;
-        }
+        return GetByName(resource_name, resource_type) != nullptr;
+    }
+
+    shared_ptr<IResource> ResourceCache::GetByName(const string& name, const ResourceType type)
+    {
+        shared_lock<shared_mutex> lock(m_mutex);
 
-        return false;
+        const auto it_group = m_index_name.find(type);
+        if (it_group == m_index_name.end())
+            return nullptr;
+
+        const auto it = it_group->second.find(name);
+        return it != it_group->second.end() ? it->second : nullptr;
     }
 
-    shared_ptr<IResource>& ResourceCache::GetByName(const string& name, const ResourceType type)
+    shared_ptr<IResource> ResourceCache::GetByPath(const string& path, const ResourceType type)
     {
-        for (auto& resource : m_resource_groups[type])
-        {
-            if (name == resource->GetResourceName())
-                return resource;
-        }
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        const auto it_group = m_index_path.find(type);
+        if (it_group == m_index_path.end())
+            return nullptr;
 
-        static shared_ptr<IResource> empty;
-        return empty;
+        const auto it = it_group->second.find(path);
+        return it != it_group->second.end() ? it->second : nullptr;
+    }
+
+    shared_ptr<IResource> ResourceCache::GetById(const uint32_t id)
+    {
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        const auto it = m_index_id.find(id);
+        return it != m_index_id.end() ? it->second.resource : nullptr;
     }
 
     vector<shared_ptr<IResource>> ResourceCache::GetByType(const ResourceType type /*= ResourceType::Unknown*/)
     {
+        shared_lock<shared_mutex> lock(m_mutex);
+
         vector<shared_ptr<IResource>> resources;
 
         if (type == ResourceType::Unknown)
@@ -122,12 +140,103 @@ namespace Spartan
         }
         else
         {
-            resources = m_resource_groups[type];
+            const auto it = m_resource_groups.find(type);
+            if (it != m_resource_groups.end())
+            {
+                resources = it->second;
+            }
         }
 
         return resources;
     }
 
+    shared_ptr<IResource> ResourceCache::Add(const shared_ptr<IResource>& resource)
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        const ResourceType type = resource->GetResourceType();
+
+        // Ensure that this resource is not already cached
+        auto& index_name = m_index_name[type];
+        const auto it = index_name.find(resource->GetResourceName());
+        if (it != index_name.end())
+            return it->second;
+
+        m_resource_groups[type].emplace_back(resource);
+        index_name[resource->GetResourceName()]                     = resource;
+        m_index_path[type][resource->GetResourceFilePathNative()]   = resource;
+        m_index_id[resource->GetId()]                               = { resource, resource->GetResourceName(), resource->GetResourceFilePathNative() };
+
+        return nullptr;
+    }
+
+    void ResourceCache::Remove(const uint32_t id)
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        const auto it_id = m_index_id.find(id);
+        if (it_id == m_index_id.end())
+            return;
+
+        const IndexEntry entry  = it_id->second;
+        const ResourceType type = entry.resource->GetResourceType();
+
+        m_index_id.erase(it_id);
+        IndexErase(type, entry);
+
+        auto& group = m_resource_groups[type];
+        group.erase(remove(group.begin(), group.end(), entry.resource), group.end());
+    }
+
+    void ResourceCache::OnResourceFilePathChanged(IResource* resource)
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        const auto it_id = m_index_id.find(resource->GetId());
+        if (it_id == m_index_id.end() || it_id->second.resource.get() != resource)
+            return;
+
+        IndexEntry& entry = it_id->second;
+        if (entry.name == resource->GetResourceName() && entry.path == resource->GetResourceFilePathNative())
+            return;
+
+        // Re-key, the first resource with a given name keeps it, same as when caching
+        const ResourceType type = resource->GetResourceType();
+        IndexErase(type, entry);
+        entry.name = resource->GetResourceName();
+        entry.path = resource->GetResourceFilePathNative();
+        m_index_name[type].emplace(entry.name, entry.resource);
+        m_index_path[type].emplace(entry.path, entry.resource);
+    }
+
+    void ResourceCache::IndexErase(const ResourceType type, const IndexEntry& entry)
+    {
+        // Only if the keys still lead to this resource, another one might be indexed under them
+        auto& index_name = m_index_name[type];
+        const auto it_name = index_name.find(entry.name);
+        if (it_name != index_name.end() && it_name->second == entry.resource)
+        {
+            index_name.erase(it_name);
+        }
+
+        auto& index_path = m_index_path[type];
+        const auto it_path = index_path.find(entry.path);
+        if (it_path != index_path.end() && it_path->second == entry.resource)
+        {
+            index_path.erase(it_path);
+        }
+    }
+
+    void ResourceCache::Clear()
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        m_resource_groups.clear();
+        m_index_name.clear();
+        m_index_path.clear();
+        m_index_id.clear();
+    }
+
     void ResourceCache::SaveResourcesToFiles()
     {
         // Start progress report
@@ -144,30 +253,29 @@ namespace Spartan
             return;
         }
 
-        const auto resource_count = GetResourceCount();
+        // Work on a copy, so that the cache isn't locked while saving (saving can cache other resources)
+        const vector<shared_ptr<IResource>> resources = GetByType();
+        const auto resource_count = static_cast<uint32_t>(resources.size());
         ProgressReport::Get().SetJobCount(g_progress_resource_cache, resource_count);
 
         // Save resource count
         file->Write(resource_count);
 
         // Save all the currently used resources to disk
-        for (const auto& resource_group : m_resource_groups)
+        for (const auto& resource : resources)
         {
-            for (const auto& resource : resource_group.second)
-            {
-                if (!resource->HasFilePathNative())
-                    continue;
-
-                // Save file path
-                file->Write(resource->GetResourceFilePathNative());
-                // Save type
-                file->Write(static_cast<uint32_t>(resource->GetResourceType()));
-                // Save resource (to a dedicated file)
-                resource->SaveToFile(resource->GetResourceFilePathNative());
-
-                // Update progress
-                ProgressReport::Get().IncrementJobsDone(g_progress_resource_cache);
-            }
+            if (!resource->HasFilePathNative())
+                continue;
+
+            // Save file path
+            file->Write(resource->GetResourceFilePathNative());
+            // Save type
+            file->Write(static_cast<uint32_t>(resource->GetResourceType()));
+            // Save resource (to a dedicated file)
+            resource->SaveToFile(resource->GetResourceFilePathNative());
+
+            // Update progress
+            ProgressReport::Get().IncrementJobsDone(g_progress_resource_cache);
         }
 
         // Finish with progress report
@@ -185,6 +293,13 @@ namespace Spartan
         // Load resource count
         const auto resource_count = file->ReadAs<uint32_t>();
 
+        // Everything loads on the worker threads. Materials look up their textures when they load,
+        // so they wait for the textures to finish first, everything else loads in any order.
+        Threading* threading        = m_context->GetSubsystem<Threading>();
+        const TaskHandle all        = threading->CreateTask([] {});
+        const TaskHandle textures   = threading->CreateTask([] {}, all);
+        vector<string> materials;
+
         for (uint32_t i = 0; i < resource_count; i++)
         {
             // Load resource file path
@@ -196,29 +311,40 @@ namespace Spartan
             switch (type)
             {
             case ResourceType::Model:
-                Load<Model>(file_path);
+                LoadAsync<Model>(file_path, TaskHandle(), all);
                 break;
             case ResourceType::Material:
-                Load<Material>(file_path);
+                materials.emplace_back(file_path);
                 break;
             case ResourceType::Texture:
-                Load<RHI_Texture>(file_path);
+                LoadAsync<RHI_Texture>(file_path, TaskHandle(), textures);
                 break;
             case ResourceType::Texture2d:
-                Load<RHI_Texture2D>(file_path);
+                LoadAsync<RHI_Texture2D>(file_path, TaskHandle(), textures);
                 break;
             case ResourceType::TextureCube:
-                Load<RHI_TextureCube>(file_path);
+                LoadAsync<RHI_TextureCube>(file_path, TaskHandle(), textures);
                 break;
             case ResourceType::Audio:
-                Load<AudioClip>(file_path);
+                LoadAsync<AudioClip>(file_path, TaskHandle(), all);
                 break;
             }
         }
+
+        for (const string& file_path : materials)
+        {
+            LoadAsync<Material>(file_path, textures, all);
+        }
+
+        threading->SubmitTask(textures);
+        threading->SubmitTask(all);
+        threading->Wait(all);
     }
 
     uint64_t ResourceCache::GetMemoryUsageCpu(ResourceType type /*= Resource_Unknown*/)
     {
+        shared_lock<shared_mutex> lock(m_mutex);
+
         uint64_t size = 0;
 
         if (type == ResourceType::Unknown)
@@ -234,9 +360,9 @@ namespace Spartan
                 }
             }
         }
-        else
+        else if (m_resource_groups.count(type))
         {
-            for (const auto& resource : m_resource_groups[type])
+            for (const auto& resource : m_resource_groups.at(type))
             {
                 if (Spartan_Object* object = dynamic_cast<Spartan_Object*>(resource.get()))
                 {
@@ -250,9 +376,14 @@ namespace Spartan
 
     uint64_t ResourceCache::GetMemoryUsageGpu(ResourceType type /*= Resource_Unknown*/)
     {
+        shared_lock<shared_mutex> lock(m_mutex);
+
         uint64_t size = 0;
 
-        for (const auto& resource : m_resource_groups[type])
+        if (!m_resource_groups.count(type))
+            return size;
+
+        for (const auto& resource : m_resource_groups.at(type))
         {
             if (Spartan_Object* object = dynamic_cast<Spartan_Object*>(resource.get()))
             {
@@ -265,7 +396,13 @@ namespace Spartan
 
     uint32_t ResourceCache::GetResourceCount(const ResourceType type)
     {
-        return static_cast<uint32_t>(GetByType(type).size());
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        if (type == ResourceType::Unknown)
+            return static_cast<uint32_t>(m_index_id.size());
+
+        const auto it = m_resource_groups.find(type);
+        return it != m_resource_groups.end() ? static_cast<uint32_t>(it->second.size()) : 0;
     }
 
     void ResourceCache::AddDataDirectory(const Asset_Type type, const string& directory)
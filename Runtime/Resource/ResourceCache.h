@@ -23,8 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==================
 #include <unordered_map>
+#include <shared_mutex>
 #include "IResource.h"
 #include "../Core/ISubsystem.h"
+#include "../Core/EventSystem.h"
+#include "../Threading/Threading.h"
 //=============================
 
 namespace Spartan
@@ -45,6 +48,51 @@ namespace Spartan
         Asset_Textures
     };
 
+    // A resource which is loading on a worker thread
+    struct ResourceLoad
+    {
+        TaskHandle task;
+        std::shared_ptr<IResource> resource;
+        std::atomic<bool> done = false;
+    };
+
+    // Returned by ResourceCache::LoadAsync(), every request for the same file shares the same load
+    template <class T>
+    class ResourceRequest
+    {
+    public:
+        ResourceRequest() = default;
+        ResourceRequest(Threading* threading, const std::shared_ptr<ResourceLoad>& load)
+        {
+            m_threading = threading;
+            m_load      = load;
+        }
+
+        // Returns true once the load has finished, successfully or not
+        bool IsReady() const { return !m_load || m_load->done.load(std::memory_order_acquire); }
+
+        // Returns the resource, or nullptr if it's not ready yet or failed to load
+        std::shared_ptr<T> Get() const { return (m_load && IsReady()) ? std::static_pointer_cast<T>(m_load->resource) : nullptr; }
+
+        // Blocks until the load finishes, the calling thread executes other tasks meanwhile
+        std::shared_ptr<T> Wait() const
+        {
+            while (!IsReady())
+            {
+                m_threading->Wait(m_load->task);
+            }
+
+            return Get();
+        }
+
+        // The task doing the loading, other tasks can be made to depend on it
+        TaskHandle GetTask() const { return m_load ? m_load->task : TaskHandle(); }
+
+    private:
+        Threading* m_threading = nullptr;
+        std::shared_ptr<ResourceLoad> m_load;
+    };
+
     class SPARTAN_CLASS ResourceCache : public ISubsystem
     {
     public:
@@ -56,7 +104,7 @@ namespace Spartan
         //=========================
 
         // Get by name
-        std::shared_ptr<IResource>& GetByName(const std::string& name, ResourceType type);
+        std::shared_ptr<IResource> GetByName(const std::string& name, ResourceType type);
         template <class T> 
         constexpr std::shared_ptr<T> GetByName(const std::string& name) 
         { 
@@ -67,18 +115,16 @@ namespace Spartan
         std::vector<std::shared_ptr<IResource>> GetByType(ResourceType type = ResourceType::Unknown);
 
         // Get by path
+        std::shared_ptr<IResource> GetByPath(const std::string& path, ResourceType type);
         template <class T>
         std::shared_ptr<T> GetByPath(const std::string& path)
         {
-            for (auto& resource : m_resource_groups[IResource::TypeToEnum<T>()])
-            {
-                if (path == resource->GetResourceFilePathNative())
-                    return std::static_pointer_cast<T>(resource);
-            }
-
-            return nullptr;
+            return std::static_pointer_cast<T>(GetByPath(path, IResource::TypeToEnum<T>()));
         }
 
+        // Get by id
+        std::shared_ptr<IResource> GetById(uint32_t id);
+
         // Caches resource, or replaces with existing cached resource
         template <class T>
         [[nodiscard]] std::shared_ptr<T> Cache(const std::shared_ptr<T>& resource)
@@ -101,71 +147,105 @@ namespace Spartan
                 return nullptr;
             }
 
-            // Ensure that this resource is not already cached
-            if (IsCached(resource->GetResourceName(), resource->GetResourceType()))
-                return GetByName<T>(resource->GetResourceName());
-
-            // Prevent threads from colliding in critical section
-            std::lock_guard<mutex> guard(m_mutex);
+            // Check if another resource with the same name got there first
+            if (std::shared_ptr<IResource> cached = GetByName(resource->GetResourceName(), resource->GetResourceType()))
+                return std::static_pointer_cast<T>(cached);
 
-            // In order to guarantee deserialization, we save it now
+            // In order to guarantee deserialization, we save it now, before other threads can find it in the cache
             resource->SaveToFile(resource->GetResourceFilePathNative());
 
-            // Cache it
-            return static_pointer_cast<T>(m_resource_groups[resource->GetResourceType()].emplace_back(resource));
+            // Cache it, unless another thread cached a resource with the same name while this one was saving
+            if (std::shared_ptr<IResource> cached = Add(resource))
+                return std::static_pointer_cast<T>(cached);
+
+            return resource;
         }
         bool IsCached(const std::string& resource_name, ResourceType resource_type);
 
+        // Called by resources when their file path (and with it their name) changes, to keep the indices valid
+        void OnResourceFilePathChanged(IResource* resource);
+
         template <class T>
         void Remove(std::shared_ptr<T>& resource)
         {
             if (!resource)
                 return;
 
-            if (!IsCached(resource->GetResourceName(), resource->GetResourceType()))
-                return;
+            Remove(resource->GetId());
+        }
 
-            auto& vector = m_resource_groups[resource->GetResourceType()];
-            for (auto it = vector.begin(); it != vector.end(); it++)
+        // Loads a resource and adds it to the resource cache
+        template <class T>
+        std::shared_ptr<T> Load(const std::string& file_path)
+        {
+            // If another thread is already loading the file, wait for it instead of loading it twice
+            std::shared_ptr<ResourceLoad> load;
             {
-                if (dynamic_cast<Spartan_Object*>((*it).get())->GetId() == resource->GetId())
+                std::lock_guard<std::mutex> lock(m_mutex_loads);
+                const auto it = m_loads.find(file_path);
+                if (it != m_loads.end())
                 {
-                    vector.erase(it);
-                    break;
+                    load = it->second;
                 }
             }
+
+            if (load)
+                return ResourceRequest<T>(m_context->GetSubsystem<Threading>(), load).Wait();
+
+            return LoadImmediate<T>(file_path);
         }
 
-        // Loads a resource and adds it to the resource cache
+        // Loads a resource on a worker thread and adds it to the resource cache. Concurrent requests for the same file share a single load.
+        // The load can be made to wait for another task (e.g. the textures a material references) and it can be grouped under a parent task.
         template <class T>
-        std::shared_ptr<T> Load(const std::string& file_path)
+        ResourceRequest<T> LoadAsync(const std::string& file_path, const TaskHandle& dependency = TaskHandle(), const TaskHandle& parent = TaskHandle())
         {
-            if (!FileSystem::Exists(file_path))
+            Threading* threading = m_context->GetSubsystem<Threading>();
+
+            // Check if the resource is already loaded
+            if (std::shared_ptr<T> cached = GetByName<T>(FileSystem::GetFileNameNoExtensionFromFilePath(file_path)))
             {
-                LOG_ERROR("\"%s\" doesn't exist.", file_path.c_str());
-                return nullptr;
+                std::shared_ptr<ResourceLoad> load = std::make_shared<ResourceLoad>();
+                load->resource  = cached;
+                load->done      = true;
+                return ResourceRequest<T>(threading, load);
             }
 
-            // Check if the resource is already loaded
-            const auto name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
-            if (IsCached(name, IResource::TypeToEnum<T>()))
-                return GetByName<T>(name);
+            std::shared_ptr<ResourceLoad> load;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_loads);
 
-            // Create new resource
-            auto typed = std::make_shared<T>(m_context);
+                // Check if the resource is already loading, if so the parent still has to wait for it, so it gets a child which completes after the load
+                const auto it = m_loads.find(file_path);
+                if (it != m_loads.end())
+                {
+                    if (parent.IsValid())
+                    {
+                        threading->SubmitTask(threading->CreateTask([] {}, parent), it->second->task);
+                    }
 
-            // Set a default file path in case it's not overridden by LoadFromFile()
-            typed->SetResourceFilePath(file_path);
+                    return ResourceRequest<T>(threading, it->second);
+                }
 
-            // Load
-            if (!typed || !typed->LoadFromFile(file_path))
-            {
-                LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
-                return nullptr;
+                load        = std::make_shared<ResourceLoad>();
+                load->task  = threading->CreateTask([this, file_path, load]()
+                {
+                    load->resource = LoadImmediate<T>(file_path);
+
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex_loads);
+                        m_loads.erase(file_path);
+                    }
+
+                    load->done = true;
+                }, parent);
+
+                m_loads[file_path] = load;
             }
 
-            // Returned cached reference which is guaranteed to be around after deserialization
-            return Cache<T>(typed);
+            threading->SubmitTask(load->task, dependency);
+
+            return ResourceRequest<T>(threading, load);
         }
 
         //= I/O ======================
@@ -178,7 +258,7 @@ namespace Spartan
         uint64_t GetMemoryUsageCpu(ResourceType type = ResourceType::Unknown);
         uint64_t GetMemoryUsageGpu(ResourceType type = ResourceType::Unknown);
         // Unloads all resources
-        void Clear() { m_resource_groups.clear(); }
+        void Clear();
         // Returns all resources of a given type
         uint32_t GetResourceCount(ResourceType type = ResourceType::Unknown);
         //====================================================================
@@ -198,9 +278,64 @@ namespace Spartan
         auto GetFontImporter()  const { return m_importer_font.get(); }
 
     private:
+        template <class T>
+        std::shared_ptr<T> LoadImmediate(const std::string& file_path)
+        {
+            if (!FileSystem::Exists(file_path))
+            {
+                LOG_ERROR("\"%s\" doesn't exist.", file_path.c_str());
+                return nullptr;
+            }
+
+            // Check if the resource is already loaded
+            const auto name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
+            if (std::shared_ptr<T> cached = GetByName<T>(name))
+                return cached;
+
+            // Create new resource
+            auto typed = std::make_shared<T>(m_context);
+
+            // Set a default file path in case it's not overridden by LoadFromFile()
+            typed->SetResourceFilePath(file_path);
+
+            // Load
+            if (!typed || !typed->LoadFromFile(file_path))
+            {
+                LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
+                return nullptr;
+            }
+
+            // Returned cached reference which is guaranteed to be around after deserialization
+            return Cache<T>(typed);
+        }
+
+        // A resource along with the keys it's indexed under, so they can be erased after the resource changes its own
+        struct IndexEntry
+        {
+            std::shared_ptr<IResource> resource;
+            std::string name;
+            std::string path;
+        };
+
+        // Adds a resource to its group and the indices, returns the already cached resource if there is one with the same name
+        std::shared_ptr<IResource> Add(const std::shared_ptr<IResource>& resource);
+        void Remove(uint32_t id);
+        void IndexErase(ResourceType type, const IndexEntry& entry);
+
         // Cache
         std::unordered_map<ResourceType, std::vector<std::shared_ptr<IResource>>> m_resource_groups;
-        std::mutex m_mutex;
+
+        // Indices, kept in sync with the groups so that lookups don't have to scan them
+        std::unordered_map<ResourceType, std::unordered_map<std::string, std::shared_ptr<IResource>>> m_index_name;
+        std::unordered_map<ResourceType, std::unordered_map<std::string, std::shared_ptr<IResource>>> m_index_path;
+        std::unordered_map<uint32_t, IndexEntry> m_index_id;
+
+        // Lookups take a shared lock, so worker threads can read concurrently, only adding and removing resources is exclusive
+        std::shared_mutex m_mutex;
+
+        // Loads in flight, keyed by file path
+        std::unordered_map<std::string, std::shared_ptr<ResourceLoad>> m_loads;
+        std::mutex m_mutex_loads;
 
         // Directories
         std::unordered_map<Asset_Type, std::string> m_standard_resource_directories;
@@ -210,5 +345,10 @@ namespace Spartan
         std::shared_ptr<ModelImporter> m_importer_model;
         std::shared_ptr<ImageImporter> m_importer_image;
         std::shared_ptr<FontImporter> m_importer_font;
+
+        // Events
+        EventSubscription m_subscription_world_save;
+        EventSubscription m_subscription_world_load;
+        EventSubscription m_subscription_world_unload;
     };
 }
@@ -30,16 +30,46 @@ using namespace std;
 
 namespace Spartan
 {
-    Threading::Threading(Context* context) : ISubsystem(context)
+    // The queue owned by the calling thread, and the instance it belongs to, so that a thread of one instance doesn't push into another's queues
+    static thread_local const Threading* g_queue_owner  = nullptr;
+    static thread_local int32_t g_queue_index           = -1;
+
+    static const uint32_t task_index_invalid    = numeric_limits<uint32_t>::max();
+    static const uint32_t spin_count            = 64; // attempts to find work before going to sleep
+
+    static uint64_t pack_free_head(uint64_t head, uint32_t index)
+    {
+        // Bump the tag so that a head which was popped and pushed back in the meantime fails the compare-exchange (ABA)
+        return (((head >> 32) + 1) << 32) | index;
+    }
+
+    Threading::Threading(Context* context, const uint32_t thread_count_max /*= UINT32_MAX*/) : ISubsystem(context)
     {
-        m_stopping                                = false;
         m_thread_count_support                  = thread::hardware_concurrency();
-        m_thread_count                          = m_thread_count_support - 1; // exclude the main (this) thread
+        m_thread_count                          = (min)(m_thread_count_support - 1, thread_count_max); // exclude the main (this) thread
         m_thread_names[this_thread::get_id()]   = "main";
 
+        // Pool the tasks and chain them into the free list
+        m_task_pool = make_unique<Task[]>(m_task_capacity);
+        for (uint32_t i = 0; i < m_task_capacity; i++)
+        {
+            m_task_pool[i].m_next_free.store(i + 1 < m_task_capacity ? i + 1 : task_index_invalid, memory_order_relaxed);
+        }
+        m_task_free_head = 0;
+
+        // One queue per worker, plus one for this thread
+        for (uint32_t i = 0; i < m_thread_count + 1; i++)
+        {
+            m_queues.emplace_back(make_unique<WorkStealingQueue<Task, 4096>>());
+        }
+        m_queue_owner_previous  = g_queue_owner;
+        m_queue_index_previous  = g_queue_index;
+        g_queue_owner           = this;
+        g_queue_index           = 0;
+
         for (uint32_t i = 0; i < m_thread_count; i++)
         {
-            m_threads.emplace_back(thread(&Threading::ThreadLoop, this));
+            m_threads.emplace_back(thread(&Threading::ThreadLoop, this, i + 1));
             m_thread_names[m_threads.back().get_id()] = "worker_" + to_string(i);
         }
 
@@ -50,14 +80,11 @@ namespace Spartan
     {
         Flush(true);
 
-        // Put unique lock on task mutex.
-        unique_lock<mutex> lock(m_mutex_tasks);
-
-        // Set termination flag to true.
-        m_stopping = true;
-
-        // Unlock the mutex
-        lock.unlock();
+        // Set termination flag to true
+        {
+            lock_guard<mutex> lock(m_mutex_sleep);
+            m_stopping = true;
+        }
 
         // Wake up all threads.
         m_condition_var.notify_all();
@@ -70,61 +97,437 @@ namespace Spartan
 
         // Empty worker threads.
         m_threads.clear();
+
+        // Give the calling thread its previous queue back
+        if (g_queue_owner == this)
+        {
+            g_queue_owner = m_queue_owner_previous;
+            g_queue_index = m_queue_index_previous;
+        }
     }
 
-    uint32_t Threading::GetThreadsAvailable() const
+    void Threading::SubmitTask(const TaskHandle& handle)
     {
-        uint32_t available_threads = m_thread_count;
+        if (!handle.IsValid())
+            return;
 
-        for (const auto& task : m_tasks)
+        // Queue it, unless it's a continuation still waiting on its dependency
+        if (handle.task->m_dependencies.fetch_sub(1, memory_order_acq_rel) == 1)
         {
-            available_threads -= task->IsExecuting() ? 1 : 0;
+            QueueTask(handle.task);
         }
+    }
+
+    void Threading::SubmitTask(const TaskHandle& handle, const TaskHandle& dependency)
+    {
+        if (!handle.IsValid())
+            return;
+
+        AddContinuation(dependency, handle.task);
+    }
+
+    void Threading::Wait(const TaskHandle& handle)
+    {
+        while (IsPending(handle))
+        {
+            if (Task* task = GetTask(handle))
+            {
+                ExecuteTask(task);
+            }
+            else
+            {
+                this_thread::yield();
+            }
+        }
+    }
 
-        return available_threads;
+    uint32_t Threading::GetThreadsAvailable() const
+    {
+        return m_thread_count - m_threads_busy.load(memory_order_relaxed);
     }
 
     void Threading::Flush(bool removed_queued /*= false*/)
     {
-        // Clear any queued tasks
+        // Queued tasks which are removed still complete, they just don't execute, so that anything waiting on them is released
         if (removed_queued)
         {
-            m_tasks.clear();
+            m_epoch_discard.store(m_epoch.fetch_add(1) + 1);
         }
 
-        // If so, wait for them
+        // Help with the remaining work, or wait for it
         while (AreTasksRunning())
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            if (Task* task = GetTask())
+            {
+                ExecuteTask(task);
+            }
+            else
+            {
+                this_thread::yield();
+            }
         }
     }
 
-    void Threading::ThreadLoop()
+    void Threading::ThreadLoop(uint32_t queue_index)
     {
-        shared_ptr<Task> task;
+        g_queue_owner = this;
+        g_queue_index = static_cast<int32_t>(queue_index);
+
+        uint32_t spins = 0;
         while (true)
         {
-            // Lock tasks mutex
-            unique_lock<mutex> lock(m_mutex_tasks);
+            // Execute the next task, either one of ours or one stolen from another thread
+            if (Task* task = GetTask())
+            {
+                ExecuteTask(task);
+                spins = 0;
+                continue;
+            }
+
+            // Nothing to do, spin for a bit in case work is about to show up
+            if (spins++ < spin_count)
+            {
+                this_thread::yield();
+                continue;
+            }
+            spins = 0;
 
-            // Check condition on notification
-            m_condition_var.wait(lock, [this] { return !m_tasks.empty() || m_stopping; });
+            // Sleep until something gets queued
+            unique_lock<mutex> lock(m_mutex_sleep);
+            m_threads_asleep++;
+            m_condition_var.wait(lock, [this] { return m_tasks_queued.load() != 0 || m_stopping; });
+            m_threads_asleep--;
 
             // If m_stopping is true, it's time to shut everything down
-            if (m_stopping && m_tasks.empty())
+            if (m_stopping && m_tasks_queued.load() == 0)
                 return;
+        }
+    }
+
+    Task* Threading::AllocateTask()
+    {
+        Task* task      = nullptr;
+        uint64_t head   = m_task_free_head.load(memory_order_acquire);
+        while (!task)
+        {
+            const uint32_t index = static_cast<uint32_t>(head);
+
+            // Pool exhausted, help drain it
+            if (index == task_index_invalid)
+            {
+                if (Task* task_queued = GetTask())
+                {
+                    ExecuteTask(task_queued);
+                }
+                else
+                {
+                    this_thread::yield();
+                }
+
+                head = m_task_free_head.load(memory_order_acquire);
+                continue;
+            }
+
+            const uint32_t next = m_task_pool[index].m_next_free.load(memory_order_relaxed);
+            if (m_task_free_head.compare_exchange_weak(head, pack_free_head(head, next), memory_order_acq_rel, memory_order_acquire))
+            {
+                task = &m_task_pool[index];
+            }
+        }
 
-            // Get next task in the queue.
-            task = m_tasks.front();
+        // Reset
+        task->m_parent = nullptr;
+        task->m_unfinished.store(1, memory_order_relaxed);
+        task->m_dependencies.store(0, memory_order_relaxed);
+        while (task->m_continuation_lock.test_and_set(memory_order_acquire));
+        task->m_continuation_head   = nullptr;
+        task->m_continuation_next   = nullptr;
+        task->m_completed           = false;
+        task->m_continuation_lock.clear(memory_order_release);
 
-            // Remove it from the queue.
-            m_tasks.pop_front();
+        m_tasks_in_flight.fetch_add(1, memory_order_acq_rel);
 
-            // Unlock the mutex
-            lock.unlock();
+        return task;
+    }
+
+    void Threading::FreeTask(Task* task)
+    {
+        // Invalidates any outstanding handles
+        task->m_generation.fetch_add(1, memory_order_acq_rel);
+
+        const uint32_t index    = static_cast<uint32_t>(task - m_task_pool.get());
+        uint64_t head           = m_task_free_head.load(memory_order_acquire);
+        do
+        {
+            task->m_next_free.store(static_cast<uint32_t>(head), memory_order_relaxed);
+        } while (!m_task_free_head.compare_exchange_weak(head, pack_free_head(head, index), memory_order_acq_rel, memory_order_acquire));
 
-            // Execute the task.
-            task->Execute();
+        m_tasks_in_flight.fetch_sub(1, memory_order_acq_rel);
+    }
+
+    void Threading::QueueTask(Task* task)
+    {
+        task->m_epoch = m_epoch.load();
+
+        // Threads which own a queue push to it (no contention), everyone else (or a full queue) goes through the shared queue
+        const int32_t index = GetQueueIndex();
+        if (index < 0 || !m_queues[index]->Push(task))
+        {
+            QueueTaskShared(task);
+        }
+
+        m_tasks_queued.fetch_add(1);
+
+        // Wake up a thread, the lock is only taken if someone is actually asleep
+        if (m_threads_asleep.load() != 0)
+        {
+            lock_guard<mutex> lock(m_mutex_sleep);
+            m_condition_var.notify_one();
         }
     }
+
+    void Threading::ExecuteTask(Task* task)
+    {
+        const bool is_worker = GetQueueIndex() > 0;
+
+        if (is_worker)
+        {
+            m_threads_busy.fetch_add(1, memory_order_relaxed);
+        }
+
+        task->m_is_executing = true;
+        if (task->m_epoch >= m_epoch_discard.load())
+        {
+            task->m_function();
+        }
+        task->m_function = nullptr; // release anything captured
+        task->m_is_executing = false;
+
+        if (is_worker)
+        {
+            m_threads_busy.fetch_sub(1, memory_order_relaxed);
+        }
+
+        FinishTask(task);
+    }
+
+    void Threading::FinishTask(Task* task)
+    {
+        // Children are still running, the last one to finish will complete the task
+        if (task->m_unfinished.fetch_sub(1, memory_order_acq_rel) != 1)
+            return;
+
+        // Detach the continuations
+        while (task->m_continuation_lock.test_and_set(memory_order_acquire));
+        Task* continuation          = task->m_continuation_head;
+        task->m_continuation_head   = nullptr;
+        task->m_completed           = true;
+        task->m_continuation_lock.clear(memory_order_release);
+
+        // Queue them
+        while (continuation)
+        {
+            Task* next = continuation->m_continuation_next;
+            continuation->m_continuation_next = nullptr;
+            if (continuation->m_dependencies.fetch_sub(1, memory_order_acq_rel) == 1)
+            {
+                QueueTask(continuation);
+            }
+            continuation = next;
+        }
+
+        Task* parent = task->m_parent;
+        FreeTask(task);
+
+        if (parent)
+        {
+            FinishTask(parent);
+        }
+    }
+
+    void Threading::AddContinuation(const TaskHandle& dependency, Task* continuation)
+    {
+        if (Task* task = dependency.task)
+        {
+            while (task->m_continuation_lock.test_and_set(memory_order_acquire));
+            const bool attach = task->m_generation.load(memory_order_acquire) == dependency.generation && !task->m_completed;
+            if (attach)
+            {
+                continuation->m_continuation_next   = task->m_continuation_head;
+                task->m_continuation_head           = continuation;
+            }
+            task->m_continuation_lock.clear(memory_order_release);
+
+            if (attach)
+                return;
+        }
+
+        // The dependency has already completed
+        if (continuation->m_dependencies.fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+            QueueTask(continuation);
+        }
+    }
+
+    void Threading::AttachChild(const TaskHandle& parent, Task* child)
+    {
+        Task* task = parent.task;
+        if (!task)
+            return;
+
+        // Only add to a count which isn't zero, a parent which reached zero is completing (or already back in the pool)
+        uint32_t unfinished = task->m_unfinished.load(memory_order_acquire);
+        do
+        {
+            if (unfinished == 0)
+                return;
+        } while (!task->m_unfinished.compare_exchange_weak(unfinished, unfinished + 1, memory_order_acq_rel, memory_order_acquire));
+
+        // Generations only grow, if it still matches the slot was never recycled, so the count we raised is the parent's
+        if (task->m_generation.load(memory_order_acquire) == parent.generation)
+        {
+            child->m_parent = task;
+            return;
+        }
+
+        // It's another task by now, give back the reference we took (completing it, if we were the last one holding it up)
+        FinishTask(task);
+    }
+
+    int32_t Threading::GetQueueIndex() const
+    {
+        return g_queue_owner == this ? g_queue_index : -1;
+    }
+
+    Task* Threading::GetTask()
+    {
+        Task* task          = nullptr;
+        const int32_t index = GetQueueIndex();
+
+        // Own queue
+        if (index >= 0)
+        {
+            task = m_queues[index]->Pop();
+        }
+
+        // Shared queue
+        if (!task && m_queue_shared_count.load(memory_order_acquire) != 0)
+        {
+            lock_guard<mutex> lock(m_mutex_queue_shared);
+            if (!m_queue_shared.empty())
+            {
+                task = m_queue_shared.front();
+                m_queue_shared.pop_front();
+                m_queue_shared_count.fetch_sub(1, memory_order_release);
+            }
+        }
+
+        // Steal, starting from the neighbour so that thieves spread out
+        if (!task)
+        {
+            const uint32_t queue_count  = static_cast<uint32_t>(m_queues.size());
+            const uint32_t start        = index >= 0 ? static_cast<uint32_t>(index) + 1 : 0;
+            for (uint32_t i = 0; i < queue_count && !task; i++)
+            {
+                const uint32_t victim = (start + i) % queue_count;
+                if (static_cast<int32_t>(victim) != index)
+                {
+                    task = m_queues[victim]->Steal();
+                }
+            }
+        }
+
+        if (task)
+        {
+            m_tasks_queued.fetch_sub(1);
+        }
+
+        return task;
+    }
+
+    Task* Threading::GetTask(const TaskHandle& owner)
+    {
+        // Own queue, anything unrelated on top of it is handed over to the shared queue, where idle threads will find it
+        const int32_t index = GetQueueIndex();
+        if (index >= 0)
+        {
+            while (Task* task = m_queues[index]->Pop())
+            {
+                if (IsPartOf(task, owner))
+                {
+                    m_tasks_queued.fetch_sub(1);
+                    return task;
+                }
+
+                QueueTaskShared(task);
+            }
+        }
+
+        // Shared queue, only take what belongs to the owner
+        if (m_queue_shared_count.load(memory_order_acquire) != 0)
+        {
+            lock_guard<mutex> lock(m_mutex_queue_shared);
+            const auto it = find_if(m_queue_shared.begin(), m_queue_shared.end(), [this, &owner](const Task* task) { return IsPartOf(task, owner); });
+            if (it != m_queue_shared.end())
+            {
+                Task* task = *it;
+                m_queue_shared.erase(it);
+                m_queue_shared_count.fetch_sub(1, memory_order_release);
+                m_tasks_queued.fetch_sub(1);
+                return task;
+            }
+        }
+
+        // Steal, same as above
+        const uint32_t queue_count  = static_cast<uint32_t>(m_queues.size());
+        const uint32_t start        = index >= 0 ? static_cast<uint32_t>(index) + 1 : 0;
+        for (uint32_t i = 0; i < queue_count; i++)
+        {
+            const uint32_t victim = (start + i) % queue_count;
+            if (static_cast<int32_t>(victim) == index)
+                continue;
+
+            if (Task* task = m_queues[victim]->Steal())
+            {
+                if (IsPartOf(task, owner))
+                {
+                    m_tasks_queued.fetch_sub(1);
+                    return task;
+                }
+
+                QueueTaskShared(task);
+            }
+        }
+
+        return nullptr;
+    }
+
+    void Threading::QueueTaskShared(Task* task)
+    {
+        // Doesn't count the task as queued, callers either just popped it (so it still is) or count it themselves
+        lock_guard<mutex> lock(m_mutex_queue_shared);
+        m_queue_shared.push_back(task);
+        m_queue_shared_count.fetch_add(1, memory_order_release);
+    }
+
+    bool Threading::IsPartOf(const Task* task, const TaskHandle& owner) const
+    {
+        // Parents can't complete before their children, so the chain is intact while the task is queued
+        for (; task; task = task->m_parent)
+        {
+            if (task == owner.task)
+                return task->m_generation.load(memory_order_acquire) == owner.generation;
+        }
+
+        return false;
+    }
+
+    bool Threading::IsPending(const TaskHandle& handle) const
+    {
+        if (!handle.task)
+            return false;
+
+        // A different generation means the task completed and its storage went back to the pool
+        return handle.task->m_generation.load(memory_order_acquire) == handle.generation && handle.task->m_unfinished.load(memory_order_acquire) != 0;
+    }
 }
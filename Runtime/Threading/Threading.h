@@ -21,16 +21,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==================
+//= INCLUDES ====================
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <deque>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
 #include <unordered_map>
 #include <functional>
+#include <cstdint>
+#include "WorkStealingQueue.h"
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
-//=============================
+//===============================
 
 namespace Spartan
 {
@@ -39,101 +44,223 @@ namespace Spartan
     public:
         typedef std::function<void()> function_type;
 
-        Task(function_type&& function)  { m_function = std::forward<function_type>(function); }
-        void Execute()                  { m_is_executing = true; m_function(); m_is_executing = false; }
-        bool IsExecuting() const { return m_is_executing; }
+        bool IsExecuting() const { return m_is_executing.load(std::memory_order_relaxed); }
 
     private:
-        bool m_is_executing = false;
+        friend class Threading;
+
         function_type m_function;
+        Task* m_parent                          = nullptr;
+        std::atomic<bool> m_is_executing        = false;
+        std::atomic<uint32_t> m_unfinished      = 0; // this task plus any unfinished children
+        std::atomic<uint32_t> m_dependencies    = 0; // things that have to happen before the task can be queued
+        std::atomic<uint32_t> m_generation      = 0; // incremented every time the task returns to the pool
+        std::atomic<uint32_t> m_next_free       = 0; // free list link
+        uint32_t m_epoch                        = 0; // the flush epoch the task was queued in
+
+        // Tasks which will be queued once this task (and its children) complete
+        std::atomic_flag m_continuation_lock    = ATOMIC_FLAG_INIT;
+        Task* m_continuation_head               = nullptr;
+        Task* m_continuation_next               = nullptr;
+        bool m_completed                        = false;
+    };
+
+    // A lightweight reference to a pooled task, it remains safe to use after the task has completed and its storage was recycled
+    struct TaskHandle
+    {
+        TaskHandle() = default;
+        TaskHandle(Task* task, uint32_t generation) { this->task = task; this->generation = generation; }
+        bool IsValid() const { return task != nullptr; }
+
+        Task* task          = nullptr;
+        uint32_t generation = 0;
     };
 
     class Threading : public ISubsystem
     {
     public:
-        Threading(Context* context);
+        // thread_count_max caps the worker threads (the hardware threads minus the calling one), 0 executes every task on the calling thread
+        Threading(Context* context, uint32_t thread_count_max = UINT32_MAX);
         ~Threading();
 
-        // Add a task
+        // Creates a task without queueing it, this allows children and continuations to be attached before it runs. Call SubmitTask() to queue it.
         template <typename Function>
-        void AddTask(Function&& function)
+        TaskHandle CreateTask(Function&& function, const TaskHandle& parent = TaskHandle())
+        {
+            Task* task          = AllocateTask();
+            task->m_function    = std::forward<Function>(function);
+            task->m_dependencies.store(1, std::memory_order_relaxed); // released by SubmitTask()
+
+            // The parent can't complete until all of its children complete
+            AttachChild(parent, task);
+
+            return TaskHandle(task, task->m_generation.load(std::memory_order_relaxed));
+        }
+
+        // Queues a task that was created with CreateTask()
+        void SubmitTask(const TaskHandle& handle);
+        // Queues a task that was created with CreateTask(), once the dependency (and its children) have completed
+        void SubmitTask(const TaskHandle& handle, const TaskHandle& dependency);
+
+        // Add a task, optionally as a child of another (the parent will only be considered done once all of its children are)
+        template <typename Function>
+        TaskHandle AddTask(Function&& function, const TaskHandle& parent = TaskHandle())
         {
             if (m_threads.empty())
             {
                 LOG_WARNING("No available threads, function will execute in the same thread");
                 function();
-                return;
+                return TaskHandle();
             }
 
-            // Lock tasks mutex
-            std::unique_lock<std::mutex> lock(m_mutex_tasks);
-
-            // Save the task
-            m_tasks.push_back(std::make_shared<Task>(std::bind(std::forward<Function>(function))));
+            TaskHandle handle = CreateTask(std::forward<Function>(function), parent);
+            SubmitTask(handle);
+            return handle;
+        }
 
-            // Unlock the mutex
-            lock.unlock();
+        // Add a task which will only be queued once the dependency (and its children) have completed
+        template <typename Function>
+        TaskHandle AddTaskContinuation(const TaskHandle& dependency, Function&& function)
+        {
+            if (m_threads.empty())
+            {
+                function();
+                return TaskHandle();
+            }
 
-            // Wake up a thread
-            m_condition_var.notify_one();
+            TaskHandle handle = CreateTask(std::forward<Function>(function));
+            SubmitTask(handle, dependency);
+            return handle;
         }
 
-        // Adds a task which is a loop and executes chunks of it in parallel
+        // Executes function(start, end) over [0, range) in parallel, the calling thread takes part instead of waiting idle.
+        // Chunks are claimed dynamically, they start large and shrink towards grain_size as the range runs out, so uneven
+        // per-item costs don't leave stragglers. A grain_size of 0 picks one based on the range and the thread count.
         template <typename Function>
-        void AddTaskLoop(Function&& function, uint32_t range)
+        void ParallelFor(uint32_t range, Function&& function, uint32_t grain_size = 0)
         {
-            uint32_t available_threads  = GetThreadsAvailable();
-            vector<bool> tasks_done     = vector<bool>(available_threads, false);
-            const uint32_t task_count   = available_threads + 1; // plus one for the current thread
+            if (range == 0)
+                return;
 
-            uint32_t start  = 0;
-            uint32_t end    = 0;
-            for (uint32_t i = 0; i < available_threads; i++)
+            const uint32_t thread_count_max = m_parallel_for_thread_count_max.load(std::memory_order_relaxed);
+            const uint32_t helper_count_max = (std::min)(m_thread_count, thread_count_max);
+            const uint32_t thread_count     = helper_count_max + 1; // plus one for the calling thread
+            if (grain_size == 0)
             {
-                start   = (range / task_count) * i;
-                end     = start + (range / task_count);
-
-                // Kick off task
-                AddTask([&function, &tasks_done, i, start, end] { function(start, end); tasks_done[i] = true; });
+                grain_size = range / (thread_count * 8);
             }
+            grain_size = grain_size == 0 ? 1 : grain_size;
 
-            // Do last task in the current thread
-            function(end, range);
+            // Not worth splitting
+            if (helper_count_max == 0 || range <= grain_size)
+            {
+                function(0, range);
+                return;
+            }
 
-            // Wait till the threads are done
-            uint32_t tasks = 0;
-            while (tasks != tasks_done.size())
+            std::atomic<uint32_t> next = 0;
+            const auto run_chunks = [&next, &function, range, grain_size, thread_count]()
             {
-                tasks = 0;
-                for (const bool job_done : tasks_done)
+                uint32_t start = next.load(std::memory_order_relaxed);
+                while (start < range)
                 {
-                    tasks += job_done ? 1 : 0;
+                    // Guided scheduling: claim a share of what's left, but never less than the grain size
+                    const uint32_t remaining    = range - start;
+                    uint32_t size               = remaining / (thread_count * 2);
+                    size                        = size < grain_size ? grain_size : size;
+                    size                        = size > remaining ? remaining : size;
+
+                    if (next.compare_exchange_weak(start, start + size, std::memory_order_relaxed))
+                    {
+                        function(start, start + size);
+                        start = next.load(std::memory_order_relaxed);
+                    }
                 }
+            };
+
+            // Kick off helpers, there is no point in having more than there are chunks
+            const uint32_t helper_count = (std::min)(helper_count_max, (range + grain_size - 1) / grain_size - 1);
+            TaskHandle parent           = CreateTask([] {});
+            for (uint32_t i = 0; i < helper_count; i++)
+            {
+                AddTask(run_chunks, parent);
             }
+            SubmitTask(parent);
+
+            // Do our share in the current thread, then help out (or pick up helpers that never started) until everything is done
+            run_chunks();
+            Wait(parent);
         }
 
+        // Returns true if the task (and all of its children) have completed
+        bool IsDone(const TaskHandle& handle) const { return !IsPending(handle); }
+        // Blocks until the task (and all of its children) have completed. The calling thread helps with the task and its children while waiting,
+        // but never with unrelated tasks, as one of them might block until the caller returns (e.g. a world load waiting for the main thread).
+        void Wait(const TaskHandle& handle);
         // Get the number of threads used
         uint32_t GetThreadCount()           const { return m_thread_count; }
         // Get the maximum number of threads the hardware supports
         uint32_t GetThreadCountSupport()    const { return m_thread_count_support; }
+        // Caps the worker threads ParallelFor() spreads over, 0 keeps it on the calling thread (useful for measuring scaling)
+        void SetParallelForThreadCountMax(uint32_t thread_count_max) { m_parallel_for_thread_count_max.store(thread_count_max, std::memory_order_relaxed); }
         // Get the number of threads which are not doing any work
         uint32_t GetThreadsAvailable()      const;
-        // Returns true if at least one task is running
-        bool AreTasksRunning()              const { return GetThreadsAvailable() != GetThreadCount(); }
-        // Waits for all executing (and queued if requested) tasks to finish
+        // Returns true if at least one task is queued or running
+        bool AreTasksRunning()              const { return m_tasks_in_flight.load(std::memory_order_acquire) != 0; }
+        // Waits for all executing (and queued if requested) tasks to finish.
+        // Removing only applies to the tasks queued before the call, the ones that running tasks spawn or release meanwhile still execute.
         void Flush(bool removed_queued = false);
 
     private:
         // This function is invoked by the threads
-        void ThreadLoop();
+        void ThreadLoop(uint32_t queue_index);
+
+        // Task life cycle
+        Task* AllocateTask();
+        void FreeTask(Task* task);
+        void QueueTask(Task* task);
+        void ExecuteTask(Task* task);
+        void FinishTask(Task* task);
+        void AddContinuation(const TaskHandle& dependency, Task* continuation);
+        void AttachChild(const TaskHandle& parent, Task* child);
+        int32_t GetQueueIndex() const;
+        Task* GetTask();
+        Task* GetTask(const TaskHandle& owner);
+        void QueueTaskShared(Task* task);
+        bool IsPending(const TaskHandle& handle) const;
+        bool IsPartOf(const Task* task, const TaskHandle& owner) const;
 
         uint32_t m_thread_count         = 0;
         uint32_t m_thread_count_support = 0;
         std::vector<std::thread> m_threads;
-        std::deque<std::shared_ptr<Task>> m_tasks;
-        std::mutex m_mutex_tasks;
-        std::condition_variable m_condition_var;
         std::unordered_map<std::thread::id, std::string> m_thread_names;
-        bool m_stopping;
+        std::atomic<bool> m_stopping    = false;
+        std::atomic<uint32_t> m_parallel_for_thread_count_max = UINT32_MAX;
+
+        // Flushing, Flush(true) starts a new epoch and tasks queued in an earlier one don't execute
+        std::atomic<uint32_t> m_epoch           = 1;
+        std::atomic<uint32_t> m_epoch_discard   = 0;
+
+        // Task pool (a lock-free free list with an ABA tag in the upper 32 bits)
+        static const uint32_t m_task_capacity = 8192;
+        std::unique_ptr<Task[]> m_task_pool;
+        std::atomic<uint64_t> m_task_free_head  = 0;
+        std::atomic<uint32_t> m_tasks_in_flight = 0;
+
+        // Queues - one per worker plus one for the thread that created the subsystem (main), threads without a queue go through the shared one.
+        // The thread which created the subsystem gets its previous queue back when the subsystem is destroyed (instances can nest, e.g. in benchmarks).
+        const Threading* m_queue_owner_previous = nullptr;
+        int32_t m_queue_index_previous          = -1;
+        std::vector<std::unique_ptr<WorkStealingQueue<Task, 4096>>> m_queues;
+        std::deque<Task*> m_queue_shared;
+        std::mutex m_mutex_queue_shared;
+        std::atomic<uint32_t> m_queue_shared_count = 0;
+
+        // Sleeping
+        std::atomic<uint32_t> m_tasks_queued    = 0;
+        std::atomic<uint32_t> m_threads_busy    = 0;
+        std::atomic<uint32_t> m_threads_asleep  = 0;
+        std::mutex m_mutex_sleep;
+        std::condition_variable m_condition_var;
     };
 }
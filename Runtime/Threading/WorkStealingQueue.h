@@ -0,0 +1,124 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <atomic>
+#include <array>
+#include <cstdint>
+//=====================
+
+namespace Spartan
+{
+    // A fixed capacity Chase-Lev deque.
+    // The owning thread pushes and pops at the bottom (LIFO, cache friendly),
+    // any other thread can steal from the top (FIFO) without taking a lock.
+    template<typename T, uint32_t capacity>
+    class WorkStealingQueue
+    {
+        static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        WorkStealingQueue()
+        {
+            for (std::atomic<T*>& item : m_items)
+            {
+                item.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        // Owner thread only, returns false if the queue is full
+        bool Push(T* item)
+        {
+            const int64_t bottom    = m_bottom.load(std::memory_order_relaxed);
+            const int64_t top       = m_top.load(std::memory_order_acquire);
+
+            if (bottom - top >= static_cast<int64_t>(capacity))
+                return false;
+
+            m_items[bottom & m_mask].store(item, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_release); // publishes the item to the thieves
+
+            return true;
+        }
+
+        // Owner thread only, returns the most recently pushed item
+        T* Pop()
+        {
+            const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+
+            // Empty
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = m_items[bottom & m_mask].load(std::memory_order_relaxed);
+
+            // Last item, race against the thieves for it
+            if (top == bottom)
+            {
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
+
+        // Any thread, returns the least recently pushed item
+        T* Steal()
+        {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return nullptr;
+
+            T* item = m_items[top & m_mask].load(std::memory_order_relaxed);
+
+            // Another thief (or the owner) got there first
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return item;
+        }
+
+        bool IsEmpty() const { return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr int64_t m_mask = static_cast<int64_t>(capacity) - 1;
+
+        // Top and bottom live on separate cache lines since they are written by different threads
+        alignas(64) std::atomic<int64_t> m_top      = 0;
+        alignas(64) std::atomic<int64_t> m_bottom   = 0;
+        alignas(64) std::array<std::atomic<T*>, capacity> m_items;
+    };
+}
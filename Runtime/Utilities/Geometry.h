@@ -21,11 +21,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES =======================
 #include <vector>
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Vertex.h"
-//================================
+#include "../Threading/Threading.h"
+//==================================
 
 namespace Spartan::Utility::Geometry
 {
@@ -287,4 +288,121 @@ namespace Spartan::Utility::Geometry
     {
         CreateCylinder(vertices, indices, 0.0f, radius, height);
     }
+
+    // Computes smooth normals and/or tangents for an indexed triangle list, in time linear to the index count.
+    // A vertex to face adjacency is built first, then every vertex gathers (rather than scatters) its faces,
+    // so the work can be split across threads without any synchronization. Face normals aren't normalized,
+    // which weighs them by area. Passing a null threading subsystem runs everything on the calling thread.
+    static void ComputeNormalsTangents(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices, Threading* threading = nullptr, const bool normals = true, const bool tangents = true)
+    {
+        using namespace Math;
+
+        const uint32_t face_count   = static_cast<uint32_t>(indices.size() / 3);
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices->size());
+        if (face_count == 0 || vertex_count == 0 || (!normals && !tangents))
+            return;
+
+        const auto parallel_for = [threading](const uint32_t range, const auto& function)
+        {
+            if (threading)
+            {
+                threading->ParallelFor(range, function);
+            }
+            else
+            {
+                function(0, range);
+            }
+        };
+
+        const auto position = [vertices](const uint32_t index) { const float* p = (*vertices)[index].pos; return Vector3(p[0], p[1], p[2]); };
+        const auto uv       = [vertices](const uint32_t index) { const float* t = (*vertices)[index].tex; return Vector2(t[0], t[1]); };
+
+        // Vertex to face adjacency, compressed into one array (a counting sort of the faces by vertex), this also validates the indices
+        std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+        for (const uint32_t index : indices)
+        {
+            if (index >= vertex_count)
+            {
+                LOG_ERROR("Index %d is out of range, there are only %d vertices", index, vertex_count);
+                return;
+            }
+
+            adjacency_offsets[index + 1]++;
+        }
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            adjacency_offsets[i + 1] += adjacency_offsets[i];
+        }
+        std::vector<uint32_t> adjacency_faces(face_count * 3);
+        {
+            std::vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (uint32_t i = 0; i < face_count * 3; i++)
+            {
+                adjacency_faces[cursor[indices[i]]++] = i / 3;
+            }
+        }
+
+        // Face normals and tangents
+        std::vector<Vector3> face_normals(face_count);
+        std::vector<Vector3> face_tangents(face_count);
+        parallel_for(face_count, [&](const uint32_t start, const uint32_t end)
+        {
+            for (uint32_t face = start; face < end; face++)
+            {
+                const uint32_t i0 = indices[face * 3 + 0];
+                const uint32_t i1 = indices[face * 3 + 1];
+                const uint32_t i2 = indices[face * 3 + 2];
+
+                const Vector3 edge_a    = position(i1) - position(i0);
+                const Vector3 edge_b    = position(i2) - position(i0);
+                const Vector2 uv_a      = uv(i1) - uv(i0);
+                const Vector2 uv_b      = uv(i2) - uv(i0);
+
+                face_normals[face] = Vector3::Cross(edge_a, edge_b);
+
+                // Degenerate texture coordinates contribute no tangent
+                const float determinant = uv_a.x * uv_b.y - uv_b.x * uv_a.y;
+                face_tangents[face]     = determinant != 0.0f ? (edge_a * uv_b.y - edge_b * uv_a.y) * (1.0f / determinant) : Vector3::Zero;
+            }
+        });
+
+        // Vertex normals and tangents
+        parallel_for(vertex_count, [&](const uint32_t start, const uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                Vector3 normal  = Vector3::Zero;
+                Vector3 tangent = Vector3::Zero;
+                for (uint32_t j = adjacency_offsets[i]; j < adjacency_offsets[i + 1]; j++)
+                {
+                    normal  += face_normals[adjacency_faces[j]];
+                    tangent += face_tangents[adjacency_faces[j]];
+                }
+
+                RHI_Vertex_PosTexNorTan& vertex = (*vertices)[i];
+
+                if (normals)
+                {
+                    normal.Normalize();
+                    vertex.nor[0] = normal.x;
+                    vertex.nor[1] = normal.y;
+                    vertex.nor[2] = normal.z;
+                }
+                else
+                {
+                    normal = Vector3(vertex.nor[0], vertex.nor[1], vertex.nor[2]);
+                }
+
+                if (tangents)
+                {
+                    // Gram-Schmidt, keep the tangent perpendicular to the normal
+                    tangent = tangent - normal * Vector3::Dot(normal, tangent);
+                    tangent.Normalize();
+                    vertex.tan[0] = tangent.x;
+                    vertex.tan[1] = tangent.y;
+                    vertex.tan[2] = tangent.z;
+                }
+            }
+        });
+    }
 }
@@ -0,0 +1,89 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+//================
+
+namespace Spartan::Utility::Sort
+{
+    // Stable LSD radix sort on a 64-bit key, 8 bits per pass, T needs a uint64_t member called "key".
+    // Passes where every item falls into the same bucket are skipped, so narrow keys only pay for the bytes they use.
+    // The scratch vector is only there so callers can keep its memory around between frames.
+    template<typename T>
+    void RadixSort(std::vector<T>& items, std::vector<T>& scratch)
+    {
+        const size_t count = items.size();
+        if (count <= 1)
+            return;
+
+        // One read of the keys builds the histograms of all the passes
+        std::array<std::array<size_t, 256>, 8> histograms = {};
+        for (const T& item : items)
+        {
+            for (uint32_t pass = 0; pass < 8; pass++)
+            {
+                histograms[pass][(item.key >> (pass * 8)) & 0xFF]++;
+            }
+        }
+
+        scratch.resize(count);
+        std::vector<T>* source      = &items;
+        std::vector<T>* destination = &scratch;
+
+        for (uint32_t pass = 0; pass < 8; pass++)
+        {
+            std::array<size_t, 256>& histogram = histograms[pass];
+            const uint32_t shift = pass * 8;
+
+            // Nothing to reorder
+            if (histogram[((*source)[0].key >> shift) & 0xFF] == count)
+                continue;
+
+            // Counts to offsets
+            size_t offset = 0;
+            for (size_t& bucket : histogram)
+            {
+                const size_t bucket_count = bucket;
+                bucket = offset;
+                offset += bucket_count;
+            }
+
+            for (const T& item : *source)
+            {
+                (*destination)[histogram[(item.key >> shift) & 0xFF]++] = item;
+            }
+
+            std::swap(source, destination);
+        }
+
+        // An odd number of passes leaves the result in the scratch memory
+        if (source != &items)
+        {
+            items.swap(scratch);
+        }
+    }
+}
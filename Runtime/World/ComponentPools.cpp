@@ -0,0 +1,76 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "Spartan.h"
+#include "ComponentPools.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    void ComponentPools::Add(IComponent* component)
+    {
+        const uint32_t type = static_cast<uint32_t>(component ? component->GetType() : ComponentType::Unknown);
+        if (type >= pool_count || component->m_pool_index != IComponent::pool_index_invalid)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        Pool& pool                  = m_pools[type];
+        component->m_pool_index     = static_cast<uint32_t>(pool.components.size());
+        pool.components.emplace_back(component);
+        pool.entities.emplace_back(component->GetEntity());
+    }
+
+    void ComponentPools::Remove(IComponent* component)
+    {
+        if (!component || component->m_pool_index == IComponent::pool_index_invalid)
+            return;
+
+        // Move the last component into the gap
+        Pool& pool              = m_pools[static_cast<uint32_t>(component->GetType())];
+        const uint32_t index    = component->m_pool_index;
+        IComponent* last        = pool.components.back();
+        pool.components[index]  = last;
+        pool.entities[index]    = pool.entities.back();
+        last->m_pool_index      = index;
+
+        pool.components.pop_back();
+        pool.entities.pop_back();
+        component->m_pool_index = IComponent::pool_index_invalid;
+    }
+
+    void ComponentPools::Remove(Entity* entity)
+    {
+        if (!entity)
+            return;
+
+        for (const shared_ptr<IComponent>& component : entity->GetAllComponents())
+        {
+            Remove(component.get());
+        }
+    }
+}
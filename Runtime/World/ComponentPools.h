@@ -0,0 +1,95 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========
+#include <array>
+#include <vector>
+#include "Entity.h"
+//=====================
+
+namespace Spartan
+{
+    // Every component in the world, grouped by type into sparse sets.
+    // Each type keeps a dense array of its components (and their entities), so iterating a type touches no other entity,
+    // while each component remembers its position in that array so adding and removing are O(1) (swap and pop).
+    // The pools don't own anything, they are views. Each entity owns its components (Entity::m_components) and keeps the pools in sync,
+    // it adds a component when it's registered and removes it before releasing it, so a pointer in here is valid for as long as it's in here.
+    class ComponentPools
+    {
+    public:
+        static const uint32_t pool_count = static_cast<uint32_t>(ComponentType::Unknown);
+
+        void Add(IComponent* component);
+        void Remove(IComponent* component);
+        // Removes all of the entity's components, for entities which leave the world while something else still holds on to them
+        void Remove(Entity* entity);
+
+        //= POOLS ==========================================================================================================================
+        // The components of a type and the entity owning each one (same index), in no particular order
+        const std::vector<IComponent*>& GetComponents(const ComponentType type) const   { return m_pools[static_cast<uint32_t>(type)].components; }
+        const std::vector<Entity*>& GetEntities(const ComponentType type) const         { return m_pools[static_cast<uint32_t>(type)].entities; }
+        uint32_t GetCount(const ComponentType type) const                               { return static_cast<uint32_t>(GetComponents(type).size()); }
+        //==================================================================================================================================
+
+        // Calls function(Entity*, T*...) for every entity which has all of the given components.
+        // The smallest of the pools drives the iteration, entities missing any of the other components are skipped.
+        // Components of the given types must not be added or removed from within the function.
+        template <typename... T, typename Function>
+        void Each(Function&& function) const
+        {
+            const ComponentType types[] = { IComponent::TypeToEnum<T>()... };
+
+            ComponentType driver = types[0];
+            for (const ComponentType type : types)
+            {
+                driver = GetCount(type) < GetCount(driver) ? type : driver;
+            }
+
+            const Pool& pool = m_pools[static_cast<uint32_t>(driver)];
+            for (uint32_t i = 0; i < static_cast<uint32_t>(pool.components.size()); i++)
+            {
+                Entity* entity = pool.entities[i];
+                if ((entity->HasComponent<T>() && ...))
+                {
+                    function(entity, Fetch<T>(entity, driver, pool.components[i])...);
+                }
+            }
+        }
+
+    private:
+        // The driving type is passed as it comes from the pool (scripts can exist more than once per entity), the rest are looked up
+        template <typename T>
+        static T* Fetch(Entity* entity, const ComponentType driver, IComponent* component)
+        {
+            return IComponent::TypeToEnum<T>() == driver ? static_cast<T*>(component) : entity->GetComponent<T>();
+        }
+
+        struct Pool
+        {
+            std::vector<IComponent*> components;
+            std::vector<Entity*> entities;
+        };
+
+        std::array<Pool, pool_count> m_pools;
+    };
+}
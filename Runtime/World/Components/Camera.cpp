@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderable.h"
 #include "../Entity.h"
 #include "../World.h"
+#include "../ComponentPools.h"
 #include "../../Input/Input.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
@@ -185,30 +186,26 @@ namespace Spartan
         // Traces ray against all AABBs in the world
         vector<RayHit> hits;
         {
-            const auto& entities = m_context->GetSubsystem<World>()->EntityGetAll();
-            for (const auto& entity : entities)
+            // Only the entities with a renderable can be hit
+            m_context->GetSubsystem<World>()->GetComponentPools()->Each<Renderable>([this, &hits](Entity* entity, Renderable* renderable)
             {
-                // Make sure there entity has a renderable
-                if (!entity->HasComponent<Renderable>())
-                    continue;
-
                 // Get object oriented bounding box
-                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetAabb();
+                const BoundingBox& aabb = renderable->GetAabb();
 
                 // Compute hit distance
                 float distance = m_ray.HitDistance(aabb);
 
                 // Don't store hit data if there was no hit
                 if (distance == Helper::INFINITY_)
-                    continue;
+                    return;
 
                 hits.emplace_back(
-                    entity,                                             // Entity
+                    entity->GetPtrShared(),                             // Entity
                     m_ray.GetStart() + distance * m_ray.GetDirection(), // Position
                     distance,                                           // Distance
                     distance == 0.0f                                    // Inside
                 );
-            }
+            });
 
             // Sort by distance (ascending)
             std::sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
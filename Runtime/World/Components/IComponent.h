@@ -148,7 +148,12 @@ namespace Spartan
         Transform* m_transform  = nullptr;
 
     private:
+        friend class ComponentPools;
+        static const uint32_t pool_index_invalid = static_cast<uint32_t>(-1);
+
         // The attributes of the component
         std::vector<Attribute> m_attributes;
+        // The position of the component in the pool of its type (see ComponentPools)
+        uint32_t m_pool_index = pool_index_invalid;
     };
 }
@@ -116,12 +116,15 @@ namespace Spartan
         const Math::Matrix& GetViewMatrix(uint32_t index = 0) const;
         const Math::Matrix& GetProjectionMatrix(uint32_t index = 0) const;
 
-        RHI_Texture* GetDepthTexture() const { return m_shadow_map.texture_depth.get(); }
-        RHI_Texture* GetColorTexture() const { return m_shadow_map.texture_color.get(); }
+        const std::shared_ptr<RHI_Texture>& GetDepthTexture() const { return m_shadow_map.texture_depth; }
+        const std::shared_ptr<RHI_Texture>& GetColorTexture() const { return m_shadow_map.texture_color; }
         uint32_t GetShadowArraySize() const;
         void CreateShadowMap();
 
         bool IsInViewFrustrum(Renderable* renderable, uint32_t index) const;
+        const Math::Frustum& GetFrustum(const uint32_t index) const { return m_shadow_map.slices[index].frustum; }
+        // Shadow casters from behind the near plane must not be rejected
+        bool GetFrustumIgnoreDepth() const { return m_light_type == LightType::Directional; }
 
     private:
         void ComputeViewMatrix();
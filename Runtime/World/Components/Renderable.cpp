@@ -145,6 +145,7 @@ namespace Spartan
         string model_name;
         stream->Read(&model_name);
         m_model = m_context->GetSubsystem<ResourceCache>()->GetByName<Model>(model_name);
+        GeometryLodsUpdate();
 
         // If it was a default mesh, we have to reconstruct it
         if (m_geometry_type != Geometry_Custom) 
@@ -176,6 +177,8 @@ namespace Spartan
         m_geometryVertexCount   = vertex_count;
         m_bounding_box          = bounding_box;
         m_model                 = model ? model->GetSharedPtr() : nullptr;
+
+        GeometryLodsUpdate();
     }
 
     void Renderable::GeometrySet(const Geometry_Type type)
@@ -216,6 +219,52 @@ namespace Spartan
         return m_aabb;
     }
 
+    void Renderable::GeometryLodSelect(const Vector3& camera_position, const float projection_scale, const float threshold)
+    {
+        m_lod_index = 0;
+        if (m_lods.size() <= 1 || threshold <= 0.0f)
+            return;
+
+        // Distance to the closest point of the bounding box, so large objects don't drop detail right in front of the camera
+        const BoundingBox& aabb = GetAabb();
+        const Vector3 closest   = Vector3(
+            Helper::Clamp(camera_position.x, aabb.GetMin().x, aabb.GetMax().x),
+            Helper::Clamp(camera_position.y, aabb.GetMin().y, aabb.GetMax().y),
+            Helper::Clamp(camera_position.z, aabb.GetMin().z, aabb.GetMax().z)
+        );
+        const float distance = Vector3::Distance(camera_position, closest);
+        if (distance <= Helper::EPSILON)
+            return;
+
+        // The errors are in model space
+        const Vector3 scale         = GetTransform()->GetScale();
+        const float pixels_per_unit = Helper::Max3(Helper::Abs(scale.x), Helper::Abs(scale.y), Helper::Abs(scale.z)) * projection_scale / distance;
+
+        for (uint32_t i = static_cast<uint32_t>(m_lods.size()) - 1; i > 0; i--)
+        {
+            if (m_lods[i].error * pixels_per_unit <= threshold)
+            {
+                m_lod_index = i;
+                return;
+            }
+        }
+    }
+
+    void Renderable::GeometryLodsUpdate()
+    {
+        m_lods.clear();
+        m_lod_index = 0;
+
+        if (m_geometryIndexCount == 0)
+            return;
+
+        m_lods.push_back({ m_geometryIndexOffset, m_geometryIndexCount, 0.0f });
+        if (const vector<MeshLod>* lods = m_model ? m_model->GetLods(m_geometryIndexOffset) : nullptr)
+        {
+            m_lods.insert(m_lods.end(), lods->begin(), lods->end());
+        }
+    }
+
     // All functions (set/load) resolve to this
     void Renderable::SetMaterial(const shared_ptr<Material>& material)
     {
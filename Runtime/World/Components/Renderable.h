@@ -26,12 +26,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include "../../Math/BoundingBox.h"
 #include "../../Math/Matrix.h"
+#include "../../Rendering/Mesh.h"
 //=================================
 
 namespace Spartan
 {
     class Model;
-    class Mesh;
     class Light;
     class Material;
     namespace Math
@@ -80,10 +80,20 @@ namespace Spartan
         Geometry_Type GeometryType()                const { return m_geometry_type; }
         const std::string& GeometryName()           const { return m_geometryName; }
         const Model* GeometryModel()                const { return m_model.get(); }
+        const std::shared_ptr<Model>& GeometryModelShared() const { return m_model; }
         const Math::BoundingBox& GetBoundingBox()   const { return m_bounding_box; }
         const Math::BoundingBox& GetAabb();
         //=====================================================================================================
 
+        //= LEVEL OF DETAIL ==============================================================================================================================
+        // Picks the coarsest level whose error, projected on screen, stays under the threshold (in pixels)
+        void GeometryLodSelect(const Math::Vector3& camera_position, float projection_scale, float threshold);
+        uint32_t GeometryLodCount()         const { return static_cast<uint32_t>(m_lods.size()); }
+        uint32_t GeometryLodIndex()         const { return m_lod_index; }
+        uint32_t GeometryLodIndexOffset()   const { return m_lods.empty() ? m_geometryIndexOffset : m_lods[m_lod_index].index_offset; }
+        uint32_t GeometryLodIndexCount()    const { return m_lods.empty() ? m_geometryIndexCount  : m_lods[m_lod_index].index_count; }
+        //================================================================================================================================================
+
         //= MATERIAL ============================================================
         // Sets a material from memory (adds it to the resource cache by default)
         void SetMaterial(const std::shared_ptr<Material>& material);
@@ -94,6 +104,7 @@ namespace Spartan
         void UseDefaultMaterial();
         std::string GetMaterialName()   const;
         Material* GetMaterial()         const { return m_material.get(); }
+        const auto& GetMaterialShared() const { return m_material; }
         auto HasMaterial()              const { return m_material != nullptr; }
         //=======================================================================
 
@@ -103,6 +114,8 @@ namespace Spartan
         //====================================================================================
 
     private:
+        void GeometryLodsUpdate();
+
         std::string m_geometryName;
         uint32_t m_geometryIndexOffset;
         uint32_t m_geometryIndexCount;
@@ -112,6 +125,8 @@ namespace Spartan
         Geometry_Type m_geometry_type;
         Math::BoundingBox m_bounding_box;
         Math::BoundingBox m_aabb;
+        std::vector<MeshLod> m_lods;    // the first one is the full detail geometry
+        uint32_t m_lod_index            = 0;
         Math::Matrix m_last_transform   = Math::Matrix::Identity;
         bool m_cast_shadows             = true;
         bool m_material_default;
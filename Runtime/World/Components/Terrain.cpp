@@ -23,13 +23,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Terrain.h"
 #include "Renderable.h"
+#include "Transform.h"
+#include "Camera.h"
 #include "..\Entity.h"
+#include "..\World.h"
 #include "..\..\RHI\RHI_Texture2D.h"
 #include "..\..\RHI\RHI_Vertex.h"
 #include "..\..\Rendering\Model.h"
+#include "..\..\Rendering\Renderer.h"
+#include "..\..\Rendering\Mesh.h"
 #include "..\..\IO\FileStream.h"
 #include "..\..\Resource\ResourceCache.h"
-#include "..\..\Rendering\Mesh.h"
 #include "..\..\Threading\Threading.h"
 //=======================================
 
@@ -40,35 +44,173 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    static float distance_to_aabb(const Vector3& point, const BoundingBox& aabb)
+    {
+        const Vector3 closest = Vector3(
+            Helper::Clamp(point.x, aabb.GetMin().x, aabb.GetMax().x),
+            Helper::Clamp(point.y, aabb.GetMin().y, aabb.GetMax().y),
+            Helper::Clamp(point.z, aabb.GetMin().z, aabb.GetMax().z)
+        );
+
+        return Vector3::Distance(point, closest);
+    }
+
+    // The samples of a chunk side at a given stride, the last one is always included so neighbouring chunks line up
+    static void lod_samples(const uint32_t quad_count, const uint32_t stride, vector<uint32_t>& samples)
+    {
+        samples.clear();
+        for (uint32_t i = 0; i < quad_count; i += stride)
+        {
+            samples.emplace_back(i);
+        }
+        samples.emplace_back(quad_count);
+    }
+
+    // Skirts are seen from both sides, so they are emitted with both windings
+    static void add_skirt_quad(vector<uint32_t>& indices, const uint32_t a, const uint32_t b, const uint32_t a_skirt, const uint32_t b_skirt)
+    {
+        indices.insert(indices.end(), { a, b, a_skirt, b, b_skirt, a_skirt });
+        indices.insert(indices.end(), { a, a_skirt, b, b, a_skirt, b_skirt });
+    }
+
     Terrain::Terrain(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id)
     {
         
     }
 
+    Terrain::~Terrain()
+    {
+        // Worker threads might still be writing into the chunks
+        while (m_is_generating || m_chunk_jobs != 0)
+        {
+            this_thread::yield();
+        }
+    }
+
     void Terrain::OnInitialize()
     {
         
     }
 
+    void Terrain::OnTick(float delta_time)
+    {
+        if (m_is_generating || m_nodes.empty())
+            return;
+
+        const shared_ptr<Camera>& camera = m_context->GetSubsystem<Renderer>()->GetCamera();
+        if (!camera)
+            return;
+
+        // Chunks are in terrain space
+        const Vector3 camera_position = camera->GetTransform()->GetPosition() * GetTransform()->GetMatrix().Inverted();
+
+        // Evict the chunks which went out of range (with some slack, so chunks on the border don't thrash)
+        const float evict_distance = m_stream_distance * 1.1f;
+        for (size_t i = 0; i < m_chunks_active.size();)
+        {
+            Chunk& chunk = m_chunks[m_chunks_active[i]];
+            if (chunk.state != Chunk_Loading && distance_to_aabb(camera_position, chunk.aabb) > evict_distance)
+            {
+                ChunkEvict(chunk);
+                m_chunks_active[i] = m_chunks_active.back();
+                m_chunks_active.pop_back();
+                continue;
+            }
+            i++;
+        }
+
+        // Walk the quadtree, only descending into nodes within the streaming distance
+        bool spawned = false;
+        m_chunks_requested.clear();
+        static thread_local vector<uint32_t> stack;
+        stack.clear();
+        stack.emplace_back(static_cast<uint32_t>(m_nodes.size() - 1));
+        while (!stack.empty())
+        {
+            const Node& node = m_nodes[stack.back()];
+            stack.pop_back();
+
+            const float distance = distance_to_aabb(camera_position, node.aabb);
+            if (distance > m_stream_distance)
+                continue;
+
+            if (node.chunk == index_invalid)
+            {
+                for (const uint32_t child : node.children)
+                {
+                    if (child != index_invalid)
+                    {
+                        stack.emplace_back(child);
+                    }
+                }
+
+                continue;
+            }
+
+            Chunk& chunk = m_chunks[node.chunk];
+            const uint8_t state = chunk.state;
+
+            if (state == Chunk_Unloaded)
+            {
+                m_chunks_requested.emplace_back(distance, node.chunk);
+                continue;
+            }
+
+            if (state == Chunk_Loaded)
+            {
+                ChunkSpawn(node.chunk);
+                spawned = true;
+            }
+
+            // Every time the distance doubles, the projected size of a quad halves, so does the resolution
+            if (chunk.state == Chunk_Resident)
+            {
+                const uint32_t lod = distance < m_lod_distance ? 0 : static_cast<uint32_t>(log2(distance / m_lod_distance)) + 1;
+                ChunkSetLod(chunk, Helper::Min(lod, lod_count - 1));
+            }
+        }
+
+        // Request the closest chunks first, without flooding the worker threads
+        sort(m_chunks_requested.begin(), m_chunks_requested.end());
+        for (const auto& [distance, index] : m_chunks_requested)
+        {
+            if (m_chunk_jobs >= m_chunk_jobs_max)
+                break;
+
+            ChunkLoad(index);
+        }
+
+        // Let the renderer know about the new chunk entities
+        if (spawned)
+        {
+            QUEUE_EVENT(EventType::WorldResolve);
+        }
+    }
+
     void Terrain::Serialize(FileStream* stream)
     {
         const string no_path;
 
         stream->Write(m_height_map ? m_height_map->GetResourceFilePathNative() : no_path);
-        stream->Write(m_model ? m_model->GetResourceName() : no_path);
         stream->Write(m_min_y);
         stream->Write(m_max_y);
+        stream->Write(m_stream_distance);
+        stream->Write(m_lod_distance);
     }
 
     void Terrain::Deserialize(FileStream* stream)
     {
-        ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
-        m_height_map    = resource_cache->GetByPath<RHI_Texture2D>(stream->ReadAs<string>());
-        m_model         = resource_cache->GetByName<Model>(stream->ReadAs<string>());
+        m_height_map = m_context->GetSubsystem<ResourceCache>()->GetByPath<RHI_Texture2D>(stream->ReadAs<string>());
         stream->Read(&m_min_y);
         stream->Read(&m_max_y);
+        stream->Read(&m_stream_distance);
+        stream->Read(&m_lod_distance);
 
-        UpdateFromModel(m_model);
+        // The chunks are not saved, they are streamed from the height map
+        if (m_height_map)
+        {
+            GenerateAsync();
+        }
     }
 
     void Terrain::SetHeightMap(const shared_ptr<RHI_Texture2D>& height_map)
@@ -85,24 +227,24 @@ namespace Spartan
             return;
         }
 
+        ChunksClear();
+
         if (!m_height_map)
         {
             LOG_WARNING("You need to assign a height map before trying to generate a terrain.");
 
-            m_context->GetSubsystem<ResourceCache>()->Remove(m_model);
-            m_model.reset();
-            if (Renderable* renderable = m_entity->AddComponent<Renderable>())
-            {
-                renderable->GeometryClear();
-            }
-            
+            m_heights.clear();
+            m_chunks.clear();
+            m_nodes.clear();
+
             return;
         }
 
+        // Set before the task starts, so OnTick() doesn't touch the chunks while they are being rebuilt
+        m_is_generating = true;
+
         m_context->GetSubsystem<Threading>()->AddTask([this]()
         {
-            m_is_generating = true;
-
             // Get height map data
             const vector<std::byte> height_map_data = m_height_map->GetOrLoadMip(0);
             if (height_map_data.empty())
@@ -111,37 +253,18 @@ namespace Spartan
             }
 
             // Deduce some stuff
-            m_height                            = m_height_map->GetHeight();
-            m_width                             = m_height_map->GetWidth();
-            m_vertex_count                      = m_height * m_width;
-            m_face_count                        = (m_height - 1) * (m_width - 1) * 2;
-            m_progress_jobs_done                = 0;
-            m_progress_job_count                = m_vertex_count * 2 + m_face_count + m_vertex_count * m_face_count;
-
-            // Pre-allocate memory for the calculations that follow
-            vector<Vector3> positions                 = vector<Vector3>(m_height * m_width);
-            vector<RHI_Vertex_PosTexNorTan> vertices  = vector<RHI_Vertex_PosTexNorTan>(m_vertex_count);
-            vector<uint32_t> indices                  = vector<uint32_t>(m_face_count * 3);
-
-            // Read height map and construct positions
-            m_progress_desc = "Generating positions...";
-            if (GeneratePositions(positions, height_map_data))
+            m_height                = m_height_map->GetHeight();
+            m_width                 = m_height_map->GetWidth();
+            m_vertex_count          = m_height * m_width;
+            m_progress_jobs_done    = 0;
+            m_progress_job_count    = m_vertex_count * 2;
+
+            // Read height map, the chunk geometry is generated from these heights once it gets close to the camera
+            m_progress_desc = "Generating heights...";
+            if (GenerateHeights(height_map_data))
             {
-                // Compute the vertices (without the normals) and the indices
-                m_progress_desc = "Generating terrain vertices and indices...";
-                if (GenerateVerticesIndices(positions, indices, vertices))
-                {
-                    m_progress_desc = "Generating normals and tangents...";
-                    positions.clear();
-                    positions.shrink_to_fit();
-
-                    // Compute the normals by doing normal averaging (very expensive)
-                    if (GenerateNormalTangents(indices, vertices))
-                    {
-                        // Create a model and set it to the renderable component
-                        UpdateFromVertices(indices, vertices);
-                    }
-                }
+                m_progress_desc = "Generating chunks...";
+                GenerateChunks();
             }
 
             // Clear progress stats
@@ -153,282 +276,330 @@ namespace Spartan
         });
     }
 
-    bool Terrain::GeneratePositions(vector<Vector3>& positions, const vector<std::byte>& height_map)
+    bool Terrain::GenerateHeights(const vector<std::byte>& height_map)
     {
+        m_heights.clear();
+        m_chunks.clear();
+        m_nodes.clear();
+
         if (height_map.empty())
         {
             LOG_ERROR("Height map is empty");
             return false;
         }
 
-        uint32_t index  = 0;
-        uint32_t k      = 0;
-
-        for (uint32_t y = 0; y < m_height; y++)
+        if (m_width < 2 || m_height < 2 || height_map.size() < m_vertex_count * 4)
         {
-            for (uint32_t x = 0; x < m_width; x++)
-            {
-                // Read height and scale it to a [0, 1] range
-                const float height = (static_cast<float>(height_map[k]) / 255.0f);
+            LOG_ERROR("Height map is too small");
+            return false;
+        }
 
-                // Construct position
-                const uint32_t index  = y * m_width + x;
-                positions[index].x    = static_cast<float>(x) - m_width * 0.5f;     // center on the X axis
-                positions[index].z    = static_cast<float>(y) - m_height * 0.5f;    // center on the Z axis
-                positions[index].y    = Helper::Lerp(m_min_y, m_max_y, height);
+        m_heights.resize(m_vertex_count);
 
-                k += 4;
+        uint32_t k = 0;
+        for (uint32_t i = 0; i < m_vertex_count; i++)
+        {
+            // Read height (red channel) and scale it to a [min_y, max_y] range
+            const float height = (static_cast<float>(height_map[k]) / 255.0f);
+            m_heights[i] = Helper::Lerp(m_min_y, m_max_y, height);
 
-                // track progress
-                m_progress_jobs_done++;
-            }
+            k += 4;
         }
 
+        // track progress
+        m_progress_jobs_done += m_vertex_count;
+
         return true;
     }
 
-    bool Terrain::GenerateVerticesIndices(const vector<Vector3>& positions, vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    void Terrain::GenerateChunks()
     {
-        if (positions.empty())
-        {
-            LOG_ERROR("Positions are empty");
-            return false;
-        }
+        const uint32_t chunk_count_x = (m_width - 2) / chunk_size + 1;
+        const uint32_t chunk_count_y = (m_height - 2) / chunk_size + 1;
 
-        uint32_t index      = 0;
-        uint32_t k          = 0;
-        uint32_t u_index    = 0;
-        uint32_t v_index    = 0;
+        m_chunks = vector<Chunk>(chunk_count_x * chunk_count_y);
 
-        for (uint32_t y = 0; y < m_height - 1; y++)
+        // Bounding boxes, from the heights each chunk covers
+        m_context->GetSubsystem<Threading>()->ParallelFor(static_cast<uint32_t>(m_chunks.size()), [this, chunk_count_x](uint32_t start, uint32_t end)
         {
-            for (uint32_t x = 0; x < m_width - 1; x++)
+            for (uint32_t i = start; i < end; i++)
             {
-                const uint32_t index_bottom_left  = y * m_width + x;
-                const uint32_t index_bottom_right = y * m_width + x + 1;
-                const uint32_t index_top_left     = (y + 1) * m_width + x;
-                const uint32_t index_top_right    = (y + 1) * m_width + x + 1;
-
-                // Bottom right of quad
-                index           = index_bottom_right;
-                indices[k]      = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 1.0f));
-
-                // Bottom left of quad
-                index           = index_bottom_left;
-                indices[k + 1]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 1.0f));
-
-                // Top left of quad
-                index           = index_top_left;
-                indices[k + 2]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 0.0f));
+                Chunk& chunk        = m_chunks[i];
+                chunk.x             = (i % chunk_count_x) * chunk_size;
+                chunk.y             = (i / chunk_count_x) * chunk_size;
+                chunk.quad_count_x  = Helper::Min(chunk_size, m_width - 1 - chunk.x);
+                chunk.quad_count_y  = Helper::Min(chunk_size, m_height - 1 - chunk.y);
+
+                float min_y = numeric_limits<float>::max();
+                float max_y = numeric_limits<float>::lowest();
+                for (uint32_t y = chunk.y; y <= chunk.y + chunk.quad_count_y; y++)
+                {
+                    for (uint32_t x = chunk.x; x <= chunk.x + chunk.quad_count_x; x++)
+                    {
+                        const float height = m_heights[y * m_width + x];
+                        min_y = Helper::Min(min_y, height);
+                        max_y = Helper::Max(max_y, height);
+                    }
+                }
 
-                // Bottom right of quad
-                index           = index_bottom_right;
-                indices[k + 3]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 1.0f));
+                const Vector3 origin = Vector3(m_width * -0.5f, 0.0f, m_height * -0.5f);
+                chunk.aabb = BoundingBox(
+                    origin + Vector3(static_cast<float>(chunk.x), min_y, static_cast<float>(chunk.y)),
+                    origin + Vector3(static_cast<float>(chunk.x + chunk.quad_count_x), max_y, static_cast<float>(chunk.y + chunk.quad_count_y))
+                );
 
-                // Top left of quad
-                index           = index_top_left;
-                indices[k + 4]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 0.0f));
+                // track progress
+                m_progress_jobs_done += (chunk.quad_count_x + 1) * (chunk.quad_count_y + 1);
+            }
+        });
 
-                // Top right of quad
-                index           = index_top_right;
-                indices[k + 5]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 0.0f));
+        // Quadtree, nodes are appended after their children so the root ends up last
+        m_nodes.reserve(m_chunks.size() * 2);
+        GenerateNode(0, 0, chunk_count_x, chunk_count_y, chunk_count_x);
+    }
 
-                k += 6; // next quad
+    uint32_t Terrain::GenerateNode(const uint32_t x_start, const uint32_t y_start, const uint32_t x_end, const uint32_t y_end, const uint32_t chunk_count_x)
+    {
+        Node node;
 
-                u_index++;
+        if (x_end - x_start == 1 && y_end - y_start == 1)
+        {
+            node.chunk  = y_start * chunk_count_x + x_start;
+            node.aabb   = m_chunks[node.chunk].aabb;
+        }
+        else
+        {
+            // Split each side in half, a side which is a single chunk wide is not split
+            const uint32_t x_mid = x_start + (x_end - x_start + 1) / 2;
+            const uint32_t y_mid = y_start + (y_end - y_start + 1) / 2;
+            const array<array<uint32_t, 4>, 4> quadrants =
+            {{
+                { x_start, y_start, x_mid, y_mid },
+                { x_mid,   y_start, x_end, y_mid },
+                { x_start, y_mid,   x_mid, y_end },
+                { x_mid,   y_mid,   x_end, y_end }
+            }};
+
+            node.aabb = BoundingBox();
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                const auto& quadrant = quadrants[i];
+                if (quadrant[0] >= quadrant[2] || quadrant[1] >= quadrant[3])
+                    continue;
 
-                // track progress
-                m_progress_jobs_done++;
+                node.children[i] = GenerateNode(quadrant[0], quadrant[1], quadrant[2], quadrant[3], chunk_count_x);
+                node.aabb.Merge(m_nodes[node.children[i]].aabb);
             }
-            u_index = 0;
-            v_index++;
         }
 
-        return true;
+        m_nodes.emplace_back(node);
+        return static_cast<uint32_t>(m_nodes.size() - 1);
     }
 
-    bool Terrain::GenerateNormalTangents(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    float Terrain::GetHeight(const uint32_t x, const uint32_t y) const
     {
-        if (indices.empty())
-        {
-            LOG_ERROR("Indices are empty");
-            return false;
-        }
+        return m_heights[Helper::Min(y, m_height - 1) * m_width + Helper::Min(x, m_width - 1)];
+    }
 
-        if (vertices.empty())
-        {
-            LOG_ERROR("Vertices are empty");
-            return false;
-        }
+    RHI_Vertex_PosTexNorTan Terrain::GenerateVertex(const uint32_t x, const uint32_t y) const
+    {
+        const float height = GetHeight(x, y);
+
+        // Central differences, they only depend on the height map so normals match across chunk borders
+        const float height_left     = GetHeight(x == 0 ? 0 : x - 1, y);
+        const float height_right    = GetHeight(x + 1, y);
+        const float height_down     = GetHeight(x, y == 0 ? 0 : y - 1);
+        const float height_up       = GetHeight(x, y + 1);
+        const Vector3 normal        = Vector3(height_left - height_right, 2.0f, height_down - height_up).Normalized();
+        const Vector3 tangent       = Vector3(2.0f, height_right - height_left, 0.0f).Normalized();
+
+        return RHI_Vertex_PosTexNorTan(
+            Vector3(static_cast<float>(x) - m_width * 0.5f, height, static_cast<float>(y) - m_height * 0.5f), // centered on the X and Z axis
+            Vector2(static_cast<float>(x), static_cast<float>(m_height - 1 - y)),
+            normal,
+            tangent
+        );
+    }
 
-        // Normals are computed by normal averaging, which can be crazy slow
-        uint32_t face_count     = static_cast<uint32_t>(indices.size()) / 3;
-        uint32_t vertex_count   = static_cast<uint32_t>(vertices.size());
+    void Terrain::ChunkLoad(const uint32_t index)
+    {
+        m_chunks[index].state = Chunk_Loading;
+        m_chunks_active.emplace_back(index);
+        m_chunk_jobs++;
 
-        // Compute face normals and tangents
-        vector<Vector3> face_normals(face_count);
-        vector<Vector3> face_tangents(face_count);
+        m_context->GetSubsystem<Threading>()->AddTask([this, index]()
         {
-            for (uint32_t i = 0; i < face_count; ++i)
+            Chunk& chunk                = m_chunks[index];
+            const uint32_t size_x       = chunk.quad_count_x + 1;
+            const uint32_t size_y       = chunk.quad_count_y + 1;
+            const float skirt_depth     = chunk.aabb.GetSize().y + 1.0f;
+
+            // Grid, at the highest level of detail, the lower ones skip vertices
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vertices.reserve(size_x * size_y + (size_x + size_y) * 2);
+            for (uint32_t y = 0; y < size_y; y++)
             {
-                Vector3 edge_a;
-                Vector3 edge_b;
-
-                // Normal
+                for (uint32_t x = 0; x < size_x; x++)
                 {
-                    // Get the vector describing one edge of our triangle (edge 0, 1)
-                    edge_a = Vector3(
-                        vertices[indices[(i * 3)]].pos[0] - vertices[indices[(i * 3) + 1]].pos[0],
-                        vertices[indices[(i * 3)]].pos[1] - vertices[indices[(i * 3) + 1]].pos[1],
-                        vertices[indices[(i * 3)]].pos[2] - vertices[indices[(i * 3) + 1]].pos[2]
-                    );
-
-                    // Get the vector describing another edge of our triangle (edge 2,1)
-                    edge_b = Vector3(
-                        vertices[indices[(i * 3) + 1]].pos[0] - vertices[indices[(i * 3) + 2]].pos[0],
-                        vertices[indices[(i * 3) + 1]].pos[1] - vertices[indices[(i * 3) + 2]].pos[1],
-                        vertices[indices[(i * 3) + 1]].pos[2] - vertices[indices[(i * 3) + 2]].pos[2]
-                    );
-
-                    // Cross multiply the two edge vectors to get the unnormalized face normal
-                    face_normals[i] = Vector3::Cross(edge_a, edge_b);
+                    vertices.emplace_back(GenerateVertex(chunk.x + x, chunk.y + y));
                 }
+            }
 
-                // Tangent
-                {
-                    // find first texture coordinate edge 2d vector
-                    const float tcU1 = vertices[indices[(i * 3)]].tex[0] - vertices[indices[(i * 3) + 1]].tex[0];
-                    const float tcV1 = vertices[indices[(i * 3)]].tex[1] - vertices[indices[(i * 3) + 1]].tex[1];
-
-                    // find second texture coordinate edge 2d vector
-                    const float tcU2 = vertices[indices[(i * 3) + 1]].tex[0] - vertices[indices[(i * 3) + 2]].tex[0];
-                    const float tcV2 = vertices[indices[(i * 3) + 1]].tex[1] - vertices[indices[(i * 3) + 2]].tex[1];
-
-                    // find tangent using both tex coord edges and position edges
-                    face_tangents[i].x = (tcV1 * edge_a.x - tcV2 * edge_b.x * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
-                    face_tangents[i].y = (tcV1 * edge_a.y - tcV2 * edge_b.y * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
-                    face_tangents[i].z = (tcV1 * edge_a.z - tcV2 * edge_b.z * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
-                }
+            // Skirts, a copy of each edge pushed downwards
+            const auto add_skirt = [this, &chunk, &vertices, skirt_depth](const uint32_t x, const uint32_t y)
+            {
+                RHI_Vertex_PosTexNorTan vertex = GenerateVertex(chunk.x + x, chunk.y + y);
+                vertex.pos[1] -= skirt_depth;
+                vertices.emplace_back(vertex);
+            };
+            const uint32_t skirt_bottom = static_cast<uint32_t>(vertices.size());
+            for (uint32_t x = 0; x < size_x; x++)
+            {
+                add_skirt(x, 0);
+            }
 
-                // track progress
-                m_progress_jobs_done++;
+            const uint32_t skirt_top = static_cast<uint32_t>(vertices.size());
+            for (uint32_t x = 0; x < size_x; x++)
+            {
+                add_skirt(x, size_y - 1);
             }
-        }
 
-        
-        // Compute vertex normals and tangents (normals averaging) - This is very expensive show we split it into multiple threads below
-        const auto compute_vertex_normals_tangents = [this, &face_normals , &face_tangents, &vertices, &indices, &vertex_count, &face_count](uint32_t i_start, uint32_t i_end)
-        {
-            Vector3 normal_sum  = Vector3::Zero;
-            Vector3 tangent_sum = Vector3::Zero;
-            float faces_using   = 0;
+            const uint32_t skirt_left = static_cast<uint32_t>(vertices.size());
+            for (uint32_t y = 0; y < size_y; y++)
+            {
+                add_skirt(0, y);
+            }
 
-            for (uint32_t i = i_start; i < i_end; ++i)
+            const uint32_t skirt_right = static_cast<uint32_t>(vertices.size());
+            for (uint32_t y = 0; y < size_y; y++)
             {
-                // Check which triangles use this vertex
-                for (uint32_t j = 0; j < face_count; ++j)
+                add_skirt(size_x - 1, y);
+            }
+
+            // Indices, one range per level of detail
+            vector<uint32_t> indices;
+            vector<uint32_t> samples_x;
+            vector<uint32_t> samples_y;
+            for (uint32_t lod = 0; lod < lod_count; lod++)
+            {
+                lod_samples(chunk.quad_count_x, 1 << lod, samples_x);
+                lod_samples(chunk.quad_count_y, 1 << lod, samples_y);
+                chunk.index_offset[lod] = static_cast<uint32_t>(indices.size());
+
+                for (uint32_t j = 0; j < samples_y.size() - 1; j++)
                 {
-                    if (indices[j * 3] == i || indices[(j * 3) + 1] == i || indices[(j * 3) + 2] == i)
+                    for (uint32_t i = 0; i < samples_x.size() - 1; i++)
                     {
-                        // If a face is using the vertex, accumulate the face normal/tangent
-                        normal_sum  += face_normals[j];
-                        tangent_sum += face_tangents[j];
-                        faces_using++;
-                    }
+                        const uint32_t index_bottom_left  = samples_y[j] * size_x + samples_x[i];
+                        const uint32_t index_bottom_right = samples_y[j] * size_x + samples_x[i + 1];
+                        const uint32_t index_top_left     = samples_y[j + 1] * size_x + samples_x[i];
+                        const uint32_t index_top_right    = samples_y[j + 1] * size_x + samples_x[i + 1];
 
-                    // Track progress but only every time the inner loop (face_count) finished.
-                    // This is because different threads increment the progress tracker which is also an atomic so it locks and unlocks.
-                    if (j == face_count < 1)
-                    {
-                        m_progress_jobs_done += face_count;
+                        indices.insert(indices.end(), { index_bottom_right, index_bottom_left, index_top_left });
+                        indices.insert(indices.end(), { index_bottom_right, index_top_left, index_top_right });
                     }
                 }
 
-                // Compute actual normal
-                normal_sum /= faces_using;
-                normal_sum.Normalize();
-
-                // Compute actual tangent
-                tangent_sum /= faces_using;
-                tangent_sum.Normalize();
-
-                // Write normal to vertex
-                vertices[i].nor[0] = normal_sum.x;
-                vertices[i].nor[1] = normal_sum.y;
-                vertices[i].nor[2] = normal_sum.z;
+                for (uint32_t i = 0; i < samples_x.size() - 1; i++)
+                {
+                    const uint32_t a = samples_x[i];
+                    const uint32_t b = samples_x[i + 1];
+                    add_skirt_quad(indices, a, b, skirt_bottom + a, skirt_bottom + b);
+                    add_skirt_quad(indices, (size_y - 1) * size_x + a, (size_y - 1) * size_x + b, skirt_top + a, skirt_top + b);
+                }
 
-                // Write tangent to vertex
-                vertices[i].tan[0] = tangent_sum.x;
-                vertices[i].tan[1] = tangent_sum.y;
-                vertices[i].tan[2] = tangent_sum.z;
+                for (uint32_t j = 0; j < samples_y.size() - 1; j++)
+                {
+                    const uint32_t a = samples_y[j];
+                    const uint32_t b = samples_y[j + 1];
+                    add_skirt_quad(indices, a * size_x, b * size_x, skirt_left + a, skirt_left + b);
+                    add_skirt_quad(indices, a * size_x + size_x - 1, b * size_x + size_x - 1, skirt_right + a, skirt_right + b);
+                }
 
-                // Reset
-                normal_sum  = Vector3::Zero;
-                tangent_sum = Vector3::Zero;
-                faces_using = 0;
+                chunk.index_count[lod] = static_cast<uint32_t>(indices.size()) - chunk.index_offset[lod];
             }
-        };
 
-        m_context->GetSubsystem<Threading>()->AddTaskLoop(compute_vertex_normals_tangents, vertex_count);
+            chunk.model = make_shared<Model>(m_context);
+            chunk.model->AppendGeometry(indices, vertices);
+            chunk.model->UpdateGeometry();
 
-        return true;
+            // Hand it over to the main thread
+            chunk.state = Chunk_Loaded;
+            m_chunk_jobs--;
+        });
     }
 
-    void Terrain::UpdateFromModel(const shared_ptr<Model>& model) const
+    void Terrain::ChunkSpawn(const uint32_t index)
     {
-        if (!model)
+        Chunk& chunk = m_chunks[index];
+
+        shared_ptr<Entity> entity = m_context->GetSubsystem<World>()->EntityCreate();
+        entity->SetName(m_entity->GetName() + "_chunk_" + to_string(index));
+        entity->SetTransient(true);
+        entity->SetHierarchyVisibility(false);
+        entity->GetTransform()->SetParent(GetTransform());
+
+        if (Renderable* renderable = entity->AddComponent<Renderable>())
         {
-            LOG_ERROR_INVALID_PARAMETER();
-            return;
+            renderable->UseDefaultMaterial();
         }
 
-        if (Renderable* renderable = m_entity->AddComponent<Renderable>())
+        chunk.entity    = entity;
+        chunk.lod       = index_invalid;
+        chunk.state     = Chunk_Resident;
+    }
+
+    void Terrain::ChunkSetLod(Chunk& chunk, const uint32_t lod) const
+    {
+        if (chunk.lod == lod)
+            return;
+
+        const shared_ptr<Entity> entity = chunk.entity.lock();
+        if (!entity)
+            return;
+
+        if (Renderable* renderable = entity->GetRenderable())
         {
             renderable->GeometrySet(
                 "Terrain",
-                0,                                  // index offset
-                model->GetMesh()->Indices_Count(),  // index count
-                0,                                  // vertex offset
-                model->GetMesh()->Vertices_Count(), // vertex count
-                model->GetAabb(),
-                model.get()
+                chunk.index_offset[lod],                    // index offset
+                chunk.index_count[lod],                     // index count
+                0,                                          // vertex offset
+                chunk.model->GetMesh()->Vertices_Count(),   // vertex count
+                chunk.model->GetAabb(),
+                chunk.model.get()
             );
-
-            renderable->UseDefaultMaterial();
         }
+
+        chunk.lod = lod;
     }
 
-    void Terrain::UpdateFromVertices(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    void Terrain::ChunkEvict(Chunk& chunk) const
     {
-        // Add vertices and indices into a model struct (and cache that)
-        if (!m_model)
+        if (const shared_ptr<Entity> entity = chunk.entity.lock())
         {
-            // Create new model
-            m_model = make_shared<Model>(m_context);
+            m_context->GetSubsystem<World>()->EntityRemove(entity);
+        }
 
-            // Set geometry
-            m_model->AppendGeometry(indices, vertices);
-            m_model->UpdateGeometry();
+        chunk.entity.reset();
+        chunk.model.reset();
+        chunk.lod   = index_invalid;
+        chunk.state = Chunk_Unloaded;
+    }
 
-            // Set a file path so the model can be used by the resource cache
-            ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
-            m_model->SetResourceFilePath(resource_cache->GetProjectDirectory() + m_entity->GetName() + "_terrain_" + to_string(m_id) + string(EXTENSION_MODEL));
-            m_model = resource_cache->Cache(m_model);
+    void Terrain::ChunksClear()
+    {
+        // Worker threads might still be writing into the chunks
+        while (m_chunk_jobs != 0)
+        {
+            this_thread::yield();
         }
-        else
+
+        for (Chunk& chunk : m_chunks)
         {
-            // Update with new geometry
-            m_model->Clear();
-            m_model->AppendGeometry(indices, vertices);
-            m_model->UpdateGeometry();
+            ChunkEvict(chunk);
         }
 
-        UpdateFromModel(m_model);
+        m_chunks_active.clear();
     }
 }
@@ -24,25 +24,31 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include "IComponent.h"
 #include <atomic>
+#include <array>
+#include <vector>
 #include "../../RHI/RHI_Definition.h"
+#include "../../Math/BoundingBox.h"
 //===================================
 
 namespace Spartan
 {
     class Model;
-    namespace Math
-    {
-        class Vector3;
-    }
+    class Entity;
 
+    // The height map is split into fixed size chunks which are organised in a quadtree.
+    // Every tick, the chunks within the streaming distance of the camera get their geometry generated
+    // on worker threads, the ones further away are evicted. Each resident chunk is drawn by a (transient)
+    // child entity, so it's culled individually, and it picks a level of detail based on its distance.
+    // Skirts hang from the chunk edges to hide the cracks between neighbouring chunks of different detail.
     class SPARTAN_CLASS Terrain : public IComponent
     {
     public:
         Terrain(Context* context, Entity* entity, uint32_t id = 0);
-        ~Terrain() = default;
+        ~Terrain();
 
         //= IComponent ===============================
         void OnInitialize() override;
+        void OnTick(float delta_time) override;
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
         //============================================
@@ -56,30 +62,82 @@ namespace Spartan
         float GetMaxY() const { return m_max_y; }
         void SetMaxY(float max_z)   { m_max_y = max_z; }
 
+        float GetStreamDistance() const                 { return m_stream_distance; }
+        void SetStreamDistance(float stream_distance)   { m_stream_distance = stream_distance; }
+
+        float GetLodDistance() const                    { return m_lod_distance; }
+        void SetLodDistance(float lod_distance)         { m_lod_distance = lod_distance; }
+
         float GetProgress() const { return static_cast<float>(static_cast<double>(m_progress_jobs_done) / static_cast<double>(m_progress_job_count)); }
         const auto& GetProgressDescription() const { return m_progress_desc; }
 
         void GenerateAsync();
 
     private:
-        bool GeneratePositions(std::vector<Math::Vector3>& positions, const std::vector<std::byte>& height_map);
-        bool GenerateVerticesIndices(const std::vector<Math::Vector3>& positions, std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
-        bool GenerateNormalTangents(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
-        void UpdateFromModel(const std::shared_ptr<Model>& model) const;
-        void UpdateFromVertices(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        static const uint32_t chunk_size        = 64;   // quads per chunk side, at the highest level of detail
+        static const uint32_t lod_count         = 5;    // each level halves the resolution, down to 4 quads per side
+        static const uint32_t index_invalid     = static_cast<uint32_t>(-1);
+
+        enum Chunk_State : uint8_t
+        {
+            Chunk_Unloaded,
+            Chunk_Loading,  // the geometry is being generated on a worker thread
+            Chunk_Loaded,   // the geometry is ready, the main thread has to spawn an entity for it
+            Chunk_Resident  // the chunk is being rendered
+        };
+
+        struct Chunk
+        {
+            uint32_t x              = 0; // first sample
+            uint32_t y              = 0;
+            uint32_t quad_count_x   = 0;
+            uint32_t quad_count_y   = 0;
+            uint32_t lod            = index_invalid;
+            Math::BoundingBox aabb; // terrain space, without the skirts
+            std::atomic<uint8_t> state = Chunk_Unloaded;
+            std::array<uint32_t, lod_count> index_offset = {};
+            std::array<uint32_t, lod_count> index_count  = {};
+            std::shared_ptr<Model> model;
+            std::weak_ptr<Entity> entity;
+        };
+
+        struct Node
+        {
+            Math::BoundingBox aabb;
+            std::array<uint32_t, 4> children = { index_invalid, index_invalid, index_invalid, index_invalid };
+            uint32_t chunk = index_invalid; // leaf nodes only
+        };
+
+        bool GenerateHeights(const std::vector<std::byte>& height_map);
+        void GenerateChunks();
+        uint32_t GenerateNode(uint32_t x_start, uint32_t y_start, uint32_t x_end, uint32_t y_end, uint32_t chunk_count_x);
+        RHI_Vertex_PosTexNorTan GenerateVertex(uint32_t x, uint32_t y) const;
+        float GetHeight(uint32_t x, uint32_t y) const;
+
+        void ChunkLoad(uint32_t index);
+        void ChunkSpawn(uint32_t index);
+        void ChunkSetLod(Chunk& chunk, uint32_t lod) const;
+        void ChunkEvict(Chunk& chunk) const;
+        void ChunksClear();
 
         uint32_t m_width                            = 0;
         uint32_t m_height                           = 0;
         float m_min_y                               = 0.0f;
         float m_max_y                               = 30.0f;
-        float m_vertex_density                      = 1.0f;
-        bool m_is_generating                        = false;
+        float m_stream_distance                     = 1024.0f;
+        float m_lod_distance                        = 128.0f; // distance at which the first level of detail drop happens, every doubling drops another
+        uint32_t m_chunk_jobs_max                   = 8;
+        std::atomic<bool> m_is_generating           = false;
+        std::atomic<uint32_t> m_chunk_jobs          = 0;
         uint64_t m_vertex_count                     = 0;
-        uint64_t m_face_count                       = 0;
         std::atomic<uint64_t> m_progress_jobs_done  = 0;
         uint64_t m_progress_job_count               = 1; // avoid devision by zero in GetProgress()
         std::string m_progress_desc;
         std::shared_ptr<RHI_Texture2D> m_height_map;
-        std::shared_ptr<Model> m_model;
+        std::vector<float> m_heights;
+        std::vector<Chunk> m_chunks;
+        std::vector<Node> m_nodes;                  // quadtree, the root is the last node
+        std::vector<uint32_t> m_chunks_active;      // chunks which are not unloaded
+        std::vector<std::pair<float, uint32_t>> m_chunks_requested;
     };
 }
@@ -36,20 +36,20 @@ namespace Spartan
 {
     Transform::Transform(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id, this)
     {
-        m_positionLocal = Vector3::Zero;
-        m_rotationLocal = Quaternion(0, 0, 0, 1);
-        m_scaleLocal    = Vector3::One;
-        m_matrix        = Matrix::Identity;
-        m_matrixLocal   = Matrix::Identity;
-        m_wvp_previous  = Matrix::Identity;
-        m_parent        = nullptr;
-
-        REGISTER_ATTRIBUTE_VALUE_VALUE(m_positionLocal, Vector3);
-        REGISTER_ATTRIBUTE_VALUE_VALUE(m_rotationLocal, Quaternion);
-        REGISTER_ATTRIBUTE_VALUE_VALUE(m_scaleLocal,    Vector3);
-        REGISTER_ATTRIBUTE_VALUE_VALUE(m_matrix,        Matrix);
-        REGISTER_ATTRIBUTE_VALUE_VALUE(m_matrixLocal,   Matrix);
-        REGISTER_ATTRIBUTE_VALUE_VALUE(m_lookAt,        Vector3);
+        m_hierarchy         = context->GetSubsystem<World>()->GetTransformHierarchy();
+        m_slot              = m_hierarchy->Add(this);
+        m_matrix_previous   = Matrix::Identity;
+        m_parent            = nullptr;
+
+        REGISTER_ATTRIBUTE_GET_SET(GetPositionLocal, SetPositionLocal, Vector3);
+        REGISTER_ATTRIBUTE_GET_SET(GetRotationLocal, SetRotationLocal, Quaternion);
+        REGISTER_ATTRIBUTE_GET_SET(GetScaleLocal,    SetScaleLocal,    Vector3);
+        REGISTER_ATTRIBUTE_VALUE_VALUE(m_lookAt, Vector3);
+    }
+
+    Transform::~Transform()
+    {
+        m_hierarchy->Remove(m_slot);
     }
 
     void Transform::OnInitialize()
@@ -59,18 +59,18 @@ namespace Spartan
 
     void Transform::Serialize(FileStream* stream)
     {
-        stream->Write(m_positionLocal);
-        stream->Write(m_rotationLocal);
-        stream->Write(m_scaleLocal);
+        stream->Write(GetPositionLocal());
+        stream->Write(GetRotationLocal());
+        stream->Write(GetScaleLocal());
         stream->Write(m_lookAt);
         stream->Write(m_parent ? m_parent->GetEntity()->GetId() : 0);
     }
 
     void Transform::Deserialize(FileStream* stream)
     {
-        stream->Read(&m_positionLocal);
-        stream->Read(&m_rotationLocal);
-        stream->Read(&m_scaleLocal);
+        stream->Read(&m_hierarchy->PositionLocal(m_slot));
+        stream->Read(&m_hierarchy->RotationLocal(m_slot));
+        stream->Read(&m_hierarchy->ScaleLocal(m_slot));
         stream->Read(&m_lookAt);
         uint32_t parententity_id = 0;
         stream->Read(&parententity_id);
@@ -88,24 +88,8 @@ namespace Spartan
 
     void Transform::UpdateTransform()
     {
-        // Compute local transform
-        m_matrixLocal = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
-
-        // Compute world transform
-        if (!HasParent())
-        {
-            m_matrix = m_matrixLocal;
-        }
-        else
-        {
-            m_matrix = m_matrixLocal * GetParentTransformMatrix();
-        }
-        
-        // Update children
-        for (const auto& child : m_children)
-        {
-            child->UpdateTransform();
-        }
+        m_hierarchy->MakeDirty(m_slot);
+        m_hierarchy->GetMatrix(m_slot);
     }
 
     void Transform::SetPosition(const Vector3& position)
@@ -118,11 +102,11 @@ namespace Spartan
 
     void Transform::SetPositionLocal(const Vector3& position)
     {
-        if (m_positionLocal == position)
+        if (GetPositionLocal() == position)
             return;
 
-        m_positionLocal = position;
-        UpdateTransform();
+        m_hierarchy->PositionLocal(m_slot) = position;
+        m_hierarchy->MakeDirty(m_slot);
     }
 
     void Transform::SetRotation(const Quaternion& rotation)
@@ -135,11 +119,11 @@ namespace Spartan
 
     void Transform::SetRotationLocal(const Quaternion& rotation)
     {
-        if (m_rotationLocal == rotation)
+        if (GetRotationLocal() == rotation)
             return;
 
-        m_rotationLocal = rotation;
-        UpdateTransform();
+        m_hierarchy->RotationLocal(m_slot) = rotation;
+        m_hierarchy->MakeDirty(m_slot);
     }
 
     void Transform::SetScale(const Vector3& scale)
@@ -152,28 +136,29 @@ namespace Spartan
 
     void Transform::SetScaleLocal(const Vector3& scale)
     {
-        if (m_scaleLocal == scale)
+        if (GetScaleLocal() == scale)
             return;
 
-        m_scaleLocal = scale;
+        Vector3& scale_local = m_hierarchy->ScaleLocal(m_slot);
+        scale_local = scale;
 
         // A scale of 0 will cause a division by zero when decomposing the world transform matrix.
-        m_scaleLocal.x = (m_scaleLocal.x == 0.0f) ? Helper::EPSILON : m_scaleLocal.x;
-        m_scaleLocal.y = (m_scaleLocal.y == 0.0f) ? Helper::EPSILON : m_scaleLocal.y;
-        m_scaleLocal.z = (m_scaleLocal.z == 0.0f) ? Helper::EPSILON : m_scaleLocal.z;
+        scale_local.x = (scale_local.x == 0.0f) ? Helper::EPSILON : scale_local.x;
+        scale_local.y = (scale_local.y == 0.0f) ? Helper::EPSILON : scale_local.y;
+        scale_local.z = (scale_local.z == 0.0f) ? Helper::EPSILON : scale_local.z;
 
-        UpdateTransform();
+        m_hierarchy->MakeDirty(m_slot);
     }
 
     void Transform::Translate(const Vector3& delta)
     {
         if (!HasParent())
         {
-            SetPositionLocal(m_positionLocal + delta);
+            SetPositionLocal(GetPositionLocal() + delta);
         }
         else
         {
-            SetPositionLocal(m_positionLocal + GetParent()->GetMatrix().Inverted() * delta);
+            SetPositionLocal(GetPositionLocal() + GetParent()->GetMatrix().Inverted() * delta);
         }
     }
 
@@ -181,11 +166,11 @@ namespace Spartan
     {
         if (!HasParent())
         {
-            SetRotationLocal((m_rotationLocal * delta).Normalized());
+            SetRotationLocal((GetRotationLocal() * delta).Normalized());
         }
         else
         {
-            SetRotationLocal(m_rotationLocal * GetRotation().Inverse() * delta * GetRotation());
+            SetRotationLocal(GetRotationLocal() * GetRotation().Inverse() * delta * GetRotation());
         }    
     }
 
@@ -247,10 +232,13 @@ namespace Spartan
         if (new_parent->IsDescendantOf(this))
         {
             // if this transform already has a parent
+            // iterate a copy, as the children remove themselves from this transform
+            const auto children = m_children;
+
             if (this->HasParent())
             {
                 // assign the parent of this transform to the children
-                for (const auto& child : m_children)
+                for (const auto& child : children)
                 {
                     child->SetParent(GetParent());
                 }
@@ -258,25 +246,24 @@ namespace Spartan
             else // if this transform doesn't have a parent
             {
                 // make the children orphans
-                for (const auto& child : m_children)
+                for (const auto& child : children)
                 {
                     child->BecomeOrphan();
                 }
             }
         }
 
-        // Switch parent but keep a pointer to the old one
-        auto parent_old = m_parent;
-        m_parent = new_parent;
-        if (parent_old) parent_old->AcquireChildren(); // update the old parent (so it removes this child)
-
-        // make the new parent "aware" of this transform/child
+        // Switch parent, the old one forgets about this transform and the new one adopts it.
+        // Only the two parents are touched, so building a hierarchy (e.g. while loading) is linear.
         if (m_parent)
         {
-            m_parent->AcquireChildren();
+            m_parent->ChildRemove(this);
         }
+        m_parent = new_parent;
+        m_parent->m_children.emplace_back(this);
 
-        UpdateTransform();
+        m_hierarchy->MakeTopologyDirty();
+        m_hierarchy->MakeDirty(m_slot, TransformHierarchy_Dirty_World);
     }
 
     void Transform::AddChild(Transform* child)
@@ -326,8 +313,9 @@ namespace Spartan
     {
         m_children.clear();
         m_children.shrink_to_fit();
+        m_hierarchy->MakeTopologyDirty();
 
-        auto entities = GetContext()->GetSubsystem<World>()->EntityGetAll();
+        const auto& entities = GetContext()->GetSubsystem<World>()->EntityGetAll();
         for (const auto& entity : entities)
         {
             if (!entity)
@@ -394,21 +382,21 @@ namespace Spartan
         if (!m_parent)
             return;
 
-        // create a temporary reference to the parent
-        auto temp_ref = m_parent;
-
-        // delete the original reference
+        // make the parent forget about this child and delete the reference to it
+        m_parent->ChildRemove(this);
         m_parent = nullptr;
 
         // Update the transform without the parent now
-        UpdateTransform();
+        m_hierarchy->MakeTopologyDirty();
+        m_hierarchy->MakeDirty(m_slot, TransformHierarchy_Dirty_World);
+    }
 
-        // make the parent search for children,
-        // that's indirect way of making the parent "forget"
-        // about this child, since it won't be able to find it
-        if (temp_ref)
+    void Transform::ChildRemove(Transform* child)
+    {
+        const auto it = find(m_children.begin(), m_children.end(), child);
+        if (it != m_children.end())
         {
-            temp_ref->AcquireChildren();
+            m_children.erase(it);
         }
     }
 }
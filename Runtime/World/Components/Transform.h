@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Math/Vector3.h"
 #include "../../Math/Quaternion.h"
 #include "../../Math/Matrix.h"
+#include "../TransformHierarchy.h"
 //================================
 
 namespace Spartan
@@ -38,7 +39,7 @@ namespace Spartan
     {
     public:
         Transform(Context* context, Entity* entity, uint32_t id = 0);
-        ~Transform() = default;
+        ~Transform();
 
         //= ICOMPONENT ===============================
         void OnInitialize() override;
@@ -46,25 +47,26 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Recomputes the matrices immediately, otherwise they are recomputed once per frame (or when read)
         void UpdateTransform();
 
         //= POSITION ==============================================================
-        Math::Vector3 GetPosition()     const { return m_matrix.GetTranslation(); }
-        const auto& GetPositionLocal()  const { return m_positionLocal; }
+        Math::Vector3 GetPosition()     const { return GetMatrix().GetTranslation(); }
+        const auto& GetPositionLocal()  const { return m_hierarchy->PositionLocal(m_slot); }
         void SetPosition(const Math::Vector3& position);
         void SetPositionLocal(const Math::Vector3& position);
         //=========================================================================
 
         //= ROTATION ===========================================================
-        Math::Quaternion GetRotation() const { return m_matrix.GetRotation(); }
-        const auto& GetRotationLocal() const { return m_rotationLocal; }
+        Math::Quaternion GetRotation() const { return GetMatrix().GetRotation(); }
+        const auto& GetRotationLocal() const { return m_hierarchy->RotationLocal(m_slot); }
         void SetRotation(const Math::Quaternion& rotation);
         void SetRotationLocal(const Math::Quaternion& rotation);
         //======================================================================
 
         //= SCALE =======================================================
-        auto GetScale()             const { return m_matrix.GetScale(); }
-        const auto& GetScaleLocal() const { return m_scaleLocal; }
+        auto GetScale()             const { return GetMatrix().GetScale(); }
+        const auto& GetScaleLocal() const { return m_hierarchy->ScaleLocal(m_slot); }
         void SetScale(const Math::Vector3& scale);
         void SetScaleLocal(const Math::Vector3& scale);
         //===============================================================
@@ -103,26 +105,26 @@ namespace Spartan
         //======================================================================================
 
         void LookAt(const Math::Vector3& v)                       { m_lookAt = v; }
-        const Math::Matrix& GetMatrix()                     const { return m_matrix; }     
-        const Math::Matrix& GetLocalMatrix()                const { return m_matrixLocal; }
-        const Math::Matrix& GetWvpLastFrame()               const { return m_wvp_previous; }
-        void SetWvpLastFrame(const Math::Matrix& matrix)          { m_wvp_previous = matrix;}
+        const Math::Matrix& GetMatrix()                     const { return m_hierarchy->GetMatrix(m_slot); }
+        const Math::Matrix& GetLocalMatrix()                const { return m_hierarchy->GetMatrixLocal(m_slot); }
+        // The world matrix the renderer saw last, for velocity
+        const Math::Matrix& GetMatrixPrevious()             const { return m_matrix_previous; }
+        void SetMatrixPrevious(const Math::Matrix& matrix)        { m_matrix_previous = matrix; }
 
     private:
+        friend class TransformHierarchy;
         Math::Matrix GetParentTransformMatrix() const;
+        void ChildRemove(Transform* child);
 
-        // local
-        Math::Vector3 m_positionLocal;
-        Math::Quaternion m_rotationLocal;
-        Math::Vector3 m_scaleLocal;
+        // Position, rotation, scale and matrices live in the world's transform hierarchy
+        std::shared_ptr<TransformHierarchy> m_hierarchy;
+        uint32_t m_slot = TransformHierarchy::slot_invalid;
 
-        Math::Matrix m_matrix;
-        Math::Matrix m_matrixLocal;
         Math::Vector3 m_lookAt;
 
         Transform* m_parent; // the parent of this transform
         std::vector<Transform*> m_children; // the children of this transform
 
-        Math::Matrix m_wvp_previous;
+        Math::Matrix m_matrix_previous;
     };
 }
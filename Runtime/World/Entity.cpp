@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Entity.h"
 #include "World.h"
+#include "ComponentPools.h"
 #include "Components/Camera.h"
 #include "Components/Collider.h"
 #include "Components/Transform.h"
@@ -51,6 +52,7 @@ namespace Spartan
         m_name                  = "Entity";
         m_is_active             = true;
         m_hierarchy_visibility  = true;
+        m_component_pools       = context->GetSubsystem<World>()->GetComponentPools();
         AddComponent<Transform>(transform_id);
     }
 
@@ -66,6 +68,7 @@ namespace Spartan
         for (auto it = m_components.begin(); it != m_components.end();)
         {
             (*it)->OnRemove();
+            m_component_pools->Remove((*it).get());
             (*it).reset();
             it = m_components.erase(it);
         }
@@ -109,6 +112,9 @@ namespace Spartan
             // clone children make them call this lambda
             for (const auto& child_transform : original->GetTransform()->GetChildren())
             {
+                if (child_transform->GetEntity()->IsTransient())
+                    continue;
+
                 const auto clone_child = clone_entity_and_descendants(child_transform->GetEntity());
                 clone_child->GetTransform()->SetParent(clone_self->GetTransform());
             }
@@ -139,18 +145,6 @@ namespace Spartan
         }
     }
 
-    void Entity::Tick(float delta_time)
-    {
-        if (!m_is_active)
-            return;
-
-        // call component Update()
-        for (const auto& component : m_components)
-        {
-            component->OnTick(delta_time);
-        }
-    }
-
     void Entity::Serialize(FileStream* stream)
     {
         // BASIC DATA
@@ -178,7 +172,15 @@ namespace Spartan
 
         // CHILDREN
         {
-            auto children = GetTransform()->GetChildren();
+            // Transient children are owned by a component which re-creates them on load
+            vector<Transform*> children;
+            for (Transform* child : GetTransform()->GetChildren())
+            {
+                if (!child->GetEntity() || !child->GetEntity()->IsTransient())
+                {
+                    children.emplace_back(child);
+                }
+            }
 
             // Children count
             stream->Write(static_cast<uint32_t>(children.size()));
@@ -211,8 +213,8 @@ namespace Spartan
         {
             stream->Read(&m_is_active);
             stream->Read(&m_hierarchy_visibility);
-            stream->Read(&m_id);
-            stream->Read(&m_name);
+            SetId(stream->ReadAs<uint32_t>());
+            SetName(stream->ReadAs<string>());
         }
 
         // COMPONENTS
@@ -260,19 +262,39 @@ namespace Spartan
             }
 
             // Children
+            // Each child adds itself to this transform's children as it's parented
             for (const auto& child : children)
             {
                 child.lock()->Deserialize(stream, GetTransform());
             }
-
-            if (m_transform)
-            {
-                m_transform->AcquireChildren();
-            }
         }
 
         // Make the scene resolve
-        FIRE_EVENT(EventType::WorldResolve);
+        QUEUE_EVENT(EventType::WorldResolve);
+    }
+
+    void Entity::SetName(const string& name)
+    {
+        if (name == m_name)
+            return;
+
+        m_name = name;
+
+        if (m_handle.IsValid())
+        {
+            m_context->GetSubsystem<World>()->EntityOnNameChanged();
+        }
+    }
+
+    void Entity::SetId(const uint32_t id)
+    {
+        const uint32_t id_old = m_id;
+        Spartan_Object::SetId(id);
+
+        if (m_handle.IsValid() && id != id_old)
+        {
+            m_context->GetSubsystem<World>()->EntityOnIdChanged(this, id_old);
+        }
     }
 
     IComponent* Entity::AddComponent(const ComponentType type, uint32_t id /*= 0*/)
@@ -302,40 +324,81 @@ namespace Spartan
         return nullptr;
     }
 
-    void Entity::RemoveComponentById(const uint32_t id)
+    void Entity::RemoveComponent(const ComponentType type)
     {
-        ComponentType component_type = ComponentType::Unknown;
-
-        for (auto it = m_components.begin(); it != m_components.end(); ) 
+        for (size_t i = m_components.size(); i-- > 0;)
         {
-            auto component = *it;
-            if (id == component->GetId())
+            if (m_components[i]->GetType() == type)
             {
-                component_type = component->GetType();
-                component->OnRemove();
-                it = m_components.erase(it);    
-                break;
+                ComponentUnregister(i);
             }
-            else
+        }
+
+        // Make the scene resolve
+        QUEUE_EVENT(EventType::WorldResolve);
+    }
+
+    void Entity::RemoveComponentById(const uint32_t id)
+    {
+        for (size_t i = 0; i < m_components.size(); i++)
+        {
+            if (m_components[i]->GetId() == id)
             {
-                ++it;
+                ComponentUnregister(i);
+                break;
             }
         }
 
-        // The script component can have multiple instance, so only remove
-        // it's flag if there are no more components of that type left
-        bool others_of_same_type_exist = false;
-        for (auto it = m_components.begin(); it != m_components.end(); ++it)
+        // Make the scene resolve
+        QUEUE_EVENT(EventType::WorldResolve);
+    }
+
+    void Entity::ComponentRegister(const shared_ptr<IComponent>& component)
+    {
+        const ComponentType type = component->GetType();
+
+        m_components.emplace_back(component);
+        m_component_mask |= GetComponentMask(type);
+        if (!m_components_by_type[static_cast<uint32_t>(type)])
         {
-            others_of_same_type_exist = ((*it)->GetType() == component_type) ? true : others_of_same_type_exist;
+            m_components_by_type[static_cast<uint32_t>(type)] = component.get();
         }
 
-        if (!others_of_same_type_exist)
+        m_component_pools->Add(component.get());
+    }
+
+    void Entity::ComponentUnregister(const size_t index)
+    {
+        const shared_ptr<IComponent> component  = m_components[index];
+        const ComponentType type                = component->GetType();
+
+        component->OnRemove();
+        m_component_pools->Remove(component.get());
+        m_components.erase(m_components.begin() + index);
+
+        if (component.get() == m_renderable)
         {
-            m_component_mask &= ~GetComponentMask(component_type);
+            m_renderable = nullptr;
         }
 
-        // Make the scene resolve
-        FIRE_EVENT(EventType::WorldResolve);
+        // The script component can have multiple instances, so the lookup falls back to the next one of the same type (if any)
+        IComponent*& component_by_type = m_components_by_type[static_cast<uint32_t>(type)];
+        if (component_by_type == component.get())
+        {
+            component_by_type = nullptr;
+            for (const shared_ptr<IComponent>& other : m_components)
+            {
+                if (other->GetType() == type)
+                {
+                    component_by_type = other.get();
+                    break;
+                }
+            }
+        }
+
+        if (!component_by_type)
+        {
+            m_component_mask &= ~GetComponentMask(type);
+        }
     }
 }
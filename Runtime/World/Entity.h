@@ -23,7 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <vector>
+#include <array>
 #include "../Core/EventSystem.h"
+#include "../Core/HandleTable.h"
 #include "Components/IComponent.h"
 //================================
 
@@ -32,6 +34,7 @@ namespace Spartan
     class Context;
     class Transform;
     class Renderable;
+    class ComponentPools;
     
     class SPARTAN_CLASS Entity : public Spartan_Object, public std::enable_shared_from_this<Entity>
     {
@@ -42,19 +45,28 @@ namespace Spartan
         void Clone();
         void Start();
         void Stop();
-        void Tick(float delta_time);
         void Serialize(FileStream* stream);
         void Deserialize(FileStream* stream, Transform* parent);
 
         //= PROPERTIES ===================================================================================================
         const std::string& GetName() const                                { return m_name; }
-        void SetName(const std::string& name)                            { m_name = name; }
+        void SetName(const std::string& name);
+
+        // Hides Spartan_Object::SetId() so that the world's index follows the change
+        void SetId(uint32_t id);
+
+        // Valid while the entity is part of the world, see World::EntityGetByHandle()
+        const Handle& GetHandle() const                                    { return m_handle; }
 
         bool IsActive() const                                            { return m_is_active; }
         void SetActive(const bool active)                                { m_is_active = active; }
 
         bool IsVisibleInHierarchy() const                                { return m_hierarchy_visibility; }
         void SetHierarchyVisibility(const bool hierarchy_visibility)    { m_hierarchy_visibility = hierarchy_visibility; }
+
+        // Transient entities are spawned at runtime (e.g. terrain chunks), they are never saved or cloned
+        bool IsTransient() const                                        { return m_is_transient; }
+        void SetTransient(const bool is_transient)                        { m_is_transient = is_transient; }
         //================================================================================================================
 
         // Adds a component of type T
@@ -70,20 +82,19 @@ namespace Spartan
             // Create a new component
             std::shared_ptr<T> component = std::make_shared<T>(m_context, this, id);
 
-            // Save new component
-            m_components.emplace_back(std::static_pointer_cast<IComponent>(component));
-            m_component_mask |= GetComponentMask(type);
-
             // Caching of rendering performance critical components
             if constexpr (std::is_same<T, Transform>::value)    { m_transform   = static_cast<Transform*>(component.get()); }
             if constexpr (std::is_same<T, Renderable>::value)   { m_renderable  = static_cast<Renderable*>(component.get()); }
 
-            // Initialize component
+            // Save new component (and add it to the pool of its type)
             component->SetType(type);
+            ComponentRegister(std::static_pointer_cast<IComponent>(component));
+
+            // Initialize component
             component->OnInitialize();
 
             // Make the scene resolve
-            FIRE_EVENT(EventType::WorldResolve);
+            QUEUE_EVENT(EventType::WorldResolve);
 
             return component.get();
         }
@@ -95,18 +106,7 @@ namespace Spartan
         template <class T>
         T* GetComponent()
         {
-            const ComponentType type = IComponent::TypeToEnum<T>();
-
-            if (!HasComponent(type))
-                return nullptr;
-
-            for (const auto& component : m_components)
-            {
-                if (component->GetType() == type)
-                    return static_cast<T*>(component.get());
-            }
-
-            return nullptr;
+            return static_cast<T*>(m_components_by_type[static_cast<uint32_t>(IComponent::TypeToEnum<T>())]);
         }
 
         // Returns any components of type T (if they exist)
@@ -139,29 +139,10 @@ namespace Spartan
 
         // Removes a component (if it exists)
         template <class T>
-        void RemoveComponent()
-        {
-            const ComponentType type = IComponent::TypeToEnum<T>();
-
-            for (auto it = m_components.begin(); it != m_components.end();)
-            {
-                auto component = *it;
-                if (component->GetType() == type)
-                {
-                    component->OnRemove();
-                    it = m_components.erase(it);
-                    m_component_mask &= ~GetComponentMask(type);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-
-            // Make the scene resolve
-            FIRE_EVENT(Event_World_Resolve_Pending);
-        }
+        void RemoveComponent() { RemoveComponent(IComponent::TypeToEnum<T>()); }
 
+        // Removes all components of ComponentType
+        void RemoveComponent(ComponentType type);
         void RemoveComponentById(uint32_t id);
         const auto& GetAllComponents() const { return m_components; }
 
@@ -174,17 +155,25 @@ namespace Spartan
         std::shared_ptr<Entity> GetPtrShared()  { return shared_from_this(); }
 
     private:
+        friend class World;
+
         constexpr uint32_t GetComponentMask(ComponentType type) { return static_cast<uint32_t>(1) << static_cast<uint32_t>(type); }
+        void ComponentRegister(const std::shared_ptr<IComponent>& component);
+        void ComponentUnregister(size_t index);
 
         std::string m_name            = "Entity";
         bool m_is_active            = true;
         bool m_hierarchy_visibility    = true;
+        bool m_is_transient         = false;
         Transform* m_transform        = nullptr;
         Renderable* m_renderable    = nullptr;
         bool m_destruction_pending  = false;
+        Handle m_handle;
         
-        // Components
+        // Components, owned here, the world's pools only point at them
         std::vector<std::shared_ptr<IComponent>> m_components;
+        std::array<IComponent*, static_cast<uint32_t>(ComponentType::Unknown) + 1> m_components_by_type = {}; // first of each type, Unknown stays null
         uint32_t m_component_mask = 0;
+        std::shared_ptr<ComponentPools> m_component_pools;
     };
 }
@@ -0,0 +1,131 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "TickScheduler.h"
+#include "ComponentPools.h"
+#include "../Threading/Threading.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    void TickScheduler::Add(TickPhase phase)
+    {
+        // A phase always writes its own components
+        if (phase.type != ComponentType::Unknown)
+        {
+            phase.writes |= Mask(phase.type);
+        }
+
+        // Join the last stage, unless this phase conflicts with any phase in it
+        bool new_stage = m_stages.empty();
+        for (size_t i = new_stage ? m_phases.size() : m_stages.back(); i < m_phases.size(); i++)
+        {
+            new_stage = new_stage || Conflicts(m_phases[i], phase);
+        }
+
+        if (new_stage)
+        {
+            m_stages.emplace_back(static_cast<uint32_t>(m_phases.size()));
+        }
+
+        m_phases.emplace_back(move(phase));
+    }
+
+    void TickScheduler::Tick(Threading* threading, const float delta_time)
+    {
+        const uint32_t stage_count = static_cast<uint32_t>(m_stages.size());
+        for (uint32_t stage = 0; stage < stage_count; stage++)
+        {
+            const uint32_t start    = m_stages[stage];
+            const uint32_t end      = stage + 1 == stage_count ? static_cast<uint32_t>(m_phases.size()) : m_stages[stage + 1];
+
+            // Hand all but the first phase to other threads, then do the first one in this thread
+            TaskHandle parent = TaskHandle();
+            if (end - start > 1)
+            {
+                parent = threading->CreateTask([] {});
+                for (uint32_t i = start + 1; i < end; i++)
+                {
+                    threading->AddTask([this, threading, delta_time, i]() { Run(m_phases[i], threading, delta_time); }, parent);
+                }
+                threading->SubmitTask(parent);
+            }
+
+            Run(m_phases[start], threading, delta_time);
+
+            if (parent.IsValid())
+            {
+                threading->Wait(parent);
+            }
+        }
+    }
+
+    bool TickScheduler::Conflicts(const TickPhase& a, const TickPhase& b)
+    {
+        if (a.mode == TickPhase_Exclusive || b.mode == TickPhase_Exclusive)
+            return true;
+
+        return (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+    }
+
+    void TickScheduler::Run(const TickPhase& phase, Threading* threading, const float delta_time) const
+    {
+        if (phase.function)
+        {
+            phase.function(delta_time);
+            return;
+        }
+
+        const vector<IComponent*>& components   = m_pools->GetComponents(phase.type);
+        const vector<Entity*>& entities         = m_pools->GetEntities(phase.type);
+
+        if (phase.mode == TickPhase_Parallel)
+        {
+            threading->ParallelFor(static_cast<uint32_t>(components.size()), [&components, &entities, delta_time](const uint32_t start, const uint32_t end)
+            {
+                for (uint32_t i = start; i < end; i++)
+                {
+                    if (entities[i]->IsActive())
+                    {
+                        components[i]->OnTick(delta_time);
+                    }
+                }
+            });
+
+            return;
+        }
+
+        // By index, exclusive phases are allowed to create entities while ticking
+        for (size_t i = 0; i < components.size(); i++)
+        {
+            if (entities[i]->IsActive())
+            {
+                components[i]->OnTick(delta_time);
+            }
+        }
+    }
+}
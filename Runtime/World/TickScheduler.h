@@ -0,0 +1,74 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include <functional>
+#include "Components/IComponent.h"
+//=================================
+
+namespace Spartan
+{
+    class Threading;
+    class ComponentPools;
+
+    enum TickPhase_Mode : uint8_t
+    {
+        TickPhase_Exclusive,    // touches state beyond its own components (script code, physics, entity creation), always runs alone
+        TickPhase_Serial,       // runs on a single thread, next to any phases it doesn't conflict with
+        TickPhase_Parallel      // the components are independent of each other, so the pool is split across threads
+    };
+
+    // A step of the world update, ticking all the components of one type (or running a function instead)
+    struct TickPhase
+    {
+        ComponentType type                  = ComponentType::Unknown;
+        uint32_t reads                      = 0; // masks of the component types accessed, see TickScheduler::Mask()
+        uint32_t writes                     = 0;
+        TickPhase_Mode mode                 = TickPhase_Serial;
+        std::function<void(float)> function = nullptr;
+    };
+
+    // Runs the component updates of the world.
+    // Phases run in the order they were added, but consecutive phases whose accesses don't conflict are grouped
+    // into a stage and run side by side, while parallel phases also split their components across threads.
+    class TickScheduler
+    {
+    public:
+        TickScheduler(ComponentPools* pools) { m_pools = pools; }
+
+        void Add(TickPhase phase);
+        void Tick(Threading* threading, float delta_time);
+
+        static constexpr uint32_t Mask(const ComponentType type) { return static_cast<uint32_t>(1) << static_cast<uint32_t>(type); }
+        static const uint32_t mask_all = static_cast<uint32_t>(-1);
+
+    private:
+        static bool Conflicts(const TickPhase& a, const TickPhase& b);
+        void Run(const TickPhase& phase, Threading* threading, float delta_time) const;
+
+        ComponentPools* m_pools = nullptr;
+        std::vector<TickPhase> m_phases;
+        std::vector<uint32_t> m_stages; // start of each stage in m_phases
+    };
+}
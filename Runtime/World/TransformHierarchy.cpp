@@ -0,0 +1,230 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Spartan.h"
+#include "TransformHierarchy.h"
+#include "Components/Transform.h"
+#include "../Threading/Threading.h"
+//=================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    uint32_t TransformHierarchy::Add(Transform* owner)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // Reuse a slot, or append one
+        uint32_t slot = slot_invalid;
+        if (!m_slots_free.empty())
+        {
+            slot = m_slots_free.back();
+            m_slots_free.pop_back();
+        }
+        else
+        {
+            if (m_slot_count == page_size * page_count_max)
+            {
+                LOG_ERROR("Maximum transform count reached");
+                return slot_invalid;
+            }
+
+            slot = m_slot_count++;
+            if (!m_pages[slot >> page_size_log2])
+            {
+                m_pages[slot >> page_size_log2] = make_unique<Page>();
+            }
+        }
+
+        Page* page              = GetPage(slot);
+        const uint32_t i        = slot & page_mask;
+        page->position_local[i] = Vector3::Zero;
+        page->rotation_local[i] = Quaternion(0, 0, 0, 1);
+        page->scale_local[i]    = Vector3::One;
+        page->matrix_local[i]   = Matrix::Identity;
+        page->matrix[i]         = Matrix::Identity;
+        page->owner[i]          = owner;
+        page->dirty[i]          = TransformHierarchy_Dirty_Local | TransformHierarchy_Dirty_World;
+        m_topology_dirty        = true;
+
+        return slot;
+    }
+
+    void TransformHierarchy::Remove(const uint32_t slot)
+    {
+        if (slot == slot_invalid)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        GetPage(slot)->owner[slot & page_mask] = nullptr;
+        m_slots_free.emplace_back(slot);
+        m_topology_dirty = true;
+    }
+
+    const Matrix& TransformHierarchy::GetMatrixLocal(const uint32_t slot)
+    {
+        Resolve(slot);
+        return GetPage(slot)->matrix_local[slot & page_mask];
+    }
+
+    const Matrix& TransformHierarchy::GetMatrix(const uint32_t slot)
+    {
+        Resolve(slot);
+        return GetPage(slot)->matrix[slot & page_mask];
+    }
+
+    void TransformHierarchy::Update(Threading* threading)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            if (m_topology_dirty)
+            {
+                RebuildOrder();
+            }
+        }
+
+        const uint32_t subtree_count = static_cast<uint32_t>(m_subtrees.size());
+        const uint32_t order_count   = static_cast<uint32_t>(m_order.size());
+
+        // Each root's subtree is independent of the others, so they can be updated in parallel.
+        // Within a subtree, parents come before their children, so a single linear pass is enough.
+        threading->ParallelFor(subtree_count, [this, subtree_count, order_count](uint32_t start, uint32_t end)
+        {
+            const uint32_t order_start  = m_subtrees[start];
+            const uint32_t order_end    = end == subtree_count ? order_count : m_subtrees[end];
+
+            for (uint32_t i = order_start; i < order_end; i++)
+            {
+                const uint32_t slot         = m_order[i];
+                const uint32_t parent       = m_order_parent[i];
+                uint8_t dirty               = GetPage(slot)->dirty[slot & page_mask];
+
+                // Inherit changes from the parent
+                if (parent != slot_invalid && m_order_changed[parent])
+                {
+                    dirty |= TransformHierarchy_Dirty_World;
+                }
+
+                m_order_changed[i] = dirty != 0;
+                if (dirty != 0)
+                {
+                    Compute(slot, parent == slot_invalid ? slot_invalid : m_order[parent], dirty);
+                }
+            }
+        });
+    }
+
+    void TransformHierarchy::Compute(const uint32_t slot, const uint32_t slot_parent, const uint8_t dirty)
+    {
+        Page* page          = GetPage(slot);
+        const uint32_t i    = slot & page_mask;
+
+        if (dirty & TransformHierarchy_Dirty_Local)
+        {
+            page->matrix_local[i] = Matrix(page->position_local[i], page->rotation_local[i], page->scale_local[i]);
+        }
+
+        if (slot_parent == slot_invalid)
+        {
+            page->matrix[i] = page->matrix_local[i];
+        }
+        else
+        {
+            page->matrix[i] = page->matrix_local[i] * GetPage(slot_parent)->matrix[slot_parent & page_mask];
+        }
+
+        page->dirty[i] = 0;
+    }
+
+    void TransformHierarchy::Resolve(const uint32_t slot)
+    {
+        // A world matrix is valid as long as neither the transform nor any of its ancestors is dirty
+        static thread_local vector<Transform*> chain;
+        chain.clear();
+        size_t chain_dirty_end = 0;
+        for (Transform* transform = GetPage(slot)->owner[slot & page_mask]; transform; transform = transform->GetParent())
+        {
+            chain.emplace_back(transform);
+            if (GetPage(transform->m_slot)->dirty[transform->m_slot & page_mask] != 0)
+            {
+                chain_dirty_end = chain.size();
+            }
+        }
+
+        // Recompute from the top-most dirty ancestor down to the transform
+        for (size_t i = chain_dirty_end; i-- > 0;)
+        {
+            Transform* transform        = chain[i];
+            const uint32_t slot_self    = transform->m_slot;
+            const uint8_t dirty         = GetPage(slot_self)->dirty[slot_self & page_mask] | TransformHierarchy_Dirty_World;
+            Compute(slot_self, transform->HasParent() ? transform->GetParent()->m_slot : slot_invalid, dirty);
+
+            // The children are now out of date, the ones on the chain get recomputed next, the rest on demand or during Update()
+            for (Transform* child : transform->GetChildren())
+            {
+                MakeDirty(child->m_slot, TransformHierarchy_Dirty_World);
+            }
+        }
+    }
+
+    void TransformHierarchy::RebuildOrder()
+    {
+        m_order.clear();
+        m_order_parent.clear();
+        m_subtrees.clear();
+
+        // Depth first from every root, so each subtree ends up contiguous with parents ahead of their children
+        vector<pair<Transform*, uint32_t>> stack;
+        for (uint32_t slot = 0; slot < m_slot_count; slot++)
+        {
+            Transform* root = GetPage(slot)->owner[slot & page_mask];
+            if (!root || root->HasParent())
+                continue;
+
+            m_subtrees.emplace_back(static_cast<uint32_t>(m_order.size()));
+
+            stack.emplace_back(root, slot_invalid);
+            while (!stack.empty())
+            {
+                const auto [transform, parent] = stack.back();
+                stack.pop_back();
+
+                const uint32_t index = static_cast<uint32_t>(m_order.size());
+                m_order.emplace_back(transform->m_slot);
+                m_order_parent.emplace_back(parent);
+
+                for (Transform* child : transform->GetChildren())
+                {
+                    stack.emplace_back(child, index);
+                }
+            }
+        }
+
+        m_order_changed.resize(m_order.size());
+        m_topology_dirty = false;
+    }
+}
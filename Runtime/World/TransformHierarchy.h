@@ -0,0 +1,107 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include "../Math/Vector3.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Matrix.h"
+//=============================
+
+namespace Spartan
+{
+    class Transform;
+    class Threading;
+
+    enum TransformHierarchy_Dirty : uint8_t
+    {
+        TransformHierarchy_Dirty_Local  = 1 << 0, // position, rotation or scale changed
+        TransformHierarchy_Dirty_World  = 1 << 1  // an ancestor changed
+    };
+
+    // Storage for every Transform in the world, laid out as structure of arrays.
+    // Setters only flag a slot as dirty, the world matrices are then recomputed in one batched pass per frame
+    // (split across threads by root subtree). Reading a dirty transform before that resolves just its ancestor chain.
+    class TransformHierarchy
+    {
+    public:
+        static const uint32_t slot_invalid = static_cast<uint32_t>(-1);
+
+        //= SLOTS =================================================================
+        uint32_t Add(Transform* owner);
+        void Remove(uint32_t slot);
+        // Has to be called whenever a parent/child relationship changes
+        void MakeTopologyDirty() { m_topology_dirty = true; }
+        //=========================================================================
+
+        //= PROPERTIES ============================================================================================
+        Math::Vector3& PositionLocal(const uint32_t slot)       { return GetPage(slot)->position_local[slot & page_mask]; }
+        Math::Quaternion& RotationLocal(const uint32_t slot)    { return GetPage(slot)->rotation_local[slot & page_mask]; }
+        Math::Vector3& ScaleLocal(const uint32_t slot)          { return GetPage(slot)->scale_local[slot & page_mask]; }
+        const Math::Matrix& GetMatrixLocal(uint32_t slot);
+        const Math::Matrix& GetMatrix(uint32_t slot);
+        void MakeDirty(const uint32_t slot, const uint8_t flags = TransformHierarchy_Dirty_Local | TransformHierarchy_Dirty_World) { GetPage(slot)->dirty[slot & page_mask] |= flags; }
+        //=========================================================================================================
+
+        // Recomputes every dirty world matrix
+        void Update(Threading* threading);
+
+    private:
+        static const uint32_t page_size_log2    = 8;
+        static const uint32_t page_size         = 1 << page_size_log2;
+        static const uint32_t page_mask         = page_size - 1;
+        static const uint32_t page_count_max    = 4096; // ~1M transforms
+
+        // Fixed size blocks, slots never move so transforms can be created while others are being read
+        struct Page
+        {
+            std::array<Math::Vector3, page_size>    position_local;
+            std::array<Math::Quaternion, page_size> rotation_local;
+            std::array<Math::Vector3, page_size>    scale_local;
+            std::array<Math::Matrix, page_size>     matrix_local;
+            std::array<Math::Matrix, page_size>     matrix;
+            std::array<Transform*, page_size>       owner;
+            std::array<uint8_t, page_size>          dirty;
+        };
+
+        Page* GetPage(const uint32_t slot) const { return m_pages[slot >> page_size_log2].get(); }
+        void Compute(uint32_t slot, uint32_t slot_parent, uint8_t dirty);
+        void Resolve(uint32_t slot);
+        void RebuildOrder();
+
+        std::array<std::unique_ptr<Page>, page_count_max> m_pages;
+        uint32_t m_slot_count = 0;
+        std::vector<uint32_t> m_slots_free;
+        std::mutex m_mutex;
+
+        // Hierarchy order, every parent comes before its children and each root's subtree is a contiguous range
+        std::vector<uint32_t> m_order;          // slot
+        std::vector<uint32_t> m_order_parent;   // index of the parent in m_order
+        std::vector<uint32_t> m_subtrees;       // start of each root's range in m_order
+        std::vector<uint8_t> m_order_changed;   // scratch, which entries were recomputed during Update()
+        bool m_topology_dirty = true;
+    };
+}
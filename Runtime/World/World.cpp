@@ -23,6 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "World.h"
 #include "Entity.h"
+#include "TransformHierarchy.h"
+#include "ComponentPools.h"
+#include "TickScheduler.h"
 #include "Components/Transform.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
@@ -35,6 +38,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Rendering/Renderer.h"
 #include "../Input/Input.h"
 #include "../RHI/RHI_Device.h"
+#include "../Threading/Threading.h"
 //=====================================
 
 //= NAMESPACES ================
@@ -46,10 +50,39 @@ namespace Spartan
 {
     World::World(Context* context) : ISubsystem(context)
     {
-        // Subscribe to events
-        SUBSCRIBE_TO_EVENT(EventType::WorldResolve, [this](Variant) { m_is_dirty = true; });
-        SUBSCRIBE_TO_EVENT(EventType::WorldStop,    [this](Variant)    { m_state = WorldState::Idle; });
-        SUBSCRIBE_TO_EVENT(EventType::WorldStart,   [this](Variant)    { m_state = WorldState::Ticking; });
+        m_transform_hierarchy   = make_shared<TransformHierarchy>();
+        m_component_pools       = make_shared<ComponentPools>();
+        m_tick_scheduler        = make_shared<TickScheduler>(m_component_pools.get());
+
+        // Component updates, in order (every component type which implements OnTick() needs a phase here)
+        {
+            const uint32_t transform    = TickScheduler::Mask(ComponentType::Transform);
+            const uint32_t camera       = TickScheduler::Mask(ComponentType::Camera);
+
+            // Scripts can do anything, physics drives the bullet world, terrain spawns entities
+            m_tick_scheduler->Add({ ComponentType::Script,         TickScheduler::mask_all, TickScheduler::mask_all, TickPhase_Exclusive });
+            m_tick_scheduler->Add({ ComponentType::RigidBody,      transform,               0,                       TickPhase_Exclusive });
+            m_tick_scheduler->Add({ ComponentType::SoftBody,       transform,               0,                       TickPhase_Exclusive });
+            m_tick_scheduler->Add({ ComponentType::Constraint,     0,                       0,                       TickPhase_Exclusive });
+            m_tick_scheduler->Add({ ComponentType::Camera,         transform,               transform,               TickPhase_Serial });    // fps control moves the camera
+            m_tick_scheduler->Add({ ComponentType::AudioListener,  transform,               0,                       TickPhase_Serial });
+            m_tick_scheduler->Add({ ComponentType::Environment,    0,                       0,                       TickPhase_Serial });
+            m_tick_scheduler->Add({ ComponentType::Terrain,        transform | camera,      0,                       TickPhase_Exclusive });
+
+            // Propagate this frame's transform changes, in one batch, so that everything after only reads them
+            m_tick_scheduler->Add({ ComponentType::Unknown, 0, transform, TickPhase_Serial, [this](float)
+            {
+                m_transform_hierarchy->Update(m_context->GetSubsystem<Threading>());
+            }});
+
+            m_tick_scheduler->Add({ ComponentType::Light,          transform | camera,      0,                       TickPhase_Parallel });
+            m_tick_scheduler->Add({ ComponentType::AudioSource,    transform,               0,                       TickPhase_Parallel });
+        }
+
+        // Subscribe to events, stopping and starting only toggle ticking so that they never overwrite a requested or ongoing load
+        SUBSCRIBE_TO_EVENT(EventType::WorldResolve, [this]() { m_is_dirty = true; });
+        SUBSCRIBE_TO_EVENT(EventType::WorldStop,    [this]() { SetState(WorldState::Ticking, WorldState::Idle); });
+        SUBSCRIBE_TO_EVENT(EventType::WorldStart,   [this]() { SetState(WorldState::Idle, WorldState::Ticking); });
     }
 
     World::~World()
@@ -57,12 +90,14 @@ namespace Spartan
         Unload();
         m_input     = nullptr;
         m_profiler  = nullptr;
+        m_renderer  = nullptr;
     }
 
     bool World::Initialize()
     {
-        m_input        = m_context->GetSubsystem<Input>();
-        m_profiler    = m_context->GetSubsystem<Profiler>();
+        m_input     = m_context->GetSubsystem<Input>();
+        m_profiler  = m_context->GetSubsystem<Profiler>();
+        m_renderer  = m_context->GetSubsystem<Renderer>();
 
         CreateCamera();
         CreateEnvironment();
@@ -73,9 +108,9 @@ namespace Spartan
 
     void World::Tick(float delta_time)
     {    
-        if (m_state == WorldState::RequestLoading)
+        if (m_state == WorldState::RequestLoading && SetState(WorldState::RequestLoading, WorldState::Loading))
         {
-            m_state = WorldState::Loading;
+            m_state_condition.notify_all();
             return;
         }
 
@@ -109,11 +144,8 @@ namespace Spartan
                 }
             }
 
-            // Tick
-            for (const auto& entity : m_entities)
-            {
-                entity->Tick(delta_time);
-            }
+            // Tick, by component type
+            m_tick_scheduler->Tick(m_context->GetSubsystem<Threading>(), delta_time);
         }
 
         if (m_is_dirty)
@@ -132,10 +164,13 @@ namespace Spartan
                 }
             }
 
-            // Notify Renderer
+            // Notify subsystems
             FIRE_EVENT_DATA(EventType::WorldResolved, m_entities);
             m_is_dirty = false;
         }
+
+        // Hand this frame over to the renderer, it draws it while the next one is simulated
+        m_renderer->SnapshotPublish();
     }
 
     void World::Unload()
@@ -143,12 +178,27 @@ namespace Spartan
         // Notify any systems that the entities are about to be cleared
         FIRE_EVENT(EventType::WorldUnload);
 
+        // Anything still holding on to an entity keeps it alive, but it's no longer part of the world
+        for (const auto& entity : m_entities)
+        {
+            m_component_pools->Remove(entity.get());
+            entity->m_handle = Handle();
+        }
+
         m_entities.clear();
         m_entities.shrink_to_fit();
+        m_entity_handles.Clear();
+        m_entity_index_id.clear();
+        m_entity_index_name.clear();
+        m_entity_index_name_dirty = true;
 
         m_is_dirty = true;
     }
 
+    // Chunks of the native world format, root entity i (along with its descendants) lives in chunk chunk_entity + i
+    static const uint32_t chunk_roots   = 0;
+    static const uint32_t chunk_entity  = 1;
+
     bool World::SaveToFile(const string& filePathIn)
     {
         // Start progress report and timer
@@ -169,20 +219,23 @@ namespace Spartan
         FIRE_EVENT(EventType::WorldSave);
 
         // Create a prefab file
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Chunked);
         if (!file->IsOpen())
         {
             LOG_ERROR_GENERIC_FAILURE();
+            ProgressReport::Get().SetIsLoading(g_progress_world, false);
             return false;
         }
 
         // Only save root entities as they will also save their descendants
         auto root_actors = EntityGetRoots();
+        root_actors.erase(remove_if(root_actors.begin(), root_actors.end(), [](const shared_ptr<Entity>& entity) { return entity->IsTransient(); }), root_actors.end());
         const auto root_entity_count = static_cast<uint32_t>(root_actors.size());
 
         ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
 
         // Save root entity count
+        file->ChunkBegin(chunk_roots);
         file->Write(root_entity_count);
 
         // Save root entity IDs
@@ -191,10 +244,11 @@ namespace Spartan
             file->Write(root->GetId());
         }
 
-        // Save root entities
-        for (const auto& root : root_actors)
+        // Save root entities, one chunk each (along with their descendants)
+        for (uint32_t i = 0; i < root_entity_count; i++)
         {
-            root->Serialize(file.get());
+            file->ChunkBegin(chunk_entity + i);
+            root_actors[i]->Serialize(file.get());
             ProgressReport::Get().IncrementJobsDone(g_progress_world);
         }
 
@@ -208,6 +262,16 @@ namespace Spartan
         return true;
     }
 
+    bool World::SetState(const WorldState expected, const WorldState state)
+    {
+        lock_guard<mutex> lock(m_state_mutex);
+        if (m_state != expected)
+            return false;
+
+        m_state = state;
+        return true;
+    }
+
     bool World::LoadFromFile(const string& file_path)
     {
         if (!FileSystem::Exists(file_path))
@@ -216,11 +280,11 @@ namespace Spartan
             return false;
         }
 
-        // Thread safety: Wait for the world and the renderer to stop using entities
-        while (m_state != WorldState::Loading || m_context->GetSubsystem<Renderer>()->IsRendering())
+        // Thread safety: Wait for the world to stop ticking, the renderer only reads published snapshots so it can keep going
         {
+            unique_lock<mutex> lock(m_state_mutex);
             m_state = WorldState::RequestLoading;
-            this_thread::sleep_for(chrono::milliseconds(16));
+            m_state_condition.wait(lock, [this] { return m_state == WorldState::Loading; });
         }
 
         // Start progress report and timing
@@ -228,15 +292,34 @@ namespace Spartan
         ProgressReport::Get().SetIsLoading(g_progress_world, true);
         ProgressReport::Get().SetStatus(g_progress_world, "Loading world...");
         const Stopwatch timer;
+
+        // Whichever way this function returns, the world goes back to ticking and the progress report closes
+        struct LoadScope
+        {
+            World* world;
+            ~LoadScope()
+            {
+                world->SetState(WorldState::Loading, WorldState::Ticking);
+                ProgressReport::Get().SetIsLoading(g_progress_world, false);
+            }
+        } load_scope = { this };
         
         // Unload current entities
         Unload();
 
         // Read all the resource file paths
-        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped | FileStream_Chunked);
         if (!file->IsOpen())
             return false;
 
+        // Files which predate the chunked container (version 0) store the same fields back to back
+        const bool chunked = file->GetVersion() != 0;
+        if (chunked && !file->ChunkSeek(chunk_roots))
+        {
+            LOG_ERROR("\"%s\" has no root entities chunk", file_path.c_str());
+            return false;
+        }
+
         m_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
 
         // Notify subsystems that need to load data
@@ -257,13 +340,17 @@ namespace Spartan
         // Serialize root entities
         for (uint32_t i = 0; i < root_entity_count; i++)
         {
+            if (chunked && !file->ChunkSeek(chunk_entity + i))
+            {
+                LOG_ERROR("\"%s\" is missing root entity %d", file_path.c_str(), i);
+                break;
+            }
+
             m_entities[i]->Deserialize(file.get(), nullptr);
             ProgressReport::Get().IncrementJobsDone(g_progress_world);
         }
 
-        m_is_dirty    = true;
-        m_state        = WorldState::Ticking;
-        ProgressReport::Get().SetIsLoading(g_progress_world, false);    
+        m_is_dirty = true;
         LOG_INFO("Loading took %.2f ms", timer.GetElapsedTimeMs());
 
         FIRE_EVENT(EventType::WorldLoaded);
@@ -273,6 +360,7 @@ namespace Spartan
     shared_ptr<Entity>& World::EntityCreate(bool is_active /*= true*/)
     {
         auto& entity = m_entities.emplace_back(make_shared<Entity>(m_context));
+        EntityRegister(entity.get());
         entity->SetActive(is_active);
         return entity;
     }
@@ -284,6 +372,7 @@ namespace Spartan
         if (!entity)
             return empty;
 
+        EntityRegister(entity.get());
         return m_entities.emplace_back(entity);
     }
 
@@ -292,7 +381,7 @@ namespace Spartan
         if (!entity)
             return false;
 
-        return EntityGetById(entity->GetId()) != nullptr;
+        return EntityGetByHandle(entity->GetHandle()) == entity.get();
     }
 
     void World::EntityRemove(const shared_ptr<Entity>& entity)
@@ -320,28 +409,61 @@ namespace Spartan
         return root_entities;
     }
 
-    const shared_ptr<Entity>& World::EntityGetByName(const string& name)
+    shared_ptr<Entity> World::EntityGetByName(const string& name)
     {
-        for (const auto& entity : m_entities)
+        // Names change far more often than they are looked up (e.g. every entity while loading), so the index is rebuilt lazily
+        if (m_entity_index_name_dirty)
         {
-            if (entity->GetName() == name)
-                return entity;
+            m_entity_index_name.clear();
+            for (const auto& entity : m_entities)
+            {
+                m_entity_index_name.emplace(entity->GetName(), entity->GetHandle());
+            }
+            m_entity_index_name_dirty = false;
         }
 
-        static shared_ptr<Entity> empty;
-        return empty;
+        const auto it = m_entity_index_name.find(name);
+        Entity* entity = it != m_entity_index_name.end() ? EntityGetByHandle(it->second) : nullptr;
+        return entity ? entity->GetPtrShared() : nullptr;
     }
 
-    const shared_ptr<Entity>& World::EntityGetById(const uint32_t id)
+    shared_ptr<Entity> World::EntityGetById(const uint32_t id)
     {
-        for (const auto& entity : m_entities)
+        const auto it = m_entity_index_id.find(id);
+        Entity* entity = it != m_entity_index_id.end() ? EntityGetByHandle(it->second) : nullptr;
+        return entity ? entity->GetPtrShared() : nullptr;
+    }
+
+    void World::EntityRegister(Entity* entity)
+    {
+        entity->m_handle                    = m_entity_handles.Add(entity);
+        m_entity_index_id[entity->GetId()]  = entity->m_handle;
+        m_entity_index_name_dirty           = true;
+    }
+
+    void World::EntityUnregister(Entity* entity)
+    {
+        // Another entity might have been given the same id since
+        const auto it = m_entity_index_id.find(entity->GetId());
+        if (it != m_entity_index_id.end() && it->second == entity->m_handle)
         {
-            if (entity->GetId() == id)
-                return entity;
+            m_entity_index_id.erase(it);
         }
 
-        static shared_ptr<Entity> empty;
-        return empty;
+        m_entity_handles.Remove(entity->m_handle);
+        entity->m_handle            = Handle();
+        m_entity_index_name_dirty   = true;
+    }
+
+    void World::EntityOnIdChanged(Entity* entity, const uint32_t id_old)
+    {
+        const auto it = m_entity_index_id.find(id_old);
+        if (it != m_entity_index_id.end() && it->second == entity->m_handle)
+        {
+            m_entity_index_id.erase(it);
+        }
+
+        m_entity_index_id[entity->GetId()] = entity->m_handle;
     }
 
     // Removes an entity and all of it's children
@@ -361,8 +483,10 @@ namespace Spartan
         for (auto it = m_entities.begin(); it < m_entities.end();)
         {
             const auto temp = *it;
-            if (temp->GetId() == entity->GetId())
+            if (temp == entity)
             {
+                m_component_pools->Remove(temp.get());
+                EntityUnregister(temp.get());
                 it = m_entities.erase(it);
                 break;
             }
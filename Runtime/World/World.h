@@ -25,7 +25,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <memory>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_map>
 #include "../Core/ISubsystem.h"
+#include "../Core/HandleTable.h"
 #include "../Core/Spartan_Definitions.h"
 //======================================
 
@@ -35,6 +40,10 @@ namespace Spartan
     class Light;
     class Input;
     class Profiler;
+    class Renderer;
+    class TransformHierarchy;
+    class ComponentPools;
+    class TickScheduler;
 
     enum class WorldState
     {
@@ -61,20 +70,36 @@ namespace Spartan
         const auto& GetName() const { return m_name; }
         void MakeDirty() { m_is_dirty = true; }
 
-        //= Entities ===========================================================================
+        //= Entities ===============================================================================================
         std::shared_ptr<Entity>& EntityCreate(bool is_active = true);
         std::shared_ptr<Entity>& EntityAdd(const std::shared_ptr<Entity>& entity);
         bool EntityExists(const std::shared_ptr<Entity>& entity);
         void EntityRemove(const std::shared_ptr<Entity>& entity);    
         std::vector<std::shared_ptr<Entity>> EntityGetRoots();
-        const std::shared_ptr<Entity>& EntityGetByName(const std::string& name);
-        const std::shared_ptr<Entity>& EntityGetById(uint32_t id);
-        const auto& EntityGetAll() const    { return m_entities; }
-        auto EntityGetCount() const         { return static_cast<uint32_t>(m_entities.size()); }
-        //======================================================================================
+        std::shared_ptr<Entity> EntityGetByName(const std::string& name);
+        std::shared_ptr<Entity> EntityGetById(uint32_t id);
+        Entity* EntityGetByHandle(const Handle& handle) const   { return m_entity_handles.Get(handle); }
+        const auto& EntityGetAll() const                        { return m_entities; }
+        auto EntityGetCount() const                             { return static_cast<uint32_t>(m_entities.size()); }
+        //==========================================================================================================
+
+        const auto& GetTransformHierarchy() const   { return m_transform_hierarchy; }
+        const auto& GetComponentPools() const       { return m_component_pools; }
 
     private:
+        friend class Entity;
+
         void _EntityRemove(const std::shared_ptr<Entity>& entity);
+        // Moves to the given state if the world is in the expected one, under m_state_mutex so that a waiting load can't miss it
+        bool SetState(WorldState expected, WorldState state);
+
+        //= ENTITY LOOKUP ========================================================
+        void EntityRegister(Entity* entity);
+        void EntityUnregister(Entity* entity);
+        // Called by entities which are part of the world, to keep the indices valid
+        void EntityOnIdChanged(Entity* entity, uint32_t id_old);
+        void EntityOnNameChanged() { m_entity_index_name_dirty = true; }
+        //========================================================================
 
         //= COMMON ENTITY CREATION ========================
         std::shared_ptr<Entity>& CreateEnvironment();
@@ -85,10 +110,20 @@ namespace Spartan
         std::string m_name;
         bool m_was_in_editor_mode   = false;
         bool m_is_dirty             = true;
-        WorldState m_state          = WorldState::Ticking;
+        std::atomic<WorldState> m_state = WorldState::Ticking;
         Input* m_input              = nullptr;
         Profiler* m_profiler        = nullptr;
+        Renderer* m_renderer        = nullptr;
+        std::mutex m_state_mutex;
+        std::condition_variable m_state_condition; // signaled when a requested load can start
 
         std::vector<std::shared_ptr<Entity>> m_entities;
+        HandleTable<Entity> m_entity_handles;
+        std::unordered_map<uint32_t, Handle> m_entity_index_id;
+        std::unordered_map<std::string, Handle> m_entity_index_name; // first entity with each name, rebuilt on lookup after a change
+        bool m_entity_index_name_dirty = true;
+        std::shared_ptr<TransformHierarchy> m_transform_hierarchy;
+        std::shared_ptr<ComponentPools> m_component_pools;
+        std::shared_ptr<TickScheduler> m_tick_scheduler;
     };
 }
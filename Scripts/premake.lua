@@ -19,10 +19,12 @@
 
 SOLUTION_NAME				= "Spartan"
 EDITOR_NAME					= "Editor"
+BENCHMARK_NAME				= "Benchmark"
 RUNTIME_NAME				= "Runtime"
 TARGET_NAME					= "Spartan" -- Name of executable
 DEBUG_FORMAT				= "c7"
 EDITOR_DIR					= "../" .. EDITOR_NAME
+BENCHMARK_DIR				= "../" .. BENCHMARK_NAME
 RUNTIME_DIR					= "../" .. RUNTIME_NAME
 IGNORE_FILES				= {}
 ADDITIONAL_INCLUDES			= {}
@@ -33,6 +35,7 @@ INTERMEDIATE_DIR			= "../Binaries/Intermediate"
 TARGET_DIR_RELEASE  		= "../Binaries/Release"
 TARGET_DIR_DEBUG    		= "../Binaries/Debug"
 API_GRAPHICS				= _ARGS[1]
+SIMD						= _ARGS[2] or "sse4" -- "avx2", "sse4" or "scalar", see Runtime/Math/Simd.h
 
 -- Compute graphics api specific variables
 if API_GRAPHICS == "d3d11" then
@@ -40,16 +43,19 @@ if API_GRAPHICS == "d3d11" then
 	TARGET_NAME		= "Spartan_d3d11"
 	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D12/**"
 	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/Vulkan/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Null/**"
 elseif API_GRAPHICS == "d3d12" then
 	API_GRAPHICS	= "API_GRAPHICS_D3D12"
 	TARGET_NAME		= "Spartan_d3d12"
 	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D11/**"
 	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/Vulkan/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Null/**"
 elseif API_GRAPHICS == "vulkan" then
 	API_GRAPHICS				= "API_GRAPHICS_VULKAN"
 	TARGET_NAME					= "Spartan_vk"
 	IGNORE_FILES[0]				= RUNTIME_DIR .. "/RHI/D3D11/**"
 	IGNORE_FILES[1]				= RUNTIME_DIR .. "/RHI/D3D12/**"
+	IGNORE_FILES[2]				= RUNTIME_DIR .. "/RHI/Null/**"
 	ADDITIONAL_INCLUDES[0] 		= "../ThirdParty/DirectXShaderCompiler";
 	ADDITIONAL_INCLUDES[1] 		= "../ThirdParty/SPIRV-Cross-2020-09-17";
 	ADDITIONAL_INCLUDES[2] 		= "../ThirdParty/Vulkan_1.2.154.1";
@@ -61,6 +67,12 @@ elseif API_GRAPHICS == "vulkan" then
 	ADDITIONAL_LIBRARIES_DBG[1] = "spirv-cross-core_debug";
 	ADDITIONAL_LIBRARIES_DBG[2] = "spirv-cross-hlsl_debug";
 	ADDITIONAL_LIBRARIES_DBG[3] = "spirv-cross-glsl_debug";
+elseif API_GRAPHICS == "null" then
+	API_GRAPHICS	= "API_GRAPHICS_NULL"
+	TARGET_NAME		= "Spartan_null"
+	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D11/**"
+	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/D3D12/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Vulkan/**"
 end
 
 -- Solution
@@ -78,6 +90,17 @@ solution (SOLUTION_NAME)
 		"SPARTAN_RUNTIME_STATIC=1",
 		"SPARTAN_RUNTIME_SHARED=0"
 	}
+
+	-- Instruction set, MSVC doesn't define a macro for SSE4.1 so the build has to
+	if SIMD == "avx2" then
+		vectorextensions "AVX2"
+		defines { "SPARTAN_SIMD_SSE4" }
+	elseif SIMD == "sse4" then
+		vectorextensions "SSE4.1"
+		defines { "SPARTAN_SIMD_SSE4" }
+	else
+		defines { "SPARTAN_SIMD_DISABLED" }
+	end
 	
 	filter { "platforms:x64" }
 		system "Windows"
@@ -118,7 +141,7 @@ project (RUNTIME_NAME)
 	}
 	
 	-- Source to ignore
-	removefiles { IGNORE_FILES[0], IGNORE_FILES[1] }
+	removefiles { IGNORE_FILES[0], IGNORE_FILES[1], IGNORE_FILES[2] }
 
 	-- Includes
 	includedirs { "../ThirdParty/Assimp_5.0.0" }
@@ -192,6 +215,41 @@ project (EDITOR_NAME)
 	-- Libraries
 	libdirs (LIBRARY_DIR)
 
+	-- "Debug"
+	filter "configurations:Debug"
+		targetdir (TARGET_DIR_DEBUG)	
+		debugdir (TARGET_DIR_DEBUG)
+		debugformat (DEBUG_FORMAT)		
+				
+	-- "Release"
+	filter "configurations:Release"
+		targetdir (TARGET_DIR_RELEASE)
+		debugdir (TARGET_DIR_RELEASE)
+
+-- Benchmark -----------------------------------------------------------------------------------------------
+project (BENCHMARK_NAME)
+	location (BENCHMARK_DIR)
+	links { RUNTIME_NAME }
+	dependson { RUNTIME_NAME }
+	targetname ( TARGET_NAME .. "_benchmark" )
+	objdir (INTERMEDIATE_DIR)
+	kind "ConsoleApp"
+	staticruntime "On"
+	defines{ API_GRAPHICS }
+	
+	-- Files
+	files 
+	{ 
+		BENCHMARK_DIR .. "/**.h",
+		BENCHMARK_DIR .. "/**.cpp"
+	}
+	
+	-- Includes
+	includedirs { "../" .. RUNTIME_NAME }
+	
+	-- Libraries
+	libdirs (LIBRARY_DIR)
+
 	-- "Debug"
 	filter "configurations:Debug"
 		targetdir (TARGET_DIR_DEBUG)	